@@ -13,5 +13,6 @@
 inline int omp_get_thread_num() { return 0; }
 inline int omp_get_max_threads() { return 1; }
 inline void omp_set_num_threads(int num_threads) { }
+inline int omp_in_parallel() { return 0; }
 #endif
 
@@ -0,0 +1,325 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include "aliceVision/camera/IntrinsicBase.hpp"
+#include "aliceVision/image/image.hpp"
+#include "aliceVision/config.hpp"
+
+#if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_SSE)
+#include <emmintrin.h>
+#endif
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+namespace aliceVision {
+namespace camera {
+
+/**
+ * @brief Precomputed undistortion map of a camera for a given image size.
+ *
+ * For each pixel of the undistorted image, the map gives the position to sample
+ * in the distorted image, ie IntrinsicBase::get_d_pixel(). As the distortion is
+ * smooth, the exact positions are only computed on a grid of step x step pixels
+ * and bilinearly interpolated in between: the map is step^2 times smaller than
+ * the image and computing it needs step^2 times less evaluations of the
+ * distortion model than the image size.
+ */
+class UndistortionMap
+{
+public:
+
+  /**
+   * @brief Compute the undistortion map.
+   * @param[in] cam The camera.
+   * @param[in] width The width of the images to undistort.
+   * @param[in] height The height of the images to undistort.
+   * @param[in] step The distance in pixels between two exact positions.
+   */
+  UndistortionMap(const IntrinsicBase& cam, int width, int height, int step = 4)
+    : _width(width)
+    , _height(height)
+    , _step(std::max(step, 1))
+    , _gridWidth((width - 1) / _step + 2)
+    , _gridHeight((height - 1) / _step + 2)
+    , _gridX(_gridWidth * _gridHeight)
+    , _gridY(_gridWidth * _gridHeight)
+  {
+    #pragma omp parallel for
+    for(int gy = 0; gy < _gridHeight; ++gy)
+    {
+      for(int gx = 0; gx < _gridWidth; ++gx)
+      {
+        const Vec2 disto_pix = cam.get_d_pixel(Vec2(gx * _step, gy * _step));
+        _gridX[gy * _gridWidth + gx] = static_cast<float>(disto_pix(0));
+        _gridY[gy * _gridWidth + gx] = static_cast<float>(disto_pix(1));
+      }
+    }
+  }
+
+  int width() const { return _width; }
+  int height() const { return _height; }
+  int step() const { return _step; }
+
+  /// Get the memory used by the map in bytes.
+  std::size_t memorySize() const
+  {
+    return (_gridX.size() + _gridY.size()) * sizeof(float);
+  }
+
+  /**
+   * @brief Get the positions in the distorted image of a row of the undistorted image.
+   * @param[in] y The row of the undistorted image.
+   * @param[out] xs The x coordinates of the row, at least width() long.
+   * @param[out] ys The y coordinates of the row, at least width() long.
+   */
+  void getRow(int y, float* xs, float* ys) const
+  {
+    const int gy = y / _step;
+    const float fy = static_cast<float>(y - gy * _step) / _step;
+    const float* x0 = &_gridX[gy * _gridWidth];
+    const float* y0 = &_gridY[gy * _gridWidth];
+    const float* x1 = x0 + _gridWidth;
+    const float* y1 = y0 + _gridWidth;
+    const float invStep = 1.f / _step;
+
+    for(int gx = 0; gx * _step < _width; ++gx)
+    {
+      // positions of the row at the grid nodes gx and gx+1
+      const float ax = x0[gx] + fy * (x1[gx] - x0[gx]);
+      const float ay = y0[gx] + fy * (y1[gx] - y0[gx]);
+      const float dx = (x0[gx + 1] + fy * (x1[gx + 1] - x0[gx + 1]) - ax) * invStep;
+      const float dy = (y0[gx + 1] + fy * (y1[gx + 1] - y0[gx + 1]) - ay) * invStep;
+
+      const int begin = gx * _step;
+      const int end = std::min(begin + _step, _width);
+      // branchless loop, vectorized by the compiler
+      for(int x = begin; x < end; ++x)
+      {
+        xs[x] = ax + (x - begin) * dx;
+        ys[x] = ay + (x - begin) * dy;
+      }
+    }
+  }
+
+private:
+  int _width;
+  int _height;
+  int _step;
+  int _gridWidth;
+  int _gridHeight;
+  std::vector<float> _gridX;
+  std::vector<float> _gridY;
+};
+
+/**
+ * @brief Thread safe cache of the undistortion maps, so that the map of a camera
+ * is computed once for all the views sharing it.
+ * The maps are identified by IntrinsicBase::hashValue() and the image size.
+ */
+class UndistortionMapCache
+{
+public:
+
+  /**
+   * @brief Get the undistortion map of a camera, it is computed on the first call.
+   * @param[in] cam The camera.
+   * @param[in] width The width of the images to undistort.
+   * @param[in] height The height of the images to undistort.
+   * @return the undistortion map.
+   */
+  std::shared_ptr<const UndistortionMap> get(const IntrinsicBase& cam, int width, int height)
+  {
+    const Key key(cam.hashValue(), width, height);
+    std::lock_guard<std::mutex> lock(_mutex);
+    std::shared_ptr<const UndistortionMap>& map = _maps[key];
+    // the map is computed under the lock: the views of the same camera wait for it
+    if(!map)
+      map = std::make_shared<const UndistortionMap>(cam, width, height, _step);
+    return map;
+  }
+
+  /// Set the distance in pixels between two exact positions of the new maps.
+  void setStep(int step)
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _step = step;
+  }
+
+  std::size_t size() const
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _maps.size();
+  }
+
+  void clear()
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _maps.clear();
+  }
+
+private:
+  typedef std::tuple<std::size_t, int, int> Key;
+
+  mutable std::mutex _mutex;
+  std::map<Key, std::shared_ptr<const UndistortionMap> > _maps;
+  int _step = 4;
+};
+
+namespace detail {
+
+/// Number of bits of the fractional part of the fixed point sampling positions
+const int REMAP_FRACTION_BITS = 5;
+const int REMAP_FRACTION_SCALE = 1 << REMAP_FRACTION_BITS;
+const int REMAP_WEIGHT_BITS = 2 * REMAP_FRACTION_BITS;
+
+/// Number of 8-bit channels of a pixel type, 0 for the other pixel types
+template <typename T> struct RemapChannels { static const int value = 0; };
+template <> struct RemapChannels<unsigned char> { static const int value = 1; };
+template <> struct RemapChannels<image::RGBColor> { static const int value = 3; };
+template <> struct RemapChannels<image::RGBAColor> { static const int value = 4; };
+
+/**
+ * @brief Bilinear interpolation of a pixel of 8-bit channels with fixed point weights.
+ * @param[in] p0 The top left pixel.
+ * @param[in] p1 The bottom left pixel.
+ * @param[in] fx, fy The fractional position in [0, REMAP_FRACTION_SCALE].
+ * @param[out] out The interpolated pixel.
+ */
+template <int NbChannels>
+inline void bilinearU8(const unsigned char* p0, const unsigned char* p1, int fx, int fy, unsigned char* out)
+{
+  const int w00 = (REMAP_FRACTION_SCALE - fx) * (REMAP_FRACTION_SCALE - fy);
+  const int w01 = fx * (REMAP_FRACTION_SCALE - fy);
+  const int w10 = (REMAP_FRACTION_SCALE - fx) * fy;
+  const int w11 = fx * fy;
+
+#if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_SSE)
+  // all the channels are interpolated at once in 32-bit lanes
+  uint32_t a = 0, b = 0, c = 0, d = 0;
+  std::memcpy(&a, p0, NbChannels);
+  std::memcpy(&b, p0 + NbChannels, NbChannels);
+  std::memcpy(&c, p1, NbChannels);
+  std::memcpy(&d, p1 + NbChannels, NbChannels);
+
+  const __m128i zero = _mm_setzero_si128();
+  // interleave the left and right pixels: a0 b0 a1 b1 ... as 16-bit values
+  const __m128i top = _mm_unpacklo_epi8(_mm_unpacklo_epi8(_mm_cvtsi32_si128(a), _mm_cvtsi32_si128(b)), zero);
+  const __m128i bottom = _mm_unpacklo_epi8(_mm_unpacklo_epi8(_mm_cvtsi32_si128(c), _mm_cvtsi32_si128(d)), zero);
+  const __m128i wTop = _mm_set1_epi32(w00 | (w01 << 16));
+  const __m128i wBottom = _mm_set1_epi32(w10 | (w11 << 16));
+
+  __m128i sum = _mm_add_epi32(_mm_madd_epi16(top, wTop), _mm_madd_epi16(bottom, wBottom));
+  sum = _mm_srli_epi32(_mm_add_epi32(sum, _mm_set1_epi32(1 << (REMAP_WEIGHT_BITS - 1))), REMAP_WEIGHT_BITS);
+  sum = _mm_packs_epi32(sum, sum);
+  sum = _mm_packus_epi16(sum, sum);
+
+  const uint32_t result = static_cast<uint32_t>(_mm_cvtsi128_si32(sum));
+  std::memcpy(out, &result, NbChannels);
+#else
+  for(int c = 0; c < NbChannels; ++c)
+  {
+    const int sum = w00 * p0[c] + w01 * p0[NbChannels + c] + w10 * p1[c] + w11 * p1[NbChannels + c];
+    out[c] = static_cast<unsigned char>((sum + (1 << (REMAP_WEIGHT_BITS - 1))) >> REMAP_WEIGHT_BITS);
+  }
+#endif
+}
+
+/// Bilinear interpolation of a pixel inside the image, 8-bit channels version
+template <typename T>
+inline typename std::enable_if<(RemapChannels<T>::value > 0)>::type
+  bilinearInside(const image::Image<T>& imageIn, int x0, int y0, float dx, float dy, T& out)
+{
+  const int fx = static_cast<int>(dx * REMAP_FRACTION_SCALE + 0.5f);
+  const int fy = static_cast<int>(dy * REMAP_FRACTION_SCALE + 0.5f);
+  bilinearU8<RemapChannels<T>::value>(reinterpret_cast<const unsigned char*>(&imageIn(y0, x0)),
+                                      reinterpret_cast<const unsigned char*>(&imageIn(y0 + 1, x0)),
+                                      fx, fy, reinterpret_cast<unsigned char*>(&out));
+}
+
+/// Bilinear interpolation of a pixel inside the image, generic version
+template <typename T>
+inline typename std::enable_if<(RemapChannels<T>::value == 0)>::type
+  bilinearInside(const image::Image<T>& imageIn, int x0, int y0, float dx, float dy, T& out)
+{
+  typedef image::RealPixel<T> RealPixelT;
+  const typename RealPixelT::real_type res =
+    RealPixelT::convert_to_real(imageIn(y0, x0)) * ((1.0 - dx) * (1.0 - dy)) +
+    RealPixelT::convert_to_real(imageIn(y0, x0 + 1)) * (dx * (1.0 - dy)) +
+    RealPixelT::convert_to_real(imageIn(y0 + 1, x0)) * ((1.0 - dx) * dy) +
+    RealPixelT::convert_to_real(imageIn(y0 + 1, x0 + 1)) * (dx * dy);
+  out = RealPixelT::convert_from_real(res);
+}
+
+} // namespace detail
+
+/**
+ * @brief Undistort an image with a precomputed undistortion map.
+ *
+ * Same as UndistortImage() with a bilinear sampling: the sampling positions of a
+ * row are interpolated from the map and the pixels are interpolated with fixed
+ * point weights (1/32 pixel) for 8-bit images.
+ *
+ * @param[in] imageIn The distorted image.
+ * @param[in] map The undistortion map, its size must be the size of the image.
+ * @param[out] image_ud The undistorted image.
+ * @param[in] fillcolor The color of the pixels outside of the distorted image.
+ */
+template <typename Image>
+void UndistortImage(
+  const Image& imageIn,
+  const UndistortionMap& map,
+  Image & image_ud,
+  typename Image::Tpixel fillcolor = typename Image::Tpixel(0))
+{
+  typedef typename Image::Tpixel T;
+  assert(map.width() == imageIn.Width() && map.height() == imageIn.Height());
+
+  const int width = imageIn.Width();
+  const int height = imageIn.Height();
+  image_ud.resize(width, height, true, fillcolor);
+  const image::Sampler2d<image::SamplerLinear> sampler;
+
+  #pragma omp parallel
+  {
+    std::vector<float> xs(width);
+    std::vector<float> ys(width);
+
+    #pragma omp for
+    for (int j = 0; j < height; ++j)
+    {
+      map.getRow(j, xs.data(), ys.data());
+      for (int i = 0; i < width; ++i)
+      {
+        const float x = xs[i];
+        const float y = ys[i];
+        // pick pixel if it is in the image domain
+        if (!imageIn.Contains(static_cast<int>(y), static_cast<int>(x)))
+          continue;
+
+        const int x0 = static_cast<int>(std::floor(x));
+        const int y0 = static_cast<int>(std::floor(y));
+        if (x0 >= 0 && y0 >= 0 && x0 + 1 < width && y0 + 1 < height)
+          detail::bilinearInside<T>(imageIn, x0, y0, x - x0, y - y0, image_ud(j, i));
+        else // on the border, only the pixels in the image are used
+          image_ud(j, i) = sampler(imageIn, y, x);
+      }
+    }
+  }
+}
+
+} // namespace camera
+} // namespace aliceVision
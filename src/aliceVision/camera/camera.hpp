@@ -13,6 +13,7 @@
 #include "aliceVision/camera/PinholeFisheye.hpp"
 #include "aliceVision/camera/PinholeFisheye1.hpp"
 #include "aliceVision/camera/cameraUndistortImage.hpp"
+#include "aliceVision/camera/UndistortionMap.hpp"
 
 namespace aliceVision {
 namespace camera {
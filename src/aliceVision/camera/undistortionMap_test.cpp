@@ -0,0 +1,162 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "aliceVision/camera/camera.hpp"
+
+#define BOOST_TEST_MODULE undistortionMap
+#include <boost/test/included/unit_test.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+#include <aliceVision/unitTest.hpp>
+
+#include <cstdlib>
+
+using namespace aliceVision;
+using namespace aliceVision::camera;
+using namespace aliceVision::image;
+
+namespace {
+
+/// Reference undistortion: the distortion model is evaluated at each pixel
+template <typename Image>
+void undistortImageReference(const Image& imageIn, const IntrinsicBase& cam, Image& image_ud)
+{
+  image_ud.resize(imageIn.Width(), imageIn.Height(), true, typename Image::Tpixel(0));
+  const Sampler2d<SamplerLinear> sampler;
+  for (int j = 0; j < imageIn.Height(); ++j)
+    for (int i = 0; i < imageIn.Width(); ++i)
+    {
+      const Vec2 disto_pix = cam.get_d_pixel(Vec2(i, j));
+      if (imageIn.Contains(disto_pix(1), disto_pix(0)))
+        image_ud(j, i) = sampler(imageIn, disto_pix(1), disto_pix(0));
+    }
+}
+
+/// Smooth image with some noise, without discontinuity
+template <typename T>
+void fillImage(Image<T>& image, int width, int height, int nbChannels)
+{
+  image.resize(width, height);
+  std::srand(0);
+  for (int j = 0; j < height; ++j)
+    for (int i = 0; i < width; ++i)
+    {
+      unsigned char* pixel = reinterpret_cast<unsigned char*>(&image(j, i));
+      for (int c = 0; c < nbChannels; ++c)
+        pixel[c] = static_cast<unsigned char>(std::min((i * (c + 1)) / 5 + j + std::rand() % 8, 255));
+    }
+}
+
+template <typename T>
+int maxDifference(const Image<T>& a, const Image<T>& b, int nbChannels)
+{
+  int maxDiff = 0;
+  for (int j = 0; j < a.Height(); ++j)
+    for (int i = 0; i < a.Width(); ++i)
+    {
+      const unsigned char* pa = reinterpret_cast<const unsigned char*>(&a(j, i));
+      const unsigned char* pb = reinterpret_cast<const unsigned char*>(&b(j, i));
+      for (int c = 0; c < nbChannels; ++c)
+        maxDiff = std::max(maxDiff, std::abs(int(pa[c]) - int(pb[c])));
+    }
+  return maxDiff;
+}
+
+} // namespace
+
+//-----------------
+// Test summary:
+//-----------------
+// - Create a PinholeRadialK3 camera
+// - Compute its undistortion map
+// - Check that the interpolated positions are close to the exact distorted positions
+//-----------------
+BOOST_AUTO_TEST_CASE(undistortionMap_positions)
+{
+  const int width = 321;
+  const int height = 243;
+  const PinholeRadialK3 cam(width, height, 300, 160, 120,
+    // K1, K2, K3
+    -0.245539, 0.255195, 0.163773);
+
+  const UndistortionMap map(cam, width, height);
+  BOOST_CHECK_EQUAL(map.width(), width);
+  BOOST_CHECK_EQUAL(map.height(), height);
+  BOOST_CHECK(map.memorySize() < width * height * sizeof(float));
+
+  std::vector<float> xs(width);
+  std::vector<float> ys(width);
+  double maxError = 0.0;
+  for (int j = 0; j < height; ++j)
+  {
+    map.getRow(j, xs.data(), ys.data());
+    for (int i = 0; i < width; ++i)
+    {
+      const Vec2 disto_pix = cam.get_d_pixel(Vec2(i, j));
+      maxError = std::max(maxError, (disto_pix - Vec2(xs[i], ys[i])).norm());
+    }
+  }
+  BOOST_CHECK_SMALL(maxError, 2e-2);
+}
+
+//-----------------
+// Test summary:
+//-----------------
+// - Undistort grey, RGB and RGBA images with a precomputed map
+// - Check that the result matches the per pixel undistortion
+//-----------------
+BOOST_AUTO_TEST_CASE(undistortionMap_remap)
+{
+  const int width = 160;
+  const int height = 120;
+  const PinholeRadialK3 cam(width, height, 150, 80, 60,
+    // K1, K2, K3
+    -0.245539, 0.255195, 0.163773);
+  const UndistortionMap map(cam, width, height);
+
+  {
+    Image<unsigned char> image, image_ud, image_ref;
+    fillImage(image, width, height, 1);
+    UndistortImage(image, map, image_ud);
+    undistortImageReference(image, cam, image_ref);
+    BOOST_CHECK_LE(maxDifference(image_ud, image_ref, 1), 2);
+  }
+  {
+    Image<RGBColor> image, image_ud, image_ref;
+    fillImage(image, width, height, 3);
+    UndistortImage(image, map, image_ud, BLACK);
+    undistortImageReference(image, cam, image_ref);
+    BOOST_CHECK_LE(maxDifference(image_ud, image_ref, 3), 2);
+  }
+  {
+    Image<RGBAColor> image, image_ud, image_ref;
+    fillImage(image, width, height, 4);
+    UndistortImage(image, map, image_ud);
+    undistortImageReference(image, cam, image_ref);
+    BOOST_CHECK_LE(maxDifference(image_ud, image_ref, 4), 2);
+  }
+}
+
+//-----------------
+// Test summary:
+//-----------------
+// - Get the maps of several cameras from the cache
+// - Check that a map is computed once per camera and image size
+//-----------------
+BOOST_AUTO_TEST_CASE(undistortionMap_cache)
+{
+  const PinholeRadialK3 camA(640, 480, 500, 320, 240, -0.2, 0.1, 0.0);
+  const PinholeRadialK3 camB(640, 480, 500, 320, 240, -0.2, 0.1, 0.0);
+  const PinholeRadialK3 camC(640, 480, 500, 320, 240, -0.1, 0.1, 0.0);
+
+  UndistortionMapCache cache;
+  const std::shared_ptr<const UndistortionMap> mapA = cache.get(camA, 640, 480);
+  BOOST_CHECK_EQUAL(mapA, cache.get(camB, 640, 480));
+  BOOST_CHECK_NE(mapA, cache.get(camC, 640, 480));
+  BOOST_CHECK_NE(mapA, cache.get(camA, 320, 240));
+  BOOST_CHECK_EQUAL(cache.size(), 3);
+
+  cache.clear();
+  BOOST_CHECK_EQUAL(cache.size(), 0);
+}
@@ -6,8 +6,16 @@
 #pragma once
 
 #include "aliceVision/image/image.hpp"
+#include "aliceVision/config.hpp"
 #include "dependencies/histogram/histogram.hpp"
+
+#if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_SSE)
+#include <emmintrin.h>
+#endif
+
+#include <array>
 #include <string>
+#include <vector>
 
 namespace aliceVision {
 namespace colorHarmonization {
@@ -60,6 +68,71 @@ public:
     }
   }
 
+  /**
+   * Compute Histogram for the color's masked data of an 8-bit RGB image
+   *
+   * The values of the masked pixels are counted first and the histogram is
+   * updated once per value. The mask is tested 16 pixels at a time with SSE2.
+   *
+   * \param[in] mask Binary image to determine acceptable zones
+   * \param[in] channelIndex selected channel : 0 = red; 1 = green; 2 = blue
+   * \param[in] image Image with RGB type
+   * \param[out] histo  Histogram of the left image.
+   *
+   */
+  static void computeHisto(
+    Histogram< double > & histo,
+    const image::Image< unsigned char >& mask,
+    size_t channelIndex,
+    const image::Image< image::RGBColor >& image )
+  {
+    // 4 count tables to reduce the dependencies between successive increments
+    std::vector< std::array< std::size_t, 256 > > counts(4);
+    for(auto& count : counts)
+      count.fill(0);
+
+    const int width = mask.Width();
+    for(int j = 0; j < mask.Height(); ++j)
+    {
+      const unsigned char* maskRow = &mask(j, 0);
+      const unsigned char* values = reinterpret_cast<const unsigned char*>(&image(j, 0)) + channelIndex;
+      int i = 0;
+#if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_SSE)
+      const __m128i zero = _mm_setzero_si128();
+      for(; i + 16 <= width; i += 16)
+      {
+        const __m128i maskValues = _mm_loadu_si128(reinterpret_cast<const __m128i*>(maskRow + i));
+        const int isMasked = ~_mm_movemask_epi8(_mm_cmpeq_epi8(maskValues, zero)) & 0xFFFF;
+        if(isMasked == 0)
+          continue;
+        if(isMasked == 0xFFFF)
+        {
+          for(int k = 0; k < 16; ++k)
+            ++counts[k & 3][values[3 * (i + k)]];
+        }
+        else
+        {
+          for(int k = 0; k < 16; ++k)
+            if(isMasked & (1 << k))
+              ++counts[k & 3][values[3 * (i + k)]];
+        }
+      }
+#endif
+      for(; i < width; ++i)
+      {
+        if(maskRow[i] != 0)
+          ++counts[i & 3][values[3 * i]];
+      }
+    }
+
+    for(int v = 0; v < 256; ++v)
+    {
+      const std::size_t count = counts[0][v] + counts[1][v] + counts[2][v] + counts[3][v];
+      if(count != 0)
+        histo.Add(v, count);
+    }
+  }
+
   const std::string & getLeftImage()const{ return _sLeftImage; }
   const std::string & getRightImage()const{ return _sRightImage; }
 
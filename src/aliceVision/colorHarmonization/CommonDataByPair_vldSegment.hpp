@@ -19,11 +19,15 @@ class CommonDataByPair_vldSegment  : public CommonDataByPair
                                const std::string& sRightImage,
                                const matching::IndMatches& matchesPerDesc,
                                const std::vector<feature::SIOPointFeature>& featsL,
-                               const std::vector<feature::SIOPointFeature>& featsR)
+                               const std::vector<feature::SIOPointFeature>& featsR,
+                               const image::Image< unsigned char >* imageLeft = nullptr,
+                               const image::Image< unsigned char >* imageRight = nullptr)
            : CommonDataByPair( sLeftImage, sRightImage )
            , _matches( matchesPerDesc )
            , _featsL( featsL )
            , _featsR( featsR )
+           , _imageLeft( imageLeft )
+           , _imageRight( imageRight )
   {}
 
   virtual ~CommonDataByPair_vldSegment()
@@ -41,12 +45,17 @@ class CommonDataByPair_vldSegment  : public CommonDataByPair
     image::Image< unsigned char > & maskLeft,
     image::Image< unsigned char > & maskRight )
   {
+    // use the already decoded images if any
     image::Image< unsigned char > imageL, imageR;
-    image::ReadImage( _sLeftImage.c_str(), &imageL );
-    image::ReadImage( _sRightImage.c_str(), &imageR );
+    if( _imageLeft == nullptr )
+      image::ReadImage( _sLeftImage.c_str(), &imageL );
+    if( _imageRight == nullptr )
+      image::ReadImage( _sRightImage.c_str(), &imageR );
+    const image::Image< unsigned char >& imageLeft = _imageLeft ? *_imageLeft : imageL;
+    const image::Image< unsigned char >& imageRight = _imageRight ? *_imageRight : imageR;
 
-    image::Image< float > imgA ( imageL.GetMat().cast< float >() );
-    image::Image< float > imgB(imageR.GetMat().cast< float >());
+    image::Image< float > imgA ( imageLeft.GetMat().cast< float >() );
+    image::Image< float > imgB(imageRight.GetMat().cast< float >());
 
     std::vector< Pair > matchesFiltered, matchesPair;
 
@@ -106,6 +115,9 @@ private:
   const vector<feature::SIOPointFeature>& _featsR;
   // Left and Right corresponding index (putatives matches)
   matching::IndMatches _matches;
+  // Left and Right grey images, optional
+  const image::Image< unsigned char >* _imageLeft;
+  const image::Image< unsigned char >* _imageRight;
 };
 
 }  // namespace colorHarmonization
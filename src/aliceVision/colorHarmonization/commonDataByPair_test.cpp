@@ -0,0 +1,51 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/colorHarmonization/CommonDataByPair.hpp>
+#include <aliceVision/image/image.hpp>
+
+#include <cstdlib>
+
+#define BOOST_TEST_MODULE CommonDataByPair
+#include <boost/test/included/unit_test.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::image;
+using namespace aliceVision::colorHarmonization;
+
+BOOST_AUTO_TEST_CASE(CommonDataByPair_computeHisto)
+{
+  std::srand(0);
+  // widths with a remainder not processed by blocks of 16 pixels
+  const int widths[] = {1, 16, 37, 64, 101};
+  for(const int width : widths)
+  {
+    const int height = 23;
+    Image<RGBColor> image(width, height);
+    Image<unsigned char> mask(width, height);
+    for(int j = 0; j < height; ++j)
+    {
+      for(int i = 0; i < width; ++i)
+      {
+        image(j, i) = RGBColor(std::rand() % 256, std::rand() % 256, std::rand() % 256);
+        // fully masked, empty and partially masked rows
+        mask(j, i) = (j % 3 == 0) ? 255 : (j % 3 == 1) ? 0 : (std::rand() % 2) * (1 + std::rand() % 255);
+      }
+    }
+
+    for(size_t channelIndex = 0; channelIndex < 3; ++channelIndex)
+    {
+      Histogram<double> histo(0.0, 255.0, 256);
+      Histogram<double> histoReference(0.0, 255.0, 256);
+      CommonDataByPair::computeHisto(histo, mask, channelIndex, image);
+      CommonDataByPair::computeHisto<RGBColor>(histoReference, mask, channelIndex, image);
+
+      const std::vector<size_t>& freq = histo.GetHist();
+      const std::vector<size_t>& freqReference = histoReference.GetHist();
+      BOOST_CHECK_EQUAL_COLLECTIONS(freq.begin(), freq.end(), freqReference.begin(), freqReference.end());
+      BOOST_CHECK_EQUAL(histo.GetTotalCount(), histoReference.GetTotalCount());
+    }
+  }
+}
@@ -247,7 +247,7 @@ public:
 
   inline const void* DescriptorRawData() const override { return &_vec_descs[0];}
 
-  inline void clearDescriptors() override { _vec_descs.clear(); }
+  inline void clearDescriptors() override { DescsT().swap(_vec_descs); }
 
   inline void swap(This& other)
   {
@@ -4,10 +4,12 @@
 // You can obtain one at https://mozilla.org/MPL/2.0/.
 
 #include "aliceVision/feature/feature.hpp"
+#include "aliceVision/feature/selection.hpp"
 
 #include <iostream>
 #include <fstream>
 #include <iterator>
+#include <random>
 #include <vector>
 
 #define BOOST_TEST_MODULE Feature
@@ -120,3 +122,64 @@ BOOST_AUTO_TEST_CASE(descriptorIO_BINARY) {
       BOOST_CHECK_EQUAL(vec_descs[i][j], vec_descs_read[i][j]);
   }
 }
+
+BOOST_AUTO_TEST_CASE(MatchesGridFilter_topK) {
+  std::mt19937 generator(42);
+  std::uniform_real_distribution<float> position(0.f, 1000.f);
+  std::uniform_real_distribution<float> scale(1.f, 10.f);
+
+  SIFT_Regions lRegions, rRegions;
+  matching::IndMatches matches;
+  for(IndexT i = 0; i < 500; ++i)
+  {
+    lRegions.Features().emplace_back(position(generator), position(generator), scale(generator), 0.f);
+    rRegions.Features().emplace_back(position(generator), position(generator), scale(generator), 0.f);
+    matches.emplace_back(i, i);
+  }
+
+  matching::IndMatches sortedMatches;
+  sortMatches(matches, lRegions, rRegions, sortedMatches);
+  thresholdMatches(sortedMatches, 100);
+
+  MatchesGridFilter filter;
+  matching::IndMatches topMatches = matches;
+  filter.filter(lRegions, rRegions, {1000, 1000}, {1000, 1000}, 100, false, topMatches);
+  BOOST_CHECK(topMatches == sortedMatches);
+
+  // the filter is reused, all the matches are kept
+  matching::IndMatches allMatches = matches;
+  filter.filter(lRegions, rRegions, {1000, 1000}, {1000, 1000}, 0, false, allMatches);
+  BOOST_CHECK_EQUAL(matches.size(), allMatches.size());
+}
+
+BOOST_AUTO_TEST_CASE(MatchesGridFilter_grid) {
+  SIFT_Regions lRegions, rRegions;
+  matching::IndMatches matches;
+  // large features in the top left corner of both images, small features everywhere
+  for(IndexT i = 0; i < 300; ++i)
+  {
+    const bool isCorner = (i < 200);
+    const float x = isCorner ? (i % 10) * 10.f : (i * 37) % 1000;
+    const float y = isCorner ? (i / 10) * 10.f : (i * 53) % 1000;
+    const float scale = isCorner ? 10.f + i : 1.f + i / 1000.f;
+    lRegions.Features().emplace_back(x, y, scale, 0.f);
+    rRegions.Features().emplace_back(x, y, scale, 0.f);
+    matches.emplace_back(i, i);
+  }
+
+  MatchesGridFilter filter;
+  matching::IndMatches topMatches = matches;
+  filter.filter(lRegions, rRegions, {1000, 1000}, {1000, 1000}, 50, false, topMatches);
+  matching::IndMatches gridMatches = matches;
+  filter.filter(lRegions, rRegions, {1000, 1000}, {1000, 1000}, 50, true, gridMatches);
+
+  BOOST_CHECK_EQUAL(50, topMatches.size());
+  BOOST_CHECK_EQUAL(50, gridMatches.size());
+
+  const auto nbOutsideCorner = [](const matching::IndMatches& selection)
+  {
+    return std::count_if(selection.begin(), selection.end(), [](const matching::IndMatch& m) { return m._i >= 200; });
+  };
+  BOOST_CHECK_EQUAL(0, nbOutsideCorner(topMatches));
+  BOOST_CHECK_GT(nbOutsideCorner(gridMatches), 20);
+}
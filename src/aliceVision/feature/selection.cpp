@@ -7,11 +7,11 @@
 
 #include <aliceVision/numeric/numeric.hpp>
 
+#include <algorithm>
+
 namespace aliceVision {
 namespace feature {
 
-const size_t gridSize = 3;
-  
 /**
 * @brief Sort the matches.
 * @param[in] inputMatches Set of indices for (putative) matches.
@@ -74,87 +74,82 @@ void thresholdMatches(aliceVision::matching::IndMatches& outputMatches, const st
 	}
 }
 
-/**
- * @brief Perform the gris filtering on the matches
- * @param[in] lRegions The regions of the first picture
- * @param[in] rRegions The regions of the second picture
- * @param[in] indexImagePair The Pair of matched images
- * @param[in] sfm_data The sfm data file
- * @param[out] outMatches The remaining matches
- */
-void matchesGridFiltering(const aliceVision::feature::FeatRegions<aliceVision::feature::SIOPointFeature>& lRegions, 
-        const aliceVision::feature::FeatRegions<aliceVision::feature::SIOPointFeature>& rRegions, 
-        const aliceVision::Pair& indexImagePair,
-        const aliceVision::sfm::SfMData sfm_data, 
-        aliceVision::matching::IndMatches& outMatches)
+void MatchesGridFilter::filter(const aliceVision::feature::FeatRegions<aliceVision::feature::SIOPointFeature>& lRegions,
+                               const aliceVision::feature::FeatRegions<aliceVision::feature::SIOPointFeature>& rRegions,
+                               const std::pair<std::size_t, std::size_t>& lSize,
+                               const std::pair<std::size_t, std::size_t>& rSize,
+                               std::size_t numMatchesToKeep,
+                               bool useGrid,
+                               aliceVision::matching::IndMatches& matches)
 {
-  const std::size_t lWidth = sfm_data.GetViews().at(indexImagePair.first)->getWidth();
-  const std::size_t lHeight = sfm_data.GetViews().at(indexImagePair.first)->getHeight();
-  const std::size_t rWidth = sfm_data.GetViews().at(indexImagePair.second)->getWidth();
-  const std::size_t rHeight = sfm_data.GetViews().at(indexImagePair.second)->getHeight();
-  
-  const size_t leftCellHeight = std::ceil(lHeight / (float)gridSize);
-  const size_t leftCellWidth = std::ceil(lWidth / (float)gridSize);
-  const size_t rightCellHeight = std::ceil(rHeight / (float)gridSize);
-  const size_t rightCellWidth = std::ceil(rWidth / (float)gridSize);
-
-  std::vector< aliceVision::matching::IndMatches > completeGrid(gridSize*gridSize*2);
-  // Reserve all cells
-  for(aliceVision::matching::IndMatches& cell: completeGrid)
-  {
-    cell.reserve(outMatches.size()/completeGrid.size());
-  }
-  // Split matches in grid cells
-  for(const auto& match: outMatches)
+  const std::vector<aliceVision::feature::SIOPointFeature>& lFeatures = lRegions.Features();
+  const std::vector<aliceVision::feature::SIOPointFeature>& rFeatures = rRegions.Features();
+  const std::size_t nbMatches = matches.size();
+  const std::size_t nbKept = (numMatchesToKeep == 0) ? nbMatches : std::min(numMatchesToKeep, nbMatches);
+
+  _scores.clear();
+  for(std::size_t i = 0; i < nbMatches; ++i)
+    _scores.emplace_back((lFeatures[matches[i]._i].scale() + rFeatures[matches[i]._j].scale()) / 2.0f, i);
+
+  _selectedMatches.clear();
+
+  if(!useGrid)
   {
-    const aliceVision::feature::SIOPointFeature& leftPoint = lRegions.Features()[match._i];
-    const aliceVision::feature::SIOPointFeature& rightPoint = rRegions.Features()[match._j];
-    
-    const float leftGridIndex_f = std::floor(leftPoint.x() / (float)leftCellWidth) + std::floor(leftPoint.y() / (float)leftCellHeight) * gridSize;
-    const float rightGridIndex_f = std::floor(rightPoint.x() / (float)rightCellWidth) + std::floor(rightPoint.y() / (float)rightCellHeight) * gridSize;
-    // clamp the values if we have feature/marker centers outside the image size.
-    const std::size_t leftGridIndex = clamp(leftGridIndex_f, 0.f, float(gridSize-1));
-    const std::size_t rightGridIndex = clamp(rightGridIndex_f, 0.f, float(gridSize-1));
-
-    aliceVision::matching::IndMatches& currentCaseL = completeGrid[leftGridIndex];
-    aliceVision::matching::IndMatches& currentCaseR = completeGrid[rightGridIndex + gridSize*gridSize];
-    
-    if(currentCaseL.size() <= currentCaseR.size())
-    {
-      currentCaseL.push_back(match);
-    }
-    else
-    {
-      currentCaseR.push_back(match);
-    }
+    // only the kept matches are sorted
+    if(nbKept < nbMatches)
+      std::nth_element(_scores.begin(), _scores.begin() + nbKept, _scores.end(), matchCompare);
+    std::sort(_scores.begin(), _scores.begin() + nbKept, matchCompare);
+
+    for(std::size_t i = 0; i < nbKept; ++i)
+      _selectedMatches.push_back(matches[_scores[i].second]);
+    matches.swap(_selectedMatches);
+    return;
   }
-  
-  // max Size of the cells:
-  int maxSize = 0;
-  for (const auto& cell: completeGrid)
+
+  // the distribution in the cells depends on the order of all the matches
+  std::sort(_scores.begin(), _scores.end(), matchCompare);
+
+  // each match goes to the least filled of its cells in the two images
+  const std::size_t nbCellsPerImage = _gridSize * _gridSize;
+  _cells.resize(nbMatches);
+  _cellFirstMatch.assign(2 * nbCellsPerImage + 1, 0);
+  for(std::size_t i = 0; i < nbMatches; ++i)
   {
-    if(cell.size() > maxSize)
-    {
-      maxSize = cell.size();
-    }
+    const aliceVision::matching::IndMatch& match = matches[_scores[i].second];
+    const std::size_t lCell = cellIndex(lFeatures[match._i], lSize);
+    const std::size_t rCell = nbCellsPerImage + cellIndex(rFeatures[match._j], rSize);
+    _cells[i] = (_cellFirstMatch[lCell + 1] <= _cellFirstMatch[rCell + 1]) ? lCell : rCell;
+    ++_cellFirstMatch[_cells[i] + 1];
   }
-  
-  aliceVision::matching::IndMatches finalMatches;
-  finalMatches.reserve(outMatches.size());
-  
-  // Combine all cells into a global ordered vector
-  for (int cmpt = 0; cmpt < maxSize; ++cmpt)
+  for(std::size_t cell = 0; cell < 2 * nbCellsPerImage; ++cell)
+    _cellFirstMatch[cell + 1] += _cellFirstMatch[cell];
+
+  // counting sort of the sorted matches by cell, the order is kept in each cell
+  _matchesPerCell.resize(nbMatches);
+  _cellNextMatch.assign(_cellFirstMatch.begin(), _cellFirstMatch.end() - 1);
+  for(std::size_t i = 0; i < nbMatches; ++i)
+    _matchesPerCell[_cellNextMatch[_cells[i]]++] = _scores[i].second;
+
+  // read the cells in turn until enough matches are selected
+  for(std::size_t rank = 0; _selectedMatches.size() < nbKept; ++rank)
   {
-    for(const auto& cell: completeGrid)
+    for(std::size_t cell = 0; cell < 2 * nbCellsPerImage && _selectedMatches.size() < nbKept; ++cell)
     {
-      if(cmpt < cell.size())
-      {
-        finalMatches.push_back(cell[cmpt]);
-      }
+      if(_cellFirstMatch[cell] + rank < _cellFirstMatch[cell + 1])
+        _selectedMatches.push_back(matches[_matchesPerCell[_cellFirstMatch[cell] + rank]]);
     }
   }
-  
-  outMatches.swap(finalMatches);
+  matches.swap(_selectedMatches);
+}
+
+std::size_t MatchesGridFilter::cellIndex(const aliceVision::feature::SIOPointFeature& point, const std::pair<std::size_t, std::size_t>& size) const
+{
+  const float cellWidth = std::ceil(size.first / (float)_gridSize);
+  const float cellHeight = std::ceil(size.second / (float)_gridSize);
+  // clamp the values if we have feature/marker centers outside the image size.
+  const std::size_t x = clamp(std::floor(point.x() / cellWidth), 0.f, float(_gridSize - 1));
+  const std::size_t y = clamp(std::floor(point.y() / cellHeight), 0.f, float(_gridSize - 1));
+  return x + y * _gridSize;
 }
 
 }
@@ -48,18 +48,57 @@ bool matchCompare(const std::pair<float, size_t>& firstElem, const std::pair<flo
 void thresholdMatches(aliceVision::matching::IndMatches& outputMatches, const std::size_t uNumMatchesToKeep);
 
 /**
- * @brief Perform the gris filtering on the matches
- * @param[in] lRegions The regions of the first picture
- * @param[in] rRegions The regions of the second picture
- * @param[in] indexImagePair The Pair of matched images
- * @param[in] sfm_data The sfm data file
- * @param[out] outMatches The remaining matches
+ * @brief Reusable selection of the best matches of image pairs, by feature scale.
+ *
+ * The working buffers are kept between the calls, so a filter per thread can
+ * be applied to all the image pairs without allocation once the buffers are large enough.
+ * Without grid, the best matches are selected with std::nth_element and only them are sorted.
+ * With grid, the matches are distributed in the cells of a grid on each image by decreasing
+ * scale and the cells are read in turn, so the kept matches are spread over the images.
  */
-void matchesGridFiltering(const aliceVision::feature::FeatRegions<aliceVision::feature::SIOPointFeature>& lRegions, 
-        const aliceVision::feature::FeatRegions<aliceVision::feature::SIOPointFeature>& rRegions, 
-        const aliceVision::Pair& indexImagePair,
-        const aliceVision::sfm::SfMData sfm_data, 
-        aliceVision::matching::IndMatches& outMatches);
+class MatchesGridFilter
+{
+public:
+  /**
+   * @param[in] gridSize The number of cells per image axis.
+   */
+  explicit MatchesGridFilter(std::size_t gridSize = 3)
+    : _gridSize(gridSize)
+  {}
+
+  /**
+   * @brief Keep the best matches of an image pair.
+   * @param[in] lRegions The regions of the first picture
+   * @param[in] rRegions The regions of the second picture
+   * @param[in] lSize The (width, height) of the first picture
+   * @param[in] rSize The (width, height) of the second picture
+   * @param[in] numMatchesToKeep The maximum number of matches to keep, 0 to keep all the matches
+   * @param[in] useGrid Spread the kept matches over the grid cells
+   * @param[in,out] matches The matches, replaced by the kept matches ordered by selection
+   */
+  void filter(const aliceVision::feature::FeatRegions<aliceVision::feature::SIOPointFeature>& lRegions,
+              const aliceVision::feature::FeatRegions<aliceVision::feature::SIOPointFeature>& rRegions,
+              const std::pair<std::size_t, std::size_t>& lSize,
+              const std::pair<std::size_t, std::size_t>& rSize,
+              std::size_t numMatchesToKeep,
+              bool useGrid,
+              aliceVision::matching::IndMatches& matches);
+
+private:
+  std::size_t cellIndex(const aliceVision::feature::SIOPointFeature& point, const std::pair<std::size_t, std::size_t>& size) const;
+
+  std::size_t _gridSize;
+  /// (mean scale, match index) of the matches
+  std::vector<std::pair<float, std::size_t>> _scores;
+  /// cell of each sorted match, the cells of the second image follow the cells of the first image
+  std::vector<std::size_t> _cells;
+  /// number of matches, then first match of each cell
+  std::vector<std::size_t> _cellFirstMatch;
+  std::vector<std::size_t> _cellNextMatch;
+  /// sorted match indexes grouped by cell
+  std::vector<std::size_t> _matchesPerCell;
+  aliceVision::matching::IndMatches _selectedMatches;
+};
 
 }
 }
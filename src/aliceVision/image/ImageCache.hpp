@@ -0,0 +1,135 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include "aliceVision/image/Image.hpp"
+#include "aliceVision/image/io.hpp"
+
+#include <algorithm>
+#include <future>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace aliceVision {
+namespace image {
+
+/**
+ * @brief Thread safe cache of decoded images with a least recently used eviction policy.
+ *
+ * An image requested concurrently by several threads is decoded once, the other
+ * threads wait for it. The least recently used images are evicted once the cached
+ * images use more than the maximum memory; the images still used by a thread are
+ * kept alive by their shared pointer.
+ */
+template <typename T>
+class ImageCache
+{
+public:
+  typedef std::shared_ptr<const Image<T> > ImagePtr;
+
+  /**
+   * @brief Create an image cache.
+   * @param[in] maxBytes The maximum memory used by the cached images.
+   */
+  explicit ImageCache(std::size_t maxBytes) : _maxBytes(maxBytes) {}
+
+  /**
+   * @brief Get the image of the given path, it is decoded if it is not in the cache.
+   * @param[in] path The image path.
+   * @return the image, nullptr if it cannot be read.
+   */
+  ImagePtr get(const std::string& path)
+  {
+    std::shared_future<ImagePtr> future;
+    std::promise<ImagePtr> promise;
+    bool isLoader = false;
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      auto it = _entries.find(path);
+      if(it != _entries.end())
+      {
+        // move the image to the front of the LRU list
+        _lru.splice(_lru.begin(), _lru, it->second.lruIt);
+        future = it->second.image;
+      }
+      else
+      {
+        future = promise.get_future().share();
+        _lru.push_front(path);
+        _entries.emplace(path, Entry{future, _lru.begin(), 0});
+        ++_nbLoads;
+        isLoader = true;
+      }
+    }
+    // wait for the image if it is loaded by another thread
+    if(!isLoader)
+      return future.get();
+
+    std::shared_ptr<Image<T> > image = std::make_shared<Image<T> >();
+    if(!ReadImage(path.c_str(), image.get()))
+      image.reset();
+    promise.set_value(image);
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    Entry& entry = _entries.at(path);
+    entry.bytes = image ? std::max<std::size_t>(image->Width() * image->Height() * sizeof(T), 1) : 1;
+    _bytes += entry.bytes;
+    evict(path);
+    return image;
+  }
+
+  /// Get the number of decoded images, including the evicted ones.
+  std::size_t nbLoads() const
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _nbLoads;
+  }
+
+  /// Get the memory used by the cached images in bytes.
+  std::size_t memorySize() const
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _bytes;
+  }
+
+private:
+  struct Entry
+  {
+    std::shared_future<ImagePtr> image;
+    std::list<std::string>::iterator lruIt;
+    /// 0 while the image is loading
+    std::size_t bytes;
+  };
+
+  /// Evict the least recently used loaded images but the given one, the mutex must be locked.
+  void evict(const std::string& keep)
+  {
+    auto lruIt = _lru.end();
+    while(_bytes > _maxBytes && lruIt != _lru.begin())
+    {
+      --lruIt;
+      auto it = _entries.find(*lruIt);
+      if(*lruIt == keep || it->second.bytes == 0)
+        continue;
+      _bytes -= it->second.bytes;
+      _entries.erase(it);
+      lruIt = _lru.erase(lruIt);
+    }
+  }
+
+  const std::size_t _maxBytes;
+  std::size_t _bytes = 0;
+  std::size_t _nbLoads = 0;
+  std::list<std::string> _lru;
+  std::map<std::string, Entry> _entries;
+  mutable std::mutex _mutex;
+};
+
+} // namespace image
+} // namespace aliceVision
@@ -0,0 +1,98 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "ImageProcessingPipeline.hpp"
+
+namespace aliceVision {
+namespace image {
+
+double ImagePipelineStats::getThroughput() const
+{
+  if(totalTimeMs <= 0.0)
+    return 0.0;
+  return (nbImages - nbFailures) / (totalTimeMs / 1000.0);
+}
+
+std::ostream& operator<<(std::ostream& os, const ImagePipelineStats& stats)
+{
+  os << "Pipeline processed " << stats.nbImages << " images in " << stats.totalTimeMs / 1000.0 << " [s]"
+     << " (" << stats.getThroughput() << " images/s), " << stats.nbFailures << " failure(s)" << std::endl
+     << "\tpeak memory in flight: " << stats.peakInFlightBytes / (1024 * 1024) << " [MB]";
+  if(stats.nbImages > 0)
+  {
+    os << std::endl
+       << "\tmean time per image: decoding " << stats.decodeTimeMs / stats.nbImages << " [ms]"
+       << ", transformation " << stats.transformTimeMs / stats.nbImages << " [ms]"
+       << ", encoding " << stats.encodeTimeMs / stats.nbImages << " [ms]";
+  }
+  return os;
+}
+
+namespace detail {
+
+void ImagePipelineQueue::push(std::size_t index)
+{
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _queue.push_back(index);
+  }
+  _notEmpty.notify_one();
+}
+
+bool ImagePipelineQueue::pop(std::size_t& index)
+{
+  std::unique_lock<std::mutex> lock(_mutex);
+  _notEmpty.wait(lock, [this]{ return _isClosed || !_queue.empty(); });
+  if(_queue.empty())
+    return false;
+  index = _queue.front();
+  _queue.pop_front();
+  return true;
+}
+
+void ImagePipelineQueue::close()
+{
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _isClosed = true;
+  }
+  _notEmpty.notify_all();
+}
+
+bool InFlightMemory::waitForRoom()
+{
+  std::unique_lock<std::mutex> lock(_mutex);
+  _hasRoom.wait(lock, [this]{ return _isStopped || _bytes < _maxBytes; });
+  return !_isStopped;
+}
+
+void InFlightMemory::add(std::size_t bytes)
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  _bytes += bytes;
+  _peakBytes = std::max(_peakBytes, _bytes);
+}
+
+void InFlightMemory::release(std::size_t bytes)
+{
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _bytes -= std::min(bytes, _bytes);
+  }
+  _hasRoom.notify_all();
+}
+
+void InFlightMemory::stop()
+{
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _isStopped = true;
+  }
+  _hasRoom.notify_all();
+}
+
+} // namespace detail
+} // namespace image
+} // namespace aliceVision
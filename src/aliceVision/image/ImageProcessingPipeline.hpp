@@ -0,0 +1,342 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include "aliceVision/image/Image.hpp"
+#include <aliceVision/alicevision_omp.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <ostream>
+#include <thread>
+#include <vector>
+
+namespace aliceVision {
+namespace image {
+
+/**
+ * @brief Parameters of an image processing pipeline.
+ */
+struct ImagePipelineParams
+{
+  /// number of threads reading the images
+  std::size_t nbDecodeThreads = 2;
+  /// number of threads transforming the images, 0 to use all the cores
+  std::size_t nbTransformThreads = 0;
+  /// number of threads writing the images
+  std::size_t nbEncodeThreads = 2;
+  /// the decoding of new images is suspended while the decoded images use more memory
+  std::size_t maxInFlightBytes = std::size_t(1) << 31;
+};
+
+/**
+ * @brief Statistics of an image processing pipeline run.
+ */
+struct ImagePipelineStats
+{
+  /// number of images given to the pipeline
+  std::size_t nbImages = 0;
+  /// number of images which failed to be decoded or encoded
+  std::size_t nbFailures = 0;
+  /// overall duration of the run in milliseconds
+  double totalTimeMs = 0.0;
+  /// cumulated time spent in each stage by all its threads in milliseconds
+  double decodeTimeMs = 0.0;
+  double transformTimeMs = 0.0;
+  double encodeTimeMs = 0.0;
+  /// maximum memory used by the images in flight in bytes
+  std::size_t peakInFlightBytes = 0;
+
+  /**
+   * @brief Get the number of images processed per second.
+   * @return the throughput of the pipeline in images per second.
+   */
+  double getThroughput() const;
+};
+
+std::ostream& operator<<(std::ostream& os, const ImagePipelineStats& stats);
+
+namespace detail {
+
+/**
+ * @brief Closable FIFO of image indexes connecting two stages of the pipeline.
+ * It is not bounded: the number of images in flight is bounded by InFlightMemory.
+ */
+class ImagePipelineQueue
+{
+public:
+  void push(std::size_t index);
+
+  /**
+   * @brief Remove the first index, wait if the queue is empty and not closed.
+   * @return false if the queue is closed and empty.
+   */
+  bool pop(std::size_t& index);
+
+  void close();
+
+private:
+  std::deque<std::size_t> _queue;
+  bool _isClosed = false;
+  std::mutex _mutex;
+  std::condition_variable _notEmpty;
+};
+
+/**
+ * @brief Memory used by the images in flight.
+ */
+class InFlightMemory
+{
+public:
+  explicit InFlightMemory(std::size_t maxBytes) : _maxBytes(maxBytes) {}
+
+  /**
+   * @brief Wait until the images in flight use less than the maximum memory.
+   * @return false if the pipeline has been stopped.
+   */
+  bool waitForRoom();
+
+  void add(std::size_t bytes);
+  void release(std::size_t bytes);
+  void stop();
+
+  std::size_t peak() const { return _peakBytes; }
+
+private:
+  const std::size_t _maxBytes;
+  std::size_t _bytes = 0;
+  std::size_t _peakBytes = 0;
+  bool _isStopped = false;
+  std::mutex _mutex;
+  std::condition_variable _hasRoom;
+};
+
+} // namespace detail
+
+/**
+ * @brief This class processes a list of images with three concurrent pools of threads:
+ * - the decoding threads read the images,
+ * - the transformation threads process them (e.g. undistortion, rescaling),
+ * - the encoding threads write the results.
+ * The reading and writing of the images thus overlap with their processing.
+ * New images are decoded only while the images in flight use less memory than
+ * ImagePipelineParams::maxInFlightBytes, so the memory used is bounded by this
+ * value plus one image per decoding thread.
+ * The images are transformed and encoded in any order.
+ */
+template <typename T>
+class ImageProcessingPipeline
+{
+public:
+
+  /**
+   * @brief Read the image of the given index.
+   * @return false if the image cannot be read, it is then skipped.
+   */
+  typedef std::function<bool(std::size_t index, Image<T>& image)> DecodeFunction;
+
+  /// Transform the image of the given index in place.
+  typedef std::function<void(std::size_t index, Image<T>& image)> TransformFunction;
+
+  /**
+   * @brief Write the image of the given index.
+   * @return false if the image cannot be written.
+   */
+  typedef std::function<bool(std::size_t index, const Image<T>& image)> EncodeFunction;
+
+  explicit ImageProcessingPipeline(const ImagePipelineParams& params = ImagePipelineParams())
+    : _params(params)
+  {
+    _params.nbDecodeThreads = std::max<std::size_t>(_params.nbDecodeThreads, 1);
+    _params.nbEncodeThreads = std::max<std::size_t>(_params.nbEncodeThreads, 1);
+    if(_params.nbTransformThreads == 0)
+      _params.nbTransformThreads = std::max(omp_get_max_threads(), 1);
+  }
+
+  const ImagePipelineParams& getParams() const { return _params; }
+
+  /**
+   * @brief Process the images [0, nbImages).
+   * The functions are called concurrently by the threads of each stage.
+   * If a function throws, the pipeline is stopped and the exception is rethrown.
+   * @param[in] nbImages The number of images.
+   * @param[in] decode The function reading an image.
+   * @param[in] transform The function processing an image.
+   * @param[in] encode The function writing an image.
+   * @return the statistics of the run.
+   */
+  ImagePipelineStats run(std::size_t nbImages,
+                         const DecodeFunction& decode,
+                         const TransformFunction& transform,
+                         const EncodeFunction& encode) const
+  {
+    typedef std::chrono::steady_clock Clock;
+    const auto elapsedMs = [](const Clock::time_point& start)
+    {
+      return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    };
+
+    ImagePipelineStats stats;
+    stats.nbImages = nbImages;
+    const Clock::time_point runStart = Clock::now();
+
+    // the images in flight, an image is only accessed by the stage owning its index
+    std::vector<Image<T> > images(nbImages);
+    detail::ImagePipelineQueue decodedImages;
+    detail::ImagePipelineQueue transformedImages;
+    detail::InFlightMemory inFlightMemory(_params.maxInFlightBytes);
+
+    std::atomic<std::size_t> nextImage(0);
+    std::atomic<std::size_t> nbRunningDecoders(_params.nbDecodeThreads);
+    std::atomic<std::size_t> nbRunningTransformers(_params.nbTransformThreads);
+    std::mutex statsMutex;
+    std::exception_ptr workerException;
+
+    const auto stopPipeline = [&](std::exception_ptr exception)
+    {
+      {
+        std::lock_guard<std::mutex> lock(statsMutex);
+        if(!workerException)
+          workerException = exception;
+      }
+      nextImage = nbImages;
+      inFlightMemory.stop();
+      decodedImages.close();
+      transformedImages.close();
+    };
+
+    const auto addTime = [&](double& stageTimeMs, double timeMs, bool isFailure)
+    {
+      std::lock_guard<std::mutex> lock(statsMutex);
+      stageTimeMs += timeMs;
+      if(isFailure)
+        ++stats.nbFailures;
+    };
+
+    const auto imageBytes = [](const Image<T>& image)
+    {
+      return static_cast<std::size_t>(image.Width()) * image.Height() * sizeof(T);
+    };
+
+    // A. decoding stage
+    const auto decodeWorker = [&]()
+    {
+      try
+      {
+        while(inFlightMemory.waitForRoom())
+        {
+          const std::size_t index = nextImage++;
+          if(index >= nbImages)
+            break;
+
+          const Clock::time_point start = Clock::now();
+          const bool isDecoded = decode(index, images[index]);
+          addTime(stats.decodeTimeMs, elapsedMs(start), !isDecoded);
+
+          if(!isDecoded)
+          {
+            images[index] = Image<T>();
+            continue;
+          }
+          inFlightMemory.add(imageBytes(images[index]));
+          decodedImages.push(index);
+        }
+      }
+      catch(...)
+      {
+        stopPipeline(std::current_exception());
+      }
+      if(--nbRunningDecoders == 0)
+        decodedImages.close();
+    };
+
+    // B. transformation stage
+    const std::size_t nbInnerThreads = std::max<std::size_t>(omp_get_max_threads() / _params.nbTransformThreads, 1);
+    const auto transformWorker = [&]()
+    {
+      // the images are processed in parallel, the parallel loops of the
+      // transformations share the remaining cores
+      omp_set_num_threads(static_cast<int>(nbInnerThreads));
+      try
+      {
+        std::size_t index;
+        while(decodedImages.pop(index))
+        {
+          const std::size_t decodedBytes = imageBytes(images[index]);
+          const Clock::time_point start = Clock::now();
+          transform(index, images[index]);
+          addTime(stats.transformTimeMs, elapsedMs(start), false);
+
+          // the memory is accounted for the larger of the decoded and transformed images
+          const std::size_t transformedBytes = imageBytes(images[index]);
+          if(transformedBytes > decodedBytes)
+            inFlightMemory.add(transformedBytes - decodedBytes);
+          else
+            inFlightMemory.release(decodedBytes - transformedBytes);
+          transformedImages.push(index);
+        }
+      }
+      catch(...)
+      {
+        stopPipeline(std::current_exception());
+      }
+      if(--nbRunningTransformers == 0)
+        transformedImages.close();
+    };
+
+    // C. encoding stage
+    const auto encodeWorker = [&]()
+    {
+      try
+      {
+        std::size_t index;
+        while(transformedImages.pop(index))
+        {
+          const Clock::time_point start = Clock::now();
+          const bool isEncoded = encode(index, images[index]);
+          addTime(stats.encodeTimeMs, elapsedMs(start), !isEncoded);
+
+          const std::size_t bytes = imageBytes(images[index]);
+          images[index] = Image<T>();
+          inFlightMemory.release(bytes);
+        }
+      }
+      catch(...)
+      {
+        stopPipeline(std::current_exception());
+      }
+    };
+
+    std::vector<std::thread> threads;
+    for(std::size_t i = 0; i < _params.nbDecodeThreads; ++i)
+      threads.emplace_back(decodeWorker);
+    for(std::size_t i = 0; i < _params.nbTransformThreads; ++i)
+      threads.emplace_back(transformWorker);
+    for(std::size_t i = 0; i < _params.nbEncodeThreads; ++i)
+      threads.emplace_back(encodeWorker);
+    for(std::thread& thread : threads)
+      thread.join();
+
+    if(workerException)
+      std::rethrow_exception(workerException);
+
+    stats.peakInFlightBytes = inFlightMemory.peak();
+    stats.totalTimeMs = elapsedMs(runStart);
+    return stats;
+  }
+
+private:
+  ImagePipelineParams _params;
+};
+
+} // namespace image
+} // namespace aliceVision
@@ -0,0 +1,93 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/image/image.hpp>
+#include <aliceVision/image/ImageCache.hpp>
+
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define BOOST_TEST_MODULE ImageCache
+#include <boost/test/included/unit_test.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::image;
+
+namespace {
+
+std::string imagePath(int index)
+{
+  return "imageCache_test_" + std::to_string(index) + ".png";
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(ImageCache_concurrentAccess)
+{
+  const int nbImages = 5;
+  for(int i = 0; i < nbImages; ++i)
+    BOOST_REQUIRE(WriteImage(imagePath(i).c_str(), Image<unsigned char>(10, 10, true, i * 10)));
+
+  // all the images fit in the cache: each image is decoded once
+  ImageCache<unsigned char> cache(nbImages * 10 * 10);
+  std::vector<std::thread> threads;
+  std::vector<bool> isValid(4, true);
+  for(int t = 0; t < 4; ++t)
+  {
+    threads.emplace_back([&, t]()
+    {
+      for(int k = 0; k < 50; ++k)
+      {
+        const int i = (k + t) % nbImages;
+        const ImageCache<unsigned char>::ImagePtr image = cache.get(imagePath(i));
+        if(!image || image->Width() != 10 || (*image)(5, 5) != i * 10)
+          isValid[t] = false;
+      }
+    });
+  }
+  for(std::thread& thread : threads)
+    thread.join();
+
+  for(int t = 0; t < 4; ++t)
+    BOOST_CHECK(isValid[t]);
+  BOOST_CHECK_EQUAL(cache.nbLoads(), nbImages);
+  BOOST_CHECK_EQUAL(cache.memorySize(), nbImages * 10 * 10);
+
+  // a missing image is not readable
+  BOOST_CHECK(cache.get("imageCache_test_missing.png") == nullptr);
+
+  for(int i = 0; i < nbImages; ++i)
+    std::remove(imagePath(i).c_str());
+}
+
+BOOST_AUTO_TEST_CASE(ImageCache_eviction)
+{
+  const int nbImages = 4;
+  for(int i = 0; i < nbImages; ++i)
+    BOOST_REQUIRE(WriteImage(imagePath(i).c_str(), Image<unsigned char>(10, 10, true, i)));
+
+  // room for 2 images
+  ImageCache<unsigned char> cache(2 * 10 * 10);
+  const ImageCache<unsigned char>::ImagePtr image0 = cache.get(imagePath(0));
+  cache.get(imagePath(1));
+  cache.get(imagePath(0));
+  // the least recently used image (1) is evicted
+  cache.get(imagePath(2));
+  BOOST_CHECK_EQUAL(cache.nbLoads(), 3);
+  BOOST_CHECK_LE(cache.memorySize(), 2 * 10 * 10);
+  cache.get(imagePath(0));
+  BOOST_CHECK_EQUAL(cache.nbLoads(), 3);
+  cache.get(imagePath(1));
+  BOOST_CHECK_EQUAL(cache.nbLoads(), 4);
+
+  // an evicted image is still valid for its users
+  cache.get(imagePath(3));
+  BOOST_CHECK_EQUAL((*image0)(0, 0), 0);
+
+  for(int i = 0; i < nbImages; ++i)
+    std::remove(imagePath(i).c_str());
+}
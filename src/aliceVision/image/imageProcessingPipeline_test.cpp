@@ -0,0 +1,83 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/image/Image.hpp>
+#include <aliceVision/image/ImageProcessingPipeline.hpp>
+
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+#define BOOST_TEST_MODULE ImageProcessingPipeline
+#include <boost/test/included/unit_test.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::image;
+
+BOOST_AUTO_TEST_CASE(ImageProcessingPipeline_allImages)
+{
+  const std::size_t nbImages = 50;
+  ImagePipelineParams params;
+  params.nbDecodeThreads = 2;
+  params.nbTransformThreads = 3;
+  params.nbEncodeThreads = 2;
+  // room for about 4 images of 32x32
+  params.maxInFlightBytes = 4 * 32 * 32;
+  const ImageProcessingPipeline<unsigned char> pipeline(params);
+
+  std::mutex mutex;
+  std::vector<int> results(nbImages, -1);
+
+  const ImagePipelineStats stats = pipeline.run(nbImages,
+    [](std::size_t index, Image<unsigned char>& image)
+    {
+      // the image 7 cannot be read
+      if(index == 7)
+        return false;
+      image.resize(32, 32, true, static_cast<unsigned char>(index));
+      return true;
+    },
+    [](std::size_t index, Image<unsigned char>& image)
+    {
+      Image<unsigned char> half(16, 16, true, image(0, 0) + 1);
+      image.swap(half);
+    },
+    [&](std::size_t index, const Image<unsigned char>& image)
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      results[index] = (image.Width() == 16) ? image(0, 0) : -2;
+      return index != 11;
+    });
+
+  // each image is transformed and encoded once, the failures are reported
+  for(std::size_t i = 0; i < nbImages; ++i)
+    BOOST_CHECK_EQUAL(results[i], i == 7 ? -1 : static_cast<int>(i) + 1);
+  BOOST_CHECK_EQUAL(stats.nbImages, nbImages);
+  BOOST_CHECK_EQUAL(stats.nbFailures, 2);
+
+  // the decoding is suspended once the budget is reached
+  BOOST_CHECK_LE(stats.peakInFlightBytes, params.maxInFlightBytes + params.nbDecodeThreads * 32 * 32);
+}
+
+BOOST_AUTO_TEST_CASE(ImageProcessingPipeline_exception)
+{
+  const ImageProcessingPipeline<unsigned char> pipeline;
+
+  BOOST_CHECK_THROW(pipeline.run(100,
+    [](std::size_t index, Image<unsigned char>& image)
+    {
+      image.resize(8, 8);
+      return true;
+    },
+    [](std::size_t index, Image<unsigned char>& image)
+    {
+      if(index == 20)
+        throw std::runtime_error("transformation failure");
+    },
+    [](std::size_t index, const Image<unsigned char>& image)
+    {
+      return true;
+    }), std::runtime_error);
+}
@@ -5,12 +5,18 @@
 
 #include "KeyframeSelector.hpp"
 #include <aliceVision/image/image.hpp>
+#include <aliceVision/image/ImageProcessingPipeline.hpp>
 #include <aliceVision/feature/sift/ImageDescriber_SIFT.hpp>
 #include <aliceVision/exif/sensorWidthDatabase/parseDatabase.hpp>
 #include <aliceVision/system/Logger.hpp>
 
 #include <tuple>
 #include <cassert>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <mutex>
+#include <numeric>
 
 namespace aliceVision {
 namespace keyframe {
@@ -120,7 +126,16 @@ void KeyframeSelector::process()
   // iteration process
   _keyframeIndexes.clear();
   std::size_t currentFrameStep = _minFrameStep; // start directly (dont skip minFrameStep first frames)
-  
+
+  // parallel processing: the frames are analyzed ahead by chunks
+  const bool isParallel = (_nbThreads != 1);
+  std::vector< std::vector<MediaData> > framesAnalysis(isParallel ? _framesData.size() : 0);
+  std::size_t analyzedEnd = 0;  // frames [0, analyzedEnd) are analyzed
+  std::size_t releasedEnd = 0;  // analysis of frames [0, releasedEnd) is released
+  std::size_t maxFrameIndex = 0;
+  double analysisTime = 0.0;    // in seconds
+  std::size_t nbAnalyzedImages = 0;
+
   for(std::size_t frameIndex = 0; frameIndex < _framesData.size(); ++frameIndex)
   {
     ALICEVISION_LOG_TRACE("frame : " << frameIndex);
@@ -128,9 +143,45 @@ void KeyframeSelector::process()
     auto& frameData = _framesData.at(frameIndex);
     frameData.mediasData.resize(_feeds.size());
 
+    if(isParallel)
+    {
+      if(frameIndex >= analyzedEnd)
+      {
+        const std::size_t chunkEnd = std::min<std::size_t>(analyzedEnd + std::max(_nbFramesPerChunk, _maxFrameStep), _framesData.size());
+        const std::size_t nbImages = (chunkEnd - analyzedEnd) * _feeds.size();
+        const double imagesPerSecond = analyzeFrames(analyzedEnd, chunkEnd, tileSharpSubset, framesAnalysis);
+        ALICEVISION_LOG_INFO("frames " << analyzedEnd << " to " << chunkEnd - 1 << " analyzed (" << imagesPerSecond / _feeds.size() << " frames/s)");
+        if(imagesPerSecond > 0.0)
+          analysisTime += nbImages / imagesPerSecond;
+        nbAnalyzedImages += nbImages;
+        analyzedEnd = chunkEnd;
+      }
+
+      // the selection process never goes back more than maxFrameStep frames
+      maxFrameIndex = std::max(maxFrameIndex, frameIndex);
+      for(; releasedEnd + _maxFrameStep < maxFrameIndex; ++releasedEnd)
+        std::vector<MediaData>().swap(framesAnalysis.at(releasedEnd));
+    }
+
     for(std::size_t mediaIndex = 0; mediaIndex < _feeds.size(); ++mediaIndex)
     {
       ALICEVISION_LOG_TRACE("media : " << _mediaPaths.at(mediaIndex));
+
+      if(isParallel)
+      {
+        if(frameSelected) // false if a camera of a rig is not selected
+        {
+          frameData.mediasData.at(mediaIndex) = framesAnalysis.at(frameIndex).at(mediaIndex);
+
+          // compute sparse distance
+          if(!computeDistScore(frameIndex, mediaIndex))
+          {
+            frameSelected = false;
+          }
+        }
+        continue;
+      }
+
       auto& feed = *_feeds.at(mediaIndex);
 
       if(frameSelected) // false if a camera of a rig is not selected
@@ -206,6 +257,14 @@ void KeyframeSelector::process()
         _keyframeIndexes.push_back(keyframeIndex);
 
         frameIndex = keyframeIndex + _minFrameStep - 1;
+
+        // the serial processing reads the feeds in order:
+        // move them to the next analyzed frame (the parallel processing seeks by itself)
+        if(!isParallel && (frameIndex + 1) < _framesData.size())
+        {
+          for(auto& feed : _feeds)
+            feed->goToFrame(frameIndex + 1);
+        }
       }
       else
       {
@@ -215,6 +274,12 @@ void KeyframeSelector::process()
     ++currentFrameStep;
   }
 
+  if(isParallel && analysisTime > 0.0)
+  {
+    ALICEVISION_LOG_INFO("keyframe selection : " << nbAnalyzedImages << " images of " << _feeds.size() << " media(s) analyzed in "
+                         << analysisTime << " s (" << nbAnalyzedImages / analysisTime / _feeds.size() << " frames/s)");
+  }
+
   if(_maxOutFrame == 0) // no limit of keyframes (evaluation and write already done)
   {
     return;
@@ -250,34 +315,72 @@ void KeyframeSelector::process()
 }
 
 float KeyframeSelector::computeSharpness(const image::Image<unsigned char>& imageGray,
+                                         const unsigned int nbTileSide,
                                          const unsigned int tileHeight,
                                          const unsigned int tileWidth,
-                                         const unsigned int tileSharpSubset) const
+                                         const unsigned int tileSharpSubset)
 {
-  image::Image<float> image;
-  image::Image<float> scharrXDer;
-  image::Image<float> scharrYDer;
-
-  image::ConvertPixelType(imageGray, &image);
-  image::ImageScharrXDerivative(image, scharrXDer); // normalized
-  image::ImageScharrYDerivative(image, scharrYDer); // normalized
+  const int width = imageGray.Width();
+  const int height = imageGray.Height();
+
+  if(tileHeight == 0 || tileWidth == 0 || width < 3 || height < 3)
+    return 0.0f;
+
+  // Sum of the absolute Scharr derivatives per tile.
+  // The derivatives are computed in one pass with integer arithmetic
+  // (the row loops are vectorized by the compiler) and normalized once per tile.
+  std::vector<std::int64_t> tileSums(nbTileSide * nbTileSide, 0);
+
+  // vertical smoothing [3 10 3] and vertical difference [-1 0 1] of the current row,
+  // with a padding column on each side.
+  // The borders are handled as by image::ImageSeparableConvolution on float images:
+  // the rows and the first column are mirrored, the last column is padded with
+  // the column width - 3.
+  std::vector<int> smooth(width + 2);
+  std::vector<int> diff(width + 2);
+  // absolute derivatives of the tiled part of the row
+  const int tiledWidth = nbTileSide * tileWidth;
+  std::vector<int> magnitude(tiledWidth);
+
+  for(int y = 0; y < static_cast<int>(nbTileSide * tileHeight); ++y)
+  {
+    // mirrored rows on the borders
+    const unsigned char* up = &imageGray(y == 0 ? 1 : y - 1, 0);
+    const unsigned char* row = &imageGray(y, 0);
+    const unsigned char* down = &imageGray(y == height - 1 ? height - 2 : y + 1, 0);
 
-  scharrXDer = scharrXDer.cwiseAbs(); // absolute value
-  scharrYDer = scharrYDer.cwiseAbs(); // absolute value
+    for(int x = 0; x < width; ++x)
+    {
+      smooth[x + 1] = 3 * (up[x] + down[x]) + 10 * row[x];
+      diff[x + 1] = down[x] - up[x];
+    }
+    smooth[0] = smooth[2];
+    diff[0] = diff[2];
+    smooth[width + 1] = smooth[width - 2];
+    diff[width + 1] = diff[width - 2];
 
-  // image tiles
-  std::vector<float> averageTileIntensity;
-  const float tileSizeInv = 1 / static_cast<float>(tileHeight * tileWidth);
+    for(int x = 0; x < tiledWidth; ++x)
+    {
+      const int derivativeX = smooth[x + 2] - smooth[x];
+      const int derivativeY = 3 * (diff[x] + diff[x + 2]) + 10 * diff[x + 1];
+      magnitude[x] = std::abs(derivativeX) + std::abs(derivativeY);
+    }
 
-  for(std::size_t y =  0; y < (_nbTileSide * tileHeight); y += tileHeight)
-  {
-    for(std::size_t x =  0; x < (_nbTileSide * tileWidth); x += tileWidth)
+    std::int64_t* tileRowSums = &tileSums[(y / tileHeight) * nbTileSide];
+    for(unsigned int tx = 0; tx < nbTileSide; ++tx)
     {
-      const auto sum = scharrXDer.block(y, x, tileHeight, tileWidth).sum() + scharrYDer.block(y, x, tileHeight, tileWidth).sum();
-      averageTileIntensity.push_back(sum * tileSizeInv);
+      const int* tileRow = &magnitude[tx * tileWidth];
+      tileRowSums[tx] += std::accumulate(tileRow, tileRow + tileWidth, std::int64_t(0));
     }
   }
 
+  // image tiles average pixel intensity (normalized kernels: 1/32)
+  std::vector<float> averageTileIntensity(tileSums.size());
+  const double tileSizeInv = 1.0 / (32.0 * tileHeight * tileWidth);
+
+  for(std::size_t i = 0; i < tileSums.size(); ++i)
+    averageTileIntensity[i] = static_cast<float>(tileSums[i] * tileSizeInv);
+
   // sort tiles average pixel intensity
   std::sort(averageTileIntensity.begin(), averageTileIntensity.end());
 
@@ -285,39 +388,47 @@ float KeyframeSelector::computeSharpness(const image::Image<unsigned char>& imag
   return std::accumulate(averageTileIntensity.end() - tileSharpSubset, averageTileIntensity.end(), 0.0f) / tileSharpSubset;
 }
 
-
-bool KeyframeSelector::computeFrameData(const image::Image<image::RGBColor>& image,
-                                        std::size_t frameIndex,
-                                        std::size_t mediaIndex,
-                                        unsigned int tileSharpSubset)
+void KeyframeSelector::analyzeFrame(const image::Image<image::RGBColor>& image,
+                                    std::size_t mediaIndex,
+                                    unsigned int tileSharpSubset,
+                                    feature::ImageDescriber& imageDescriber,
+                                    MediaData& mediaData) const
 {
   image::Image<unsigned char> imageGray;                // grayscale image
   image::Image<unsigned char> imageGrayHalfSample;      // half resolution grayscale image
-  
+
   const auto& currMediaInfo = _mediasInfo.at(mediaIndex);
-  auto& currframeData = _framesData.at(frameIndex);
-  auto& currMediaData = currframeData.mediasData.at(mediaIndex);
 
   // get grayscale image and resize
   image::ConvertPixelType(image, &imageGray);
   image::ImageHalfSample(imageGray, imageGrayHalfSample);
 
   // compute sharpness
-  currMediaData.sharpness = computeSharpness(imageGrayHalfSample,
-                                             currMediaInfo.tileHeight,
-                                             currMediaInfo.tileWidth,
-                                             tileSharpSubset);
+  mediaData.sharpness = computeSharpness(imageGrayHalfSample,
+                                         _nbTileSide,
+                                         currMediaInfo.tileHeight,
+                                         currMediaInfo.tileWidth,
+                                         tileSharpSubset);
 
-  ALICEVISION_LOG_TRACE( " - sharpness : " << currMediaData.sharpness);
+  ALICEVISION_LOG_TRACE( " - sharpness : " << mediaData.sharpness);
 
-  if(currMediaData.sharpness > _sharpnessThreshold)
+  if(mediaData.sharpness > _sharpnessThreshold)
   {
-    bool noKeyframe = (_keyframeIndexes.empty());
-
     // compute current frame sparse histogram
     std::unique_ptr<feature::Regions> regions;
-    _imageDescriber->Describe(imageGrayHalfSample, regions);
-    currMediaData.histogram = voctree::SparseHistogram(_voctree->quantizeToSparse(dynamic_cast<feature::SIFT_Regions*>(regions.get())->Descriptors()));
+    imageDescriber.Describe(imageGrayHalfSample, regions);
+    mediaData.histogram = voctree::SparseHistogram(_voctree->quantizeToSparse(dynamic_cast<feature::SIFT_Regions*>(regions.get())->Descriptors()));
+  }
+}
+
+bool KeyframeSelector::computeDistScore(std::size_t frameIndex, std::size_t mediaIndex)
+{
+  auto& currframeData = _framesData.at(frameIndex);
+  auto& currMediaData = currframeData.mediasData.at(mediaIndex);
+
+  if(currMediaData.sharpness > _sharpnessThreshold)
+  {
+    bool noKeyframe = (_keyframeIndexes.empty());
 
     // compute sparseDistance
     if(!noKeyframe)
@@ -343,6 +454,118 @@ bool KeyframeSelector::computeFrameData(const image::Image<image::RGBColor>& ima
   return false;
 }
 
+bool KeyframeSelector::computeFrameData(const image::Image<image::RGBColor>& image,
+                                        std::size_t frameIndex,
+                                        std::size_t mediaIndex,
+                                        unsigned int tileSharpSubset)
+{
+  analyzeFrame(image, mediaIndex, tileSharpSubset, *_imageDescriber, _framesData.at(frameIndex).mediasData.at(mediaIndex));
+  return computeDistScore(frameIndex, mediaIndex);
+}
+
+double KeyframeSelector::analyzeFrames(std::size_t firstFrame,
+                                       std::size_t lastFrame,
+                                       unsigned int tileSharpSubset,
+                                       std::vector< std::vector<MediaData> >& framesAnalysis)
+{
+  const std::size_t nbMedias = _feeds.size();
+  const std::size_t nbFrames = lastFrame - firstFrame;
+
+  // the feeds may have been moved to write the keyframes
+  for(auto& feed : _feeds)
+    feed->goToFrame(firstFrame);
+
+  for(std::size_t frameIndex = firstFrame; frameIndex < lastFrame; ++frameIndex)
+    framesAnalysis.at(frameIndex).resize(nbMedias);
+
+  // the frames of a media are read in order, one at a time
+  struct FeedTurn
+  {
+    std::mutex mutex;
+    std::condition_variable nextFrameReady;
+    std::size_t nextFrame = 0;
+  };
+  std::vector<FeedTurn> feedTurns(nbMedias);
+  for(auto& turn : feedTurns)
+    turn.nextFrame = firstFrame;
+
+  // image describers not used by an analysis thread
+  std::mutex describersMutex;
+  std::vector< std::unique_ptr<feature::ImageDescriber> > describers;
+
+  // a decoding thread per media, the analysis threads use all the cores
+  image::ImagePipelineParams params;
+  params.nbDecodeThreads = nbMedias;
+  params.nbTransformThreads = _nbThreads;
+  params.nbEncodeThreads = 1;
+  const image::ImageProcessingPipeline<image::RGBColor> pipeline(params);
+
+  // the images are interleaved: index = frame * nbMedias + media
+  const image::ImagePipelineStats stats = pipeline.run(nbFrames * nbMedias,
+    [&](std::size_t index, image::Image<image::RGBColor>& image)
+    {
+      const std::size_t frameIndex = firstFrame + index / nbMedias;
+      const std::size_t mediaIndex = index % nbMedias;
+      FeedTurn& turn = feedTurns.at(mediaIndex);
+
+      std::unique_lock<std::mutex> lock(turn.mutex);
+      turn.nextFrameReady.wait(lock, [&]{ return turn.nextFrame == frameIndex; });
+
+      camera::PinholeRadialK3 queryIntrinsics;
+      bool hasIntrinsics = false;
+      std::string currentImgName;
+      auto& feed = *_feeds.at(mediaIndex);
+      const bool isRead = feed.readImage(image, queryIntrinsics, currentImgName, hasIntrinsics);
+      feed.goToNextFrame();
+
+      // the next frame can be read, even after a failure
+      ++turn.nextFrame;
+      lock.unlock();
+      turn.nextFrameReady.notify_all();
+
+      if(!isRead)
+      {
+        ALICEVISION_LOG_ERROR("ERROR  : can't read frame '" << currentImgName << "' !");
+        throw std::invalid_argument("ERROR : can't read frame '" + currentImgName + "' !");
+      }
+      return true;
+    },
+    [&](std::size_t index, image::Image<image::RGBColor>& image)
+    {
+      const std::size_t frameIndex = firstFrame + index / nbMedias;
+      const std::size_t mediaIndex = index % nbMedias;
+
+      std::unique_ptr<feature::ImageDescriber> imageDescriber;
+      {
+        std::lock_guard<std::mutex> lock(describersMutex);
+        if(!describers.empty())
+        {
+          imageDescriber = std::move(describers.back());
+          describers.pop_back();
+        }
+      }
+      if(!imageDescriber)
+        imageDescriber.reset(new feature::ImageDescriber_SIFT());
+
+      analyzeFrame(image, mediaIndex, tileSharpSubset, *imageDescriber, framesAnalysis.at(frameIndex).at(mediaIndex));
+
+      {
+        std::lock_guard<std::mutex> lock(describersMutex);
+        describers.push_back(std::move(imageDescriber));
+      }
+
+      // only the analysis is kept
+      image::Image<image::RGBColor>().swap(image);
+    },
+    [](std::size_t index, const image::Image<image::RGBColor>& image)
+    {
+      return true;
+    });
+
+  ALICEVISION_LOG_DEBUG(stats);
+  return stats.getThroughput();
+}
+
 void KeyframeSelector::writeKeyframe(const image::Image<image::RGBColor>& image, 
                                      std::size_t frameIndex,
                                      std::size_t mediaIndex)
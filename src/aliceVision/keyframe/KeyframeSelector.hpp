@@ -140,6 +140,15 @@ public:
       _maxOutFrame = nbFrame;
   }
 
+  /**
+   * @brief Set the number of threads analyzing the frames
+   * @param[in] nbThreads number of threads (0 = all cores, 1 = serial processing)
+   */
+  void setNbThreads(unsigned int nbThreads)
+  {
+      _nbThreads = nbThreads;
+  }
+
   /**
    * @brief Get sharp subset size for process algorithm
    * @return sharp part of the image (1 = all, 2 = size/2, ...)
@@ -175,6 +184,40 @@ public:
   {
       return _maxOutFrame;
   }
+
+  /**
+   * @brief Get the number of threads analyzing the frames
+   * @return number of threads (0 = all cores, 1 = serial processing)
+   */
+  unsigned int getNbThreads() const
+  {
+      return _nbThreads;
+  }
+
+  /**
+   * @brief Get the keyframe indexes chosen by the last process
+   * @return keyframe indexes in the selection order
+   */
+  const std::vector<std::size_t>& getKeyframeIndexes() const
+  {
+      return _keyframeIndexes;
+  }
+
+  /**
+   * @brief Compute sharpness score of a given image: the mean of the tileSharpSubset
+   * highest tile averages of the normalized absolute Scharr derivatives
+   * @param[in] imageGray given image in grayscale
+   * @param[in] nbTileSide number of tiles per side
+   * @param[in] tileHeight height of tile
+   * @param[in] tileWidth width of tile
+   * @param[in] tileSharpSubset number of sharp tiles
+   * @return sharpness score
+   */
+  static float computeSharpness(const image::Image<unsigned char>& imageGray,
+                                const unsigned int nbTileSide,
+                                const unsigned int tileHeight,
+                                const unsigned int tileWidth,
+                                const unsigned int tileSharpSubset);
     
 private:
 
@@ -207,6 +250,10 @@ private:
   float _sharpnessThreshold = 15.0f;
   /// Distance max score (image with smallest distance from the last keyframe will be selected)
   float _distScoreMax = 100.0f;
+  /// Number of threads analyzing the frames (0 = all cores, 1 = serial processing)
+  unsigned int _nbThreads = 0;
+  /// Number of frames analyzed ahead at once by the parallel processing
+  unsigned int _nbFramesPerChunk = 256;
 
   /// Camera metadatas
   std::vector<CameraInfo> _cameraInfos;
@@ -283,17 +330,26 @@ private:
   std::vector<std::size_t> _keyframeIndexes;
 
   /**
-   * @brief Compute sharpness score of a given image
-   * @param[in] imageGray given image in grayscale
-   * @param[in] tileHeight height of tile
-   * @param[in] tileWidth width of tile
+   * @brief Compute sharpness score and sparse histogram (if the image is sharp enough) of a given image
+   * @param[in] image an image of the media
+   * @param[in] mediaIndex the media index
    * @param[in] tileSharpSubset number of sharp tiles
-   * @return sharpness score
+   * @param[in] imageDescriber image describer used by the calling thread
+   * @param[out] mediaData sharpness score and sparse histogram of the image
    */
-  float computeSharpness(const image::Image<unsigned char>& imageGray,
-                         const unsigned int tileHeight,
-                         const unsigned int tileWidth,
-                         const unsigned int tileSharpSubset) const;
+  void analyzeFrame(const image::Image<image::RGBColor>& image,
+                    std::size_t mediaIndex,
+                    unsigned int tileSharpSubset,
+                    feature::ImageDescriber& imageDescriber,
+                    MediaData& mediaData) const;
+
+  /**
+   * @brief Compute distance score of an analyzed frame with the last keyframes
+   * @param[in] frameIndex the image index in the media sequence
+   * @param[in] mediaIndex the media index
+   * @return true if the frame is selected
+   */
+  bool computeDistScore(std::size_t frameIndex, std::size_t mediaIndex);
 
   /**
    * @brief Compute sharpness and distance score for a given image
@@ -308,6 +364,21 @@ private:
                         std::size_t mediaIndex,
                         unsigned int tileSharpSubset);
 
+  /**
+   * @brief Analyze the frames [firstFrame, lastFrame) of all the medias in parallel.
+   * The frames of each media are decoded ahead in order while the previous ones are analyzed,
+   * the frames of the different medias are decoded concurrently.
+   * @param[in] firstFrame first frame index
+   * @param[in] lastFrame last frame index (excluded)
+   * @param[in] tileSharpSubset number of sharp tiles
+   * @param[in,out] framesAnalysis per frame and per media analysis
+   * @return the number of images analyzed per second
+   */
+  double analyzeFrames(std::size_t firstFrame,
+                       std::size_t lastFrame,
+                       unsigned int tileSharpSubset,
+                       std::vector< std::vector<MediaData> >& framesAnalysis);
+
   /**
    * @brief Write a keyframe and metadata
    * @param[in] image an image of the media
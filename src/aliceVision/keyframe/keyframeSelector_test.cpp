@@ -0,0 +1,177 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/keyframe/KeyframeSelector.hpp>
+#include <aliceVision/image/image.hpp>
+#include <aliceVision/voctree/TreeBuilder.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+#define BOOST_TEST_MODULE KeyframeSelector
+#include <boost/test/included/unit_test.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+
+using namespace aliceVision;
+
+/**
+ * @brief Reference sharpness score: the previous implementation, with the
+ * separable convolutions of the image module on a float image.
+ */
+float computeSharpnessReference(const image::Image<unsigned char>& imageGray,
+                                unsigned int nbTileSide,
+                                unsigned int tileHeight,
+                                unsigned int tileWidth,
+                                unsigned int tileSharpSubset)
+{
+  image::Image<float> image;
+  image::Image<float> scharrXDer;
+  image::Image<float> scharrYDer;
+
+  image::ConvertPixelType(imageGray, &image);
+  image::ImageScharrXDerivative(image, scharrXDer); // normalized
+  image::ImageScharrYDerivative(image, scharrYDer); // normalized
+
+  scharrXDer = scharrXDer.cwiseAbs();
+  scharrYDer = scharrYDer.cwiseAbs();
+
+  std::vector<float> averageTileIntensity;
+  const float tileSizeInv = 1 / static_cast<float>(tileHeight * tileWidth);
+
+  for(std::size_t y = 0; y < (nbTileSide * tileHeight); y += tileHeight)
+  {
+    for(std::size_t x = 0; x < (nbTileSide * tileWidth); x += tileWidth)
+    {
+      const auto sum = scharrXDer.block(y, x, tileHeight, tileWidth).sum() + scharrYDer.block(y, x, tileHeight, tileWidth).sum();
+      averageTileIntensity.push_back(sum * tileSizeInv);
+    }
+  }
+
+  std::sort(averageTileIntensity.begin(), averageTileIntensity.end());
+  return std::accumulate(averageTileIntensity.end() - tileSharpSubset, averageTileIntensity.end(), 0.0f) / tileSharpSubset;
+}
+
+BOOST_AUTO_TEST_CASE(KeyframeSelector_computeSharpness)
+{
+  const unsigned int nbTileSide = 20;
+
+  // the images are not exactly covered by the tiles, and the sharpest tiles
+  // are on the borders so that the border handling matters
+  const std::vector<std::pair<int, int>> imageSizes = {{160, 120}, {163, 127}, {61, 41}};
+
+  std::mt19937 generator(0);
+  std::uniform_int_distribution<int> noise(0, 40);
+
+  for(const auto& imageSize : imageSizes)
+  {
+    const int width = imageSize.first;
+    const int height = imageSize.second;
+    image::Image<unsigned char> imageGray(width, height);
+
+    for(int y = 0; y < height; ++y)
+    {
+      for(int x = 0; x < width; ++x)
+      {
+        const bool border = (x < 3 || y < 3 || x >= width - 3 || y >= height - 3);
+        imageGray(y, x) = static_cast<unsigned char>((border ? ((x + y) % 2) * 200 : 50) + noise(generator));
+      }
+    }
+
+    const unsigned int tileHeight = height / nbTileSide;
+    const unsigned int tileWidth = width / nbTileSide;
+
+    for(const unsigned int tileSharpSubset : {1u, 20u, 100u, 400u})
+    {
+      const float sharpness = keyframe::KeyframeSelector::computeSharpness(imageGray, nbTileSide, tileHeight, tileWidth, tileSharpSubset);
+      const float reference = computeSharpnessReference(imageGray, nbTileSide, tileHeight, tileWidth, tileSharpSubset);
+      BOOST_CHECK_CLOSE(sharpness, reference, 1e-3);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(KeyframeSelector_computeSharpness_uniform)
+{
+  // no derivative on a uniform image, including on the borders
+  image::Image<unsigned char> imageGray(100, 80, true, 128);
+  BOOST_CHECK_EQUAL(keyframe::KeyframeSelector::computeSharpness(imageGray, 20, 4, 5, 10), 0.0f);
+}
+
+BOOST_AUTO_TEST_CASE(KeyframeSelector_process_serialParallel)
+{
+  namespace bfs = boost::filesystem;
+
+  const std::string mediaFolder = "keyframeSelectorMedia";
+  const std::string outputFolder = "keyframeSelectorOutput";
+  const std::string treeName = "keyframeSelector.tree";
+  bfs::create_directory(mediaFolder);
+  bfs::create_directory(outputFolder);
+
+  // image sequence with a random texture whose contrast (i.e. sharpness) changes at each frame
+  std::mt19937 generator(0);
+  std::uniform_int_distribution<int> contrastDistribution(20, 120);
+  std::uniform_int_distribution<int> textureDistribution(-1, 1);
+  const int width = 320;
+  const int height = 240;
+  const std::size_t nbFrames = 40;
+
+  for(std::size_t frame = 0; frame < nbFrames; ++frame)
+  {
+    const int contrast = contrastDistribution(generator);
+    image::Image<image::RGBColor> image(width, height);
+    for(int y = 0; y < height; y += 4)
+    {
+      for(int x = 0; x < width; x += 4)
+      {
+        const unsigned char value = static_cast<unsigned char>(128 + contrast * textureDistribution(generator));
+        image.block(y, x, 4, 4).fill(image::RGBColor(value));
+      }
+    }
+    const std::string frameName = std::to_string(frame);
+    const std::string imagePath = mediaFolder + "/frame_" + std::string(3 - frameName.size(), '0') + frameName + ".ppm";
+    BOOST_REQUIRE(image::WriteImage(imagePath.c_str(), image));
+  }
+
+  // small vocabulary tree of SIFT-like descriptors
+  {
+    using DescriptorFloat = feature::Descriptor<float, 128>;
+    std::uniform_real_distribution<float> descriptorDistribution(0.f, 255.f);
+    std::vector<DescriptorFloat> descriptors(500);
+    for(auto& descriptor : descriptors)
+      for(std::size_t d = 0; d < 128; ++d)
+        descriptor[d] = descriptorDistribution(generator);
+
+    voctree::TreeBuilder<DescriptorFloat> builder(DescriptorFloat(0));
+    builder.setVerbose(0);
+    builder.build(descriptors, 4, 2);
+    builder.tree().save(treeName);
+  }
+
+  // the serial and the parallel processing select the same keyframes
+  std::vector<std::size_t> keyframeIndexes[2];
+  for(const unsigned int nbThreads : {1u, 0u})
+  {
+    keyframe::KeyframeSelector selector({mediaFolder}, "", treeName, outputFolder);
+    selector.setCameraInfos(std::vector<keyframe::KeyframeSelector::CameraInfo>(1));
+    selector.setSharpnessSelectionPreset(keyframe::ESharpnessSelectionPreset::NONE);
+    selector.setMinFrameStep(3);
+    selector.setMaxFrameStep(7);
+    selector.setNbThreads(nbThreads);
+    selector.process();
+    keyframeIndexes[nbThreads] = selector.getKeyframeIndexes();
+  }
+
+  BOOST_CHECK(!keyframeIndexes[0].empty());
+  BOOST_CHECK_EQUAL_COLLECTIONS(keyframeIndexes[0].begin(), keyframeIndexes[0].end(),
+                                keyframeIndexes[1].begin(), keyframeIndexes[1].end());
+
+  bfs::remove_all(mediaFolder);
+  bfs::remove_all(outputFolder);
+  bfs::remove(treeName);
+}
@@ -6,6 +6,7 @@
 #pragma once
 
 #include <deque>
+#include <utility>
 #include <assert.h>
 
 namespace aliceVision {
@@ -85,9 +86,50 @@ public:
     {
       _buffer.pop_front();
     }
-    _buffer.emplace_back(args...);
+    _buffer.emplace_back(std::forward<Args>(args)...);
   }
 
+  /**
+   * @brief Returns a reference to the first element of the buffer.
+   * 
+   * @return the first element of the buffer.
+   */
+  T& front() { return _buffer.front(); }
+
+  /**
+   * @brief It removes the first element of the buffer.
+   */
+  void pop_front() { _buffer.pop_front(); }
+
+  /**
+   * @brief Returns the number of elements in the buffer.
+   * 
+   * @return the number of elements in the buffer.
+   */
+  std::size_t size() const { return _buffer.size(); }
+
+  /**
+   * @brief Returns the maximum number of elements of the buffer.
+   * 
+   * @return the maximum number of elements of the buffer.
+   */
+  std::size_t maxSize() const { return _maxSize; }
+
+  /**
+   * @brief Returns true if the buffer contains no element.
+   * 
+   * @return true if the buffer is empty.
+   */
+  bool empty() const { return _buffer.empty(); }
+
+  /**
+   * @brief Returns true if the buffer has reached its maximum size, ie the next
+   * insertion will remove its first element.
+   * 
+   * @return true if the buffer is full.
+   */
+  bool full() const { return _buffer.size() >= _maxSize; }
+
 };
 
 }
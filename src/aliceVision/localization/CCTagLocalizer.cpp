@@ -201,35 +201,17 @@ bool CCTagLocalizer::localize(const image::Image<unsigned char> & imageGrey,
                               LocalizationResult & localizationResult, 
                               const std::string& imagePath)
 {
-  namespace bfs = boost::filesystem;
-  
   const CCTagLocalizer::Parameters *param = static_cast<const CCTagLocalizer::Parameters *>(parameters);
   if(!param)
   {
     throw std::invalid_argument("The CCTag localizer parameters are not in the right format.");
   }
   // extract descriptors and features from image
-  ALICEVISION_LOG_DEBUG("[features]\tExtract CCTag from query image");
   feature::MapRegionsPerDesc tmpQueryRegions;
+  describe(_imageDescriber, imageGrey, param, tmpQueryRegions, imagePath);
 
-  _imageDescriber.setCudaPipe( _cudaPipe );
-  _imageDescriber.Set_configuration_preset(param->_featurePreset);
-  _imageDescriber.Describe(imageGrey, tmpQueryRegions[_cctagDescType]);
-  ALICEVISION_LOG_DEBUG("[features]\tExtract CCTAG done: found " << tmpQueryRegions.at(_cctagDescType)->RegionCount() << " features");
-  
   std::pair<std::size_t, std::size_t> imageSize = std::make_pair(imageGrey.Width(),imageGrey.Height());
-  
-  if(!param->_visualDebug.empty() && !imagePath.empty())
-  {
-    // it automatically throws an exception if the cast does not work
-    const feature::CCTAG_Regions & cctagQueryRegions = tmpQueryRegions.getRegions<feature::CCTAG_Regions>(_cctagDescType);
-    
-    // just debugging -- save the svg image with detected cctag
-    feature::saveCCTag2SVG(imagePath, 
-                            imageSize, 
-                            cctagQueryRegions,
-                            param->_visualDebug+"/"+bfs::path(imagePath).stem().string()+".svg");
-  }
+
   return localize(tmpQueryRegions,
                   imageSize,
                   parameters,
@@ -239,6 +221,52 @@ bool CCTagLocalizer::localize(const image::Image<unsigned char> & imageGrey,
                   imagePath);
 }
 
+std::vector<std::unique_ptr<feature::ImageDescriber>> CCTagLocalizer::createImageDescribers() const
+{
+  std::vector<std::unique_ptr<feature::ImageDescriber>> imageDescribers;
+  imageDescribers.push_back(feature::createImageDescriber(_cctagDescType));
+  return imageDescribers;
+}
+
+void CCTagLocalizer::extractRegions(const image::Image<unsigned char> & imageGrey,
+                                    const LocalizerParameters *param,
+                                    const std::vector<std::unique_ptr<feature::ImageDescriber>> & imageDescribers,
+                                    feature::MapRegionsPerDesc &queryRegions,
+                                    const std::string& imagePath) const
+{
+  for(const auto& imageDescriber : imageDescribers)
+    describe(*imageDescriber, imageGrey, param, queryRegions, imagePath);
+}
+
+void CCTagLocalizer::describe(feature::ImageDescriber& imageDescriber,
+                              const image::Image<unsigned char> & imageGrey,
+                              const LocalizerParameters *param,
+                              feature::MapRegionsPerDesc &queryRegions,
+                              const std::string& imagePath) const
+{
+  namespace bfs = boost::filesystem;
+
+  ALICEVISION_LOG_DEBUG("[features]\tExtract CCTag from query image");
+  const feature::EImageDescriberType descType = imageDescriber.getDescriberType();
+
+  imageDescriber.setCudaPipe( _cudaPipe );
+  imageDescriber.Set_configuration_preset(param->_featurePreset);
+  imageDescriber.Describe(imageGrey, queryRegions[descType]);
+  ALICEVISION_LOG_DEBUG("[features]\tExtract CCTAG done: found " << queryRegions.at(descType)->RegionCount() << " features");
+
+  if(!param->_visualDebug.empty() && !imagePath.empty())
+  {
+    // it automatically throws an exception if the cast does not work
+    const feature::CCTAG_Regions & cctagQueryRegions = queryRegions.getRegions<feature::CCTAG_Regions>(descType);
+
+    // just debugging -- save the svg image with detected cctag
+    feature::saveCCTag2SVG(imagePath,
+                            std::make_pair(imageGrey.Width(), imageGrey.Height()),
+                            cctagQueryRegions,
+                            param->_visualDebug+"/"+bfs::path(imagePath).stem().string()+".svg");
+  }
+}
+
 void CCTagLocalizer::setCudaPipe( int i )
 {
     _cudaPipe = i;
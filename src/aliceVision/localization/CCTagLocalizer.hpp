@@ -71,6 +71,14 @@ public:
                 LocalizationResult & localizationResult,
                 const std::string& imagePath = std::string()) override;
 
+  std::vector<std::unique_ptr<feature::ImageDescriber>> createImageDescribers() const override;
+
+  void extractRegions(const image::Image<unsigned char> & imageGrey,
+                      const LocalizerParameters *param,
+                      const std::vector<std::unique_ptr<feature::ImageDescriber>> & imageDescribers,
+                      feature::MapRegionsPerDesc &queryRegions,
+                      const std::string& imagePath = std::string()) const override;
+
   /**
    * @brief Naive implementation of the localizer using the rig. Each image from
    * the rig is localized and then a bundle adjustment is run for optimizing the 
@@ -151,6 +159,16 @@ private:
     const sfm::SfMData & sfm_data,
     const std::string & feat_directory);
   
+  /**
+   * @brief Extract the CCTags of a query image with the given image describer,
+   * and save them in the visual debugging folder if it is enabled.
+   */
+  void describe(feature::ImageDescriber& imageDescriber,
+                const image::Image<unsigned char> & imageGrey,
+                const LocalizerParameters *param,
+                feature::MapRegionsPerDesc &queryRegions,
+                const std::string& imagePath) const;
+
   // for each view index, it contains the cctag features and descriptors that have an
   // associated 3D point
   feature::RegionsPerView _regionsPerView;
@@ -0,0 +1,109 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include "BoundedBuffer.hpp"
+
+#include <condition_variable>
+#include <mutex>
+
+namespace aliceVision {
+namespace localization {
+
+/**
+ * @brief This class implements a thread safe bounded buffer to connect the stages
+ * of a producer/consumer pipeline. Contrary to BoundedBuffer, when the buffer
+ * is full the producer waits until a consumer removes an element, so that no
+ * element is lost and the memory used by the elements in flight is bounded.
+ * Once the producers have finished, the buffer is closed: the consumers can still
+ * pop the remaining elements and then pop() returns false.
+ */
+template<class T>
+class ConcurrentBoundedBuffer
+{
+public:
+
+  /**
+   * @brief Build a concurrent bounded buffer of the given size.
+   * @param[in] maxSize The maximum number of elements in the buffer, it must be > 0.
+   */
+  ConcurrentBoundedBuffer(std::size_t maxSize) : _buffer(maxSize)
+  {
+    assert(maxSize > 0);
+  }
+
+  /**
+   * @brief Append a new element at the end of the buffer. If the buffer is full
+   * it waits until an element is removed.
+   * @param[in] element The element to add.
+   * @return false if the buffer has been closed, the element is not added.
+   */
+  bool push(T&& element)
+  {
+    std::unique_lock<std::mutex> lock(_mutex);
+    _notFull.wait(lock, [this]{ return _isClosed || !_buffer.full(); });
+    if(_isClosed)
+      return false;
+    _buffer.emplace_back(std::move(element));
+    lock.unlock();
+    _notEmpty.notify_one();
+    return true;
+  }
+
+  /**
+   * @brief Remove the first element of the buffer (FIFO strategy). If the buffer
+   * is empty it waits until an element is added or the buffer is closed.
+   * @param[out] element The removed element.
+   * @return false if the buffer is closed and empty.
+   */
+  bool pop(T& element)
+  {
+    std::unique_lock<std::mutex> lock(_mutex);
+    _notEmpty.wait(lock, [this]{ return _isClosed || !_buffer.empty(); });
+    if(_buffer.empty())
+      return false;
+    element = std::move(_buffer.front());
+    _buffer.pop_front();
+    lock.unlock();
+    _notFull.notify_one();
+    return true;
+  }
+
+  /**
+   * @brief Close the buffer: the waiting producers and consumers are woken up,
+   * no element can be added anymore.
+   */
+  void close()
+  {
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _isClosed = true;
+    }
+    _notFull.notify_all();
+    _notEmpty.notify_all();
+  }
+
+  /**
+   * @brief Returns the number of elements in the buffer.
+   *
+   * @return the number of elements in the buffer.
+   */
+  std::size_t size() const
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _buffer.size();
+  }
+
+private:
+  BoundedBuffer<T> _buffer;
+  bool _isClosed = false;
+  mutable std::mutex _mutex;
+  std::condition_variable _notFull;
+  std::condition_variable _notEmpty;
+};
+
+}
+}
@@ -0,0 +1,55 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "ConcurrentBoundedBuffer.hpp"
+
+#include <thread>
+#include <vector>
+
+#define BOOST_TEST_MODULE ConcurrentBoundedBuffer
+#include <boost/test/included/unit_test.hpp>
+
+using namespace aliceVision;
+
+BOOST_AUTO_TEST_CASE(ConcurrentBoundedBuffer_producerConsumer)
+{
+  const std::size_t nbElements = 1000;
+  localization::ConcurrentBoundedBuffer<std::size_t> buffer(3);
+
+  std::thread producer([&]()
+  {
+    for(std::size_t i = 0; i < nbElements; ++i)
+      buffer.push(std::size_t(i));
+    buffer.close();
+  });
+
+  // the elements are received in the FIFO order and none is lost
+  std::vector<std::size_t> received;
+  std::size_t element;
+  while(buffer.pop(element))
+    received.push_back(element);
+  producer.join();
+
+  BOOST_CHECK_EQUAL(received.size(), nbElements);
+  for(std::size_t i = 0; i < received.size(); ++i)
+    BOOST_CHECK_EQUAL(received[i], i);
+}
+
+BOOST_AUTO_TEST_CASE(ConcurrentBoundedBuffer_close)
+{
+  localization::ConcurrentBoundedBuffer<int> buffer(2);
+  BOOST_CHECK(buffer.push(1));
+  BOOST_CHECK(buffer.push(2));
+  buffer.close();
+
+  // no element can be added once closed but the remaining ones can be popped
+  BOOST_CHECK(!buffer.push(3));
+  int element;
+  BOOST_CHECK(buffer.pop(element));
+  BOOST_CHECK_EQUAL(element, 1);
+  BOOST_CHECK(buffer.pop(element));
+  BOOST_CHECK_EQUAL(element, 2);
+  BOOST_CHECK(!buffer.pop(element));
+}
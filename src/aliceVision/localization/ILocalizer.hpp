@@ -13,6 +13,10 @@
 #include <aliceVision/robustEstimation/estimators.hpp>
 #include <aliceVision/numeric/numeric.hpp>
 
+#include <memory>
+#include <string>
+#include <vector>
+
 namespace aliceVision {
 namespace localization {
 
@@ -94,6 +98,31 @@ public:
                         camera::PinholeRadialK3 &queryIntrinsics,
                         LocalizationResult & localizationResult,
                         const std::string& imagePath = std::string()) = 0;
+
+  /**
+   * @brief Create a new set of the image describers used to extract the regions
+   * of the query images. The image describers hold a state, each thread extracting
+   * regions concurrently needs its own set.
+   *
+   * @return the image describers, with the same types as the localizer's ones.
+   */
+  virtual std::vector<std::unique_ptr<feature::ImageDescriber>> createImageDescribers() const = 0;
+
+  /**
+   * @brief Extract the regions of a query image as localize() does from an image:
+   * same describer types and preset, same CUDA pipe, same visual debugging output.
+   *
+   * @param[in] imageGrey The input greyscale image.
+   * @param[in] param The parameters for the localization.
+   * @param[in] imageDescribers The image describers, created by createImageDescribers().
+   * @param[out] queryRegions The regions extracted for each describer type.
+   * @param[in] imagePath Optional complete path to the image, used only for debugging purposes.
+   */
+  virtual void extractRegions(const image::Image<unsigned char> & imageGrey,
+                              const LocalizerParameters *param,
+                              const std::vector<std::unique_ptr<feature::ImageDescriber>> & imageDescribers,
+                              feature::MapRegionsPerDesc &queryRegions,
+                              const std::string& imagePath = std::string()) const = 0;
     
   virtual bool localizeRig(const std::vector<image::Image<unsigned char> > & vec_imageGrey,
                            const LocalizerParameters *param,
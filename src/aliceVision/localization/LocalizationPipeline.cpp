@@ -0,0 +1,268 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "LocalizationPipeline.hpp"
+#include "ConcurrentBoundedBuffer.hpp"
+#include <aliceVision/feature/ImageDescriber.hpp>
+#include <aliceVision/image/Image.hpp>
+#include <aliceVision/system/Logger.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <exception>
+#include <map>
+#include <mutex>
+#include <thread>
+
+namespace aliceVision {
+namespace localization {
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+/// A frame flowing through the stages of the pipeline
+struct PipelineFrame
+{
+  std::size_t frameId = 0;
+  std::string imagePath;
+  image::Image<unsigned char> imageGrey;
+  std::pair<std::size_t, std::size_t> imageSize;
+  camera::PinholeRadialK3 queryIntrinsics;
+  bool hasIntrinsics = false;
+  feature::MapRegionsPerDesc regions;
+  /// when the decoding of the frame started
+  Clock::time_point startTime;
+};
+
+double elapsedMs(const Clock::time_point& start, const Clock::time_point& end)
+{
+  return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+} // namespace
+
+double LocalizationPipelineStats::getLatencyPercentile(double percentile) const
+{
+  if(latenciesMs.empty())
+    return 0.0;
+  std::vector<double> sorted(latenciesMs);
+  std::sort(sorted.begin(), sorted.end());
+  const double rank = std::ceil(std::min(std::max(percentile, 0.0), 100.0) / 100.0 * sorted.size());
+  const std::size_t index = std::max<std::size_t>(static_cast<std::size_t>(rank), 1) - 1;
+  return sorted[index];
+}
+
+double LocalizationPipelineStats::getThroughput() const
+{
+  if(totalTimeMs <= 0.0)
+    return 0.0;
+  return nbFrames / (totalTimeMs / 1000.0);
+}
+
+std::ostream& operator<<(std::ostream& os, const LocalizationPipelineStats& stats)
+{
+  os << "Pipeline processed " << stats.nbFrames << " frames in " << stats.totalTimeMs / 1000.0 << " [s]"
+     << " (" << stats.getThroughput() << " fps)" << std::endl
+     << "\tlatency p50: " << stats.getLatencyPercentile(50) << " [ms]"
+     << ", p90: " << stats.getLatencyPercentile(90) << " [ms]"
+     << ", p99: " << stats.getLatencyPercentile(99) << " [ms]"
+     << ", max: " << stats.getLatencyPercentile(100) << " [ms]" << std::endl;
+  if(stats.nbFrames > 0)
+  {
+    os << "\tmean time per frame: decoding " << stats.decodeTimeMs / stats.nbFrames << " [ms]"
+       << ", feature extraction " << stats.extractionTimeMs / stats.nbFrames << " [ms]"
+       << ", localization " << stats.localizationTimeMs / stats.nbFrames << " [ms]";
+  }
+  return os;
+}
+
+LocalizationPipeline::LocalizationPipeline(ILocalizer& localizer,
+                                           const LocalizerParameters* param,
+                                           std::size_t nbExtractionThreads,
+                                           std::size_t bufferSize)
+  : _localizer(localizer)
+  , _param(param)
+  , _nbExtractionThreads(std::max<std::size_t>(nbExtractionThreads, 1))
+  , _bufferSize(std::max<std::size_t>(bufferSize, 1))
+{}
+
+LocalizationPipelineStats LocalizationPipeline::run(dataio::FeedProvider& feed, const FrameCallback& callback)
+{
+  LocalizationPipelineStats stats;
+  const Clock::time_point runStart = Clock::now();
+
+  ConcurrentBoundedBuffer<PipelineFrame> decodedFrames(_bufferSize);
+  ConcurrentBoundedBuffer<PipelineFrame> describedFrames(_bufferSize);
+
+  // the first exception thrown by a stage, it is rethrown once all the threads are joined
+  std::exception_ptr workerException;
+  std::mutex statsMutex;
+  std::atomic<std::size_t> nbRunningExtractors(_nbExtractionThreads);
+
+  // reordering window of the localization stage: only the frames [nextFrameId, windowEnd)
+  // can be passed to it, so that a slow extraction cannot make the other ones pile up
+  std::mutex windowMutex;
+  std::condition_variable windowMoved;
+  std::size_t windowEnd = _bufferSize;
+  bool isStopped = false;
+
+  const auto stopPipeline = [&](std::exception_ptr exception)
+  {
+    {
+      std::lock_guard<std::mutex> lock(statsMutex);
+      if(!workerException)
+        workerException = exception;
+    }
+    {
+      std::lock_guard<std::mutex> lock(windowMutex);
+      isStopped = true;
+    }
+    windowMoved.notify_all();
+    decodedFrames.close();
+    describedFrames.close();
+  };
+
+  // A. decoding stage: read the frames from the feed
+  std::thread decoder([&]()
+  {
+    try
+    {
+      std::size_t frameId = 0;
+      while(true)
+      {
+        PipelineFrame frame;
+        frame.frameId = frameId++;
+        frame.startTime = Clock::now();
+        if(!feed.readImage(frame.imageGrey, frame.queryIntrinsics, frame.imagePath, frame.hasIntrinsics))
+          break;
+        frame.imageSize = std::make_pair(frame.imageGrey.Width(), frame.imageGrey.Height());
+        feed.goToNextFrame();
+        {
+          std::lock_guard<std::mutex> lock(statsMutex);
+          stats.decodeTimeMs += elapsedMs(frame.startTime, Clock::now());
+        }
+        if(!decodedFrames.push(std::move(frame)))
+          break;
+      }
+      decodedFrames.close();
+    }
+    catch(...)
+    {
+      stopPipeline(std::current_exception());
+    }
+  });
+
+  // B. feature extraction stage: each thread owns its set of the localizer's
+  // image describers
+  std::vector<std::thread> extractors;
+  for(std::size_t t = 0; t < _nbExtractionThreads; ++t)
+  {
+    extractors.emplace_back([&]()
+    {
+      try
+      {
+        const std::vector<std::unique_ptr<feature::ImageDescriber>> imageDescribers = _localizer.createImageDescribers();
+
+        PipelineFrame frame;
+        while(decodedFrames.pop(frame))
+        {
+          const Clock::time_point extractionStart = Clock::now();
+          _localizer.extractRegions(frame.imageGrey, _param, imageDescribers, frame.regions, frame.imagePath);
+          // the image is not needed anymore by the next stages
+          frame.imageGrey = image::Image<unsigned char>();
+          {
+            std::lock_guard<std::mutex> lock(statsMutex);
+            stats.extractionTimeMs += elapsedMs(extractionStart, Clock::now());
+          }
+          {
+            // the frames are popped in the feed order: the next frame to localize
+            // is never waiting here
+            std::unique_lock<std::mutex> lock(windowMutex);
+            windowMoved.wait(lock, [&]{ return frame.frameId < windowEnd || isStopped; });
+            if(isStopped)
+              break;
+          }
+          if(!describedFrames.push(std::move(frame)))
+            break;
+        }
+      }
+      catch(...)
+      {
+        stopPipeline(std::current_exception());
+      }
+      // the last extractor closes the buffer of the localization stage
+      if(--nbRunningExtractors == 0)
+        describedFrames.close();
+    });
+  }
+
+  // C. localization stage: the frames are localized in the feed order as the
+  // localizer may rely on the previous frames (e.g. frame buffer matching)
+  std::map<std::size_t, PipelineFrame> pendingFrames;
+  std::size_t nextFrameId = 0;
+  try
+  {
+    PipelineFrame frame;
+    while(describedFrames.pop(frame))
+    {
+      pendingFrames.emplace(frame.frameId, std::move(frame));
+
+      for(auto it = pendingFrames.find(nextFrameId); it != pendingFrames.end(); it = pendingFrames.find(nextFrameId))
+      {
+        PipelineFrame& currFrame = it->second;
+
+        ALICEVISION_LOG_DEBUG("[pipeline]\tLocalizing frame " << currFrame.frameId << " (" << pendingFrames.size() - 1 << " frames waiting)");
+        const Clock::time_point localizationStart = Clock::now();
+        LocalizationResult localizationResult;
+        _localizer.localize(currFrame.regions,
+                            currFrame.imageSize,
+                            _param,
+                            currFrame.hasIntrinsics /*useInputIntrinsics*/,
+                            currFrame.queryIntrinsics,
+                            localizationResult,
+                            currFrame.imagePath);
+        const Clock::time_point localizationEnd = Clock::now();
+
+        stats.localizationTimeMs += elapsedMs(localizationStart, localizationEnd);
+        stats.latenciesMs.push_back(elapsedMs(currFrame.startTime, localizationEnd));
+        ++stats.nbFrames;
+
+        callback(currFrame.frameId, currFrame.imagePath, currFrame.queryIntrinsics, localizationResult);
+
+        pendingFrames.erase(it);
+        ++nextFrameId;
+        {
+          std::lock_guard<std::mutex> lock(windowMutex);
+          windowEnd = nextFrameId + _bufferSize;
+        }
+        windowMoved.notify_all();
+      }
+    }
+  }
+  catch(...)
+  {
+    stopPipeline(std::current_exception());
+  }
+
+  decoder.join();
+  for(std::thread& extractor : extractors)
+    extractor.join();
+
+  if(workerException)
+    std::rethrow_exception(workerException);
+
+  if(!pendingFrames.empty())
+    ALICEVISION_LOG_WARNING("[pipeline]\t" << pendingFrames.size() << " frames have not been localized.");
+
+  stats.totalTimeMs = elapsedMs(runStart, Clock::now());
+  return stats;
+}
+
+} // namespace localization
+} // namespace aliceVision
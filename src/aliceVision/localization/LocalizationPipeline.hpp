@@ -0,0 +1,113 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include "ILocalizer.hpp"
+#include "LocalizationResult.hpp"
+#include <aliceVision/camera/PinholeRadial.hpp>
+#include <aliceVision/dataio/FeedProvider.hpp>
+
+#include <cstddef>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace aliceVision {
+namespace localization {
+
+/**
+ * @brief Timing statistics of a localization pipeline run.
+ */
+struct LocalizationPipelineStats
+{
+  /// number of processed frames
+  std::size_t nbFrames = 0;
+  /// overall duration of the run in milliseconds
+  double totalTimeMs = 0.0;
+  /// for each frame (in the feed order), the time between the beginning of its
+  /// decoding and the end of its localization in milliseconds
+  std::vector<double> latenciesMs;
+  /// cumulated time spent in each stage in milliseconds
+  double decodeTimeMs = 0.0;
+  double extractionTimeMs = 0.0;
+  double localizationTimeMs = 0.0;
+
+  /**
+   * @brief Get the frame latency for the given percentile (nearest-rank method).
+   * @param[in] percentile The percentile in [0, 100].
+   * @return the latency in milliseconds, 0 if no frame has been processed.
+   */
+  double getLatencyPercentile(double percentile) const;
+
+  /**
+   * @brief Get the number of frames localized per second.
+   * @return the throughput of the pipeline in frames per second.
+   */
+  double getThroughput() const;
+};
+
+std::ostream& operator<<(std::ostream& os, const LocalizationPipelineStats& stats);
+
+/**
+ * @brief This class localizes the frames of a feed with a pipeline of concurrent
+ * stages connected by bounded buffers:
+ * - a decoding thread reads the frames from the feed,
+ * - a pool of threads extracts the features of the decoded frames,
+ * - the calling thread localizes the frames in the feed order.
+ * The localization of a frame thus overlaps with the decoding and the feature
+ * extraction of the next ones, while the number of frames in memory is bounded
+ * by the size of the buffers: the described frames are also passed to the
+ * localization stage only within a window of the buffer size after the next
+ * frame to localize.
+ */
+class LocalizationPipeline
+{
+public:
+
+  /**
+   * @brief Callback called for each frame in the feed order once it has been localized.
+   * @param[in] frameId The index of the frame in the feed.
+   * @param[in] imagePath The media path of the frame.
+   * @param[in] queryIntrinsics The intrinsics of the frame, estimated or refined by the localizer.
+   * @param[in] localizationResult The localization result.
+   */
+  typedef std::function<void(std::size_t frameId,
+                             const std::string& imagePath,
+                             const camera::PinholeRadialK3& queryIntrinsics,
+                             const LocalizationResult& localizationResult)> FrameCallback;
+
+  /**
+   * @brief Initialize the pipeline.
+   * @param[in] localizer The localizer used for the last stage, it also provides
+   * the image describers of the feature extraction stage.
+   * @param[in] param The parameters for the localization.
+   * @param[in] nbExtractionThreads The number of feature extraction threads.
+   * @param[in] bufferSize The maximum number of frames waiting in each buffer,
+   * and the size of the reordering window of the localization stage.
+   */
+  LocalizationPipeline(ILocalizer& localizer,
+                       const LocalizerParameters* param,
+                       std::size_t nbExtractionThreads = 2,
+                       std::size_t bufferSize = 4);
+
+  /**
+   * @brief Localize all the frames of the feed.
+   * @param[in] feed The feed providing the frames.
+   * @param[in] callback Called for each frame in the feed order after its localization.
+   * @return the timing statistics of the run.
+   */
+  LocalizationPipelineStats run(dataio::FeedProvider& feed, const FrameCallback& callback);
+
+private:
+  ILocalizer& _localizer;
+  const LocalizerParameters* _param;
+  std::size_t _nbExtractionThreads;
+  std::size_t _bufferSize;
+};
+
+} // namespace localization
+} // namespace aliceVision
@@ -0,0 +1,132 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "MatcherCache.hpp"
+
+namespace aliceVision {
+namespace localization {
+
+MatcherCache::MatcherPtr MatcherCache::get(IndexT viewId,
+                                           const feature::MapRegionsPerDesc& regions,
+                                           matching::EMatcherType matcherType)
+{
+  std::promise<MatcherPtr> promise;
+  std::shared_future<MatcherPtr> future;
+  bool isBuilder = false;
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto it = _entries.find(viewId);
+    if(it != _entries.end() && it->second.matcherType == matcherType)
+    {
+      // move the view in front of the LRU list
+      _lru.splice(_lru.begin(), _lru, it->second.lruIt);
+      ++_nbHits;
+      future = it->second.matcher;
+    }
+    else
+    {
+      ++_nbMisses;
+      isBuilder = true;
+      if(_maxSize > 0)
+      {
+        // register the matcher before building it, so that the other threads
+        // requesting this view wait for it instead of building it again
+        future = promise.get_future().share();
+        if(it != _entries.end())
+        {
+          // outdated matcher (different matcher type)
+          it->second.matcher = future;
+          it->second.matcherType = matcherType;
+          _lru.splice(_lru.begin(), _lru, it->second.lruIt);
+        }
+        else
+        {
+          _lru.push_front(viewId);
+          _entries[viewId] = {future, matcherType, _lru.begin()};
+          shrink();
+        }
+      }
+    }
+  }
+
+  // another thread builds or has built the matcher
+  if(!isBuilder)
+    return future.get();
+
+  // build the matcher outside of the lock, so that the other threads can still
+  // access the cache while the index is built
+  MatcherPtr matcher;
+  try
+  {
+    matcher = std::make_shared<const matching::RegionsDatabaseMatcherPerDesc>(matcherType, regions);
+  }
+  catch(...)
+  {
+    promise.set_exception(std::current_exception());
+    {
+      // do not keep the failure in the cache, the next request builds it again
+      std::lock_guard<std::mutex> lock(_mutex);
+      auto it = _entries.find(viewId);
+      if(it != _entries.end() && it->second.matcherType == matcherType)
+      {
+        _lru.erase(it->second.lruIt);
+        _entries.erase(it);
+      }
+    }
+    throw;
+  }
+  promise.set_value(matcher);
+  return matcher;
+}
+
+void MatcherCache::setMaxSize(std::size_t maxSize)
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  _maxSize = maxSize;
+  shrink();
+}
+
+void MatcherCache::clear()
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  _entries.clear();
+  _lru.clear();
+}
+
+std::size_t MatcherCache::maxSize() const
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  return _maxSize;
+}
+
+std::size_t MatcherCache::size() const
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  return _entries.size();
+}
+
+std::size_t MatcherCache::getNbHits() const
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  return _nbHits;
+}
+
+std::size_t MatcherCache::getNbMisses() const
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  return _nbMisses;
+}
+
+void MatcherCache::shrink()
+{
+  while(_entries.size() > _maxSize)
+  {
+    _entries.erase(_lru.back());
+    _lru.pop_back();
+  }
+}
+
+} // namespace localization
+} // namespace aliceVision
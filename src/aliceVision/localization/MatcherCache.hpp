@@ -0,0 +1,111 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/types.hpp>
+#include <aliceVision/feature/RegionsPerView.hpp>
+#include <aliceVision/matching/matcherType.hpp>
+#include <aliceVision/matching/RegionsMatcher.hpp>
+
+#include <future>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+
+namespace aliceVision {
+namespace localization {
+
+/**
+ * @brief This class implements a cache of matchers built on the regions of the
+ * views of the database. The matchers (e.g. the FLANN k-d forests) are built
+ * lazily the first time a view is requested and they are kept in memory so
+ * that the following queries matching the same view can reuse them.
+ * The number of matchers kept in memory is bounded: whenever the cache is full,
+ * the least recently used matcher is discarded (LRU strategy).
+ *
+ * The cache is thread safe, the matchers are shared so that a matcher evicted
+ * from the cache remains valid as long as someone is still using it. When several
+ * threads request the same view at the same time (e.g. the cameras of a rig), the
+ * matcher is built only once and the other threads wait for it.
+ */
+class MatcherCache
+{
+public:
+
+  typedef std::shared_ptr<const matching::RegionsDatabaseMatcherPerDesc> MatcherPtr;
+
+  /**
+   * @brief Build a matcher cache of the given size.
+   * @param[in] maxSize The maximum number of matchers kept in memory, 0 means
+   * that the cache is disabled.
+   */
+  explicit MatcherCache(std::size_t maxSize = 0)
+    : _maxSize(maxSize)
+  {}
+
+  /**
+   * @brief Get the matcher built on the regions of the given view. If the matcher
+   * is not in the cache it is built and inserted in the cache, possibly
+   * discarding the least recently used one.
+   *
+   * @param[in] viewId The id of the view.
+   * @param[in] regions The regions of the view, they must outlive the cache.
+   * @param[in] matcherType The type of matcher to build.
+   * @return the matcher built on the regions of the view.
+   */
+  MatcherPtr get(IndexT viewId,
+                 const feature::MapRegionsPerDesc& regions,
+                 matching::EMatcherType matcherType);
+
+  /**
+   * @brief Set the maximum number of matchers kept in memory. If the cache
+   * contains more matchers, the least recently used are discarded.
+   * @param[in] maxSize The maximum number of matchers, 0 disables the cache.
+   */
+  void setMaxSize(std::size_t maxSize);
+
+  /**
+   * @brief Remove all the matchers from the cache.
+   */
+  void clear();
+
+  std::size_t maxSize() const;
+  std::size_t size() const;
+  bool isEnabled() const { return maxSize() > 0; }
+
+  /// number of requests served with an already built matcher
+  std::size_t getNbHits() const;
+  /// number of requests that needed to build a matcher
+  std::size_t getNbMisses() const;
+
+private:
+
+  struct Entry
+  {
+    /// the matcher, possibly still being built by another thread
+    std::shared_future<MatcherPtr> matcher;
+    matching::EMatcherType matcherType;
+    std::list<IndexT>::iterator lruIt;
+  };
+
+  /// Discard the least recently used matchers until the cache fits its maximum size.
+  /// The mutex must be held by the caller.
+  void shrink();
+
+  /// the maximum number of matchers in memory
+  std::size_t _maxSize;
+  /// the matchers per view id
+  std::map<IndexT, Entry> _entries;
+  /// the view ids ordered from the most recently used to the least recently used
+  std::list<IndexT> _lru;
+  std::size_t _nbHits = 0;
+  std::size_t _nbMisses = 0;
+  mutable std::mutex _mutex;
+};
+
+} // namespace localization
+} // namespace aliceVision
@@ -0,0 +1,157 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "MatcherCache.hpp"
+#include <aliceVision/feature/regionsFactory.hpp>
+
+#include <algorithm>
+#include <map>
+#include <numeric>
+#include <random>
+#include <thread>
+#include <vector>
+
+#define BOOST_TEST_MODULE MatcherCache
+#include <boost/test/included/unit_test.hpp>
+#include <aliceVision/unitTest.hpp>
+
+using namespace aliceVision;
+
+void generateRandomRegions(std::size_t numFeatures, std::mt19937& generator, feature::MapRegionsPerDesc& regionsPerDesc)
+{
+  std::uniform_int_distribution<int> distribution(0, 255);
+  std::unique_ptr<feature::SIFT_Regions> regions(new feature::SIFT_Regions());
+
+  for(std::size_t i = 0; i < numFeatures; ++i)
+  {
+    regions->Features().emplace_back(i, i);
+    feature::SIFT_Regions::DescriptorT desc;
+    for(std::size_t j = 0; j < desc.size(); ++j)
+      desc[j] = static_cast<unsigned char>(distribution(generator));
+    regions->Descriptors().push_back(desc);
+  }
+  regionsPerDesc[feature::EImageDescriberType::SIFT] = std::move(regions);
+}
+
+BOOST_AUTO_TEST_CASE(MatcherCache_LRU)
+{
+  std::mt19937 generator(0);
+  std::map<IndexT, feature::MapRegionsPerDesc> regionsPerView;
+  for(IndexT viewId = 0; viewId < 4; ++viewId)
+    generateRandomRegions(50, generator, regionsPerView[viewId]);
+
+  localization::MatcherCache cache(2);
+
+  const auto matcher0 = cache.get(0, regionsPerView.at(0), matching::ANN_L2);
+  const auto matcher1 = cache.get(1, regionsPerView.at(1), matching::ANN_L2);
+  BOOST_CHECK_EQUAL(cache.size(), 2);
+  BOOST_CHECK_EQUAL(cache.getNbMisses(), 2);
+
+  // view 0 is already in the cache and becomes the most recently used
+  BOOST_CHECK(cache.get(0, regionsPerView.at(0), matching::ANN_L2) == matcher0);
+  BOOST_CHECK_EQUAL(cache.getNbHits(), 1);
+
+  // view 1 is the least recently used: it is discarded
+  cache.get(2, regionsPerView.at(2), matching::ANN_L2);
+  BOOST_CHECK_EQUAL(cache.size(), 2);
+  BOOST_CHECK(cache.get(0, regionsPerView.at(0), matching::ANN_L2) == matcher0);
+  BOOST_CHECK(cache.get(1, regionsPerView.at(1), matching::ANN_L2) != matcher1);
+  BOOST_CHECK_EQUAL(cache.getNbMisses(), 4);
+
+  // the discarded matcher is still usable
+  matching::MatchesPerDescType matches;
+  BOOST_CHECK(matcher1->Match(0.8f, regionsPerView.at(1), matches));
+  BOOST_CHECK_EQUAL(matches.getNbAllMatches(), 50);
+
+  cache.setMaxSize(1);
+  BOOST_CHECK_EQUAL(cache.size(), 1);
+
+  // a disabled cache does not keep any matcher
+  cache.setMaxSize(0);
+  BOOST_CHECK_EQUAL(cache.size(), 0);
+  cache.get(3, regionsPerView.at(3), matching::ANN_L2);
+  BOOST_CHECK_EQUAL(cache.size(), 0);
+  BOOST_CHECK(!cache.isEnabled());
+}
+
+BOOST_AUTO_TEST_CASE(MatcherCache_ConcurrentRequests)
+{
+  std::mt19937 generator(0);
+  feature::MapRegionsPerDesc regions;
+  generateRandomRegions(2000, generator, regions);
+
+  localization::MatcherCache cache(2);
+
+  // the threads requesting the same view share a single matcher
+  const std::size_t nbThreads = 8;
+  std::vector<localization::MatcherCache::MatcherPtr> matchers(nbThreads);
+  std::vector<std::thread> threads;
+  for(std::size_t i = 0; i < nbThreads; ++i)
+    threads.emplace_back([&, i]() { matchers[i] = cache.get(0, regions, matching::ANN_L2); });
+  for(std::thread& thread : threads)
+    thread.join();
+
+  BOOST_CHECK_EQUAL(cache.getNbMisses(), 1);
+  BOOST_CHECK_EQUAL(cache.getNbHits(), nbThreads - 1);
+  for(const auto& matcher : matchers)
+    BOOST_CHECK(matcher && matcher == matchers.front());
+}
+
+BOOST_AUTO_TEST_CASE(MatcherCache_MatchingDirection)
+{
+  // the query contains noisy copies of the first features of the database
+  // view, in another order, and unrelated features
+  std::mt19937 generator(0);
+  feature::MapRegionsPerDesc databaseRegions, unrelatedRegions;
+  generateRandomRegions(400, generator, databaseRegions);
+  generateRandomRegions(100, generator, unrelatedRegions);
+  const auto& database = static_cast<const feature::SIFT_Regions&>(*databaseRegions.at(feature::EImageDescriberType::SIFT));
+  const auto& unrelated = static_cast<const feature::SIFT_Regions&>(*unrelatedRegions.at(feature::EImageDescriberType::SIFT));
+
+  const std::size_t nbCommon = 300;
+  std::vector<std::size_t> order(nbCommon);
+  std::iota(order.begin(), order.end(), 0);
+  std::shuffle(order.begin(), order.end(), generator);
+
+  std::uniform_int_distribution<int> noise(-5, 5);
+  std::unique_ptr<feature::SIFT_Regions> query(new feature::SIFT_Regions());
+  for(std::size_t i = 0; i < nbCommon; ++i)
+  {
+    feature::SIFT_Regions::DescriptorT desc = database.Descriptors()[order[i]];
+    for(std::size_t j = 0; j < desc.size(); ++j)
+      desc[j] = static_cast<unsigned char>(std::min(255, std::max(0, desc[j] + noise(generator))));
+    query->Features().emplace_back(i, i);
+    query->Descriptors().push_back(desc);
+  }
+  for(std::size_t i = 0; i < unrelated.RegionCount(); ++i)
+  {
+    query->Features().push_back(unrelated.Features()[i]);
+    query->Descriptors().push_back(unrelated.Descriptors()[i]);
+  }
+  feature::MapRegionsPerDesc queryRegions;
+  queryRegions[feature::EImageDescriberType::SIFT] = std::move(query);
+
+  // without cache: matcher built on the query regions (_i query, _j database)
+  matching::MatchesPerDescType queryIndexed;
+  BOOST_CHECK(matching::RegionsDatabaseMatcherPerDesc(matching::ANN_L2, queryRegions).Match(0.8f, databaseRegions, queryIndexed));
+
+  // with cache: matcher built on the database regions (_i database, _j query)
+  localization::MatcherCache cache(1);
+  matching::MatchesPerDescType databaseIndexed;
+  BOOST_CHECK(cache.get(0, databaseRegions, matching::ANN_L2)->Match(0.8f, queryRegions, databaseIndexed));
+
+  matching::IndMatches matches = queryIndexed.at(feature::EImageDescriberType::SIFT);
+  matching::IndMatches cachedMatches = databaseIndexed.at(feature::EImageDescriberType::SIFT);
+  for(matching::IndMatch& match : cachedMatches)
+    std::swap(match._i, match._j);
+  std::sort(matches.begin(), matches.end());
+  std::sort(cachedMatches.begin(), cachedMatches.end());
+
+  // the distinctive correspondences are the same in both directions
+  BOOST_CHECK_EQUAL(matches.size(), nbCommon);
+  BOOST_CHECK(matches == cachedMatches);
+  for(const matching::IndMatch& match : matches)
+    BOOST_CHECK_EQUAL(order[match._i], match._j);
+}
@@ -29,6 +29,8 @@
 
 #include <algorithm>
 #include <chrono>
+#include <exception>
+#include <numeric>
 
 namespace aliceVision {
 namespace localization {
@@ -208,10 +210,38 @@ bool VoctreeLocalizer::localize(const image::Image<unsigned char> & imageGrey,
                                 const std::string& imagePath /* = std::string() */)
 {
   // A. extract descriptors and features from image
-  ALICEVISION_LOG_DEBUG("[features]\tExtract Regions from query image");
   feature::MapRegionsPerDesc queryRegionsPerDesc;
+  extractRegions(imageGrey, param, _imageDescribers, queryRegionsPerDesc, imagePath);
+
+  const std::pair<std::size_t, std::size_t> queryImageSize = std::make_pair(imageGrey.Width(), imageGrey.Height());
+
+  return localize(queryRegionsPerDesc,
+                  queryImageSize,
+                  param,
+                  useInputIntrinsics,
+                  queryIntrinsics,
+                  localizationResult,
+                  imagePath);
+}
 
+std::vector<std::unique_ptr<feature::ImageDescriber>> VoctreeLocalizer::createImageDescribers() const
+{
+  std::vector<std::unique_ptr<feature::ImageDescriber>> imageDescribers;
+  imageDescribers.reserve(_imageDescribers.size());
   for(const auto& imageDescriber : _imageDescribers)
+    imageDescribers.push_back(feature::createImageDescriber(imageDescriber->getDescriberType()));
+  return imageDescribers;
+}
+
+void VoctreeLocalizer::extractRegions(const image::Image<unsigned char> & imageGrey,
+                                      const LocalizerParameters *param,
+                                      const std::vector<std::unique_ptr<feature::ImageDescriber>> & imageDescribers,
+                                      feature::MapRegionsPerDesc &queryRegionsPerDesc,
+                                      const std::string& imagePath /* = std::string() */) const
+{
+  ALICEVISION_LOG_DEBUG("[features]\tExtract Regions from query image");
+
+  for(const auto& imageDescriber : imageDescribers)
   {
     const auto descType = imageDescriber->getDescriberType();
     auto & queryRegions = queryRegionsPerDesc[descType];
@@ -226,14 +256,12 @@ bool VoctreeLocalizer::localize(const image::Image<unsigned char> & imageGrey,
     ALICEVISION_LOG_DEBUG("[features]\tExtract " << feature::EImageDescriberType_enumToString(descType) << " done: found " << queryRegions->RegionCount() << " features in " << timer.elapsedMs() << " [ms]");
   }
 
-  const std::pair<std::size_t, std::size_t> queryImageSize = std::make_pair(imageGrey.Width(), imageGrey.Height());
-
   // if debugging is enable save the svg image with the extracted features
   if(!param->_visualDebug.empty() && !imagePath.empty())
   {
     feature::MapFeaturesPerDesc extractedFeatures;
 
-    for(const auto& imageDescriber : _imageDescribers)
+    for(const auto& imageDescriber : imageDescribers)
     {
       const auto descType = imageDescriber->getDescriberType();
       extractedFeatures[descType] = queryRegionsPerDesc.at(descType)->GetRegionsPositions();
@@ -241,18 +269,10 @@ bool VoctreeLocalizer::localize(const image::Image<unsigned char> & imageGrey,
 
     namespace bfs = boost::filesystem;
     feature::saveFeatures2SVG(imagePath,
-                     queryImageSize,
+                     std::make_pair(imageGrey.Width(), imageGrey.Height()),
                      extractedFeatures,
                      param->_visualDebug + "/" + bfs::path(imagePath).stem().string() + ".svg");
   }
-
-  return localize(queryRegionsPerDesc,
-                  queryImageSize,
-                  param,
-                  useInputIntrinsics,
-                  queryIntrinsics,
-                  localizationResult,
-                  imagePath);
 }
 
 bool VoctreeLocalizer::loadReconstructionDescriptors(const sfm::SfMData & sfm_data,
@@ -382,6 +402,8 @@ bool VoctreeLocalizer::initDatabase(const std::string & vocTreeFilepath,
       ++my_progress_bar;
     }
   }
+  // the database is only queried from now on
+  _database.buildInvertedIndex();
   return true;
 }
 
@@ -418,8 +440,15 @@ bool VoctreeLocalizer::localizeFirstBestResult(const feature::MapRegionsPerDesc
 //            << " features with 3D points");
 //  }
 
-  ALICEVISION_LOG_DEBUG("[matching]\tBuilding the matcher");
-  matching::RegionsDatabaseMatcherPerDesc matchers(_matcherType, queryRegions);
+  // if the matcher cache is enabled the query is matched against the matchers
+  // of the database views, otherwise a matcher is built on the query regions
+  _matcherCache.setMaxSize(param._matcherCacheSize);
+  std::unique_ptr<matching::RegionsDatabaseMatcherPerDesc> queryMatchers;
+  if(!_matcherCache.isEnabled())
+  {
+    ALICEVISION_LOG_DEBUG("[matching]\tBuilding the matcher");
+    queryMatchers.reset(new matching::RegionsDatabaseMatcherPerDesc(_matcherType, queryRegions));
+  }
 
   sfm::ImageLocalizerMatchData resectionData;
   std::vector<IndMatch3D2D> associationIDs;
@@ -455,19 +484,15 @@ bool VoctreeLocalizer::localizeFirstBestResult(const feature::MapRegionsPerDesc
     const camera::Pinhole *matchedIntrinsics = (const camera::Pinhole*)(matchedIntrinsicsBase);
     
     matching::MatchesPerDescType featureMatches;
-    bool matchWorked = robustMatching(matchers,
-                                      // pass the input intrinsic if they are valid, null otherwise
-                                      (useInputIntrinsics) ? &queryIntrinsics : nullptr,
-                                      _regionsPerView.getRegionsPerDesc(matchedViewId),
-                                      matchedIntrinsics,
-                                      param._fDistRatio,
-                                      param._matchingError,
-                                      param._useRobustMatching,
-                                      param._useGuidedMatching,
-                                      queryImageSize,
-                                      std::make_pair(matchedView->getWidth(), matchedView->getHeight()),
-                                      featureMatches,
-                                      param._matchingEstimator);
+    bool matchWorked = matchDatabaseView(queryRegions,
+                                         queryMatchers.get(),
+                                         matchedViewId,
+                                         matchedIntrinsics,
+                                         param,
+                                         useInputIntrinsics,
+                                         queryIntrinsics,
+                                         queryImageSize,
+                                         featureMatches);
     if (!matchWorked)
     {
       ALICEVISION_LOG_DEBUG("[matching]\tMatching with " << matchedView->getImagePath() << " failed! Skipping image");
@@ -636,10 +661,23 @@ bool VoctreeLocalizer::localizeAllResults(const feature::MapRegionsPerDesc &quer
   std::vector<IndMatch3D2D> associationIDs;
   associationIDs.reserve(numCollectedPts);
 
+  std::vector<std::size_t> nbOccurences;
+  nbOccurences.reserve(numCollectedPts);
   for(const auto &ass : occurences)
   {
     // recopy the associations IDs in the vector
     associationIDs.push_back(ass.first);
+    nbOccurences.push_back(ass.second);
+  }
+
+  // the associations seen in more images are more likely to be correct:
+  // if some are, let the resection sample them first
+  if(std::any_of(nbOccurences.begin(), nbOccurences.end(), [](std::size_t n){ return n > 1; }))
+  {
+    resectionData.vec_sortedIndices.resize(numCollectedPts);
+    std::iota(resectionData.vec_sortedIndices.begin(), resectionData.vec_sortedIndices.end(), 0);
+    std::stable_sort(resectionData.vec_sortedIndices.begin(), resectionData.vec_sortedIndices.end(),
+                     [&](std::size_t a, std::size_t b){ return nbOccurences[a] > nbOccurences[b]; });
   }
   
   assert(associationIDs.size() == numCollectedPts);
@@ -781,8 +819,17 @@ void VoctreeLocalizer::getAllAssociations(const feature::MapRegionsPerDesc &quer
 //            << " features with 3D points");
 //  }
 
-  ALICEVISION_LOG_DEBUG("[matching]\tBuilding the matcher");
-  matching::RegionsDatabaseMatcherPerDesc matchers(_matcherType, queryRegions);
+  // if the matcher cache is enabled the query is matched against the matchers
+  // of the database views, otherwise a matcher is built on the query regions.
+  // The latter is also needed to match the frames of the buffer, if any.
+  _matcherCache.setMaxSize(param._matcherCacheSize);
+  const bool useFrameBuffer = (param._nbFrameBufferMatching > 0) && !_frameBuffer.empty();
+  std::unique_ptr<matching::RegionsDatabaseMatcherPerDesc> queryMatchers;
+  if(!_matcherCache.isEnabled() || useFrameBuffer)
+  {
+    ALICEVISION_LOG_DEBUG("[matching]\tBuilding the matcher");
+    queryMatchers.reset(new matching::RegionsDatabaseMatcherPerDesc(_matcherType, queryRegions));
+  }
 
   std::map< std::pair<IndexT, IndexT>, std::size_t > repeated;
   
@@ -824,19 +871,15 @@ void VoctreeLocalizer::getAllAssociations(const feature::MapRegionsPerDesc &quer
     const camera::Pinhole *matchedIntrinsics = (const camera::Pinhole*)(matchedIntrinsicsBase);
 
     matching::MatchesPerDescType featureMatches;
-    const bool matchWorked = robustMatching(matchers,
-                                      // pass the input intrinsic if they are valid, null otherwise
-                                      (useInputIntrinsics) ? &queryIntrinsics : nullptr,
-                                      matchedRegions,
-                                      matchedIntrinsics,
-                                      param._fDistRatio,
-                                      param._matchingError,
-                                      param._useRobustMatching,
-                                      param._useGuidedMatching,
-                                      imageSize,
-                                      std::make_pair(matchedView->getWidth(), matchedView->getHeight()),
-                                      featureMatches,
-                                      param._matchingEstimator);
+    const bool matchWorked = matchDatabaseView(queryRegions,
+                                               _matcherCache.isEnabled() ? nullptr : queryMatchers.get(),
+                                               matchedViewId,
+                                               matchedIntrinsics,
+                                               param,
+                                               useInputIntrinsics,
+                                               queryIntrinsics,
+                                               imageSize,
+                                               featureMatches);
     if (!matchWorked)
     {
 //      ALICEVISION_LOG_DEBUG("[matching]\tMatching with " << matchedView->getImagePath() << " failed! Skipping image");
@@ -922,11 +965,11 @@ void VoctreeLocalizer::getAllAssociations(const feature::MapRegionsPerDesc &quer
     }
   }
   
-  if(param._nbFrameBufferMatching > 0)
+  if(useFrameBuffer)
   {
     ALICEVISION_LOG_DEBUG("[matching]\tUsing frameBuffer matching: matching with the past " 
-            << param._nbFrameBufferMatching << " frames" );
-    getAssociationsFromBuffer(matchers, imageSize, param, useInputIntrinsics, queryIntrinsics, out_occurences);
+            << _frameBuffer.size() << " frames" );
+    getAssociationsFromBuffer(*queryMatchers, imageSize, param, useInputIntrinsics, queryIntrinsics, out_occurences);
   }
   
   const std::size_t numCollectedPts = out_occurences.size();
@@ -976,7 +1019,7 @@ void VoctreeLocalizer::getAllAssociations(const feature::MapRegionsPerDesc &quer
   
 }
 
-void VoctreeLocalizer::getAssociationsFromBuffer(matching::RegionsDatabaseMatcherPerDesc & matchers,
+void VoctreeLocalizer::getAssociationsFromBuffer(const matching::RegionsDatabaseMatcherPerDesc & matchers,
                                                  const std::pair<std::size_t, std::size_t> queryImageSize,
                                                  const Parameters &param,
                                                  bool useInputIntrinsics,
@@ -1048,7 +1091,67 @@ void VoctreeLocalizer::getAssociationsFromBuffer(matching::RegionsDatabaseMatche
   }
 }
 
-bool VoctreeLocalizer::robustMatching(matching::RegionsDatabaseMatcherPerDesc & matchers,
+bool VoctreeLocalizer::matchDatabaseView(const feature::MapRegionsPerDesc & queryRegions,
+                                         const matching::RegionsDatabaseMatcherPerDesc * queryMatchers,
+                                         IndexT matchedViewId,
+                                         const camera::IntrinsicBase * matchedIntrinsics,
+                                         const Parameters &param,
+                                         bool useInputIntrinsics,
+                                         const camera::PinholeRadialK3 &queryIntrinsics,
+                                         const std::pair<std::size_t, std::size_t> &queryImageSize,
+                                         matching::MatchesPerDescType & out_featureMatches) const
+{
+  const sfm::View& matchedView = *_sfm_data.views.at(matchedViewId);
+  const feature::MapRegionsPerDesc& matchedRegions = _regionsPerView.getRegionsPerDesc(matchedViewId);
+  const std::pair<std::size_t, std::size_t> matchedImageSize = std::make_pair(matchedView.getWidth(), matchedView.getHeight());
+  // pass the input intrinsic if they are valid, null otherwise
+  const camera::IntrinsicBase* queryIntrinsicsPtr = (useInputIntrinsics) ? &queryIntrinsics : nullptr;
+
+  if(queryMatchers != nullptr)
+  {
+    return robustMatching(*queryMatchers,
+                          queryIntrinsicsPtr,
+                          matchedRegions,
+                          matchedIntrinsics,
+                          param._fDistRatio,
+                          param._matchingError,
+                          param._useRobustMatching,
+                          param._useGuidedMatching,
+                          queryImageSize,
+                          matchedImageSize,
+                          out_featureMatches,
+                          param._matchingEstimator);
+  }
+
+  // the matchers of the database view are built once and reused by the next
+  // queries: the roles of the query and of the database view are swapped
+  const MatcherCache::MatcherPtr matchedMatchers = _matcherCache.get(matchedViewId, matchedRegions, _matcherType);
+
+  const bool matchWorked = robustMatching(*matchedMatchers,
+                                          matchedIntrinsics,
+                                          queryRegions,
+                                          queryIntrinsicsPtr,
+                                          param._fDistRatio,
+                                          param._matchingError,
+                                          param._useRobustMatching,
+                                          param._useGuidedMatching,
+                                          matchedImageSize,
+                                          queryImageSize,
+                                          out_featureMatches,
+                                          param._matchingEstimator);
+  if(!matchWorked)
+    return false;
+
+  // put the matches back in the (query, database view) order
+  for(auto& featureMatchesIt : out_featureMatches)
+  {
+    for(matching::IndMatch& featureMatch : featureMatchesIt.second)
+      std::swap(featureMatch._i, featureMatch._j);
+  }
+  return true;
+}
+
+bool VoctreeLocalizer::robustMatching(const matching::RegionsDatabaseMatcherPerDesc & matchers,
                                       const camera::IntrinsicBase * queryIntrinsicsBase,   // the intrinsics of the image we are using as reference
                                       const feature::MapRegionsPerDesc & matchedRegions,
                                       const camera::IntrinsicBase * matchedIntrinsicsBase,
@@ -1250,41 +1353,74 @@ bool VoctreeLocalizer::localizeRig_opengv(const std::vector<feature::MapRegionsP
     throw std::invalid_argument("The parameters are not in the right format!!");
   }
 
+  aliceVision::system::Timer rigTimer;
+
   std::vector<OccurenceMap> vec_occurrences(numCams);
   std::vector<std::vector<voctree::DocMatch> > vec_matchedImages(numCams);
   std::vector< std::vector<feature::EImageDescriberType> > descTypesPerCamera(numCams);
   std::vector<Mat> vec_pts3D(numCams);
   std::vector<Mat> vec_pts2D(numCams);
+  std::vector<double> vec_matchingTimeMs(numCams, 0.0);
+  // the exceptions cannot leave the parallel loop, they are rethrown after it
+  std::vector<std::exception_ptr> vec_exceptions(numCams);
+  const int nbCameras = static_cast<int>(numCams);
+
+  // for each camera retrieve the associations, all the cameras are matched
+  // concurrently: the matchers of the database views are shared through the
+  // matcher cache (if enabled) and built only once when several cameras need them
+  #pragma omp parallel for schedule(dynamic)
+  for(int camID = 0; camID < nbCameras; ++camID)
+  {
+    try
+    {
+      aliceVision::system::Timer cameraTimer;
+
+      // this map is used to collect the 2d-3d associations as we go through the images
+      // the key is a pair <Id3D, Id2d>
+      // the element is the pair 3D point - 2D point
+      auto &occurrences = vec_occurrences[camID];
+      auto &matchedImages = vec_matchedImages[camID];
+      auto &descTypes = descTypesPerCamera[camID];
+      auto &imageSize = vec_imageSize[camID];
+      Mat &pts3D = vec_pts3D[camID];
+      Mat &pts2D = vec_pts2D[camID];
+      camera::PinholeRadialK3 &queryIntrinsics = vec_queryIntrinsics[camID];
+      const bool useInputIntrinsics = true;
+      getAllAssociations(vec_queryRegions[camID],
+                         imageSize,
+                         *param,
+                         useInputIntrinsics,
+                         queryIntrinsics,
+                         occurrences,
+                         pts2D,
+                         pts3D,
+                         descTypes,
+                         matchedImages);
+      vec_matchingTimeMs[camID] = cameraTimer.elapsedMs();
+    }
+    catch(...)
+    {
+      vec_exceptions[camID] = std::current_exception();
+    }
+  }
+
+  for(const std::exception_ptr& exception : vec_exceptions)
+  {
+    if(exception)
+      std::rethrow_exception(exception);
+  }
 
-  // for each camera retrieve the associations
-  //@todo parallelize?
   size_t numAssociations = 0;
+  double sumMatchingTimeMs = 0.0;
   for(std::size_t camID = 0; camID < numCams; ++camID)
   {
-
-    // this map is used to collect the 2d-3d associations as we go through the images
-    // the key is a pair <Id3D, Id2d>
-    // the element is the pair 3D point - 2D point
-    auto &occurrences = vec_occurrences[camID];
-    auto &matchedImages = vec_matchedImages[camID];
-    auto &descTypes = descTypesPerCamera[camID];
-    auto &imageSize = vec_imageSize[camID];
-    Mat &pts3D = vec_pts3D[camID];
-    Mat &pts2D = vec_pts2D[camID];
-    camera::PinholeRadialK3 &queryIntrinsics = vec_queryIntrinsics[camID];
-    const bool useInputIntrinsics = true;
-    getAllAssociations(vec_queryRegions[camID],
-                       imageSize,
-                       *param,
-                       useInputIntrinsics,
-                       queryIntrinsics,
-                       occurrences,
-                       pts2D,
-                       pts3D,
-                       descTypes,
-                       matchedImages);
-    numAssociations += occurrences.size();
+    ALICEVISION_LOG_DEBUG("[matching]\tCamera " << camID << ": " << vec_occurrences[camID].size()
+            << " associations found in " << vec_matchingTimeMs[camID] << " [ms]");
+    numAssociations += vec_occurrences[camID].size();
+    sumMatchingTimeMs += vec_matchingTimeMs[camID];
   }
+  ALICEVISION_LOG_DEBUG("[matching]\tMatching the " << numCams << " cameras took " << rigTimer.elapsedMs()
+          << " [ms] (" << sumMatchingTimeMs << " [ms] if done sequentially)");
   
   // @todo Here it could be possible to filter the associations according to their
   // occurrences, eg giving priority to those associations that are more frequent
@@ -1310,6 +1446,7 @@ bool VoctreeLocalizer::localizeRig_opengv(const std::vector<feature::MapRegionsP
   }
   
   std::vector<std::vector<std::size_t> > vec_inliers;
+  aliceVision::system::Timer resectionTimer;
   const EstimationStatus resectionEstimation = rigResection(vec_pts2D,
                                         vec_pts3D,
                                         vec_queryIntrinsics,
@@ -1318,6 +1455,7 @@ bool VoctreeLocalizer::localizeRig_opengv(const std::vector<feature::MapRegionsP
                                         rigPose,
                                         vec_inliers,
                                         param->_angularThreshold);
+  ALICEVISION_LOG_DEBUG("[poseEstimation]\tRig resection took " << resectionTimer.elapsedMs() << " [ms]");
 
   if(!resectionEstimation.isValid)
   {
@@ -1390,6 +1528,7 @@ bool VoctreeLocalizer::localizeRig_opengv(const std::vector<feature::MapRegionsP
     // debugging stats
     printRigRMSEStats(vec_pts2D, vec_pts3D, vec_queryIntrinsics, vec_subPoses, rigPose, vec_inliers);
   }
+  ALICEVISION_LOG_DEBUG("[poseEstimation]\tRig localization took " << rigTimer.elapsedMs() << " [ms]");
   
   // create localization results
   for(std::size_t camID = 0; camID < numCams; ++camID)
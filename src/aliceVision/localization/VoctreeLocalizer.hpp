@@ -9,6 +9,7 @@
 #include "LocalizationResult.hpp"
 #include "ILocalizer.hpp"
 #include "BoundedBuffer.hpp"
+#include "MatcherCache.hpp"
 #include <aliceVision/config.hpp>
 #include <aliceVision/feature/ImageDescriber.hpp>
 #include <aliceVision/sfm/SfMData.hpp>
@@ -53,7 +54,8 @@ public:
       _numCommonViews(3),
       _ccTagUseCuda(true),
       _matchingError(std::numeric_limits<double>::infinity()),
-      _nbFrameBufferMatching(10)
+      _nbFrameBufferMatching(10),
+      _matcherCacheSize(0)
     { }
     
     /// Enable/disable guided matching when matching images
@@ -74,6 +76,12 @@ public:
     double _matchingError;
     /// maximum capacity of the frame buffer
     std::size_t _nbFrameBufferMatching;
+    /// maximum number of database views whose matchers are kept in memory
+    /// between queries (0 = disabled, the matcher is built on the query regions).
+    /// With the cache the ratio test is done for each query feature among the
+    /// features of the database view, instead of the opposite: the unambiguous
+    /// matches are the same, the ambiguous ones may differ.
+    std::size_t _matcherCacheSize;
   };
   
 public:
@@ -149,6 +157,14 @@ public:
                 camera::PinholeRadialK3 &queryIntrinsics,
                 LocalizationResult & localizationResult,
                 const std::string& imagePath = std::string()) override;
+
+  std::vector<std::unique_ptr<feature::ImageDescriber>> createImageDescribers() const override;
+
+  void extractRegions(const image::Image<unsigned char> & imageGrey,
+                      const LocalizerParameters *param,
+                      const std::vector<std::unique_ptr<feature::ImageDescriber>> & imageDescribers,
+                      feature::MapRegionsPerDesc &queryRegions,
+                      const std::string& imagePath = std::string()) const override;
   
   
   bool localizeRig(const std::vector<image::Image<unsigned char> > & vec_imageGrey,
@@ -297,7 +313,7 @@ private:
    * @param[in] estimator
    * @return
    */
-  bool robustMatching(matching::RegionsDatabaseMatcherPerDesc & matchers,
+  bool robustMatching(const matching::RegionsDatabaseMatcherPerDesc & matchers,
                       const camera::IntrinsicBase * queryIntrinsics,// the intrinsics of the image we are using as reference
                       const feature::MapRegionsPerDesc & regionsToMatch,
                       const camera::IntrinsicBase * matchedIntrinsics,
@@ -309,8 +325,41 @@ private:
                       const std::pair<size_t,size_t> & imageSizeJ,     // size of the query image
                       matching::MatchesPerDescType & out_featureMatches,
                       robustEstimation::ERobustEstimator estimator = robustEstimation::ERobustEstimator::ACRANSAC) const;
+
+  /**
+   * @brief Robust matching between the query image and a view of the database.
+   * If \p queryMatchers is provided the regions of the view are matched against
+   * it, otherwise the query regions are matched against the matchers of the view
+   * retrieved from (or inserted in) the matcher cache.
+   * The direction of the matching changes which matches pass the distance ratio
+   * test: the ratio is computed among the candidates of the regions that are not
+   * indexed (e.g. among the database view features for each query feature when
+   * the cache is used). Distinctive correspondences are found in both directions,
+   * whereas a feature close to several others may be kept in one direction only.
+   *
+   * @param[in] queryRegions The regions of the query image.
+   * @param[in] queryMatchers The matchers built on the query regions, can be null.
+   * @param[in] matchedViewId The id of the database view to match.
+   * @param[in] matchedIntrinsics The intrinsics of the database view.
+   * @param[in] param The parameters for the localization.
+   * @param[in] useInputIntrinsics Uses the \p queryIntrinsics as known calibration.
+   * @param[in] queryIntrinsics The intrinsics of the query image.
+   * @param[in] queryImageSize The size of the query image.
+   * @param[out] out_featureMatches The matches, _i is the query feature index and
+   * _j the database view feature index.
+   * @return true if the matching succeeded
+   */
+  bool matchDatabaseView(const feature::MapRegionsPerDesc & queryRegions,
+                         const matching::RegionsDatabaseMatcherPerDesc * queryMatchers,
+                         IndexT matchedViewId,
+                         const camera::IntrinsicBase * matchedIntrinsics,
+                         const Parameters &param,
+                         bool useInputIntrinsics,
+                         const camera::PinholeRadialK3 &queryIntrinsics,
+                         const std::pair<std::size_t, std::size_t> &queryImageSize,
+                         matching::MatchesPerDescType & out_featureMatches) const;
   
-  void getAssociationsFromBuffer(matching::RegionsDatabaseMatcherPerDesc& matchers,
+  void getAssociationsFromBuffer(const matching::RegionsDatabaseMatcherPerDesc& matchers,
                                  const std::pair<std::size_t, std::size_t> imageSize,
                                  const Parameters &param,
                                  bool useInputIntrinsics,
@@ -353,6 +402,10 @@ public:
   /// Last frames buffer
   BoundedBuffer<FrameData> _frameBuffer;
 
+  /// the matchers built on the regions of the database views, reused across
+  /// queries (see Parameters::_matcherCacheSize)
+  mutable MatcherCache _matcherCache;
+
   matching::EMatcherType _matcherType = matching::ANN_L2;
 };
 
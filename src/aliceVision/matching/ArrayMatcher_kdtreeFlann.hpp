@@ -11,6 +11,7 @@
 
 #include "flann/flann.hpp"
 
+#include <algorithm>
 #include <memory>
 
 namespace aliceVision {
@@ -29,17 +30,25 @@ class ArrayMatcher_kdtreeFlann : public ArrayMatcher<Scalar, Metric>
   public:
   typedef typename Metric::ResultType DistanceType;
 
-  ArrayMatcher_kdtreeFlann() {}
+  /**
+   * @param[in] nbQueriesPerChunk The queries are searched in parallel by chunks of this size,
+   *            the threads share the same index.
+   */
+  explicit ArrayMatcher_kdtreeFlann(int nbQueriesPerChunk = 256)
+    : _nbQueriesPerChunk(std::max(nbQueriesPerChunk, 1))
+  {}
 
   virtual ~ArrayMatcher_kdtreeFlann()
   {
-    _datasetM.reset();
     _index.reset();
+    _datasetM.reset();
   }
 
   /**
    * Build the matching structure
    *
+   * The copies of a built matcher share its index and can search without building it again.
+   *
    * \param[in] dataset   Input data.
    * \param[in] nbRows    The number of component.
    * \param[in] dimension Length of the data contained in the each
@@ -54,12 +63,10 @@ class ArrayMatcher_kdtreeFlann : public ArrayMatcher<Scalar, Metric>
 
     _dimension = dimension;
     //-- Build Flann Matrix container (map to already allocated memory)
-    _datasetM.reset(
-        new flann::Matrix<Scalar>((Scalar*)dataset, nbRows, dimension));
+    _datasetM = std::make_shared<flann::Matrix<Scalar>>((Scalar*)dataset, nbRows, dimension);
 
     //-- Build FLANN index
-    _index.reset(
-        new flann::Index<Metric> (*_datasetM, flann::KDTreeIndexParams(4)));
+    _index = std::make_shared<flann::Index<Metric>>(*_datasetM, flann::KDTreeIndexParams(4));
     _index->buildIndex();
 
     return true;
@@ -93,6 +100,9 @@ class ArrayMatcher_kdtreeFlann : public ArrayMatcher<Scalar, Metric>
   /**
    * Search the N nearest Neighbor of the scalar array query.
    *
+   * The queries are split in chunks searched in parallel on the same index,
+   * unless the search is already called from a parallel region (e.g. one pair per thread).
+   *
    * \param[in]   query           The query array
    * \param[in]   nbQuery         The number of query rows
    * \param[out]  indices   The corresponding (query, neighbor) indices
@@ -109,23 +119,37 @@ class ArrayMatcher_kdtreeFlann : public ArrayMatcher<Scalar, Metric>
     size_t NN
   )
   {
-    if (_index.get() == nullptr || NN > _datasetM->rows)
+    if (_index.get() == nullptr || NN > _datasetM->rows || nbQuery <= 0)
       return false;
 
     std::vector<DistanceType> vec_distances(nbQuery * NN);
-    DistanceType * distancePTR = &(vec_distances[0]);
-    flann::Matrix<DistanceType> dists(distancePTR, nbQuery, NN);
-
     std::vector<int> vec_indices(nbQuery * NN);
-    int * indicePTR = &(vec_indices[0]);
-    flann::Matrix<int> indices(indicePTR, nbQuery, NN);
 
-    flann::Matrix<Scalar> queries((Scalar*)query, nbQuery, _dimension);
-    // do a knn search, using 128 checks
+    // do a knn search, using 128 checks, one thread per chunk of queries
     flann::SearchParams params(128);
-    params.cores = omp_get_max_threads();
+    params.cores = 1;
+
+    const int nbChunks = (nbQuery + _nbQueriesPerChunk - 1) / _nbQueriesPerChunk;
+    bool isValid = true;
+
+    #pragma omp parallel for schedule(dynamic) if(nbChunks > 1 && !omp_in_parallel())
+    for (int chunk = 0; chunk < nbChunks; ++chunk)
+    {
+      const int firstQuery = chunk * _nbQueriesPerChunk;
+      const int nbChunkQueries = std::min(_nbQueriesPerChunk, nbQuery - firstQuery);
+
+      flann::Matrix<Scalar> queries((Scalar*)query + firstQuery * _dimension, nbChunkQueries, _dimension);
+      flann::Matrix<int> indices(&vec_indices[firstQuery * NN], nbChunkQueries, NN);
+      flann::Matrix<DistanceType> dists(&vec_distances[firstQuery * NN], nbChunkQueries, NN);
+
+      if (_index->knnSearch(queries, indices, dists, NN, params) <= 0)
+      {
+        #pragma omp critical
+        isValid = false;
+      }
+    }
 
-    if (_index->knnSearch(queries, indices, dists, NN, params) <= 0)
+    if (!isValid)
       return false;
 
     // Save the resulting found indices
@@ -135,11 +159,8 @@ class ArrayMatcher_kdtreeFlann : public ArrayMatcher<Scalar, Metric>
     {
       for (size_t j = 0; j < NN; ++j)
       {
-        if (indices[i] > 0)
-        {
-          pvec_indices->emplace_back(IndMatch(i, vec_indices[i*NN+j]));
-          pvec_distances->emplace_back(vec_distances[i*NN+j]);
-        }
+        pvec_indices->emplace_back(IndMatch(i, vec_indices[i*NN+j]));
+        pvec_distances->emplace_back(vec_distances[i*NN+j]);
       }
     }
     return true;
@@ -147,9 +168,10 @@ class ArrayMatcher_kdtreeFlann : public ArrayMatcher<Scalar, Metric>
 
   private:
 
-  std::unique_ptr< flann::Matrix<Scalar> > _datasetM;
-  std::unique_ptr< flann::Index<Metric> > _index;
+  std::shared_ptr< flann::Matrix<Scalar> > _datasetM;
+  std::shared_ptr< flann::Index<Metric> > _index;
   std::size_t _dimension;
+  int _nbQueriesPerChunk;
 };
 
 } // namespace matching
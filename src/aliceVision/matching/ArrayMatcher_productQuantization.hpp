@@ -0,0 +1,212 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include "aliceVision/matching/ArrayMatcher.hpp"
+#include "aliceVision/matching/ProductQuantizer.hpp"
+#include "aliceVision/matching/metric.hpp"
+
+#include <algorithm>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace aliceVision {
+namespace matching {
+
+/**
+ * @brief Matcher of product quantized descriptors.
+ *
+ * The dataset descriptors are encoded with a ProductQuantizer and scanned with
+ * the asymmetric distance (full query, encoded dataset), which reads codeSize()
+ * bytes per descriptor instead of the full descriptors.
+ * The best candidates of the asymmetric distance are then re-ranked with the
+ * exact distance, so the returned distances are exact (squared L2).
+ *
+ * The quantizer and the codes can be shared between matchers (e.g. one quantizer
+ * trained on a whole image collection), otherwise a quantizer is trained on the dataset.
+ */
+template < typename Scalar = float, typename Metric = L2_Vectorized<Scalar> >
+class ArrayMatcher_productQuantization : public ArrayMatcher<Scalar, Metric>
+{
+  public:
+  typedef typename Metric::ResultType DistanceType;
+
+  /**
+   * @param[in] quantizer The trained quantizer, nullptr to train it on the dataset.
+   * @param[in] codes The codes of the dataset, nullptr to encode the dataset.
+   * @param[in] nbRerankedCandidates The number of asymmetric distance candidates re-ranked with the exact distance.
+   */
+  explicit ArrayMatcher_productQuantization(std::shared_ptr<const ProductQuantizer> quantizer = nullptr,
+                                            std::shared_ptr<const std::vector<std::uint8_t>> codes = nullptr,
+                                            std::size_t nbRerankedCandidates = 8)
+    : _quantizer(quantizer)
+    , _codes(codes)
+    , _nbRerankedCandidates(nbRerankedCandidates)
+  {}
+
+  virtual ~ArrayMatcher_productQuantization() {}
+
+  /**
+   * Build the matching structure
+   *
+   * \param[in] dataset   Input data.
+   * \param[in] nbRows    The number of component.
+   * \param[in] dimension Length of the data contained in the dataset.
+   *
+   * \return True if success.
+   */
+  bool Build(const Scalar * dataset, int nbRows, int dimension)
+  {
+    if (nbRows < 1)
+    {
+      _dataset = nullptr;
+      return false;
+    }
+
+    if (!_quantizer || _quantizer->dimension() != static_cast<std::size_t>(dimension))
+    {
+      std::shared_ptr<ProductQuantizer> quantizer = std::make_shared<ProductQuantizer>();
+      // a per-dataset codebook is trained on a small sample to keep the build time low
+      quantizer->train(dataset, nbRows, dimension, ProductQuantizer::defaultNbSubspaces(dimension), 256, 8, 4096);
+      _quantizer = quantizer;
+      _codes.reset();
+    }
+
+    if (!_codes || _codes->size() != nbRows * _quantizer->codeSize())
+    {
+      std::shared_ptr<std::vector<std::uint8_t>> codes = std::make_shared<std::vector<std::uint8_t>>();
+      _quantizer->encode(dataset, nbRows, *codes);
+      _codes = codes;
+    }
+
+    _dataset = dataset;
+    _nbRows = nbRows;
+    _dimension = dimension;
+    return true;
+  }
+
+  /**
+   * Search the nearest Neighbor of the scalar array query.
+   *
+   * \param[in]   query     The query array
+   * \param[out]  indice    The indice of array in the dataset that
+   *  have been computed as the nearest array.
+   * \param[out]  distance  The distance between the two arrays.
+   *
+   * \return True if success.
+   */
+  bool SearchNeighbour( const Scalar * query,
+                        int * indice, DistanceType * distance)
+  {
+    IndMatches indices;
+    std::vector<DistanceType> distances;
+    if (!SearchNeighbours(query, 1, &indices, &distances, 1))
+      return false;
+    *indice = indices.front()._j;
+    *distance = distances.front();
+    return true;
+  }
+
+  /**
+   * Search the N nearest Neighbor of the scalar array query.
+   *
+   * \param[in]   query     The query array
+   * \param[in]   nbQuery   The number of query rows
+   * \param[out]  indices   The corresponding (query, neighbor) indices
+   * \param[out]  distances The distances between the matched arrays.
+   * \param[out]  NN        The number of maximal neighbor that will be searched.
+   *
+   * \return True if success.
+   */
+  bool SearchNeighbours
+  (
+    const Scalar * query, int nbQuery,
+    IndMatches * pvec_indices,
+    std::vector<DistanceType> * pvec_distances,
+    size_t NN
+  )
+  {
+    if (_dataset == nullptr)
+      return false;
+
+    if (NN > static_cast<std::size_t>(_nbRows) || nbQuery < 1)
+      return false;
+
+    const std::size_t nbCandidates = std::min(std::max(NN, _nbRerankedCandidates), static_cast<std::size_t>(_nbRows));
+    const std::size_t codeSize = _quantizer->codeSize();
+    Metric metric;
+
+    pvec_distances->resize(nbQuery * NN);
+    pvec_indices->resize(nbQuery * NN);
+
+    #pragma omp parallel
+    {
+      std::vector<float> table;
+      // max-heap of the best asymmetric distances
+      std::vector<std::pair<float, int>> candidates;
+      std::vector<std::pair<DistanceType, int>> reranked;
+      candidates.reserve(nbCandidates + 1);
+      reranked.reserve(nbCandidates);
+
+      #pragma omp for schedule(dynamic)
+      for (int queryIndex = 0; queryIndex < nbQuery; ++queryIndex)
+      {
+        const Scalar * queryPtr = query + queryIndex * _dimension;
+        _quantizer->computeDistanceTable(queryPtr, table);
+
+        candidates.clear();
+        const std::uint8_t * code = _codes->data();
+        for (int i = 0; i < _nbRows; ++i, code += codeSize)
+        {
+          const float distance = _quantizer->asymmetricDistance(table.data(), code);
+          if (candidates.size() < nbCandidates)
+          {
+            candidates.emplace_back(distance, i);
+            std::push_heap(candidates.begin(), candidates.end());
+          }
+          else if (distance < candidates.front().first)
+          {
+            std::pop_heap(candidates.begin(), candidates.end());
+            candidates.back() = std::make_pair(distance, i);
+            std::push_heap(candidates.begin(), candidates.end());
+          }
+        }
+
+        // exact re-ranking of the candidates
+        reranked.clear();
+        for (const auto& candidate : candidates)
+          reranked.emplace_back(metric(queryPtr, _dataset + candidate.second * _dimension, _dimension), candidate.second);
+        std::partial_sort(reranked.begin(), reranked.begin() + NN, reranked.end());
+
+        for (std::size_t i = 0; i < NN; ++i)
+        {
+          (*pvec_distances)[queryIndex*NN+i] = reranked[i].first;
+          (*pvec_indices)[queryIndex*NN+i] = IndMatch(queryIndex, reranked[i].second);
+        }
+      }
+    }
+    return true;
+  }
+
+  /// Get the quantizer, to share it with other matchers
+  std::shared_ptr<const ProductQuantizer> getQuantizer() const { return _quantizer; }
+
+  /// Get the codes of the dataset
+  std::shared_ptr<const std::vector<std::uint8_t>> getCodes() const { return _codes; }
+
+private:
+  std::shared_ptr<const ProductQuantizer> _quantizer;
+  std::shared_ptr<const std::vector<std::uint8_t>> _codes;
+  std::size_t _nbRerankedCandidates;
+  /// Full descriptors of the dataset, only read for the re-ranking
+  const Scalar * _dataset = nullptr;
+  int _nbRows = 0;
+  int _dimension = 0;
+};
+
+}  // namespace matching
+}  // namespace aliceVision
@@ -0,0 +1,145 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "PackedPairwiseMatches.hpp"
+
+namespace aliceVision {
+namespace matching {
+
+void PackedPairwiseMatches::clear()
+{
+  _matches.clear();
+  _entries.clear();
+  _pairFirstEntry.clear();
+  _isSorted = true;
+}
+
+void PackedPairwiseMatches::append(const PackedPairwiseMatches& other)
+{
+  const std::size_t offset = _matches.size();
+  _matches.insert(_matches.end(), other._matches.begin(), other._matches.end());
+  _entries.reserve(_entries.size() + other._entries.size());
+  for(const Entry& otherEntry: other._entries)
+  {
+    const Entry entry = {otherEntry.pair, otherEntry.descType, offset + otherEntry.begin, offset + otherEntry.end};
+    _isSorted = _isSorted && (_entries.empty() || isBefore(_entries.back(), entry));
+    _entries.push_back(entry);
+  }
+}
+
+void PackedPairwiseMatches::finalize()
+{
+  if(!_isSorted)
+  {
+    // the stable sort keeps the duplicated entries in their adding order
+    std::stable_sort(_entries.begin(), _entries.end(), isBefore);
+
+    std::vector<Entry> entries;
+    entries.reserve(_entries.size());
+    std::size_t nbMatches = 0;
+    for(std::size_t i = 0; i < _entries.size(); ++i)
+    {
+      if(i + 1 < _entries.size() && !isBefore(_entries[i], _entries[i + 1]))
+        continue; // duplicated entry, the last one is kept
+      entries.push_back(_entries[i]);
+      nbMatches += _entries[i].end - _entries[i].begin;
+    }
+
+    // reorder the matches like the entries
+    std::vector<IndMatch> matches;
+    matches.reserve(nbMatches);
+    for(Entry& entry: entries)
+    {
+      const std::size_t begin = matches.size();
+      matches.insert(matches.end(), _matches.begin() + entry.begin, _matches.begin() + entry.end);
+      entry.begin = begin;
+      entry.end = matches.size();
+    }
+    _matches.swap(matches);
+    _entries.swap(entries);
+    _isSorted = true;
+  }
+  indexPairs();
+}
+
+void PackedPairwiseMatches::indexPairs()
+{
+  _pairFirstEntry.clear();
+  for(std::size_t i = 0; i < _entries.size(); ++i)
+  {
+    if(i == 0 || _entries[i].pair != _entries[i - 1].pair)
+      _pairFirstEntry.push_back(i);
+  }
+  _pairFirstEntry.push_back(_entries.size());
+}
+
+void PackedPairwiseMatches::filter(const std::set<IndexT>& viewsKeys, const std::vector<feature::EImageDescriberType>& descTypes)
+{
+  if(viewsKeys.empty() && descTypes.empty())
+    return;
+
+  // compact the kept entries and their matches in place, in the same order
+  std::size_t nbEntries = 0;
+  std::size_t nbMatches = 0;
+  for(const Entry& entry: _entries)
+  {
+    if(!viewsKeys.empty() && (viewsKeys.count(entry.pair.first) == 0 || viewsKeys.count(entry.pair.second) == 0))
+      continue;
+    if(!descTypes.empty() && std::find(descTypes.begin(), descTypes.end(), entry.descType) == descTypes.end())
+      continue;
+    const std::size_t begin = nbMatches;
+    nbMatches = std::copy(_matches.begin() + entry.begin, _matches.begin() + entry.end, _matches.begin() + begin) - _matches.begin();
+    _entries[nbEntries++] = {entry.pair, entry.descType, begin, nbMatches};
+  }
+  _entries.resize(nbEntries);
+  _matches.resize(nbMatches);
+  indexPairs();
+}
+
+void PackedPairwiseMatches::assign(const PairwiseMatches& matches)
+{
+  clear();
+  std::size_t nbEntries = 0;
+  std::size_t nbMatches = 0;
+  for(const auto& matchesPerDesc: matches)
+  {
+    nbEntries += matchesPerDesc.second.size();
+    nbMatches += matchesPerDesc.second.getNbAllMatches();
+  }
+  reserve(nbEntries, nbMatches);
+
+  for(const auto& matchesPerDesc: matches)
+  {
+    for(const auto& matchesIt: matchesPerDesc.second)
+      append(matchesPerDesc.first, matchesIt.first, matchesIt.second.begin(), matchesIt.second.end());
+  }
+  finalize();
+}
+
+void PackedPairwiseMatches::toPairwiseMatches(PairwiseMatches& matches) const
+{
+  matches.clear();
+  for(std::size_t i = 0; i < size(); ++i)
+  {
+    const Pair& pair = _entries[_pairFirstEntry[i]].pair;
+    MatchesPerDescType& matchesPerDesc = matches.emplace_hint(matches.end(), pair, MatchesPerDescType())->second;
+    for(std::size_t entry = _pairFirstEntry[i]; entry < _pairFirstEntry[i + 1]; ++entry)
+    {
+      const Entry& e = _entries[entry];
+      matchesPerDesc.emplace_hint(matchesPerDesc.end(), e.descType, IndMatches(_matches.begin() + e.begin, _matches.begin() + e.end));
+    }
+  }
+}
+
+PairSet PackedPairwiseMatches::getImagePairs() const
+{
+  PairSet pairs;
+  for(std::size_t i = 0; i < size(); ++i)
+    pairs.insert(pairs.end(), _entries[_pairFirstEntry[i]].pair);
+  return pairs;
+}
+
+}  // namespace matching
+}  // namespace aliceVision
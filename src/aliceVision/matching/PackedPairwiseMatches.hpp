@@ -0,0 +1,441 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/types.hpp>
+#include <aliceVision/feature/imageDescriberCommon.hpp>
+#include <aliceVision/matching/IndMatch.hpp>
+
+#include <cereal/cereal.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace aliceVision {
+namespace matching {
+
+/**
+ * @brief Pairwise matches stored in one contiguous buffer.
+ *
+ * The matches of all the pairs and describer types are packed in one IndMatch
+ * buffer and each (pair, describer type) entry references a range of this buffer.
+ * The entries are sorted by pair and describer type and the entries of each pair
+ * are indexed, so the pairs can be accessed by index or found by binary search.
+ * It avoids the allocations of PairwiseMatches (one per pair, per describer type
+ * and per matches vector) for the loading, filtering and track building of
+ * large image collections.
+ *
+ * The pairs can be iterated like PairwiseMatches: the iterators give a pair of
+ * the image pair and a MatchesPerDescTypeRef, iterated as pairs of describer type
+ * and IndMatchesRef, so read-only code can be written once for both storages.
+ *
+ * The binary serialization has the same layout as the one of PairwiseMatches,
+ * so the match files can be read and written by both containers.
+ */
+class PackedPairwiseMatches
+{
+public:
+  /**
+   * @brief Holds a value built on dereference, for the operator-> of the iterators.
+   */
+  template <typename T>
+  struct ArrowProxy
+  {
+    explicit ArrowProxy(const T& value)
+      : _value(value)
+    {}
+
+    const T* operator->() const { return &_value; }
+
+  private:
+    T _value;
+  };
+
+  /// Range of the matches of a pair for one describer type
+  struct Entry
+  {
+    Pair pair;
+    feature::EImageDescriberType descType;
+    std::size_t begin;
+    std::size_t end;
+  };
+
+  /**
+   * @brief Read-only range of packed matches, with the read members of IndMatches.
+   */
+  class IndMatchesRef
+  {
+  public:
+    typedef const IndMatch* const_iterator;
+
+    IndMatchesRef(const IndMatch* begin, const IndMatch* end)
+      : _begin(begin)
+      , _end(end)
+    {}
+
+    const_iterator begin() const { return _begin; }
+    const_iterator end() const { return _end; }
+    std::size_t size() const { return _end - _begin; }
+    bool empty() const { return _end == _begin; }
+    const IndMatch& operator[](std::size_t i) const { return _begin[i]; }
+    const IndMatch* data() const { return _begin; }
+
+  private:
+    const IndMatch* _begin;
+    const IndMatch* _end;
+  };
+
+  /**
+   * @brief Read-only matches of a pair, iterated as MatchesPerDescType: pairs of describer type and matches.
+   */
+  class MatchesPerDescTypeRef
+  {
+  public:
+    /**
+     * @brief Input iterator: the pairs are built on dereference and returned by value.
+     */
+    class const_iterator
+    {
+    public:
+      using iterator_category = std::input_iterator_tag;
+      using value_type = std::pair<feature::EImageDescriberType, IndMatchesRef>;
+      using difference_type = std::ptrdiff_t;
+      using reference = value_type;
+      using pointer = ArrowProxy<value_type>;
+
+      const_iterator(const PackedPairwiseMatches& matches, std::size_t entry)
+        : _matches(&matches)
+        , _entry(entry)
+      {}
+
+      reference operator*() const
+      {
+        return value_type(_matches->_entries[_entry].descType, _matches->matchesOfEntry(_entry));
+      }
+      pointer operator->() const { return pointer(**this); }
+      const_iterator& operator++() { ++_entry; return *this; }
+      const_iterator operator++(int) { const_iterator it = *this; ++_entry; return it; }
+      bool operator==(const const_iterator& other) const { return _entry == other._entry; }
+      bool operator!=(const const_iterator& other) const { return _entry != other._entry; }
+
+    private:
+      const PackedPairwiseMatches* _matches;
+      std::size_t _entry;
+    };
+
+    MatchesPerDescTypeRef(const PackedPairwiseMatches& matches, std::size_t firstEntry, std::size_t lastEntry)
+      : _matches(matches)
+      , _firstEntry(firstEntry)
+      , _lastEntry(lastEntry)
+    {}
+
+    const_iterator begin() const { return const_iterator(_matches, _firstEntry); }
+    const_iterator end() const { return const_iterator(_matches, _lastEntry); }
+    /// Number of describer types
+    std::size_t size() const { return _lastEntry - _firstEntry; }
+    bool empty() const { return _lastEntry == _firstEntry; }
+
+    const_iterator find(feature::EImageDescriberType descType) const
+    {
+      for(std::size_t entry = _firstEntry; entry < _lastEntry; ++entry)
+      {
+        if(_matches._entries[entry].descType == descType)
+          return const_iterator(_matches, entry);
+      }
+      return end();
+    }
+
+    std::size_t count(feature::EImageDescriberType descType) const { return find(descType) != end() ? 1 : 0; }
+
+    /// Matches of a describer type, empty if there is no matches of this type
+    IndMatchesRef at(feature::EImageDescriberType descType) const
+    {
+      const const_iterator it = find(descType);
+      if(it == end())
+        return IndMatchesRef(nullptr, nullptr);
+      return (*it).second;
+    }
+
+    int getNbMatches(feature::EImageDescriberType descType) const { return at(descType).size(); }
+
+    int getNbAllMatches() const
+    {
+      return _matches._entries[_lastEntry - 1].end - _matches._entries[_firstEntry].begin;
+    }
+
+  private:
+    const PackedPairwiseMatches& _matches;
+    std::size_t _firstEntry;
+    std::size_t _lastEntry;
+  };
+
+  /**
+   * @brief Iterator on the pairs, ordered by pair, giving pairs of image pair and MatchesPerDescTypeRef.
+   * Input iterator: the pairs are built on dereference and returned by value.
+   */
+  class const_iterator
+  {
+  public:
+    using iterator_category = std::input_iterator_tag;
+    using value_type = std::pair<Pair, MatchesPerDescTypeRef>;
+    using difference_type = std::ptrdiff_t;
+    using reference = value_type;
+    using pointer = ArrowProxy<value_type>;
+
+    const_iterator(const PackedPairwiseMatches& matches, std::size_t index)
+      : _matches(&matches)
+      , _index(index)
+    {}
+
+    reference operator*() const { return _matches->pairAt(_index); }
+    pointer operator->() const { return pointer(**this); }
+    const_iterator& operator++() { ++_index; return *this; }
+    const_iterator operator++(int) { const_iterator it = *this; ++_index; return it; }
+    bool operator==(const const_iterator& other) const { return _index == other._index; }
+    bool operator!=(const const_iterator& other) const { return _index != other._index; }
+
+    /// Index of the pair
+    std::size_t index() const { return _index; }
+
+  private:
+    const PackedPairwiseMatches* _matches;
+    std::size_t _index;
+  };
+
+  PackedPairwiseMatches() = default;
+
+  /**
+   * @brief Pack pairwise matches.
+   * @param[in] matches The pairwise matches.
+   */
+  explicit PackedPairwiseMatches(const PairwiseMatches& matches)
+  {
+    assign(matches);
+  }
+
+  const_iterator begin() const { return const_iterator(*this, 0); }
+  const_iterator end() const { return const_iterator(*this, size()); }
+
+  /// Number of pairs
+  std::size_t size() const { return _pairFirstEntry.empty() ? 0 : _pairFirstEntry.size() - 1; }
+  bool empty() const { return size() == 0; }
+
+  /// Number of matches of all the pairs and describer types
+  std::size_t nbMatches() const { return _matches.size(); }
+
+  /// Number of (pair, describer type) entries
+  std::size_t nbEntries() const { return _entries.size(); }
+
+  /// Pair and matches of the pair of index i, in [0, size())
+  std::pair<Pair, MatchesPerDescTypeRef> pairAt(std::size_t i) const
+  {
+    const std::size_t firstEntry = _pairFirstEntry[i];
+    return std::make_pair(_entries[firstEntry].pair, MatchesPerDescTypeRef(*this, firstEntry, _pairFirstEntry[i + 1]));
+  }
+
+  const_iterator find(const Pair& pair) const
+  {
+    if(empty())
+      return end();
+    const auto it = std::lower_bound(_pairFirstEntry.begin(), _pairFirstEntry.end() - 1, pair,
+                                     [this](std::size_t entry, const Pair& p) { return _entries[entry].pair < p; });
+    if(it == _pairFirstEntry.end() - 1 || _entries[*it].pair != pair)
+      return end();
+    return const_iterator(*this, it - _pairFirstEntry.begin());
+  }
+
+  std::size_t count(const Pair& pair) const { return find(pair) != end() ? 1 : 0; }
+
+  /// Pair and matches of a pair
+  std::pair<Pair, MatchesPerDescTypeRef> at(const Pair& pair) const
+  {
+    const const_iterator it = find(pair);
+    if(it == end())
+      throw std::out_of_range("No matches for the image pair (" + std::to_string(pair.first) + ", " + std::to_string(pair.second) + ").");
+    return pairAt(it.index());
+  }
+
+  void clear();
+
+  void swap(PackedPairwiseMatches& other)
+  {
+    _matches.swap(other._matches);
+    _entries.swap(other._entries);
+    _pairFirstEntry.swap(other._pairFirstEntry);
+    std::swap(_isSorted, other._isSorted);
+  }
+
+  /**
+   * @brief Reserve the buffers.
+   * @param[in] nbEntries The number of (pair, describer type) entries.
+   * @param[in] nbMatches The number of matches.
+   */
+  void reserve(std::size_t nbEntries, std::size_t nbMatches)
+  {
+    _entries.reserve(nbEntries);
+    _matches.reserve(nbMatches);
+  }
+
+  /**
+   * @brief Add uninitialized matches of a pair for a describer type.
+   * The added matches are only accessible with the returned pointer and after finalize().
+   * @param[in] pair The image pair.
+   * @param[in] descType The describer type.
+   * @param[in] nbMatches The number of matches.
+   * @return the buffer of the matches to fill, valid until the next addition
+   */
+  IndMatch* allocate(const Pair& pair, feature::EImageDescriberType descType, std::size_t nbMatches)
+  {
+    const std::size_t begin = _matches.size();
+    _matches.resize(begin + nbMatches);
+    addEntry(pair, descType, begin);
+    return _matches.data() + begin;
+  }
+
+  /**
+   * @brief Add matches of a pair for a describer type, accessible after finalize().
+   * If the (pair, describer type) entry already exists, the last added matches are kept by finalize().
+   */
+  template <typename IteratorT>
+  void append(const Pair& pair, feature::EImageDescriberType descType, IteratorT begin, IteratorT end)
+  {
+    const std::size_t first = _matches.size();
+    _matches.insert(_matches.end(), begin, end);
+    addEntry(pair, descType, first);
+  }
+
+  /**
+   * @brief Add all the matches of another container, accessible after finalize().
+   */
+  void append(const PackedPairwiseMatches& other);
+
+  /**
+   * @brief Sort the entries by pair and describer type and index the pairs.
+   * The duplicated entries are removed (the last added is kept) and the matches are
+   * reordered like the entries, so the matches of a pair are contiguous.
+   * It must be called after the additions, before the accesses.
+   */
+  void finalize();
+
+  /**
+   * @brief Keep only the pairs of some views and some describer types.
+   * @param[in] viewsKeys The views to keep, all the views if empty.
+   * @param[in] descTypes The describer types to keep, all the types if empty.
+   */
+  void filter(const std::set<IndexT>& viewsKeys, const std::vector<feature::EImageDescriberType>& descTypes);
+
+  /**
+   * @brief Replace the matches by pairwise matches.
+   * @param[in] matches The pairwise matches.
+   */
+  void assign(const PairwiseMatches& matches);
+
+  /**
+   * @brief Export the matches in pairwise matches.
+   * @param[out] matches The pairwise matches.
+   */
+  void toPairwiseMatches(PairwiseMatches& matches) const;
+
+  /// Image pairs
+  PairSet getImagePairs() const;
+
+  /**
+   * @brief Save the pairs [firstPair, lastPair) with the layout of PairwiseMatches.
+   */
+  template <class Archive>
+  void savePairs(Archive& ar, std::size_t firstPair, std::size_t lastPair) const
+  {
+    cereal::size_type nbPairs = lastPair - firstPair;
+    ar(cereal::make_size_tag(nbPairs));
+    for(std::size_t i = firstPair; i < lastPair; ++i)
+    {
+      const Pair& pair = _entries[_pairFirstEntry[i]].pair;
+      ar(pair.first, pair.second);
+      cereal::size_type nbDescTypes = _pairFirstEntry[i + 1] - _pairFirstEntry[i];
+      ar(cereal::make_size_tag(nbDescTypes));
+      for(std::size_t entry = _pairFirstEntry[i]; entry < _pairFirstEntry[i + 1]; ++entry)
+      {
+        ar(_entries[entry].descType);
+        cereal::size_type nbEntryMatches = _entries[entry].end - _entries[entry].begin;
+        ar(cereal::make_size_tag(nbEntryMatches));
+        for(std::size_t m = _entries[entry].begin; m < _entries[entry].end; ++m)
+          ar(_matches[m]);
+      }
+    }
+  }
+
+  template <class Archive>
+  void save(Archive& ar) const
+  {
+    savePairs(ar, 0, size());
+  }
+
+  template <class Archive>
+  void load(Archive& ar)
+  {
+    clear();
+    cereal::size_type nbPairs = 0;
+    ar(cereal::make_size_tag(nbPairs));
+    for(std::size_t i = 0; i < nbPairs; ++i)
+    {
+      Pair pair;
+      ar(pair.first, pair.second);
+      cereal::size_type nbDescTypes = 0;
+      ar(cereal::make_size_tag(nbDescTypes));
+      for(std::size_t d = 0; d < nbDescTypes; ++d)
+      {
+        feature::EImageDescriberType descType;
+        ar(descType);
+        cereal::size_type nbEntryMatches = 0;
+        ar(cereal::make_size_tag(nbEntryMatches));
+        IndMatch* matches = allocate(pair, descType, nbEntryMatches);
+        for(std::size_t m = 0; m < nbEntryMatches; ++m)
+          ar(matches[m]);
+      }
+    }
+    finalize();
+  }
+
+private:
+  void addEntry(const Pair& pair, feature::EImageDescriberType descType, std::size_t begin)
+  {
+    const Entry entry = {pair, descType, begin, _matches.size()};
+    _isSorted = _isSorted && (_entries.empty() || isBefore(_entries.back(), entry));
+    _entries.push_back(entry);
+  }
+
+  static bool isBefore(const Entry& a, const Entry& b)
+  {
+    return a.pair < b.pair || (a.pair == b.pair && a.descType < b.descType);
+  }
+
+  IndMatchesRef matchesOfEntry(std::size_t entry) const
+  {
+    const IndMatch* data = _matches.data();
+    return IndMatchesRef(data + _entries[entry].begin, data + _entries[entry].end);
+  }
+
+  /// Build the index of the first entry of each pair
+  void indexPairs();
+
+  /// All the matches, the matches of an entry are contiguous
+  std::vector<IndMatch> _matches;
+  /// (pair, describer type) entries, sorted after finalize()
+  std::vector<Entry> _entries;
+  /// nbPairs + 1 indexes in the entries
+  std::vector<std::size_t> _pairFirstEntry;
+  /// the entries have been added in order without duplicates
+  bool _isSorted = true;
+};
+
+}  // namespace matching
+}  // namespace aliceVision
@@ -0,0 +1,172 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "ProductQuantizer.hpp"
+
+#include <aliceVision/system/Logger.hpp>
+
+#include <fstream>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+
+namespace aliceVision {
+namespace matching {
+
+namespace {
+
+const char productQuantizerMagic[4] = {'A', 'V', 'P', 'Q'};
+const std::uint32_t productQuantizerVersion = 1;
+
+} // namespace
+
+std::size_t ProductQuantizer::defaultNbSubspaces(std::size_t dimension)
+{
+  for(std::size_t nbSubspaces = dimension / 8; nbSubspaces > 1; --nbSubspaces)
+  {
+    if(dimension % nbSubspaces == 0)
+      return nbSubspaces;
+  }
+  return 1;
+}
+
+void ProductQuantizer::trainFloat(const std::vector<float>& data, std::size_t nbRows, std::size_t dimension, std::size_t nbSubspaces,
+                                  std::size_t nbCentroids, std::size_t nbIterations)
+{
+  if(nbRows == 0 || dimension == 0)
+    throw std::invalid_argument("Cannot train a product quantizer without data.");
+  if(nbSubspaces == 0 || dimension % nbSubspaces != 0)
+    throw std::invalid_argument("The number of subspaces (" + std::to_string(nbSubspaces) + ") must divide the descriptor dimension (" + std::to_string(dimension) + ").");
+  if(nbCentroids == 0 || nbCentroids > 256)
+    throw std::invalid_argument("The number of centroids per subspace must be in [1, 256].");
+
+  _dimension = dimension;
+  _nbSubspaces = nbSubspaces;
+  _subspaceDimension = dimension / nbSubspaces;
+  _nbCentroids = std::min(nbCentroids, nbRows);
+  _centroids.assign(_nbSubspaces * _nbCentroids * _subspaceDimension, 0.f);
+
+  // each subspace is an independent k-means
+  #pragma omp parallel for schedule(dynamic)
+  for(int m = 0; m < static_cast<int>(_nbSubspaces); ++m)
+  {
+    float* centroids = &_centroids[m * _nbCentroids * _subspaceDimension];
+    const std::size_t offset = m * _subspaceDimension;
+
+    // initialize the centroids with distinct random rows
+    std::vector<std::size_t> rows(nbRows);
+    std::iota(rows.begin(), rows.end(), 0);
+    std::mt19937 generator(m);
+    std::shuffle(rows.begin(), rows.end(), generator);
+    for(std::size_t k = 0; k < _nbCentroids; ++k)
+      std::copy_n(&data[rows[k] * dimension + offset], _subspaceDimension, &centroids[k * _subspaceDimension]);
+
+    std::vector<std::size_t> assignments(nbRows, 0);
+    std::vector<std::size_t> counts(_nbCentroids);
+    std::vector<double> sums(_nbCentroids * _subspaceDimension);
+
+    for(std::size_t iteration = 0; iteration < nbIterations; ++iteration)
+    {
+      std::size_t nbChanges = 0;
+      for(std::size_t i = 0; i < nbRows; ++i)
+      {
+        const float* subvector = &data[i * dimension + offset];
+        float bestDistance = std::numeric_limits<float>::max();
+        std::size_t bestCentroid = 0;
+        for(std::size_t k = 0; k < _nbCentroids; ++k)
+        {
+          const float distance = squaredDistance(subvector, &centroids[k * _subspaceDimension]);
+          if(distance < bestDistance)
+          {
+            bestDistance = distance;
+            bestCentroid = k;
+          }
+        }
+        if(iteration == 0 || assignments[i] != bestCentroid)
+          ++nbChanges;
+        assignments[i] = bestCentroid;
+      }
+
+      if(nbChanges == 0)
+        break;
+
+      std::fill(counts.begin(), counts.end(), 0);
+      std::fill(sums.begin(), sums.end(), 0.0);
+      for(std::size_t i = 0; i < nbRows; ++i)
+      {
+        const float* subvector = &data[i * dimension + offset];
+        double* sum = &sums[assignments[i] * _subspaceDimension];
+        for(std::size_t d = 0; d < _subspaceDimension; ++d)
+          sum[d] += subvector[d];
+        ++counts[assignments[i]];
+      }
+      // an empty cluster keeps its previous centroid
+      for(std::size_t k = 0; k < _nbCentroids; ++k)
+      {
+        if(counts[k] == 0)
+          continue;
+        for(std::size_t d = 0; d < _subspaceDimension; ++d)
+          centroids[k * _subspaceDimension + d] = static_cast<float>(sums[k * _subspaceDimension + d] / counts[k]);
+      }
+    }
+  }
+
+  ALICEVISION_LOG_DEBUG("Product quantizer trained on " << nbRows << " descriptors: " << _nbSubspaces << " subspaces of "
+                        << _nbCentroids << " centroids (" << _dimension << " dimensions).");
+}
+
+void ProductQuantizer::save(const std::string& filepath) const
+{
+  std::ofstream out(filepath.c_str(), std::ios_base::binary);
+  if(!out.is_open())
+    throw std::runtime_error("Failed to write product quantizer file " + filepath);
+
+  const std::uint32_t header[4] = {productQuantizerVersion,
+                                   static_cast<std::uint32_t>(_dimension),
+                                   static_cast<std::uint32_t>(_nbSubspaces),
+                                   static_cast<std::uint32_t>(_nbCentroids)};
+  out.write(productQuantizerMagic, sizeof(productQuantizerMagic));
+  out.write(reinterpret_cast<const char*>(header), sizeof(header));
+  out.write(reinterpret_cast<const char*>(_centroids.data()), _centroids.size() * sizeof(float));
+
+  if(!out.good())
+    throw std::runtime_error("Failed to write product quantizer file " + filepath);
+}
+
+void ProductQuantizer::load(const std::string& filepath)
+{
+  std::ifstream in(filepath.c_str(), std::ios_base::binary);
+  if(!in.is_open())
+    throw std::runtime_error("Failed to load product quantizer file " + filepath);
+
+  char magic[4];
+  std::uint32_t header[4];
+  in.read(magic, sizeof(magic));
+  in.read(reinterpret_cast<char*>(header), sizeof(header));
+  if(!in.good() || !std::equal(magic, magic + 4, productQuantizerMagic))
+    throw std::runtime_error("Invalid product quantizer file " + filepath);
+  if(header[0] != productQuantizerVersion)
+    throw std::runtime_error("Unsupported product quantizer file version " + std::to_string(header[0]) + ": " + filepath);
+
+  const std::size_t dimension = header[1];
+  const std::size_t nbSubspaces = header[2];
+  const std::size_t nbCentroids = header[3];
+  if(nbSubspaces == 0 || dimension % nbSubspaces != 0 || nbCentroids == 0 || nbCentroids > 256)
+    throw std::runtime_error("Invalid product quantizer file " + filepath);
+
+  std::vector<float> centroids(nbCentroids * dimension);
+  in.read(reinterpret_cast<char*>(centroids.data()), centroids.size() * sizeof(float));
+  if(!in.good())
+    throw std::runtime_error("Invalid product quantizer file " + filepath + ": truncated codebooks");
+
+  _dimension = dimension;
+  _nbSubspaces = nbSubspaces;
+  _subspaceDimension = dimension / nbSubspaces;
+  _nbCentroids = nbCentroids;
+  _centroids.swap(centroids);
+}
+
+}  // namespace matching
+}  // namespace aliceVision
@@ -0,0 +1,193 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace aliceVision {
+namespace matching {
+
+/**
+ * @brief Product quantization of descriptors.
+ *
+ * The descriptor space is split in nbSubspaces contiguous subspaces and each
+ * subspace is quantized with its own k-means codebook of at most 256 centroids.
+ * A descriptor is then encoded in nbSubspaces bytes (16 bytes instead of the
+ * 128 bytes of a SIFT descriptor).
+ *
+ * The distance between a full query descriptor and an encoded descriptor is
+ * approximated with the asymmetric distance (ADC): the squared distances from
+ * the query subvectors to all the centroids are computed once per query in a
+ * table, then the distance to a code is the sum of nbSubspaces table lookups.
+ *
+ * "Product quantization for nearest neighbor search", Jegou, Douze, Schmid, PAMI 2011.
+ */
+class ProductQuantizer
+{
+public:
+  ProductQuantizer() = default;
+
+  /**
+   * @brief Get the default number of subspaces of a dimension: 8 dimensions per subspace if possible.
+   * @param[in] dimension The descriptor dimension.
+   * @return the largest divisor of the dimension lower or equal to dimension / 8 (at least 1)
+   */
+  static std::size_t defaultNbSubspaces(std::size_t dimension);
+
+  /**
+   * @brief Train the codebooks with k-means.
+   * @param[in] data The training descriptors (row major).
+   * @param[in] nbRows The number of training descriptors.
+   * @param[in] dimension The descriptor dimension.
+   * @param[in] nbSubspaces The number of subspaces, it must divide the dimension.
+   * @param[in] nbCentroids The number of centroids per subspace (at most 256).
+   * @param[in] nbIterations The number of k-means iterations.
+   * @param[in] maxTrainingRows The maximum number of descriptors used for the training, evenly sampled in data.
+   */
+  template <typename ScalarT>
+  void train(const ScalarT* data, std::size_t nbRows, std::size_t dimension, std::size_t nbSubspaces,
+             std::size_t nbCentroids = 256, std::size_t nbIterations = 12, std::size_t maxTrainingRows = 65536)
+  {
+    const std::size_t nbTrainingRows = std::min(nbRows, maxTrainingRows);
+    std::vector<float> trainingData(nbTrainingRows * dimension);
+    for(std::size_t i = 0; i < nbTrainingRows; ++i)
+    {
+      const ScalarT* row = data + (i * nbRows / nbTrainingRows) * dimension;
+      std::copy(row, row + dimension, &trainingData[i * dimension]);
+    }
+    trainFloat(trainingData, nbTrainingRows, dimension, nbSubspaces, nbCentroids, nbIterations);
+  }
+
+  bool isTrained() const { return !_centroids.empty(); }
+  std::size_t dimension() const { return _dimension; }
+  std::size_t nbSubspaces() const { return _nbSubspaces; }
+  std::size_t nbCentroids() const { return _nbCentroids; }
+  /// Size of a code in bytes
+  std::size_t codeSize() const { return _nbSubspaces; }
+
+  /**
+   * @brief Encode a descriptor.
+   * @param[in] descriptor The descriptor.
+   * @param[out] code The code of codeSize() bytes.
+   */
+  template <typename ScalarT>
+  void encode(const ScalarT* descriptor, std::uint8_t* code) const
+  {
+    for(std::size_t m = 0; m < _nbSubspaces; ++m)
+    {
+      const ScalarT* subvector = descriptor + m * _subspaceDimension;
+      const float* centroid = subspaceCentroids(m);
+      float bestDistance = std::numeric_limits<float>::max();
+      std::size_t bestCentroid = 0;
+      for(std::size_t k = 0; k < _nbCentroids; ++k, centroid += _subspaceDimension)
+      {
+        const float distance = squaredDistance(subvector, centroid);
+        if(distance < bestDistance)
+        {
+          bestDistance = distance;
+          bestCentroid = k;
+        }
+      }
+      code[m] = static_cast<std::uint8_t>(bestCentroid);
+    }
+  }
+
+  /**
+   * @brief Encode descriptors.
+   * @param[in] data The descriptors (row major).
+   * @param[in] nbRows The number of descriptors.
+   * @param[out] codes The codes, codeSize() bytes per descriptor.
+   */
+  template <typename ScalarT>
+  void encode(const ScalarT* data, std::size_t nbRows, std::vector<std::uint8_t>& codes) const
+  {
+    codes.resize(nbRows * codeSize());
+    #pragma omp parallel for schedule(static)
+    for(int i = 0; i < static_cast<int>(nbRows); ++i)
+      encode(data + i * _dimension, &codes[i * codeSize()]);
+  }
+
+  /**
+   * @brief Compute the table of the squared distances from the query subvectors to the centroids.
+   * @param[in] query The query descriptor.
+   * @param[out] table The nbSubspaces x nbCentroids distances.
+   */
+  template <typename ScalarT>
+  void computeDistanceTable(const ScalarT* query, std::vector<float>& table) const
+  {
+    table.resize(_nbSubspaces * _nbCentroids);
+    float* distance = table.data();
+    for(std::size_t m = 0; m < _nbSubspaces; ++m)
+    {
+      const ScalarT* subvector = query + m * _subspaceDimension;
+      const float* centroid = subspaceCentroids(m);
+      for(std::size_t k = 0; k < _nbCentroids; ++k, centroid += _subspaceDimension)
+        *distance++ = squaredDistance(subvector, centroid);
+    }
+  }
+
+  /**
+   * @brief Get the asymmetric squared distance between a query and an encoded descriptor.
+   * @param[in] table The distance table of the query.
+   * @param[in] code The code of the descriptor.
+   * @return the approximated squared distance
+   */
+  float asymmetricDistance(const float* table, const std::uint8_t* code) const
+  {
+    float distance = 0.f;
+    for(std::size_t m = 0; m < _nbSubspaces; ++m, table += _nbCentroids)
+      distance += table[code[m]];
+    return distance;
+  }
+
+  /**
+   * @brief Save the codebooks in a binary file.
+   * @param[in] filepath The file path.
+   */
+  void save(const std::string& filepath) const;
+
+  /**
+   * @brief Load the codebooks from a binary file.
+   * @param[in] filepath The file path.
+   */
+  void load(const std::string& filepath);
+
+private:
+  void trainFloat(const std::vector<float>& data, std::size_t nbRows, std::size_t dimension, std::size_t nbSubspaces,
+                  std::size_t nbCentroids, std::size_t nbIterations);
+
+  const float* subspaceCentroids(std::size_t m) const
+  {
+    return &_centroids[m * _nbCentroids * _subspaceDimension];
+  }
+
+  template <typename ScalarT>
+  float squaredDistance(const ScalarT* subvector, const float* centroid) const
+  {
+    float distance = 0.f;
+    for(std::size_t d = 0; d < _subspaceDimension; ++d)
+    {
+      const float diff = static_cast<float>(subvector[d]) - centroid[d];
+      distance += diff * diff;
+    }
+    return distance;
+  }
+
+  std::size_t _dimension = 0;
+  std::size_t _nbSubspaces = 0;
+  std::size_t _subspaceDimension = 0;
+  std::size_t _nbCentroids = 0;
+  /// nbSubspaces x nbCentroids x subspaceDimension
+  std::vector<float> _centroids;
+};
+
+}  // namespace matching
+}  // namespace aliceVision
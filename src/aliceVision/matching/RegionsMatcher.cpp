@@ -8,6 +8,7 @@
 #include "aliceVision/matching/ArrayMatcher_bruteForce.hpp"
 #include "aliceVision/matching/ArrayMatcher_kdtreeFlann.hpp"
 #include "aliceVision/matching/ArrayMatcher_cascadeHashing.hpp"
+#include "aliceVision/matching/ArrayMatcher_productQuantization.hpp"
 
 namespace aliceVision {
 namespace matching {
@@ -90,6 +91,12 @@ std::unique_ptr<IRegionsMatcher> createRegionsMatcher(const feature::Regions & r
           out.reset(new matching::RegionsMatcher<MatcherT>(regions, true));
         }
         break;
+        case PRODUCT_QUANTIZATION_L2:
+        {
+          typedef ArrayMatcher_productQuantization<unsigned char> MatcherT;
+          out.reset(new matching::RegionsMatcher<MatcherT>(regions, true));
+        }
+        break;
         default:
           ALICEVISION_LOG_WARNING("Using unknown matcher type");
       }
@@ -119,6 +126,12 @@ std::unique_ptr<IRegionsMatcher> createRegionsMatcher(const feature::Regions & r
           out.reset(new matching::RegionsMatcher<MatcherT>(regions, true));
         }
         break;
+        case PRODUCT_QUANTIZATION_L2:
+        {
+          typedef ArrayMatcher_productQuantization<float> MatcherT;
+          out.reset(new matching::RegionsMatcher<MatcherT>(regions, true));
+        }
+        break;
         default:
           ALICEVISION_LOG_WARNING("Using unknown matcher type");
       }
@@ -142,6 +155,7 @@ std::unique_ptr<IRegionsMatcher> createRegionsMatcher(const feature::Regions & r
         }
         break;
         case CASCADE_HASHING_L2:
+        case PRODUCT_QUANTIZATION_L2:
         {
           ALICEVISION_LOG_WARNING("Not yet implemented");
         }
@@ -118,6 +118,25 @@ public:
     matcher_.Build(tab, regions_.RegionCount(), regions_.DescriptorLength());
   }
 
+  /**
+   * @brief Initialize the matcher with a Regions that will be used as database
+   * and a configured array matcher (e.g. sharing precomputed data between databases).
+   *
+   * @param regions The Regions to be used as database.
+   * @param matcher The array matcher to build on the database.
+   * @param b_squared_metric Whether to use a squared metric for the ratio test
+   * when matching two Regions.
+   */
+  RegionsMatcher(const feature::Regions& regions, const ArrayMatcherT& matcher, bool b_squared_metric = false)
+    : IRegionsMatcher(regions), matcher_(matcher), b_squared_metric_(b_squared_metric)
+  {
+    if (regions_.RegionCount() == 0)
+      return;
+
+    const Scalar * tab = reinterpret_cast<const Scalar *>(regions_.DescriptorRawData());
+    matcher_.Build(tab, regions_.RegionCount(), regions_.DescriptorLength());
+  }
+
   /**
    * @brief Match a Regions to the internal database using the test ratio to improve
    * the robustness of the match.
@@ -244,10 +263,10 @@ public:
   bool Match(
     float distRatio,
     const feature::MapRegionsPerDesc & matchedRegions,
-    matching::MatchesPerDescType & out_putativeFeatureMatches)
+    matching::MatchesPerDescType & out_putativeFeatureMatches) const
   {
     bool res = false;
-    for(auto& matcherIt: _mapMatchers)
+    for(const auto& matcherIt: _mapMatchers)
     {
       const feature::EImageDescriberType descType = matcherIt.first;
       res |= matcherIt.second.Match(
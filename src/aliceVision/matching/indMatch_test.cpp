@@ -5,6 +5,9 @@
 
 #include "aliceVision/matching/IndMatch.hpp"
 #include "aliceVision/matching/io.hpp"
+#include "aliceVision/matching/PackedPairwiseMatches.hpp"
+
+#include "dependencies/stlplus3/filesystemSimplified/file_system.hpp"
 
 #define BOOST_TEST_MODULE IndMatch
 #include <boost/test/included/unit_test.hpp>
@@ -104,6 +107,142 @@ BOOST_AUTO_TEST_CASE(IndMatch_IO)
   }
 }
 
+BOOST_AUTO_TEST_CASE(IndMatch_MergeFolders)
+{
+  // matches of two chunks of pairs, saved in separate folders
+  PairwiseMatches matchesA;
+  matchesA[std::make_pair(0,1)][EImageDescriberType::UNKNOWN] = {{0,0},{1,1}};
+  matchesA[std::make_pair(2,3)][EImageDescriberType::UNKNOWN] = {{0,0}};
+  PairwiseMatches matchesB;
+  matchesB[std::make_pair(1,2)][EImageDescriberType::UNKNOWN] = {{0,0},{1,1},{2,2}};
+  matchesB[std::make_pair(0,1)][EImageDescriberType::UNKNOWN] = {{5,5}};
+
+  BOOST_CHECK(stlplus::folder_create("mergeA") || stlplus::folder_exists("mergeA"));
+  BOOST_CHECK(stlplus::folder_create("mergeB") || stlplus::folder_exists("mergeB"));
+  BOOST_CHECK(Save(matchesA, "mergeA", "merge", "bin", false));
+  BOOST_CHECK(Save(matchesB, "mergeB", "merge", "bin", true));
+
+  PairwiseMatches matches;
+  BOOST_CHECK(MergeMatchFolders(matches, {"mergeA", "mergeB"}, "merge"));
+  BOOST_CHECK_EQUAL(3, matches.size());
+  // the duplicated pair is taken from the first folder
+  BOOST_CHECK_EQUAL(2, matches.at(std::make_pair(0,1)).at(EImageDescriberType::UNKNOWN).size());
+  BOOST_CHECK_EQUAL(3, matches.at(std::make_pair(1,2)).at(EImageDescriberType::UNKNOWN).size());
+  BOOST_CHECK_EQUAL(1, matches.at(std::make_pair(2,3)).at(EImageDescriberType::UNKNOWN).size());
+
+  PairwiseMatches invalidMatches;
+  BOOST_CHECK(!MergeMatchFolders(invalidMatches, {"mergeA", "mergeMissing"}, "merge"));
+}
+
+BOOST_AUTO_TEST_CASE(IndMatch_PackedPairwiseMatches)
+{
+  PairwiseMatches matches;
+  matches[std::make_pair(0,1)][EImageDescriberType::UNKNOWN] = {{0,0},{1,1}};
+  matches[std::make_pair(0,1)][EImageDescriberType::SIFT] = {{2,3}};
+  matches[std::make_pair(1,2)][EImageDescriberType::UNKNOWN] = {{0,0},{1,1},{2,2}};
+
+  const PackedPairwiseMatches packedMatches(matches);
+  BOOST_CHECK_EQUAL(2, packedMatches.size());
+  BOOST_CHECK_EQUAL(3, packedMatches.nbEntries());
+  BOOST_CHECK_EQUAL(6, packedMatches.nbMatches());
+
+  // same iteration as the pairwise matches
+  PairwiseMatches::const_iterator matchesIt = matches.begin();
+  for(const auto& pairMatches: packedMatches)
+  {
+    BOOST_CHECK(pairMatches.first == matchesIt->first);
+    BOOST_CHECK_EQUAL(pairMatches.second.getNbAllMatches(), matchesIt->second.getNbAllMatches());
+    BOOST_CHECK_EQUAL(pairMatches.second.size(), matchesIt->second.size());
+    for(const auto& descMatches: pairMatches.second)
+    {
+      const IndMatches& expected = matchesIt->second.at(descMatches.first);
+      BOOST_CHECK(std::equal(descMatches.second.begin(), descMatches.second.end(), expected.begin()));
+      BOOST_CHECK_EQUAL(descMatches.second.size(), expected.size());
+    }
+    ++matchesIt;
+  }
+  BOOST_CHECK(matchesIt == matches.end());
+
+  // member access through the iterators
+  const PackedPairwiseMatches::const_iterator packedIt = packedMatches.find(std::make_pair(1,2));
+  BOOST_CHECK(packedIt->first == std::make_pair(IndexT(1), IndexT(2)));
+  BOOST_CHECK_EQUAL(3, packedIt->second.getNbAllMatches());
+  BOOST_CHECK_EQUAL(3, packedIt->second.begin()->second.size());
+
+  BOOST_CHECK_EQUAL(1, packedMatches.count(std::make_pair(1,2)));
+  BOOST_CHECK_EQUAL(0, packedMatches.count(std::make_pair(0,2)));
+  BOOST_CHECK_EQUAL(1, packedMatches.at(std::make_pair(0,1)).second.getNbMatches(EImageDescriberType::SIFT));
+  BOOST_CHECK_EQUAL(0, packedMatches.at(std::make_pair(1,2)).second.getNbMatches(EImageDescriberType::SIFT));
+  BOOST_CHECK_THROW(packedMatches.at(std::make_pair(0,2)), std::out_of_range);
+
+  PairwiseMatches exportedMatches;
+  packedMatches.toPairwiseMatches(exportedMatches);
+  BOOST_CHECK(exportedMatches == matches);
+
+  // unordered additions with a duplicated entry, the last one is kept
+  PackedPairwiseMatches unorderedMatches;
+  const IndMatches first = {{9,9}};
+  const IndMatches last = {{0,0},{1,1},{2,2}};
+  unorderedMatches.append(std::make_pair(1,2), EImageDescriberType::UNKNOWN, first.begin(), first.end());
+  IndMatch* buffer = unorderedMatches.allocate(std::make_pair(0,1), EImageDescriberType::SIFT, 1);
+  buffer[0] = IndMatch(2,3);
+  PackedPairwiseMatches otherMatches;
+  otherMatches.append(std::make_pair(0,1), EImageDescriberType::UNKNOWN, matches[std::make_pair(0,1)][EImageDescriberType::UNKNOWN].begin(), matches[std::make_pair(0,1)][EImageDescriberType::UNKNOWN].end());
+  otherMatches.append(std::make_pair(1,2), EImageDescriberType::UNKNOWN, last.begin(), last.end());
+  unorderedMatches.append(otherMatches);
+  unorderedMatches.finalize();
+  BOOST_CHECK_EQUAL(6, unorderedMatches.nbMatches());
+  unorderedMatches.toPairwiseMatches(exportedMatches);
+  BOOST_CHECK(exportedMatches == matches);
+
+  // filters
+  unorderedMatches.filter({0, 1}, {});
+  BOOST_CHECK_EQUAL(1, unorderedMatches.size());
+  BOOST_CHECK_EQUAL(3, unorderedMatches.nbMatches());
+  unorderedMatches.filter({}, {EImageDescriberType::SIFT});
+  BOOST_CHECK_EQUAL(1, unorderedMatches.size());
+  BOOST_CHECK_EQUAL(1, unorderedMatches.nbMatches());
+  BOOST_CHECK(unorderedMatches.pairAt(0).second.at(EImageDescriberType::SIFT)[0] == IndMatch(2,3));
+}
+
+BOOST_AUTO_TEST_CASE(IndMatch_PackedIO)
+{
+  const std::set<IndexT> viewsKeys = {0, 1, 2};
+  PairwiseMatches matches;
+  matches[std::make_pair(0,1)][EImageDescriberType::UNKNOWN] = {{0,0},{1,1}};
+  matches[std::make_pair(0,2)][EImageDescriberType::SIFT] = {{4,5}};
+  matches[std::make_pair(1,2)][EImageDescriberType::UNKNOWN] = {{0,0},{1,1},{2,2}};
+  matches[std::make_pair(2,3)][EImageDescriberType::UNKNOWN] = {{7,7}};
+
+  PairwiseMatches expectedMatches = matches;
+  expectedMatches.erase(std::make_pair(2,3));
+
+  for(const std::string extension: {"txt", "bin"})
+  {
+    for(bool matchFilePerImage: {false, true})
+    {
+      const std::string mode = "packed_" + extension + (matchFilePerImage ? "_perImage" : "");
+
+      // the files of the pairwise matches and of the packed matches are the same
+      BOOST_CHECK(Save(matches, ".", mode, extension, matchFilePerImage));
+      PackedPairwiseMatches packedMatches;
+      BOOST_CHECK(Load(packedMatches, viewsKeys, ".", {}, mode));
+      PairwiseMatches loadedMatches;
+      packedMatches.toPairwiseMatches(loadedMatches);
+      BOOST_CHECK(loadedMatches == expectedMatches);
+
+      BOOST_CHECK(Save(packedMatches, ".", mode + "_2", extension, matchFilePerImage));
+      loadedMatches.clear();
+      BOOST_CHECK(Load(loadedMatches, viewsKeys, ".", {}, mode + "_2"));
+      BOOST_CHECK(loadedMatches == expectedMatches);
+
+      BOOST_CHECK(Load(packedMatches, viewsKeys, ".", {EImageDescriberType::SIFT}, mode));
+      BOOST_CHECK_EQUAL(1, packedMatches.size());
+      BOOST_CHECK_EQUAL(1, packedMatches.nbMatches());
+    }
+  }
+}
+
 BOOST_AUTO_TEST_CASE(IndMatch_DuplicateRemoval_NoRemoval)
 {
   std::vector<IndMatch> vec_indMatch;
@@ -248,6 +248,208 @@ bool Load(
   return res;
 }
 
+namespace {
+
+/// Add the matches of a match file to packed matches, they must be finalized after the loading
+bool loadMatchFile(
+  PackedPairwiseMatches & matches,
+  const std::string & folder,
+  const std::string & filename)
+{
+  if(!stlplus::is_file(stlplus::create_filespec(folder, filename)))
+    return false;
+
+  const std::string ext = stlplus::extension_part(filename);
+  const std::string filepath = folder + "/" + filename;
+
+  if (ext == "txt")
+  {
+    std::ifstream stream(filepath.c_str());
+    if (!stream.is_open())
+      return false;
+
+    // same format as the PairwiseMatches text files
+    std::size_t I = 0;
+    std::size_t J = 0;
+    std::size_t nbDescType = 0;
+    while(stream >> I >> J >> nbDescType)
+    {
+      for(std::size_t i = 0; i < nbDescType; ++i)
+      {
+        std::string descTypeStr;
+        std::size_t nbMatches = 0;
+        stream >> descTypeStr >> nbMatches;
+
+        const feature::EImageDescriberType descType = feature::EImageDescriberType_stringToEnum(descTypeStr);
+        IndMatch* matchesPerDesc = matches.allocate(std::make_pair(I, J), descType, nbMatches);
+        for (std::size_t m = 0; m < nbMatches; ++m)
+        {
+          stream >> matchesPerDesc[m];
+        }
+      }
+    }
+    return true;
+  }
+  else if (ext == "bin")
+  {
+    std::ifstream stream (filepath.c_str(), std::ios::in | std::ios::binary);
+    if (!stream.is_open())
+      return false;
+
+    cereal::PortableBinaryInputArchive archive(stream);
+    if(matches.nbEntries() == 0)
+    {
+      archive(matches);
+    }
+    else
+    {
+      PackedPairwiseMatches loadMatches;
+      archive(loadMatches);
+      matches.append(loadMatches);
+    }
+    return true;
+  }
+  else
+  {
+    ALICEVISION_LOG_WARNING("Unknown matching file format: " << ext);
+  }
+  return false;
+}
+
+/// Add the matches of the match file of each image to packed matches, they must be finalized after the loading
+bool loadMatchFilePerImage(
+  PackedPairwiseMatches & matches,
+  const std::set<IndexT> & viewsKeys,
+  const std::string & folder,
+  const std::string & basename)
+{
+  const std::vector<IndexT> viewIds(viewsKeys.begin(), viewsKeys.end());
+  std::vector<PackedPairwiseMatches> matchesPerFile(viewIds.size());
+  std::vector<char> isLoaded(viewIds.size(), 0);
+
+  #pragma omp parallel for num_threads(3)
+  for(ptrdiff_t i = 0; i < static_cast<ptrdiff_t>(viewIds.size()); ++i)
+  {
+    const std::string matchFilename = std::to_string(viewIds[i]) + "." + basename;
+    isLoaded[i] = loadMatchFile(matchesPerFile[i], folder, matchFilename);
+    if(!isLoaded[i])
+    {
+      #pragma omp critical
+      {
+        ALICEVISION_LOG_DEBUG("Unable to load match file: " << folder << "/" << matchFilename);
+      }
+    }
+  }
+
+  int nbLoadedMatchFiles = 0;
+  for(std::size_t i = 0; i < viewIds.size(); ++i)
+  {
+    if(!isLoaded[i])
+      continue;
+    ++nbLoadedMatchFiles;
+    matches.append(matchesPerFile[i]);
+    PackedPairwiseMatches().swap(matchesPerFile[i]);
+  }
+  if( nbLoadedMatchFiles == 0 )
+  {
+    ALICEVISION_LOG_WARNING("No matches file loaded in: " << folder);
+    return false;
+  }
+  return true;
+}
+
+} // namespace
+
+bool Load(
+  PackedPairwiseMatches & matches,
+  const std::set<IndexT> & viewsKeysFilter,
+  const std::string & folder,
+  const std::vector<feature::EImageDescriberType>& descTypesFilter,
+  const std::string & mode)
+{
+  matches.clear();
+
+  bool res = false;
+  const std::string basename = "matches." + mode;
+  if(stlplus::is_file(stlplus::create_filespec(folder, basename + ".txt")))
+  {
+    res = loadMatchFile(matches, folder, basename + ".txt");
+  }
+  else if(stlplus::is_file(stlplus::create_filespec(folder, basename + ".bin")))
+  {
+    res = loadMatchFile(matches, folder, basename + ".bin");
+  }
+  else if(!stlplus::folder_wildcard(folder, "*."+basename+".txt", false, true).empty())
+  {
+    res = loadMatchFilePerImage(matches, viewsKeysFilter, folder, basename + ".txt");
+  }
+  else if(!stlplus::folder_wildcard(folder, "*."+basename+".bin", false, true).empty())
+  {
+    res = loadMatchFilePerImage(matches, viewsKeysFilter, folder, basename + ".bin");
+  }
+  matches.finalize();
+  if(!res)
+    return res;
+
+  matches.filter(viewsKeysFilter, descTypesFilter);
+
+  ALICEVISION_LOG_DEBUG(matches.nbMatches() << " matches loaded for " << matches.size() << " image pairs.");
+  return res;
+}
+
+bool MergeMatchFolders(
+  PairwiseMatches & matches,
+  const std::vector<std::string> & folders,
+  const std::string & mode)
+{
+  std::vector<PairwiseMatches> matchesPerFolder(folders.size());
+  std::vector<char> isLoaded(folders.size(), 0);
+
+  #pragma omp parallel for num_threads(3)
+  for(ptrdiff_t i = 0; i < static_cast<ptrdiff_t>(folders.size()); ++i)
+  {
+    const std::string basename = "matches." + mode;
+    const std::vector<std::string> filesPerImage = stlplus::folder_wildcard(folders[i], "*." + basename + ".*", false, true);
+    if(filesPerImage.empty())
+    {
+      isLoaded[i] = Load(matchesPerFolder[i], std::set<IndexT>(), folders[i], {}, mode);
+      continue;
+    }
+    // the views of the match files per image are given by the file names: <viewId>.matches.<mode>.<ext>
+    std::set<IndexT> viewsKeys;
+    for(const std::string& filename: filesPerImage)
+    {
+      const std::string viewId = filename.substr(0, filename.find('.'));
+      if(!viewId.empty() && viewId.find_first_not_of("0123456789") == std::string::npos)
+        viewsKeys.insert(std::stoul(viewId));
+    }
+    const std::string extension = stlplus::extension_part(filesPerImage.front());
+    isLoaded[i] = LoadMatchFilePerImage(matchesPerFolder[i], viewsKeys, folders[i], basename + "." + extension);
+  }
+
+  bool res = true;
+  std::size_t nbDuplicates = 0;
+  for(std::size_t i = 0; i < folders.size(); ++i)
+  {
+    if(!isLoaded[i])
+    {
+      ALICEVISION_LOG_WARNING("Unable to load the " << mode << " matches of: " << folders[i]);
+      res = false;
+      continue;
+    }
+    for(auto& v: matchesPerFolder[i])
+    {
+      const std::size_t size = matches.size();
+      matches.emplace_hint(matches.end(), v.first, std::move(v.second));
+      if(matches.size() == size)
+        ++nbDuplicates;
+    }
+    PairwiseMatches().swap(matchesPerFolder[i]);
+  }
+  if(nbDuplicates > 0)
+    ALICEVISION_LOG_WARNING(nbDuplicates << " image pairs are found in several folders, only their first matches are kept.");
+  return res;
+}
 
 class MatchExporter
 {
@@ -382,5 +584,82 @@ bool Save(
   return true;
 }
 
+namespace {
+
+void saveTxt(
+  const std::string & filepath,
+  const PackedPairwiseMatches & matches,
+  std::size_t firstPair,
+  std::size_t lastPair)
+{
+  std::ofstream stream(filepath.c_str(), std::ios::out);
+  for(std::size_t i = firstPair; i < lastPair; ++i)
+  {
+    const auto pairMatches = matches.pairAt(i);
+    stream << pairMatches.first.first << " " << pairMatches.first.second << '\n'
+           << pairMatches.second.size() << '\n';
+    for(const auto& m: pairMatches.second)
+    {
+      stream << feature::EImageDescriberType_enumToString(m.first) << " " << m.second.size() << '\n';
+      copy(m.second.begin(), m.second.end(),
+           std::ostream_iterator<IndMatch>(stream, "\n"));
+    }
+  }
+}
+
+void saveBinary(
+  const std::string & filepath,
+  const PackedPairwiseMatches & matches,
+  std::size_t firstPair,
+  std::size_t lastPair)
+{
+  std::ofstream stream(filepath.c_str(), std::ios::out | std::ios::binary);
+  cereal::PortableBinaryOutputArchive archive(stream);
+  matches.savePairs(archive, firstPair, lastPair);
+}
+
+} // namespace
+
+bool Save(
+  const PackedPairwiseMatches & matches,
+  const std::string & folder,
+  const std::string & mode,
+  const std::string & extension,
+  bool matchFilePerImage)
+{
+  const std::string filename = "matches." + mode + "." + extension;
+  if(extension != "txt" && extension != "bin")
+    throw std::runtime_error(std::string("Unknown matching file format: ") + extension);
+
+  const auto save = [&](const std::string& filepath, std::size_t firstPair, std::size_t lastPair)
+  {
+    if(extension == "txt")
+      saveTxt(filepath, matches, firstPair, lastPair);
+    else
+      saveBinary(filepath, matches, firstPair, lastPair);
+  };
+
+  if(!matchFilePerImage)
+  {
+    save(folder + "/" + filename, 0, matches.size());
+    return true;
+  }
+
+  // the pairs are sorted, so the pairs of an image are contiguous
+  std::size_t firstPair = 0;
+  while(firstPair < matches.size())
+  {
+    const IndexT key = matches.pairAt(firstPair).first.first;
+    std::size_t lastPair = firstPair + 1;
+    while(lastPair < matches.size() && matches.pairAt(lastPair).first.first == key)
+      ++lastPair;
+    const std::string filepath = folder + "/" + std::to_string(key) + "." + filename;
+    ALICEVISION_LOG_DEBUG("Export Matches in: " << filepath);
+    save(filepath, firstPair, lastPair);
+    firstPair = lastPair;
+  }
+  return true;
+}
+
 }  // namespace matching
 }  // namespace aliceVision
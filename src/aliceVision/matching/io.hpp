@@ -6,8 +6,10 @@
 #pragma once
 
 #include <aliceVision/matching/IndMatch.hpp>
+#include <aliceVision/matching/PackedPairwiseMatches.hpp>
 
 #include <string>
+#include <vector>
 
 namespace aliceVision {
 namespace matching {
@@ -54,6 +56,41 @@ bool Load(
   const std::vector<feature::EImageDescriberType>& descTypesFilter,
   const std::string & mode);
 
+/**
+ * @brief Load match files in packed pairwise matches.
+ *
+ * The matches are read directly in the contiguous buffer of the container,
+ * without the allocations of PairwiseMatches.
+ *
+ * @param[out] matches: container for the output matches
+ * @param[in] viewsKeysFilter: views to keep, all the views if empty
+ * @param[in] folder: folder containing the match files
+ * @param[in] descTypesFilter: describer types to keep, all the types if empty
+ * @param[in] mode: type of matching, it could be: "f", "e" or "putative".
+ */
+bool Load(
+  PackedPairwiseMatches & matches,
+  const std::set<IndexT> & viewsKeysFilter,
+  const std::string & folder,
+  const std::vector<feature::EImageDescriberType>& descTypesFilter,
+  const std::string & mode);
+
+/**
+ * @brief Merge the match files of several folders, e.g. the outputs of matching jobs run on chunks of the pairs.
+ *
+ * The folders are loaded in parallel and their pairs are moved in the output in the folders order.
+ * If a pair is found in several folders, the first one is kept.
+ *
+ * @param[out] matches: container for the output matches
+ * @param[in] folders: folders containing the match files
+ * @param[in] mode: type of matching, it could be: "f", "e" or "putative".
+ * @return false if the match files of a folder cannot be loaded
+ */
+bool MergeMatchFolders(
+  PairwiseMatches & matches,
+  const std::vector<std::string> & folders,
+  const std::string & mode);
+
 /**
  * @brief Filter to keep only specific viewIds.
  */
@@ -79,5 +116,22 @@ bool Save(
   const std::string & extension,
   bool matchFilePerImage);
 
+/**
+ * @brief Save packed match files, with the same formats as the PairwiseMatches files.
+ *
+ * @param[in] matches: container for the output matches
+ * @param[in] folder: folder containing the match files
+ * @param[in] mode: type of matching, it could be: "f", "e" or "putative".
+ * @param[in] extension: txt or bin file format
+ * @param[in] matchFilePerImage: do we store a global match file
+ *            or one match file per image
+ */
+bool Save(
+  const PackedPairwiseMatches & matches,
+  const std::string & folder,
+  const std::string & mode,
+  const std::string & extension,
+  bool matchFilePerImage);
+
 }  // namespace matching
 }  // namespace aliceVision
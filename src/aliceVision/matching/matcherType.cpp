@@ -18,6 +18,7 @@ std::string EMatcherType_enumToString(EMatcherType matcherType)
     case EMatcherType::ANN_L2:                  return "ANN_L2";
     case EMatcherType::CASCADE_HASHING_L2:      return "CASCADE_HASHING_L2";
     case EMatcherType::FAST_CASCADE_HASHING_L2: return "FAST_CASCADE_HASHING_L2";
+    case EMatcherType::PRODUCT_QUANTIZATION_L2: return "PRODUCT_QUANTIZATION_L2";
     case EMatcherType::BRUTE_FORCE_HAMMING:     return "BRUTE_FORCE_HAMMING";
   }
   throw std::out_of_range("Invalid matcherType enum");
@@ -29,6 +30,7 @@ EMatcherType EMatcherType_stringToEnum(const std::string& matcherType)
   if(matcherType == "ANN_L2")                   return EMatcherType::ANN_L2;
   if(matcherType == "CASCADE_HASHING_L2")       return EMatcherType::CASCADE_HASHING_L2;
   if(matcherType == "FAST_CASCADE_HASHING_L2")  return EMatcherType::FAST_CASCADE_HASHING_L2;
+  if(matcherType == "PRODUCT_QUANTIZATION_L2")  return EMatcherType::PRODUCT_QUANTIZATION_L2;
   if(matcherType == "BRUTE_FORCE_HAMMING")      return EMatcherType::BRUTE_FORCE_HAMMING;
   throw std::out_of_range("Invalid matcherType : " + matcherType);
 }
@@ -16,6 +16,7 @@ enum EMatcherType
   ANN_L2,
   CASCADE_HASHING_L2,
   FAST_CASCADE_HASHING_L2,
+  PRODUCT_QUANTIZATION_L2,
   BRUTE_FORCE_HAMMING
 };
 
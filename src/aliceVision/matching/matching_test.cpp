@@ -7,7 +7,11 @@
 #include "aliceVision/matching/ArrayMatcher_bruteForce.hpp"
 #include "aliceVision/matching/ArrayMatcher_kdtreeFlann.hpp"
 #include "aliceVision/matching/ArrayMatcher_cascadeHashing.hpp"
+#include "aliceVision/matching/ArrayMatcher_productQuantization.hpp"
+#include <cstdio>
+#include <cstdlib>
 #include <iostream>
+#include <random>
 
 #define BOOST_TEST_MODULE matching
 #include <boost/test/included/unit_test.hpp>
@@ -112,6 +116,49 @@ BOOST_AUTO_TEST_CASE(Matching_ArrayMatcher_kdtreeFlann_Simple__NN)
   BOOST_CHECK_EQUAL(IndMatch(0,4), vec_nIndice[4]);
 }
 
+BOOST_AUTO_TEST_CASE(Matching_ArrayMatcher_kdtreeFlann_ChunkedQueries)
+{
+  const int dimension = 32;
+  const int nbRows = 3000;
+  const int nbQueries = 1000;
+
+  std::mt19937 generator(42);
+  std::uniform_real_distribution<float> value(0.f, 1.f);
+  std::vector<float> dataset(nbRows * dimension);
+  for (float& v : dataset)
+    v = value(generator);
+  std::vector<float> queries(nbQueries * dimension);
+  for (float& v : queries)
+    v = value(generator);
+
+  const int NN = 2;
+  // one chunk with all the queries
+  std::srand(0);
+  ArrayMatcher_kdtreeFlann<float> matcher(nbQueries);
+  BOOST_CHECK( matcher.Build(&dataset[0], nbRows, dimension) );
+  IndMatches vec_nIndice;
+  vector<float> vec_fDistance;
+  BOOST_CHECK( matcher.SearchNeighbours(&queries[0], nbQueries, &vec_nIndice, &vec_fDistance, NN) );
+
+  // same randomized trees, the queries are searched by chunks in parallel
+  std::srand(0);
+  ArrayMatcher_kdtreeFlann<float> chunkedMatcher(37);
+  BOOST_CHECK( chunkedMatcher.Build(&dataset[0], nbRows, dimension) );
+  IndMatches vec_nIndiceChunked;
+  vector<float> vec_fDistanceChunked;
+  BOOST_CHECK( chunkedMatcher.SearchNeighbours(&queries[0], nbQueries, &vec_nIndiceChunked, &vec_fDistanceChunked, NN) );
+
+  BOOST_CHECK( vec_nIndice == vec_nIndiceChunked );
+  BOOST_CHECK( vec_fDistance == vec_fDistanceChunked );
+
+  // a copy shares the built index
+  ArrayMatcher_kdtreeFlann<float> copiedMatcher(chunkedMatcher);
+  IndMatches vec_nIndiceCopy;
+  vector<float> vec_fDistanceCopy;
+  BOOST_CHECK( copiedMatcher.SearchNeighbours(&queries[0], nbQueries, &vec_nIndiceCopy, &vec_fDistanceCopy, NN) );
+  BOOST_CHECK( vec_nIndice == vec_nIndiceCopy );
+}
+
 //-- Test LIMIT case (empty arrays)
 
 BOOST_AUTO_TEST_CASE(Matching_ArrayMatcher_bruteForce_Simple_EmptyArrays)
@@ -146,3 +193,105 @@ BOOST_AUTO_TEST_CASE(Matching_Cascade_Hashing_Simple_EmptyArrays)
   float fDistance = -1.0f;
   BOOST_CHECK(! matcher.SearchNeighbour( &array[0], &nIndice, &fDistance) );
 }
+
+BOOST_AUTO_TEST_CASE(Matching_ArrayMatcher_productQuantization_Simple_EmptyArrays)
+{
+  std::vector<float> array;
+  ArrayMatcher_productQuantization<float> matcher;
+  BOOST_CHECK(! matcher.Build(&array[0], 0, 4) );
+
+  int nIndice = -1;
+  float fDistance = -1.0f;
+  BOOST_CHECK(! matcher.SearchNeighbour( &array[0], &nIndice, &fDistance) );
+}
+
+//-- Test product quantization against the exact brute force matching
+
+BOOST_AUTO_TEST_CASE(Matching_ArrayMatcher_productQuantization_NN)
+{
+  const int dimension = 128;
+  const int nbRows = 2000;
+  const int nbQueries = 200;
+
+  std::mt19937 generator(42);
+  std::uniform_int_distribution<int> value(0, 255);
+  std::uniform_int_distribution<int> noise(-8, 8);
+
+  std::vector<unsigned char> dataset(nbRows * dimension);
+  for (unsigned char& v : dataset)
+    v = static_cast<unsigned char>(value(generator));
+
+  // the queries are noisy copies of dataset rows
+  std::vector<unsigned char> queries(nbQueries * dimension);
+  for (int q = 0; q < nbQueries; ++q)
+    for (int d = 0; d < dimension; ++d)
+      queries[q * dimension + d] = static_cast<unsigned char>(std::min(255, std::max(0, dataset[(q * 7) * dimension + d] + noise(generator))));
+
+  const int NN = 2;
+  ArrayMatcher_productQuantization<unsigned char> matcher;
+  BOOST_CHECK( matcher.Build(&dataset[0], nbRows, dimension) );
+  BOOST_CHECK_EQUAL( matcher.getQuantizer()->codeSize(), dimension / 8 );
+  BOOST_CHECK_EQUAL( matcher.getCodes()->size(), nbRows * dimension / 8 );
+
+  IndMatches vec_nIndice;
+  vector<float> vec_fDistance;
+  BOOST_CHECK( matcher.SearchNeighbours(&queries[0], nbQueries, &vec_nIndice, &vec_fDistance, NN) );
+
+  ArrayMatcher_bruteForce<unsigned char, L2_Vectorized<unsigned char> > exactMatcher;
+  BOOST_CHECK( exactMatcher.Build(&dataset[0], nbRows, dimension) );
+  IndMatches vec_nIndiceExact;
+  vector<float> vec_fDistanceExact;
+  BOOST_CHECK( exactMatcher.SearchNeighbours(&queries[0], nbQueries, &vec_nIndiceExact, &vec_fDistanceExact, NN) );
+
+  int nbFound = 0;
+  for (int q = 0; q < nbQueries; ++q)
+  {
+    if (vec_nIndice[q * NN]._j == vec_nIndiceExact[q * NN]._j)
+    {
+      ++nbFound;
+      // the re-ranked distances are exact
+      BOOST_CHECK_SMALL(static_cast<double>(vec_fDistance[q * NN] - vec_fDistanceExact[q * NN]), 1e-3);
+    }
+    BOOST_CHECK(vec_fDistance[q * NN] <= vec_fDistance[q * NN + 1]);
+  }
+  BOOST_CHECK_GE(nbFound, 0.95 * nbQueries);
+}
+
+BOOST_AUTO_TEST_CASE(Matching_ProductQuantizer_SaveLoad)
+{
+  const int dimension = 64;
+  const int nbRows = 500;
+
+  std::mt19937 generator(42);
+  std::uniform_real_distribution<float> value(0.f, 1.f);
+  std::vector<float> dataset(nbRows * dimension);
+  for (float& v : dataset)
+    v = value(generator);
+
+  ProductQuantizer quantizer;
+  quantizer.train(&dataset[0], nbRows, dimension, 8, 64);
+  BOOST_CHECK(quantizer.isTrained());
+  BOOST_CHECK_EQUAL(quantizer.nbCentroids(), 64);
+
+  std::vector<std::uint8_t> codes;
+  quantizer.encode(&dataset[0], nbRows, codes);
+
+  const std::string filepath = "productQuantizer_test.bin";
+  quantizer.save(filepath);
+  ProductQuantizer loadedQuantizer;
+  loadedQuantizer.load(filepath);
+  std::remove(filepath.c_str());
+
+  BOOST_CHECK_EQUAL(loadedQuantizer.dimension(), quantizer.dimension());
+  BOOST_CHECK_EQUAL(loadedQuantizer.nbSubspaces(), quantizer.nbSubspaces());
+  std::vector<std::uint8_t> loadedCodes;
+  loadedQuantizer.encode(&dataset[0], nbRows, loadedCodes);
+  BOOST_CHECK(codes == loadedCodes);
+
+  // the asymmetric distance approximates the exact distance
+  std::vector<float> table;
+  quantizer.computeDistanceTable(&dataset[0], table);
+  const float exactDistance = L2_Simple<float>()(&dataset[0], &dataset[dimension], dimension);
+  const float approximateDistance = quantizer.asymmetricDistance(table.data(), &codes[quantizer.codeSize()]);
+  BOOST_CHECK_CLOSE(approximateDistance, exactDistance, 50.0);
+}
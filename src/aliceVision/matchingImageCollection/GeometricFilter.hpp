@@ -9,14 +9,19 @@
 #include "aliceVision/feature/PointFeature.hpp"
 #include "aliceVision/feature/RegionsPerView.hpp"
 #include "aliceVision/matching/IndMatch.hpp"
+#include "aliceVision/matching/PackedPairwiseMatches.hpp"
 #include "aliceVision/matchingImageCollection/GeometricFilterMatrix.hpp"
+#include "aliceVision/matchingImageCollection/GeometricFilterWorkspace.hpp"
+#include "aliceVision/matchingImageCollection/GuidedMatchingGrids.hpp"
 
 #include "dependencies/stlplus3/filesystemSimplified/file_system.hpp"
 
 #include <boost/progress.hpp>
 
+#include <functional>
 #include <vector>
 #include <map>
+#include <utility>
 
 namespace aliceVision {
 namespace matchingImageCollection {
@@ -42,14 +47,157 @@ struct GeometricFilter
     const double d_distance_ratio = 0.6
   );
 
+  /// Perform robust model estimation (with optional guided_matching) for all the pairs of packed putative matches.
+  template<typename GeometryFunctor>
+  void Robust_model_estimation(
+    const GeometryFunctor & functor,
+    const PackedPairwiseMatches & putative_matches,
+    const bool b_guided_matching = false,
+    const double d_distance_ratio = 0.6
+  );
+
+  /**
+   * @brief Perform robust model estimation (with optional guided_matching) for a batch of pairs with the same model type.
+   * The pairs are filtered sequentially with the same workspace, so the batches can be filtered in parallel
+   * with one workspace per thread.
+   * @param[in] functor The geometric filter, copied for each pair.
+   * @param[in] putativeMatches The pairs and their putative matches.
+   * @param[in] guidedMatchingGrids Optional spatial grids of the features for the guided matching (can be NULL).
+   * @param[in,out] workspace The buffers reused between the pairs.
+   * @param[in] b_guided_matching Use the guided matching.
+   * @param[in] d_distance_ratio The distance ratio of the guided matching.
+   * @param[out] geometricMatches The geometric matches of the pairs with a strong support are added to it.
+   */
+  template<typename GeometryFunctor>
+  void Robust_model_estimation_batch(
+    const GeometryFunctor & functor,
+    const std::vector<std::pair<Pair, const MatchesPerDescType*>> & putativeMatches,
+    const GuidedMatchingGrids * guidedMatchingGrids,
+    GeometricFilterWorkspace & workspace,
+    const bool b_guided_matching,
+    const double d_distance_ratio,
+    std::vector<std::pair<Pair, MatchesPerDescType>> & geometricMatches) const;
+
   const PairwiseMatches & Get_geometric_matches() const {return _map_GeometricMatches;}
 
+  /// Minimal number of putative matches of a batch of consecutive pairs filtered by a thread
+  static const std::size_t batchNbMatches = 2048;
+
   // Data
   const sfm::SfMData * _sfm_data;
   const feature::RegionsPerView & _regionsPerView;
   PairwiseMatches _map_GeometricMatches;
+
+private:
+  /**
+   * @brief Filter the pairs [0, nbPairs) in parallel batches of consecutive pairs.
+   * @param[in] nbMatches Gives the number of putative matches of a pair.
+   * @param[in] getBatch Gives the pairs and putative matches of the pairs [first, last), the putative matches
+   *            can be stored in the given buffers to reuse them between the batches of a thread.
+   */
+  template<typename GeometryFunctor>
+  void robustModelEstimationBatches(
+    const GeometryFunctor & functor,
+    std::size_t nbPairs,
+    const std::set<IndexT> & viewIds,
+    const std::function<std::size_t(std::size_t)> & nbMatches,
+    const std::function<void(std::size_t, std::size_t, std::vector<MatchesPerDescType>&, std::vector<std::pair<Pair, const MatchesPerDescType*>>&)> & getBatch,
+    const bool b_guided_matching,
+    const double d_distance_ratio);
 };
 
+template<typename GeometryFunctor>
+void GeometricFilter::Robust_model_estimation_batch(
+  const GeometryFunctor & functor,
+  const std::vector<std::pair<Pair, const MatchesPerDescType*>> & putativeMatches,
+  const GuidedMatchingGrids * guidedMatchingGrids,
+  GeometricFilterWorkspace & workspace,
+  const bool b_guided_matching,
+  const double d_distance_ratio,
+  std::vector<std::pair<Pair, MatchesPerDescType>> & geometricMatches) const
+{
+  for (const auto& pairMatches : putativeMatches)
+  {
+    const Pair& imagePair = pairMatches.first;
+
+    //-- Apply the geometric filter (robust model estimation)
+    MatchesPerDescType inliers;
+    GeometryFunctor geometricFilter = functor; // use a copy since the estimation stores the model
+    geometricFilter.m_guidedMatchingGrids = guidedMatchingGrids;
+    geometricFilter.m_workspace = &workspace;
+    const EstimationStatus state = geometricFilter.geometricEstimation(_sfm_data, _regionsPerView, imagePair, *pairMatches.second, inliers);
+    if (state.hasStrongSupport)
+    {
+      if (b_guided_matching)
+      {
+        MatchesPerDescType guided_geometric_inliers;
+        geometricFilter.Geometry_guided_matching(_sfm_data, _regionsPerView, imagePair, d_distance_ratio, guided_geometric_inliers);
+        //ALICEVISION_LOG_DEBUG("#before/#after: " << putative_inliers.size() << "/" << guided_geometric_inliers.size());
+        std::swap(inliers, guided_geometric_inliers);
+      }
+      geometricMatches.emplace_back(imagePair, std::move(inliers));
+    }
+  }
+}
+
+template<typename GeometryFunctor>
+void GeometricFilter::robustModelEstimationBatches(
+  const GeometryFunctor & functor,
+  std::size_t nbPairs,
+  const std::set<IndexT> & viewIds,
+  const std::function<std::size_t(std::size_t)> & nbMatches,
+  const std::function<void(std::size_t, std::size_t, std::vector<MatchesPerDescType>&, std::vector<std::pair<Pair, const MatchesPerDescType*>>&)> & getBatch,
+  const bool b_guided_matching,
+  const double d_distance_ratio)
+{
+  // Spatial grids of the features, built once per view for the guided matching of all the pairs
+  GuidedMatchingGrids guidedMatchingGrids;
+  if (b_guided_matching)
+    guidedMatchingGrids.build(*_sfm_data, _regionsPerView, viewIds);
+
+  // Batches of consecutive pairs with at least batchNbMatches putative matches,
+  // so the small pairs are filtered together
+  std::vector<std::size_t> batchFirstPair(1, 0);
+  std::size_t batchMatches = 0;
+  for (std::size_t i = 0; i < nbPairs; ++i)
+  {
+    batchMatches += nbMatches(i);
+    if (batchMatches >= batchNbMatches)
+    {
+      batchFirstPair.push_back(i + 1);
+      batchMatches = 0;
+    }
+  }
+  if (batchFirstPair.back() != nbPairs)
+    batchFirstPair.push_back(nbPairs);
+
+  boost::progress_display my_progress_bar( nbPairs );
+
+  #pragma omp parallel
+  {
+    GeometricFilterWorkspace workspace;
+    std::vector<MatchesPerDescType> putativeMatchesBuffers;
+    std::vector<std::pair<Pair, const MatchesPerDescType*>> putativeMatches;
+    std::vector<std::pair<Pair, MatchesPerDescType>> geometricMatches;
+
+    #pragma omp for schedule(dynamic)
+    for (int b = 0; b < (int)batchFirstPair.size() - 1; ++b)
+    {
+      putativeMatches.clear();
+      geometricMatches.clear();
+      getBatch(batchFirstPair[b], batchFirstPair[b + 1], putativeMatchesBuffers, putativeMatches);
+      Robust_model_estimation_batch(functor, putativeMatches, &guidedMatchingGrids, workspace, b_guided_matching, d_distance_ratio, geometricMatches);
+
+      #pragma omp critical
+      {
+        for (auto& pairMatches : geometricMatches)
+          _map_GeometricMatches.insert(std::move(pairMatches));
+        my_progress_bar += putativeMatches.size();
+      }
+    }
+  }
+}
+
 template<typename GeometryFunctor>
 void GeometricFilter::Robust_model_estimation(
   const GeometryFunctor & functor,
@@ -57,46 +205,65 @@ void GeometricFilter::Robust_model_estimation(
   const bool b_guided_matching,
   const double d_distance_ratio)
 {
-  boost::progress_display my_progress_bar( putative_matches.size() );
-  
-  #pragma omp parallel for schedule(dynamic)
-  for (int i = 0; i < (int)putative_matches.size(); ++i)
+  std::set<IndexT> viewIds;
+  std::vector<PairwiseMatches::const_iterator> pairs;
+  pairs.reserve(putative_matches.size());
+  for (PairwiseMatches::const_iterator it = putative_matches.begin(); it != putative_matches.end(); ++it)
   {
-    PairwiseMatches::const_iterator iter = putative_matches.begin();
-    advance(iter,i);
+    viewIds.insert(it->first.first);
+    viewIds.insert(it->first.second);
+    pairs.push_back(it);
+  }
 
-    Pair current_pair = iter->first;
-    const MatchesPerDescType & putativeMatchesPerType = iter->second;
-    const Pair& imagePair = iter->first;
+  robustModelEstimationBatches(functor, pairs.size(), viewIds,
+    [&](std::size_t i) { return std::size_t(pairs[i]->second.getNbAllMatches()); },
+    [&](std::size_t first, std::size_t last, std::vector<MatchesPerDescType>&, std::vector<std::pair<Pair, const MatchesPerDescType*>>& batch)
+    {
+      for (std::size_t i = first; i < last; ++i)
+        batch.emplace_back(pairs[i]->first, &pairs[i]->second);
+    },
+    b_guided_matching, d_distance_ratio);
+}
 
-    //-- Apply the geometric filter (robust model estimation)
+template<typename GeometryFunctor>
+void GeometricFilter::Robust_model_estimation(
+  const GeometryFunctor & functor,
+  const PackedPairwiseMatches & putative_matches,
+  const bool b_guided_matching,
+  const double d_distance_ratio)
+{
+  std::set<IndexT> viewIds;
+  for (const Pair& pair : putative_matches.getImagePairs())
+  {
+    viewIds.insert(pair.first);
+    viewIds.insert(pair.second);
+  }
+
+  robustModelEstimationBatches(functor, putative_matches.size(), viewIds,
+    [&](std::size_t i) { return std::size_t(putative_matches.pairAt(i).second.getNbAllMatches()); },
+    [&](std::size_t first, std::size_t last, std::vector<MatchesPerDescType>& buffers, std::vector<std::pair<Pair, const MatchesPerDescType*>>& batch)
     {
-      MatchesPerDescType inliers;
-      GeometryFunctor geometricFilter = functor; // use a copy since we are in a multi-thread context
-      const EstimationStatus state = geometricFilter.geometricEstimation(_sfm_data, _regionsPerView, imagePair, putativeMatchesPerType, inliers);
-      if (state.hasStrongSupport)
+      // the putative matches are copied in the buffers of the thread, their vectors keep their capacity between the batches
+      if (buffers.size() < last - first)
+        buffers.resize(last - first);
+      for (std::size_t i = first; i < last; ++i)
       {
-        if (b_guided_matching)
+        const auto pairMatches = putative_matches.pairAt(i);
+        MatchesPerDescType& putativeMatchesPerType = buffers[i - first];
+        for (auto it = putativeMatchesPerType.begin(); it != putativeMatchesPerType.end();)
         {
-          MatchesPerDescType guided_geometric_inliers;
-          geometricFilter.Geometry_guided_matching(_sfm_data, _regionsPerView, imagePair, d_distance_ratio, guided_geometric_inliers);
-          //ALICEVISION_LOG_DEBUG("#before/#after: " << putative_inliers.size() << "/" << guided_geometric_inliers.size());
-          std::swap(inliers, guided_geometric_inliers);
-        }
-        #pragma omp critical
-        {
-          _map_GeometricMatches.insert(std::make_pair(current_pair, std::move(inliers)));
+          if (pairMatches.second.count(it->first) == 0)
+            it = putativeMatchesPerType.erase(it);
+          else
+            ++it;
         }
+        for (const auto& matchesIt : pairMatches.second)
+          putativeMatchesPerType[matchesIt.first].assign(matchesIt.second.begin(), matchesIt.second.end());
+        batch.emplace_back(pairMatches.first, &putativeMatchesPerType);
       }
-    }
-    #pragma omp critical
-    {
-      ++my_progress_bar;
-    }
-  }
+    },
+    b_guided_matching, d_distance_ratio);
 }
 
 } // namespace aliceVision
 } // namespace matchingImageCollection
-
-
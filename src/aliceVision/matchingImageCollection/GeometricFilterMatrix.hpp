@@ -23,6 +23,9 @@ class SfMData;
 
 namespace matchingImageCollection {
 
+class GuidedMatchingGrids;
+struct GeometricFilterWorkspace;
+
 
 struct GeometricFilterMatrix
 {
@@ -56,6 +59,10 @@ struct GeometricFilterMatrix
   double m_dPrecision;  //upper_bound precision used for robust estimation
   double m_dPrecision_robust;
   std::size_t m_stIteration; //maximal number of iteration for robust estimation
+  /// Optional spatial grids of the features shared between the pairs for the guided matching (built per pair if NULL)
+  const GuidedMatchingGrids * m_guidedMatchingGrids = nullptr;
+  /// Optional buffers reused between the pairs filtered by a thread (temporary buffers are used if NULL)
+  GeometricFilterWorkspace * m_workspace = nullptr;
 };
 
 
@@ -17,6 +17,7 @@
 #include "aliceVision/sfm/SfMData.hpp"
 #include "aliceVision/feature/RegionsPerView.hpp"
 #include "aliceVision/matchingImageCollection/GeometricFilterMatrix.hpp"
+#include "aliceVision/matchingImageCollection/GeometricFilterWorkspace.hpp"
 
 namespace aliceVision {
 namespace matchingImageCollection {
@@ -69,7 +70,10 @@ struct GeometricFilterMatrix_E_AC : public GeometricFilterMatrix
       return EstimationStatus(false, false);
 
     // Get corresponding point regions arrays
-    Mat xI,xJ;
+    std::unique_ptr<GeometricFilterWorkspace> localWorkspace;
+    GeometricFilterWorkspace& workspace = getWorkspace(m_workspace, localWorkspace);
+    Mat& xI = workspace.xI;
+    Mat& xJ = workspace.xJ;
     MatchesPairToMat(pairIndex, putativeMatchesPerType, sfmData, regionsPerView, descTypes, xI, xJ);
 
     // Define the AContrario adapted Essential matrix solver
@@ -91,8 +95,8 @@ struct GeometricFilterMatrix_E_AC : public GeometricFilterMatrix
     // Robustly estimate the Essential matrix with A Contrario ransac
     const double upper_bound_precision = Square(m_dPrecision);
 
-    std::vector<size_t> inliers;
-    const std::pair<double,double> ACRansacOut = ACRANSAC(kernel, inliers, m_stIteration, &m_E, upper_bound_precision);
+    std::vector<size_t>& inliers = workspace.inliers;
+    const std::pair<double,double> ACRansacOut = ACRANSAC(kernel, workspace.acRansac, inliers, m_stIteration, &m_E, upper_bound_precision);
 
     if (inliers.empty())
       return EstimationStatus(false, false);
@@ -158,12 +162,14 @@ struct GeometricFilterMatrix_E_AC : public GeometricFilterMatrix
       Mat3 F;
       FundamentalFromEssential(m_E, ptrPinhole_I->K(), ptrPinhole_J->K(), &F);
 
-      robustEstimation::GuidedMatching<Mat3,
-            aliceVision::fundamental::kernel::EpipolarDistanceError>(
-            //aliceVision::fundamental::kernel::SymmetricEpipolarDistanceError>(
+      guidedMatchingWithGrids<Mat3,
+            aliceVision::fundamental::kernel::EpipolarDistanceError,
+            robustEstimation::EpipolarLineSearch>(
         F,
-        cam_I, regionsPerView.getAllRegions(viewId_I),
-        cam_J, regionsPerView.getAllRegions(viewId_J),
+        m_guidedMatchingGrids,
+        regionsPerView,
+        imageIdsPair,
+        cam_I, cam_J,
         Square(m_dPrecision_robust), Square(dDistanceRatio),
         matches);
     }
@@ -6,7 +6,9 @@
 #pragma once
 
 #include "aliceVision/matchingImageCollection/GeometricFilterMatrix.hpp"
+#include "aliceVision/matchingImageCollection/GeometricFilterWorkspace.hpp"
 #include "aliceVision/matchingImageCollection/geometricFilterUtils.hpp"
+#include "aliceVision/matchingImageCollection/GuidedMatchingGrids.hpp"
 #include "aliceVision/matching/IndMatch.hpp"
 #include "aliceVision/multiview/fundamentalKernelSolver.hpp"
 #include "aliceVision/multiview/essential.hpp"
@@ -96,12 +98,16 @@ struct GeometricFilterMatrix_F_AC: public GeometricFilterMatrix
     if(descTypes.empty())
       return EstimationStatus(false, false);
 
+    std::unique_ptr<GeometricFilterWorkspace> localWorkspace;
+    GeometricFilterWorkspace& workspace = getWorkspace(m_workspace, localWorkspace);
+
     // Retrieve all 2D features as undistorted positions into flat arrays
-    Mat xI, xJ;
+    Mat& xI = workspace.xI;
+    Mat& xJ = workspace.xJ;
     MatchesPairToMat(putativeMatchesPerType, cam_I, cam_J,
                      region_I, region_J,
                      descTypes, xI, xJ);
-    std::vector<size_t> inliers;
+    std::vector<size_t>& inliers = workspace.inliers;
 
     std::pair<bool, std::size_t> estimationPair = geometricEstimation_Mat(
         xI, xJ,
@@ -167,10 +173,13 @@ struct GeometricFilterMatrix_F_AC: public GeometricFilterMatrix
           xI, imageSizeI.first, imageSizeI.second,
           xJ, imageSizeJ.first, imageSizeJ.second, true);
 
+        std::unique_ptr<GeometricFilterWorkspace> localWorkspace;
+        GeometricFilterWorkspace& workspace = getWorkspace(m_workspace, localWorkspace);
+
         // Robustly estimate the Fundamental matrix with A Contrario ransac
         const double upper_bound_precision = Square(m_dPrecision);
         const std::pair<double,double> ACRansacOut =
-          ACRANSAC(kernel, out_inliers, m_stIteration, &m_F, upper_bound_precision);
+          ACRANSAC(kernel, workspace.acRansac, out_inliers, m_stIteration, &m_F, upper_bound_precision);
 
         if(out_inliers.empty())
           return std::make_pair(false, KernelType::MINIMUM_SAMPLES);
@@ -251,13 +260,15 @@ struct GeometricFilterMatrix_F_AC: public GeometricFilterMatrix
           sfmData->GetIntrinsics().at(view_J->getIntrinsicId()).get() : nullptr;
 
       // Check the features correspondences that agree in the geometric and photometric domain
-      robustEstimation::GuidedMatching<Mat3,
-                                     fundamental::kernel::EpipolarDistanceError>(
+      // (only the features close to the epipolar lines are tested)
+      guidedMatchingWithGrids<Mat3,
+                              fundamental::kernel::EpipolarDistanceError,
+                              robustEstimation::EpipolarLineSearch>(
         m_F,
-        cam_I, // camera::IntrinsicBase
-        regionsPerView.getAllRegions(viewId_I), // feature::Regions
-        cam_J, // camera::IntrinsicBase
-        regionsPerView.getAllRegions(viewId_J), // feature::Regions
+        m_guidedMatchingGrids,
+        regionsPerView,
+        imageIdsPair,
+        cam_I, cam_J,
         Square(m_dPrecision_robust), Square(dDistanceRatio),
         matches);
     }
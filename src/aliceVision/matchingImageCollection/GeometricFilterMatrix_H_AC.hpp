@@ -15,6 +15,8 @@
 #include "aliceVision/sfm/SfMData.hpp"
 #include "aliceVision/feature/RegionsPerView.hpp"
 #include "aliceVision/matchingImageCollection/GeometricFilterMatrix.hpp"
+#include "aliceVision/matchingImageCollection/GeometricFilterWorkspace.hpp"
+#include "aliceVision/matchingImageCollection/GuidedMatchingGrids.hpp"
 
 namespace aliceVision {
 namespace matchingImageCollection {
@@ -54,7 +56,10 @@ struct GeometricFilterMatrix_H_AC : public GeometricFilterMatrix
       return EstimationStatus(false, false);
 
     // Retrieve all 2D features as undistorted positions into flat arrays
-    Mat xI, xJ;
+    std::unique_ptr<GeometricFilterWorkspace> localWorkspace;
+    GeometricFilterWorkspace& workspace = getWorkspace(m_workspace, localWorkspace);
+    Mat& xI = workspace.xI;
+    Mat& xJ = workspace.xJ;
     MatchesPairToMat(pairIndex, putativeMatchesPerType, sfmData, regionsPerView, descTypes, xI, xJ);
 
     // Define the AContrario adapted Homography matrix solver
@@ -73,8 +78,8 @@ struct GeometricFilterMatrix_H_AC : public GeometricFilterMatrix
     // Robustly estimate the Homography matrix with A Contrario ransac
     const double upper_bound_precision = Square(m_dPrecision);
 
-    std::vector<size_t> inliers;
-    const std::pair<double,double> ACRansacOut = ACRANSAC(kernel, inliers, m_stIteration, &m_H, upper_bound_precision);
+    std::vector<size_t>& inliers = workspace.inliers;
+    const std::pair<double,double> ACRansacOut = ACRANSAC(kernel, workspace.acRansac, inliers, m_stIteration, &m_H, upper_bound_precision);
 
     if (inliers.empty())
       return EstimationStatus(false, false);
@@ -234,11 +239,14 @@ struct GeometricFilterMatrix_H_AC : public GeometricFilterMatrix
       else
       {
         // Filtering based on region positions and regions descriptors
-        robustEstimation::GuidedMatching
-          <Mat3, aliceVision::homography::kernel::AsymmetricError>(
+        // (only the features close to the transferred points are tested)
+        guidedMatchingWithGrids
+          <Mat3, aliceVision::homography::kernel::AsymmetricError, robustEstimation::TransferredPointSearch>(
           m_H,
-          cam_I, regionsPerView.getAllRegions(viewId_I),
-          cam_J, regionsPerView.getAllRegions(viewId_J),
+          m_guidedMatchingGrids,
+          regionsPerView,
+          imageIdsPair,
+          cam_I, cam_J,
           Square(m_dPrecision_robust), Square(dDistanceRatio),
           matches);
       }
@@ -0,0 +1,48 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include "aliceVision/numeric/numeric.hpp"
+#include "aliceVision/robustEstimation/ACRansac.hpp"
+
+#include <memory>
+#include <vector>
+
+namespace aliceVision {
+namespace matchingImageCollection {
+
+/**
+ * @brief Buffers of the geometric filters, reused between the pairs filtered by a thread.
+ *
+ * The ACRANSAC buffers (residuals, sampling indices, log combination tables and
+ * random generator) are the main gain: without a workspace they are allocated
+ * per pair and the samples are drawn with a new generator at each iteration.
+ */
+struct GeometricFilterWorkspace
+{
+  /// Undistorted positions of the putative matches in the two images
+  Mat xI, xJ;
+  /// Inlier indexes of the estimated model
+  std::vector<std::size_t> inliers;
+  robustEstimation::ACRansacWorkspace acRansac;
+};
+
+/**
+ * @brief Get a workspace, or create a temporary one if there is none.
+ * @param[in] workspace The workspace of the filter (can be NULL).
+ * @param[out] localWorkspace Owner of the temporary workspace.
+ * @return the workspace to use
+ */
+inline GeometricFilterWorkspace& getWorkspace(GeometricFilterWorkspace* workspace, std::unique_ptr<GeometricFilterWorkspace>& localWorkspace)
+{
+  if(workspace)
+    return *workspace;
+  localWorkspace.reset(new GeometricFilterWorkspace());
+  return *localWorkspace;
+}
+
+} // namespace matchingImageCollection
+} // namespace aliceVision
@@ -0,0 +1,72 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "GuidedMatchingGrids.hpp"
+
+#include <vector>
+
+namespace aliceVision {
+namespace matchingImageCollection {
+
+void GuidedMatchingGrids::build(const sfm::SfMData& sfmData,
+                                const feature::RegionsPerView& regionsPerView,
+                                const std::set<IndexT>& viewIds)
+{
+  // create the entries first, the grids are built in parallel
+  std::vector<std::pair<IndexT, feature::EImageDescriberType>> entries;
+  for(const IndexT viewId : viewIds)
+  {
+    if(!regionsPerView.viewExist(viewId))
+      continue;
+    for(const auto& regionsIt : regionsPerView.getAllRegions(viewId))
+    {
+      _grids[viewId][regionsIt.first];
+      entries.emplace_back(viewId, regionsIt.first);
+    }
+  }
+
+  #pragma omp parallel for schedule(dynamic)
+  for(int i = 0; i < static_cast<int>(entries.size()); ++i)
+  {
+    const IndexT viewId = entries[i].first;
+    const feature::EImageDescriberType descType = entries[i].second;
+
+    const sfm::View& view = *sfmData.views.at(viewId);
+    const camera::IntrinsicBase* cam = sfmData.GetIntrinsics().count(view.getIntrinsicId()) ?
+                                         sfmData.GetIntrinsics().at(view.getIntrinsicId()).get() : nullptr;
+
+    _grids.at(viewId).at(descType) = createGrid(cam, regionsPerView.getRegions(viewId, descType));
+  }
+}
+
+const robustEstimation::FeaturesGrid* GuidedMatchingGrids::getGrid(IndexT viewId, feature::EImageDescriberType descType) const
+{
+  const auto viewIt = _grids.find(viewId);
+  if(viewIt == _grids.end())
+    return nullptr;
+  const auto gridIt = viewIt->second.find(descType);
+  if(gridIt == viewIt->second.end())
+    return nullptr;
+  return &gridIt->second;
+}
+
+robustEstimation::FeaturesGrid GuidedMatchingGrids::createGrid(const camera::IntrinsicBase* cam, const feature::Regions& regions)
+{
+  std::vector<Vec2> positions(regions.RegionCount());
+  if(cam && cam->isValid())
+  {
+    for(std::size_t i = 0; i < regions.RegionCount(); ++i)
+      positions[i] = cam->get_ud_pixel(regions.GetRegionPosition(i));
+  }
+  else
+  {
+    for(std::size_t i = 0; i < regions.RegionCount(); ++i)
+      positions[i] = regions.GetRegionPosition(i);
+  }
+  return robustEstimation::FeaturesGrid(positions);
+}
+
+} // namespace matchingImageCollection
+} // namespace aliceVision
@@ -0,0 +1,114 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include "aliceVision/camera/IntrinsicBase.hpp"
+#include "aliceVision/feature/RegionsPerView.hpp"
+#include "aliceVision/matching/IndMatch.hpp"
+#include "aliceVision/robustEstimation/FeaturesGrid.hpp"
+#include "aliceVision/robustEstimation/guidedMatching.hpp"
+#include "aliceVision/sfm/SfMData.hpp"
+
+#include <map>
+#include <set>
+
+namespace aliceVision {
+namespace matchingImageCollection {
+
+/**
+ * @brief Spatial grids of the undistorted feature positions of the views,
+ * built once and shared by the guided matching of all the pairs.
+ */
+class GuidedMatchingGrids
+{
+public:
+  /**
+   * @brief Build the grids of the regions of the given views.
+   * @param[in] sfmData The SfMData, for the view intrinsics.
+   * @param[in] regionsPerView The regions of the views.
+   * @param[in] viewIds The views to index.
+   */
+  void build(const sfm::SfMData& sfmData,
+             const feature::RegionsPerView& regionsPerView,
+             const std::set<IndexT>& viewIds);
+
+  /**
+   * @brief Get the grid of the regions of a view.
+   * @return the grid or nullptr if the view is not indexed
+   */
+  const robustEstimation::FeaturesGrid* getGrid(IndexT viewId, feature::EImageDescriberType descType) const;
+
+  /**
+   * @brief Create the grid of the (undistorted) positions of regions.
+   * @param[in] cam Optional camera, to undistort the feature positions (can be NULL).
+   * @param[in] regions The regions.
+   */
+  static robustEstimation::FeaturesGrid createGrid(const camera::IntrinsicBase* cam, const feature::Regions& regions);
+
+private:
+  std::map<IndexT, std::map<feature::EImageDescriberType, robustEstimation::FeaturesGrid>> _grids;
+};
+
+/**
+ * @brief Guided matching of all the common describer types of a pair with spatial grids.
+ * The grids are taken from the shared grids if available, otherwise they are built for the pair.
+ * @param[in] mod The model.
+ * @param[in] grids Optional shared grids (can be NULL).
+ * @param[in] regionsPerView The regions of the views.
+ * @param[in] imageIdsPair The pair of views.
+ * @param[in] camI Optional camera of the first view (can be NULL).
+ * @param[in] camJ Optional camera of the second view (can be NULL).
+ * @param[in] errorTh Maximal authorized error threshold.
+ * @param[in] distRatio Maximal authorized distance ratio.
+ * @param[out] out_matchesPerDesc The matches per describer type.
+ */
+template<
+  typename ModelArg,  // The used model type
+  typename ErrorArg,  // The metric to compute distance to the model
+  typename SearchArg  // The search of the features compatible with the model
+  >
+void guidedMatchingWithGrids(
+  const ModelArg & mod,
+  const GuidedMatchingGrids * grids,
+  const feature::RegionsPerView & regionsPerView,
+  const Pair imageIdsPair,
+  const camera::IntrinsicBase * camI,
+  const camera::IntrinsicBase * camJ,
+  double errorTh,
+  double distRatio,
+  matching::MatchesPerDescType & out_matchesPerDesc)
+{
+  const std::vector<feature::EImageDescriberType> descTypes = regionsPerView.getCommonDescTypes(imageIdsPair);
+
+  for(const feature::EImageDescriberType descType : descTypes)
+  {
+    const feature::Regions & regionsI = regionsPerView.getRegions(imageIdsPair.first, descType);
+    const feature::Regions & regionsJ = regionsPerView.getRegions(imageIdsPair.second, descType);
+
+    const robustEstimation::FeaturesGrid * gridI = grids ? grids->getGrid(imageIdsPair.first, descType) : nullptr;
+    const robustEstimation::FeaturesGrid * gridJ = grids ? grids->getGrid(imageIdsPair.second, descType) : nullptr;
+
+    // build the missing grids for this pair only
+    robustEstimation::FeaturesGrid localGridI;
+    robustEstimation::FeaturesGrid localGridJ;
+    if(!gridI)
+    {
+      localGridI = GuidedMatchingGrids::createGrid(camI, regionsI);
+      gridI = &localGridI;
+    }
+    if(!gridJ)
+    {
+      localGridJ = GuidedMatchingGrids::createGrid(camJ, regionsJ);
+      gridJ = &localGridJ;
+    }
+
+    robustEstimation::GuidedMatching_Grid<ModelArg, ErrorArg, SearchArg>(
+      mod, *gridI, regionsI, *gridJ, regionsJ, errorTh, distRatio, out_matchesPerDesc[descType]);
+  }
+}
+
+} // namespace matchingImageCollection
+} // namespace aliceVision
@@ -22,11 +22,20 @@ using namespace aliceVision::matching;
 using namespace aliceVision::feature;
 
 ImageCollectionMatcher_generic::ImageCollectionMatcher_generic(
-  float distRatio, EMatcherType matcherType)
+  float distRatio, EMatcherType matcherType, bool prebuildIndexes)
   : IImageCollectionMatcher()
   , _f_dist_ratio(distRatio)
   , _matcherType(matcherType)
+  , _prebuildIndexes(prebuildIndexes)
 {
+  // the FLANN k-d trees are randomized with the global rand(): they cannot be built
+  // in parallel reproducibly, prebuilding them would only keep them all in memory
+  if (_prebuildIndexes && _matcherType == ANN_L2)
+  {
+    ALICEVISION_LOG_WARNING("The matching structures cannot be prebuilt with the ANN_L2 matcher, "
+                            "they are built for each image during the matching.");
+    _prebuildIndexes = false;
+  }
 }
 
 void ImageCollectionMatcher_generic::Match(
@@ -52,9 +61,29 @@ void ImageCollectionMatcher_generic::Match(
     map_Pairs[iter->first].push_back(iter->second);
   }
 
+  // Build the matching structures of the database views in parallel,
+  // the pairs are then matched with the queries searched in parallel
+  std::vector<matching::RegionsDatabaseMatcher> prebuiltMatchers;
+  if (_prebuildIndexes)
+  {
+    std::vector<size_t> databaseViews;
+    for (const auto& pairsPerView : map_Pairs)
+      databaseViews.push_back(pairsPerView.first);
+
+    prebuiltMatchers.resize(databaseViews.size());
+    #pragma omp parallel for schedule(dynamic)
+    for (int i = 0; i < (int)databaseViews.size(); ++i)
+    {
+      const feature::Regions & regionsI = regionsPerView.getRegions(databaseViews[i], descType);
+      if (regionsI.RegionCount() > 0)
+        prebuiltMatchers[i] = matching::RegionsDatabaseMatcher(_matcherType, regionsI);
+    }
+  }
+
   // Perform matching between all the pairs
+  std::size_t databaseIndex = 0;
   for (Map_vectorT::const_iterator iter = map_Pairs.begin();
-    iter != map_Pairs.end(); ++iter)
+    iter != map_Pairs.end(); ++iter, ++databaseIndex)
   {
     const size_t I = iter->first;
     const std::vector<size_t> & indexToCompare = iter->second;
@@ -66,8 +95,11 @@ void ImageCollectionMatcher_generic::Match(
       continue;
     }
 
-    // Initialize the matching interface
-    matching::RegionsDatabaseMatcher matcher(_matcherType, regionsI);
+    // Initialize the matching interface, it is reused for all the pairs of the database view
+    matching::RegionsDatabaseMatcher builtMatcher;
+    if (!_prebuildIndexes)
+      builtMatcher = matching::RegionsDatabaseMatcher(_matcherType, regionsI);
+    const matching::RegionsDatabaseMatcher & matcher = _prebuildIndexes ? prebuiltMatchers[databaseIndex] : builtMatcher;
 
     #pragma omp parallel for schedule(dynamic) if(b_multithreaded_pair_search)
     for (int j = 0; j < (int)indexToCompare.size(); ++j)
@@ -21,9 +21,17 @@ namespace matchingImageCollection {
 class ImageCollectionMatcher_generic : public IImageCollectionMatcher
 {
   public:
+  /**
+   * @param[in] dist_ratio The distance ratio used to discard spurious correspondences.
+   * @param[in] matcherType The matcher type.
+   * @param[in] prebuildIndexes Build the matching structures of all the database views before matching
+   *            the pairs, in parallel (all of them are kept in memory). Not available with ANN_L2,
+   *            whose k-d trees cannot be built in parallel reproducibly.
+   */
   ImageCollectionMatcher_generic(
     float dist_ratio,
-    matching::EMatcherType matcherType
+    matching::EMatcherType matcherType,
+    bool prebuildIndexes = false
   );
 
   /// Find corresponding points between some pair of view Ids
@@ -40,6 +48,8 @@ class ImageCollectionMatcher_generic : public IImageCollectionMatcher
   float _f_dist_ratio;
   // Matcher Type
   matching::EMatcherType _matcherType;
+  // Build all the matching structures before matching
+  bool _prebuildIndexes;
 };
 
 } // namespace aliceVision
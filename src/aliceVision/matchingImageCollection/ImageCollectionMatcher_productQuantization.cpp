@@ -0,0 +1,224 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "aliceVision/matchingImageCollection/ImageCollectionMatcher_productQuantization.hpp"
+#include "aliceVision/matching/ArrayMatcher_productQuantization.hpp"
+#include "aliceVision/matching/RegionsMatcher.hpp"
+#include <aliceVision/config.hpp>
+
+#include <dependencies/stlplus3/filesystemSimplified/file_system.hpp>
+
+#include <boost/progress.hpp>
+
+#include <stdexcept>
+
+namespace aliceVision {
+namespace matchingImageCollection {
+
+using namespace aliceVision::matching;
+using namespace aliceVision::feature;
+
+ImageCollectionMatcher_productQuantization
+::ImageCollectionMatcher_productQuantization
+(
+  float distRatio
+):IImageCollectionMatcher(), _f_dist_ratio(distRatio)
+{
+}
+
+namespace impl
+{
+template <typename ScalarT>
+void MatchProductQuantization
+(
+  const feature::RegionsPerView& regionsPerView,
+  const PairSet & pairs,
+  EImageDescriberType descType,
+  float fDistRatio,
+  const std::string& loadCodebookPath,
+  const std::string& saveCodebookPath,
+  PairwiseMatches & map_PutativesMatches // the pairwise photometric corresponding points
+)
+{
+  // maximum number of descriptors used to train the codebook
+  const std::size_t maxTrainingRows = 65536;
+
+  // Collect used view indexes
+  std::set<IndexT> used_index;
+  // Sort pairs according the first index to minimize the matcher build operations
+  typedef std::map<IndexT, std::vector<IndexT> > Map_vectorT;
+  Map_vectorT map_Pairs;
+  for (PairSet::const_iterator iter = pairs.begin(); iter != pairs.end(); ++iter)
+  {
+    map_Pairs[iter->first].push_back(iter->second);
+    used_index.insert(iter->first);
+    used_index.insert(iter->second);
+  }
+
+  if (used_index.empty())
+    return;
+
+  const std::size_t dimension = regionsPerView.getRegions(*used_index.begin(), descType).DescriptorLength();
+
+  std::shared_ptr<ProductQuantizer> quantizer = std::make_shared<ProductQuantizer>();
+  if (!loadCodebookPath.empty())
+  {
+    quantizer->load(loadCodebookPath);
+    if (quantizer->dimension() != dimension)
+      throw std::runtime_error("The product quantizer " + loadCodebookPath + " has " + std::to_string(quantizer->dimension())
+                               + " dimensions instead of " + std::to_string(dimension));
+    ALICEVISION_LOG_INFO("Product quantizer loaded: " << loadCodebookPath);
+  }
+  else
+  {
+    // Train one codebook on descriptors sampled in all the views
+    const std::size_t nbRowsPerView = std::max(std::size_t(1), maxTrainingRows / used_index.size());
+    std::vector<ScalarT> trainingData;
+    for (const IndexT I : used_index)
+    {
+      const feature::Regions & regionsI = regionsPerView.getRegions(I, descType);
+      const ScalarT * tabI = reinterpret_cast<const ScalarT*>(regionsI.DescriptorRawData());
+      const std::size_t nbRows = std::min(nbRowsPerView, regionsI.RegionCount());
+      for (std::size_t i = 0; i < nbRows; ++i)
+      {
+        const ScalarT * row = tabI + (i * regionsI.RegionCount() / nbRows) * dimension;
+        trainingData.insert(trainingData.end(), row, row + dimension);
+      }
+    }
+    if (trainingData.empty())
+      return;
+    quantizer->train(trainingData.data(), trainingData.size() / dimension, dimension,
+                     ProductQuantizer::defaultNbSubspaces(dimension), 256, 12, maxTrainingRows);
+  }
+
+  if (!saveCodebookPath.empty())
+  {
+    quantizer->save(saveCodebookPath);
+    ALICEVISION_LOG_INFO("Product quantizer saved: " << saveCodebookPath);
+  }
+
+  // Encode the regions of each view once
+  std::map<IndexT, std::shared_ptr<std::vector<std::uint8_t>>> codesPerView;
+  for (const IndexT I : used_index)
+    codesPerView[I] = std::make_shared<std::vector<std::uint8_t>>();
+
+  #pragma omp parallel for schedule(dynamic)
+  for (int i = 0; i < static_cast<int>(used_index.size()); ++i)
+  {
+    std::set<IndexT>::const_iterator iter = used_index.begin();
+    std::advance(iter, i);
+    const feature::Regions & regionsI = regionsPerView.getRegions(*iter, descType);
+    const ScalarT * tabI = reinterpret_cast<const ScalarT*>(regionsI.DescriptorRawData());
+    quantizer->encode(tabI, regionsI.RegionCount(), *codesPerView.at(*iter));
+  }
+
+  ALICEVISION_LOG_INFO("Product quantization: " << used_index.size() << " views encoded with " << quantizer->codeSize()
+                       << " bytes per descriptor instead of " << dimension * sizeof(ScalarT) << " bytes.");
+
+  boost::progress_display my_progress_bar( pairs.size() );
+
+  // Perform matching between all the pairs
+  for (Map_vectorT::const_iterator iter = map_Pairs.begin();
+    iter != map_Pairs.end(); ++iter)
+  {
+    const IndexT I = iter->first;
+    const std::vector<IndexT> & indexToCompare = iter->second;
+
+    const feature::Regions & regionsI = regionsPerView.getRegions(I, descType);
+    if (regionsI.RegionCount() == 0)
+    {
+      my_progress_bar += indexToCompare.size();
+      continue;
+    }
+
+    // Initialize the matching interface with the shared codebook and the codes of the view
+    typedef ArrayMatcher_productQuantization<ScalarT> MatcherT;
+    RegionsMatcher<MatcherT> matcher(regionsI, MatcherT(quantizer, codesPerView.at(I)), true);
+
+    #pragma omp parallel for schedule(dynamic)
+    for (int j = 0; j < (int)indexToCompare.size(); ++j)
+    {
+      const IndexT J = indexToCompare[j];
+
+      const feature::Regions & regionsJ = regionsPerView.getRegions(J, descType);
+      if (regionsJ.RegionCount() == 0
+          || regionsI.Type_id() != regionsJ.Type_id())
+      {
+        #pragma omp critical
+        ++my_progress_bar;
+        continue;
+      }
+
+      IndMatches vec_putatives_matches;
+      matcher.Match(fDistRatio, regionsJ, vec_putatives_matches);
+      #pragma omp critical
+      {
+        ++my_progress_bar;
+        if (!vec_putatives_matches.empty())
+        {
+          map_PutativesMatches[std::make_pair(I,J)].emplace(descType, std::move(vec_putatives_matches));
+        }
+      }
+    }
+  }
+}
+} // namespace impl
+
+void ImageCollectionMatcher_productQuantization::Match
+(
+  const sfm::SfMData & sfm_data,
+  const feature::RegionsPerView& regionsPerView,
+  const PairSet & pairs,
+  feature::EImageDescriberType descType,
+  PairwiseMatches & map_PutativesMatches // the pairwise photometric corresponding points
+) const
+{
+#if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_OPENMP)
+  ALICEVISION_LOG_DEBUG("Using the OPENMP thread interface");
+#endif
+
+  if (regionsPerView.isEmpty())
+    return;
+
+  const feature::Regions& regions = regionsPerView.getFirstViewRegions(descType);
+
+  if (regions.IsBinary())
+    return;
+
+  const std::string codebookFilename = EImageDescriberType_enumToString(descType) + ".pq";
+  const std::string loadCodebookPath = _loadCodebooksFolder.empty() ? "" : stlplus::create_filespec(_loadCodebooksFolder, codebookFilename);
+  const std::string saveCodebookPath = _saveCodebooksFolder.empty() ? "" : stlplus::create_filespec(_saveCodebooksFolder, codebookFilename);
+
+  if(regions.Type_id() == typeid(unsigned char).name())
+  {
+    impl::MatchProductQuantization<unsigned char>(
+      regionsPerView,
+      pairs,
+      descType,
+      _f_dist_ratio,
+      loadCodebookPath,
+      saveCodebookPath,
+      map_PutativesMatches);
+  }
+  else
+  if(regions.Type_id() == typeid(float).name())
+  {
+    impl::MatchProductQuantization<float>(
+      regionsPerView,
+      pairs,
+      descType,
+      _f_dist_ratio,
+      loadCodebookPath,
+      saveCodebookPath,
+      map_PutativesMatches);
+  }
+  else
+  {
+    ALICEVISION_LOG_WARNING("Matcher not implemented for this region type");
+  }
+}
+
+} // namespace aliceVision
+} // namespace matchingImageCollection
@@ -0,0 +1,64 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include "aliceVision/matchingImageCollection/IImageCollectionMatcher.hpp"
+
+#include <string>
+
+namespace aliceVision {
+namespace matchingImageCollection {
+
+/**
+ * @brief Compute putative matches between a collection of pictures.
+ *
+ * Spurious correspondences are discarded by using the
+ * a threshold over the distance ratio of the 2 nearest neighbours.
+ *
+ * @note: One product quantization codebook is trained for all the regions and
+ * the regions of each view are encoded once. The matching scans the codes with
+ * the asymmetric distance and re-ranks the best candidates with the exact distance.
+ * The codebooks can be loaded instead of trained, and saved to be reused
+ * (one <describerType>.pq file per describer type).
+ * @warning: all descriptors are loaded in memory. You need to ensure that it can fit in RAM.
+ */
+class ImageCollectionMatcher_productQuantization : public IImageCollectionMatcher
+{
+  public:
+  ImageCollectionMatcher_productQuantization
+  (
+    float dist_ratio
+  );
+
+  /// Find corresponding points between some pair of view Ids
+  void Match(
+    const sfm::SfMData & sfm_data,
+    const feature::RegionsPerView& regionsPerView,
+    const PairSet & pairs,
+    feature::EImageDescriberType descType,
+    matching::PairwiseMatches & map_PutativesMatches // the pairwise photometric corresponding points
+  ) const;
+
+  /**
+   * @brief Set the folders of the codebooks.
+   * @param[in] loadFolder The folder of the codebooks loaded instead of trained, empty to train them.
+   * @param[in] saveFolder The folder where the codebooks are saved, empty to not save them.
+   */
+  void setCodebooksFolders(const std::string& loadFolder, const std::string& saveFolder)
+  {
+    _loadCodebooksFolder = loadFolder;
+    _saveCodebooksFolder = saveFolder;
+  }
+
+  private:
+  // Distance ratio used to discard spurious correspondence
+  float _f_dist_ratio;
+  std::string _loadCodebooksFolder;
+  std::string _saveCodebooksFolder;
+};
+
+} // namespace aliceVision
+} // namespace matchingImageCollection
@@ -7,6 +7,7 @@
 
 #include "aliceVision/matchingImageCollection/ImageCollectionMatcher_generic.hpp"
 #include "aliceVision/matchingImageCollection/ImageCollectionMatcher_cascadeHashing.hpp"
+#include "aliceVision/matchingImageCollection/ImageCollectionMatcher_productQuantization.hpp"
 
 #include <exception>
 #include <cassert>
@@ -15,17 +16,18 @@ namespace aliceVision {
 namespace matchingImageCollection {
   
 
-std::unique_ptr<IImageCollectionMatcher> createImageCollectionMatcher(matching::EMatcherType matcherType, float distRatio)
+std::unique_ptr<IImageCollectionMatcher> createImageCollectionMatcher(matching::EMatcherType matcherType, float distRatio, bool prebuildIndexes)
 {
   std::unique_ptr<IImageCollectionMatcher> matcherPtr;
   
   switch(matcherType)
   {
-    case matching::BRUTE_FORCE_L2:          matcherPtr.reset(new ImageCollectionMatcher_generic(distRatio, matching::BRUTE_FORCE_L2)); break;
-    case matching::ANN_L2:                  matcherPtr.reset(new ImageCollectionMatcher_generic(distRatio, matching::ANN_L2)); break;
-    case matching::CASCADE_HASHING_L2:      matcherPtr.reset(new ImageCollectionMatcher_generic(distRatio, matching::CASCADE_HASHING_L2)); break;
+    case matching::BRUTE_FORCE_L2:          matcherPtr.reset(new ImageCollectionMatcher_generic(distRatio, matching::BRUTE_FORCE_L2, prebuildIndexes)); break;
+    case matching::ANN_L2:                  matcherPtr.reset(new ImageCollectionMatcher_generic(distRatio, matching::ANN_L2, prebuildIndexes)); break;
+    case matching::CASCADE_HASHING_L2:      matcherPtr.reset(new ImageCollectionMatcher_generic(distRatio, matching::CASCADE_HASHING_L2, prebuildIndexes)); break;
     case matching::FAST_CASCADE_HASHING_L2: matcherPtr.reset(new ImageCollectionMatcher_cascadeHashing(distRatio)); break;
-    case matching::BRUTE_FORCE_HAMMING:     matcherPtr.reset(new ImageCollectionMatcher_generic(distRatio, matching::BRUTE_FORCE_HAMMING)); break;
+    case matching::PRODUCT_QUANTIZATION_L2: matcherPtr.reset(new ImageCollectionMatcher_productQuantization(distRatio)); break;
+    case matching::BRUTE_FORCE_HAMMING:     matcherPtr.reset(new ImageCollectionMatcher_generic(distRatio, matching::BRUTE_FORCE_HAMMING, prebuildIndexes)); break;
     
     default: throw std::out_of_range("Invalid matcherType enum");
   }
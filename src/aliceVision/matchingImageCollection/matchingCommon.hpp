@@ -14,9 +14,12 @@ namespace matchingImageCollection {
 /**
  * 
  * @param matcherType
+ * @param distRatio
+ * @param prebuildIndexes build the matching structures of all the images before matching
+ *        (generic matchers except ANN_L2)
  * @return 
  */
-std::unique_ptr<IImageCollectionMatcher> createImageCollectionMatcher(matching::EMatcherType matcherType, float distRatio);
+std::unique_ptr<IImageCollectionMatcher> createImageCollectionMatcher(matching::EMatcherType matcherType, float distRatio, bool prebuildIndexes = false);
 
 
 } // namespace matching
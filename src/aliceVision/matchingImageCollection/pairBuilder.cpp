@@ -11,7 +11,10 @@
 #include <set>
 #include <iostream>
 #include <fstream>
+#include <functional>
+#include <queue>
 #include <sstream>
+#include <stdexcept>
 namespace aliceVision {
 
 /// Generate all the (I,J) pairs of the upper diagonal of the NxN matrix
@@ -151,4 +154,48 @@ bool savePairs(const std::string &sFileName, const PairSet & pairs)
   return bOk;
 }
 
+std::vector<PairSet> splitPairsInChunks(const PairSet& pairs,
+                                        const std::map<IndexT, std::size_t>& nbFeaturesPerView,
+                                        std::size_t nbChunks,
+                                        std::vector<std::size_t>* chunksCost)
+{
+  if(nbChunks == 0)
+    throw std::invalid_argument("splitPairsInChunks: the number of chunks must be positive.");
+
+  const auto nbFeatures = [&](IndexT viewId) -> std::size_t
+  {
+    const auto it = nbFeaturesPerView.find(viewId);
+    return (it == nbFeaturesPerView.end()) ? 1 : std::max(it->second, std::size_t(1));
+  };
+
+  // pairs sorted by decreasing cost
+  std::vector<std::pair<std::size_t, Pair>> costPerPair;
+  costPerPair.reserve(pairs.size());
+  for(const Pair& pair : pairs)
+    costPerPair.emplace_back(nbFeatures(pair.first) * nbFeatures(pair.second), pair);
+  std::stable_sort(costPerPair.begin(), costPerPair.end(),
+                   [](const std::pair<std::size_t, Pair>& a, const std::pair<std::size_t, Pair>& b) { return a.first > b.first; });
+
+  // min-heap of (chunk cost, chunk index), ties are broken by the chunk index to be deterministic
+  typedef std::pair<std::size_t, std::size_t> ChunkCost;
+  std::priority_queue<ChunkCost, std::vector<ChunkCost>, std::greater<ChunkCost>> chunksHeap;
+  for(std::size_t i = 0; i < nbChunks; ++i)
+    chunksHeap.emplace(0, i);
+
+  std::vector<PairSet> chunks(nbChunks);
+  std::vector<std::size_t> costs(nbChunks, 0);
+  for(const auto& pairCost : costPerPair)
+  {
+    const std::size_t chunk = chunksHeap.top().second;
+    chunksHeap.pop();
+    chunks[chunk].insert(pairCost.second);
+    costs[chunk] += pairCost.first;
+    chunksHeap.emplace(costs[chunk], chunk);
+  }
+
+  if(chunksCost != nullptr)
+    chunksCost->swap(costs);
+  return chunks;
+}
+
 }; // namespace aliceVision
@@ -9,6 +9,8 @@
 #include <aliceVision/sfm/SfMData.hpp>
 
 #include <algorithm>
+#include <map>
+#include <vector>
 
 namespace aliceVision {
 
@@ -32,4 +34,22 @@ bool loadPairs(
 /// I K
 bool savePairs(const std::string &sFileName, const PairSet & pairs);
 
+/**
+ * @brief Split the pairs in chunks of balanced matching costs, to match them in separate jobs.
+ *
+ * The cost of a pair (I,J) is estimated with nbFeatures(I) * nbFeatures(J) (the number of
+ * descriptor comparisons of an exhaustive matching), a view without feature count costs as one feature.
+ * The pairs are assigned by decreasing cost to the chunk of lowest cost (longest processing time first).
+ *
+ * @param[in] pairs The pairs to split.
+ * @param[in] nbFeaturesPerView The number of features of each view.
+ * @param[in] nbChunks The number of chunks.
+ * @param[out] chunksCost The estimated cost of each chunk, optional.
+ * @return nbChunks chunks, some may be empty if there are less pairs than chunks
+ */
+std::vector<PairSet> splitPairsInChunks(const PairSet& pairs,
+                                        const std::map<IndexT, std::size_t>& nbFeaturesPerView,
+                                        std::size_t nbChunks,
+                                        std::vector<std::size_t>* chunksCost = nullptr);
+
 }; // namespace aliceVision
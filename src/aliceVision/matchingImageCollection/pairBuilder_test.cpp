@@ -124,3 +124,42 @@ BOOST_AUTO_TEST_CASE(matchingImageCollection_IO)
   BOOST_CHECK( loadPairs("pairsT_IO.txt", loaded_Pairs));
   BOOST_CHECK( std::equal(loaded_Pairs.begin(), loaded_Pairs.end(), pairSetGTsorted.begin()) );
 }
+
+BOOST_AUTO_TEST_CASE(matchingImageCollection_splitPairsInChunks)
+{
+  sfm::Views views;
+  std::map<IndexT, std::size_t> nbFeaturesPerView;
+  for(IndexT i = 0; i < 20; ++i)
+  {
+    views[i] = std::make_shared<sfm::View>("filepath", i);
+    // a few views with a lot of features
+    nbFeaturesPerView[i] = (i % 7 == 0) ? 20000 : 1000 + 100 * i;
+  }
+  const PairSet pairs = exhaustivePairs(views);
+
+  std::vector<std::size_t> chunksCost;
+  const std::vector<PairSet> chunks = splitPairsInChunks(pairs, nbFeaturesPerView, 4, &chunksCost);
+  BOOST_CHECK_EQUAL(4, chunks.size());
+  BOOST_CHECK_EQUAL(4, chunksCost.size());
+
+  // the chunks are a partition of the pairs
+  PairSet allPairs;
+  std::size_t nbPairs = 0;
+  for(const PairSet& chunk : chunks)
+  {
+    allPairs.insert(chunk.begin(), chunk.end());
+    nbPairs += chunk.size();
+  }
+  BOOST_CHECK_EQUAL(pairs.size(), nbPairs);
+  BOOST_CHECK(allPairs == pairs);
+
+  // the costs are balanced
+  const std::size_t minCost = *std::min_element(chunksCost.begin(), chunksCost.end());
+  const std::size_t maxCost = *std::max_element(chunksCost.begin(), chunksCost.end());
+  BOOST_CHECK_LT(maxCost - minCost, 0.05 * maxCost);
+
+  // more chunks than pairs
+  const std::vector<PairSet> smallChunks = splitPairsInChunks({{0, 1}, {0, 2}}, nbFeaturesPerView, 4);
+  BOOST_CHECK_EQUAL(4, smallChunks.size());
+  BOOST_CHECK_EQUAL(2, std::count_if(smallChunks.begin(), smallChunks.end(), [](const PairSet& chunk) { return chunk.size() == 1; }));
+}
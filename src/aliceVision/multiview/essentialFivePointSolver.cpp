@@ -18,8 +18,21 @@ Mat FivePointsNullspaceBasis(const Mat2X &x1, const Mat2X &x2) {
   return svd.matrixV().topRightCorner<9,4>();
 }
 
-Vec o1(const Vec &a, const Vec &b) {
-  Vec res = Vec::Zero(20);
+Eigen::Matrix<double, 9, 4> FivePointsNullspaceBasisMinimal(const Eigen::Matrix<double, 2, 5> &x1,
+                                                            const Eigen::Matrix<double, 2, 5> &x2) {
+  Eigen::Matrix<double, 5, 9> A;
+  fundamental::kernel::EncodeEpipolarEquation(x1, x2, &A);
+  return NullspaceBasis(A);
+}
+
+namespace {
+
+// The polynomial products are templated on the polynomial type, to use either
+// dynamic size vectors or fixed size vectors of 20 coefficients on the stack.
+
+template <typename TVec>
+TVec multiplyDegree1(const TVec &a, const TVec &b) {
+  TVec res = TVec::Zero(20);
 
   res(coef_xx) = a(coef_x) * b(coef_x);
   res(coef_xy) = a(coef_x) * b(coef_y)
@@ -41,8 +54,10 @@ Vec o1(const Vec &a, const Vec &b) {
   return res;
 }
 
-Vec o2(const Vec &a, const Vec &b) {
-  Vec res(20);
+template <typename TVec>
+TVec multiplyDegree2(const TVec &a, const TVec &b) {
+  TVec res;
+  res.resize(20);
 
   res(coef_xxx) = a(coef_xx) * b(coef_x);
   res(coef_xxy) = a(coef_xx) * b(coef_y)
@@ -88,12 +103,13 @@ Vec o2(const Vec &a, const Vec &b) {
   return res;
 }
 
-Mat FivePointsPolynomialConstraints(const Mat &E_basis) {
+template <typename TVec, typename TBasis, typename TMat>
+void buildPolynomialConstraints(const TBasis &E_basis, TMat &M) {
   // Build the polynomial form of E (equation (8) in Stewenius et al. [1])
-  Vec E[3][3];
+  TVec E[3][3];
   for (int i = 0; i < 3; ++i) {
     for (int j = 0; j < 3; ++j) {
-      E[i][j] = Vec::Zero(20);
+      E[i][j] = TVec::Zero(20);
       E[i][j](coef_x) = E_basis(3 * i + j, 0);
       E[i][j](coef_y) = E_basis(3 * i + j, 1);
       E[i][j](coef_z) = E_basis(3 * i + j, 2);
@@ -102,23 +118,22 @@ Mat FivePointsPolynomialConstraints(const Mat &E_basis) {
   }
 
   // The constraint matrix.
-  Mat M(10, 20);
   int mrow = 0;
 
   // Determinant constraint det(E) = 0; equation (19) of Nister [2].
-  M.row(mrow++) = o2(o1(E[0][1], E[1][2]) - o1(E[0][2], E[1][1]), E[2][0]) +
-                  o2(o1(E[0][2], E[1][0]) - o1(E[0][0], E[1][2]), E[2][1]) +
-                  o2(o1(E[0][0], E[1][1]) - o1(E[0][1], E[1][0]), E[2][2]);
+  M.row(mrow++) = multiplyDegree2<TVec>(multiplyDegree1(E[0][1], E[1][2]) - multiplyDegree1(E[0][2], E[1][1]), E[2][0]) +
+                  multiplyDegree2<TVec>(multiplyDegree1(E[0][2], E[1][0]) - multiplyDegree1(E[0][0], E[1][2]), E[2][1]) +
+                  multiplyDegree2<TVec>(multiplyDegree1(E[0][0], E[1][1]) - multiplyDegree1(E[0][1], E[1][0]), E[2][2]);
 
   // Cubic singular values constraint.
   // Equation (20).
-  Vec EET[3][3];
+  TVec EET[3][3];
   for (int i = 0; i < 3; ++i) {    // Since EET is symmetric, we only compute
     for (int j = 0; j < 3; ++j) {  // its upper triangular part.
       if (i <= j) {
-        EET[i][j] = o1(E[i][0], E[j][0])
-                  + o1(E[i][1], E[j][1])
-                  + o1(E[i][2], E[j][2]);
+        EET[i][j] = multiplyDegree1(E[i][0], E[j][0])
+                  + multiplyDegree1(E[i][1], E[j][1])
+                  + multiplyDegree1(E[i][2], E[j][2]);
       } else {
         EET[i][j] = EET[j][i];
       }
@@ -126,8 +141,8 @@ Mat FivePointsPolynomialConstraints(const Mat &E_basis) {
   }
 
   // Equation (21).
-  Vec (&L)[3][3] = EET;
-  Vec trace  = 0.5 * (EET[0][0] + EET[1][1] + EET[2][2]);
+  TVec (&L)[3][3] = EET;
+  TVec trace  = 0.5 * (EET[0][0] + EET[1][1] + EET[2][2]);
   for (int i = 0; i < 3; ++i) {
     L[i][i] -= trace;
   }
@@ -135,25 +150,58 @@ Mat FivePointsPolynomialConstraints(const Mat &E_basis) {
   // Equation (23).
   for (int i = 0; i < 3; ++i) {
     for (int j = 0; j < 3; ++j) {
-      Vec LEij = o2(L[i][0], E[0][j])
-               + o2(L[i][1], E[1][j])
-               + o2(L[i][2], E[2][j]);
+      TVec LEij = multiplyDegree2(L[i][0], E[0][j])
+                + multiplyDegree2(L[i][1], E[1][j])
+                + multiplyDegree2(L[i][2], E[2][j]);
       M.row(mrow++) = LEij;
     }
   }
+}
+
+} // namespace
+
+Vec o1(const Vec &a, const Vec &b) {
+  return multiplyDegree1(a, b);
+}
+
+Vec o2(const Vec &a, const Vec &b) {
+  return multiplyDegree2(a, b);
+}
 
+Mat FivePointsPolynomialConstraints(const Mat &E_basis) {
+  Mat M(10, 20);
+  buildPolynomialConstraints<Vec>(E_basis, M);
   return M;
 }
 
+void FivePointsPolynomialConstraints(const Eigen::Matrix<double, 9, 4> &E_basis,
+                                     Eigen::Matrix<double, 10, 20> &M) {
+  buildPolynomialConstraints<Eigen::Matrix<double, 20, 1> >(E_basis, M);
+}
+
 void FivePointsRelativePose(const Mat2X &x1,
                             const Mat2X &x2,
                             vector<Mat3> *Es) {
-  // Step 1: Nullspace Extraction.
-  const Eigen::Matrix<double, 9, 4> E_basis = FivePointsNullspaceBasis(x1, x2);
+  Eigen::Matrix<double, 9, 4> E_basis;
+  Eigen::Matrix<double, 10, 20> E_constraints;
+  if (x1.cols() == 5) {
+    // The minimal case is solved with fixed size matrices.
+    // Step 1: Nullspace Extraction.
+    E_basis = FivePointsNullspaceBasisMinimal(x1, x2);
+    // Step 2: Constraint Expansion.
+    FivePointsPolynomialConstraints(E_basis, E_constraints);
+  }
+  else {
+    E_basis = FivePointsNullspaceBasis(x1, x2);
+    E_constraints = FivePointsPolynomialConstraints(E_basis);
+  }
 
-  // Step 2: Constraint Expansion.
-  const Eigen::Matrix<double, 10, 20> E_constraints = FivePointsPolynomialConstraints(E_basis);
+  FivePointsRelativePoseFromConstraints(E_basis, E_constraints, Es);
+}
 
+void FivePointsRelativePoseFromConstraints(const Eigen::Matrix<double, 9, 4> &E_basis,
+                                           const Eigen::Matrix<double, 10, 20> &E_constraints,
+                                           vector<Mat3> *Es) {
   // Step 3: Gauss-Jordan Elimination (done thanks to a LU decomposition).
   typedef Eigen::Matrix<double, 10, 10> Mat10;
   Eigen::FullPivLU<Mat10> c_lu(E_constraints.block<10, 10>(0, 0));
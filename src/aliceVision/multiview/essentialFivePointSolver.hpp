@@ -21,9 +21,22 @@ namespace aliceVision {
 void FivePointsRelativePose(const Mat2X &x1, const Mat2X &x2,
                             vector<Mat3> *E);
 
+/** Computes the candidate essential matrices from the nullspace basis of the
+ * linear constraints and the polynomial constraint matrix (Gauss-Jordan
+ * elimination and eigen decomposition of the action matrix).
+ */
+void FivePointsRelativePoseFromConstraints(const Eigen::Matrix<double, 9, 4> &E_basis,
+                                           const Eigen::Matrix<double, 10, 20> &E_constraints,
+                                           vector<Mat3> *E);
+
 // Compute the nullspace of the linear constraints given by the matches.
 Mat FivePointsNullspaceBasis(const Mat2X &x1, const Mat2X &x2);
 
+// Compute the nullspace of the linear constraints given by exactly 5 matches,
+// with fixed size matrices and a QR decomposition instead of a 9x9 SVD.
+Eigen::Matrix<double, 9, 4> FivePointsNullspaceBasisMinimal(const Eigen::Matrix<double, 2, 5> &x1,
+                                                            const Eigen::Matrix<double, 2, 5> &x2);
+
 // Multiply two polynomials of degree 1.
 Vec o1(const Vec &a, const Vec &b);
 
@@ -33,6 +46,10 @@ Vec o2(const Vec &a, const Vec &b);
 // Builds the polynomial constraint matrix M.
 Mat FivePointsPolynomialConstraints(const Mat &E_basis);
 
+// Builds the polynomial constraint matrix M with fixed size polynomials.
+void FivePointsPolynomialConstraints(const Eigen::Matrix<double, 9, 4> &E_basis,
+                                     Eigen::Matrix<double, 10, 20> &M);
+
 // In the following code, polynomials are expressed as vectors containing
 // their coeficients in the basis of monomials:
 //
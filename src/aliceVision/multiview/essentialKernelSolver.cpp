@@ -22,11 +22,18 @@ void EightPointRelativePoseSolver::Solve(const Mat &x1, const Mat &x2, vector<Ma
   assert(x1.rows() == x2.rows());
   assert(x1.cols() == x2.cols());
 
-  MatX9 A(x1.cols(), 9);
-  fundamental::kernel::EncodeEpipolarEquation(x1, x2, &A);
-
   Vec9 e;
-  Nullspace(&A, &e);
+  if (x1.cols() == 8) {
+    // In the minimal case use fixed size matrices and a QR decomposition.
+    Eigen::Matrix<double, 8, 9> A;
+    fundamental::kernel::EncodeEpipolarEquation(Eigen::Matrix<double, 2, 8>(x1), Eigen::Matrix<double, 2, 8>(x2), &A);
+    e = NullspaceBasis(A);
+  }
+  else {
+    MatX9 A(x1.cols(), 9);
+    fundamental::kernel::EncodeEpipolarEquation(x1, x2, &A);
+    Nullspace(&A, &e);
+  }
   Mat3 E = Map<RMat3>(e.data());
 
   // Find the closest essential matrix to E in frobenius norm
@@ -11,46 +11,10 @@ namespace fundamental {
 namespace kernel {
 
 using namespace std;
-void SevenPointSolver::Solve(const Mat &x1, const Mat &x2, vector<Mat3> *F) {
-  assert(2 == x1.rows());
-  assert(7 <= x1.cols());
-  assert(x1.rows() == x2.rows());
-  assert(x1.cols() == x2.cols());
 
-  Vec9 f1, f2;
-  if (x1.cols() == 7) {
-    // Set up the homogeneous system Af = 0 from the equations x'T*F*x = 0.
-    typedef Eigen::Matrix<double, 9, 9> Mat9;
-    // In the minimal solution use fixed sized matrix to let Eigen and the
-    //  compiler doing the maximum of optimization.
-    Mat9 A = Mat::Zero(9,9);
-    EncodeEpipolarEquation(x1, x2, &A);
-//    Eigen::FullPivLU<Mat9> luA(A);
-//    ALICEVISION_LOG_DEBUG("\n rank(A) = " << luA.rank()); 
-//    Eigen::JacobiSVD<Mat9> svdA(A);
-//    cout << "Its singular values are:" << endl << svdA.singularValues() << endl;
-    // Find the two F matrices in the nullspace of A.
-    Nullspace2(&A, &f1, &f2);
-    //@fixme here there is a potential error, we should check that the size of
-    // null(A) is 2. Otherwise we have a family of possible solutions for the
-    // fundamental matrix (ie infinite solution). This happens, e.g., when matching
-    // the image against itself or in other degenerate configurations of the camera,
-    // such as pure rotation or correspondences all on the same plane (cf HZ pg296 table 11.1)
-    // This is not critical for just matching images with geometric validation, 
-    // it becomes an issue if the estimated F has to be used for retrieving the 
-    // motion of the camera.
-  }
-  else
-  {
-    // Set up the homogeneous system Af = 0 from the equations x'T*F*x = 0.
-    Mat A(x1.cols(), 9);
-    EncodeEpipolarEquation(x1, x2, &A);
-    // Find the two F matrices in the nullspace of A.
-    Nullspace2(&A, &f1, &f2);
-  }
-
-  Mat3 F1 = Map<RMat3>(f1.data());
-  Mat3 F2 = Map<RMat3>(f2.data());
+void SolveSevenPointRankConstraint(const Vec9 &f1, const Vec9 &f2, vector<Mat3> *F) {
+  Mat3 F1 = Map<const RMat3>(f1.data());
+  Mat3 F2 = Map<const RMat3>(f2.data());
 
   // Then, use the condition det(F) = 0 to determine F. In other words, solve
   // det(F1 + a*F2) = 0 for a.
@@ -84,6 +48,46 @@ void SevenPointSolver::Solve(const Mat &x1, const Mat &x2, vector<Mat3> *F) {
   }
 }
 
+void SevenPointSolver::Solve(const Mat &x1, const Mat &x2, vector<Mat3> *F) {
+  assert(2 == x1.rows());
+  assert(7 <= x1.cols());
+  assert(x1.rows() == x2.rows());
+  assert(x1.cols() == x2.cols());
+
+  if (x1.cols() == 7) {
+    SolveMinimal(x1, x2, F);
+    return;
+  }
+
+  // Set up the homogeneous system Af = 0 from the equations x'T*F*x = 0.
+  Vec9 f1, f2;
+  Mat A(x1.cols(), 9);
+  EncodeEpipolarEquation(x1, x2, &A);
+  // Find the two F matrices in the nullspace of A.
+  Nullspace2(&A, &f1, &f2);
+
+  SolveSevenPointRankConstraint(f1, f2, F);
+}
+
+void SevenPointSolver::SolveMinimal(const Eigen::Matrix<double, 2, 7> &x1, const Eigen::Matrix<double, 2, 7> &x2, vector<Mat3> *F) {
+  // Set up the homogeneous system Af = 0 from the equations x'T*F*x = 0,
+  // the matrices are on the stack and the nullspace comes from a QR decomposition.
+  Eigen::Matrix<double, 7, 9> A;
+  EncodeEpipolarEquation(x1, x2, &A);
+  // Find the two F matrices in the nullspace of A.
+  const Eigen::Matrix<double, 9, 2> f = NullspaceBasis(A);
+  //@fixme here there is a potential error, we should check that the size of
+  // null(A) is 2. Otherwise we have a family of possible solutions for the
+  // fundamental matrix (ie infinite solution). This happens, e.g., when matching
+  // the image against itself or in other degenerate configurations of the camera,
+  // such as pure rotation or correspondences all on the same plane (cf HZ pg296 table 11.1)
+  // This is not critical for just matching images with geometric validation, 
+  // it becomes an issue if the estimated F has to be used for retrieving the 
+  // motion of the camera.
+
+  SolveSevenPointRankConstraint(f.col(0), f.col(1), F);
+}
+
 void EightPointSolver::Solve(const Mat &x1, const Mat &x2, vector<Mat3> *Fs, const vector<double> *weights) 
 {
   assert(2 == x1.rows());
@@ -91,38 +95,39 @@ void EightPointSolver::Solve(const Mat &x1, const Mat &x2, vector<Mat3> *Fs, con
   assert(x1.rows() == x2.rows());
   assert(x1.cols() == x2.cols());
 
-  Vec9 f;
   if (x1.cols() == 8) 
   {
-    typedef Eigen::Matrix<double, 9, 9> Mat9;
-    // In the minimal solution use fixed sized matrix to let Eigen and the
-    //  compiler doing the maximum of optimization.
-    Mat9 A = Mat::Zero(9,9);
-    EncodeEpipolarEquation(x1, x2, &A, weights);
-    Nullspace(&A, &f);
-  }
-  else  
-  {
-    MatX9 A(x1.cols(), 9);
-    EncodeEpipolarEquation(x1, x2, &A, weights);
-    Nullspace(&A, &f);
+    SolveMinimal(x1, x2, Fs, weights);
+    return;
   }
 
+  Vec9 f;
+  MatX9 A(x1.cols(), 9);
+  EncodeEpipolarEquation(x1, x2, &A, weights);
+  Nullspace(&A, &f);
+
   Mat3 F = Map<RMat3>(f.data());
 
   // Force the fundamental property if the A matrix has full rank.
   // HZ 11.1.1 pag.280
-  if (x1.cols() > 8) 
-  {
-    // Force fundamental matrix to have rank 2
-    Eigen::JacobiSVD<Mat3> USV(F, Eigen::ComputeFullU | Eigen::ComputeFullV);
-    Vec3 d = USV.singularValues();
-    d[2] = 0.0;
-    F = USV.matrixU() * d.asDiagonal() * USV.matrixV().transpose();
-  }
+  // Force fundamental matrix to have rank 2
+  Eigen::JacobiSVD<Mat3> USV(F, Eigen::ComputeFullU | Eigen::ComputeFullV);
+  Vec3 d = USV.singularValues();
+  d[2] = 0.0;
+  F = USV.matrixU() * d.asDiagonal() * USV.matrixV().transpose();
   Fs->push_back(F);
 }
 
+void EightPointSolver::SolveMinimal(const Eigen::Matrix<double, 2, 8> &x1, const Eigen::Matrix<double, 2, 8> &x2, vector<Mat3> *Fs, const vector<double> *weights)
+{
+  // In the minimal solution the matrices are on the stack and the nullspace
+  //  comes from a QR decomposition instead of the SVD of a 9x9 matrix.
+  Eigen::Matrix<double, 8, 9> A;
+  EncodeEpipolarEquation(x1, x2, &A, weights);
+  const Vec9 f = NullspaceBasis(A);
+  Fs->push_back(Map<const RMat3>(f.data()));
+}
+
 }  // namespace kernel
 }  // namespace fundamental
 }  // namespace aliceVision
@@ -31,14 +31,25 @@ struct SevenPointSolver {
   enum { MINIMUM_SAMPLES = 7 };
   enum { MAX_MODELS = 3 };
   static void Solve(const Mat &x1, const Mat &x2, vector<Mat3> *F);
+  /// Minimal case with fixed size matrices, used by Solve for 7 correspondences
+  static void SolveMinimal(const Eigen::Matrix<double, 2, 7> &x1, const Eigen::Matrix<double, 2, 7> &x2, vector<Mat3> *F);
 };
 
 struct EightPointSolver {
   enum { MINIMUM_SAMPLES = 8 };
   enum { MAX_MODELS = 1 };
   static void Solve(const Mat &x1, const Mat &x2, vector<Mat3> *Fs, const vector<double> *weights = nullptr);
+  /// Minimal case with fixed size matrices, used by Solve for 8 correspondences
+  static void SolveMinimal(const Eigen::Matrix<double, 2, 8> &x1, const Eigen::Matrix<double, 2, 8> &x2, vector<Mat3> *Fs, const vector<double> *weights = nullptr);
 };
 
+/**
+ * Solve det(F1 + a*F2) = 0 for a, where F1 and F2 are the two fundamental
+ * matrices (as row major 9-vectors) spanning the nullspace of the seven-point
+ * system, and add the up to 3 fundamental matrices F1 + a*F2 to F.
+ */
+void SolveSevenPointRankConstraint(const Vec9 &f1, const Vec9 &f2, vector<Mat3> *F);
+
 /**
  * Build a 9 x n matrix from point matches, where each row is equivalent to the
  * equation x'T*F*x = 0 for a single correspondence pair (x', x). The domain of
@@ -30,8 +30,39 @@ struct FourPointSolver {
    * The estimated homography should approximately hold the condition y = H x.
    */
   static void Solve(const Mat &x, const Mat &y, vector<Mat3> *Hs);
+
+  /// Minimal case with fixed size matrices, used by Solve for 4 correspondences
+  static void SolveMinimal(const Eigen::Matrix<double, 2, 4> &x, const Eigen::Matrix<double, 2, 4> &y, vector<Mat3> *Hs);
 };
 
+/// Setup the Direct Linear Transform.
+///  Use template in order to support fixed or dynamic sized matrix.
+/// Allow solve H as homogeneous(x2) = H homogeneous(x1)
+/// The 2 * x.cols() first rows of L are set, the other coefficients of these
+/// rows are expected to be zero.
+template<typename Matrix, typename TMatX>
+void BuildActionMatrix(Matrix & L, const TMatX &x, const TMatX &y)  {
+
+  const Mat::Index n = x.cols();
+  for (Mat::Index i = 0; i < n; ++i) {
+    Mat::Index j = 2 * i;
+    L(j, 0) = x(0, i);
+    L(j, 1) = x(1, i);
+    L(j, 2) = 1.0;
+    L(j, 6) = -y(0, i) * x(0, i);
+    L(j, 7) = -y(0, i) * x(1, i);
+    L(j, 8) = -y(0, i);
+
+    ++j;
+    L(j, 3) = x(0, i);
+    L(j, 4) = x(1, i);
+    L(j, 5) = 1.0;
+    L(j, 6) = -y(1, i) * x(0, i);
+    L(j, 7) = -y(1, i) * x(1, i);
+    L(j, 8) = -y(1, i);
+  }
+}
+
 // Should be distributed as Chi-squared with k = 2.
 struct AsymmetricError {
   static double Error(const Mat &H, const Vec2 &x1, const Vec2 &x2) {
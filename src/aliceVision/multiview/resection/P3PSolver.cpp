@@ -76,8 +76,14 @@ void solveQuartic(const Vec5 & factors, Vec4 & realRoots)
 
 bool compute_P3P_Poses(const Mat3 & featureVectors, const Mat3 & worldPoints, Mat & solutions)
 {
-  solutions = Mat(3, 4 * 4);
+  Eigen::Matrix<double, 3, 16> fixedSolutions;
+  const bool success = compute_P3P_Poses(featureVectors, worldPoints, fixedSolutions);
+  solutions = fixedSolutions;
+  return success;
+}
 
+bool compute_P3P_Poses(const Mat3 & featureVectors, const Mat3 & worldPoints, Eigen::Matrix<double, 3, 16> & solutions)
+{
   // Extraction of world points
 
   Vec3 P1 = worldPoints.col(0);
@@ -258,7 +264,7 @@ void P3PSolver::Solve(const Mat &pt2D, const Mat &pt3D, std::vector<Mat34> *mode
   assert(2 == pt2D.rows());
   assert(3 == pt3D.rows());
   assert(pt2D.cols() == pt3D.cols());
-  Mat solutions = Mat(3, 4 * 4);
+  Eigen::Matrix<double, 3, 16> solutions;
   Mat3 pt2D_3x3;
   pt2D_3x3.block<2, 3>(0, 0) = pt2D;
   pt2D_3x3.row(2).fill(1);
@@ -301,7 +307,7 @@ void P3P_ResectionKernel_K::Fit(const std::vector<size_t> &samples, std::vector<
 {
   const Mat3 pt2D_3x3(ExtractColumns(x_camera_, samples));
   const Mat3 pt3D_3x3(ExtractColumns(X_, samples));
-  Mat solutions(3, 4 * 4);
+  Eigen::Matrix<double, 3, 16> solutions;
   if(compute_P3P_Poses(pt2D_3x3, pt3D_3x3, solutions))
   {
     Mat34 P;
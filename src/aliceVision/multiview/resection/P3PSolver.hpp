@@ -37,6 +37,11 @@ void solveQuartic(const Vec5 & factors, Vec4 & realRoots);
 
 bool compute_P3P_Poses(const Mat3 & featureVectors, const Mat3 & worldPoints, Mat & solutions);
 
+/**
+ * @brief Same as compute_P3P_Poses with the solutions in a fixed size matrix (no heap allocation)
+ */
+bool compute_P3P_Poses(const Mat3 & featureVectors, const Mat3 & worldPoints, Eigen::Matrix<double, 3, 16> & solutions);
+
 struct P3PSolver
 {
 
@@ -279,6 +279,21 @@ inline double Nullspace2(TMat *A, TVec1 *x1, TVec2 *x2)
   return Nullspace2(&A_extended, x1, x2);
 }
 
+/// Basis of the nullspace of a fixed size matrix A with less rows than columns
+/// (e.g. the linear system of a minimal solver). The columns of the returned
+/// matrix are orthonormal and orthogonal to the rows of A. They are the last
+/// columns of Q in the QR decomposition of A^T, which is much faster than the
+/// SVD of the zero padded square matrix and stays on the stack.
+
+template <int Rows, int Cols>
+inline Eigen::Matrix<double, Cols, Cols - Rows> NullspaceBasis(const Eigen::Matrix<double, Rows, Cols> & A)
+{
+  static_assert(Rows < Cols, "The nullspace basis needs less equations than unknowns.");
+  const Eigen::HouseholderQR<Eigen::Matrix<double, Cols, Rows> > qr(A.transpose());
+  const Eigen::Matrix<double, Cols, Cols> Q = qr.householderQ();
+  return Q.template rightCols<Cols - Rows>();
+}
+
 // Make a rotation matrix such that center becomes the direction of the
 // positive z-axis, and y is oriented close to up by default.
 Mat3 LookAt(const Vec3 &center, const Vec3 & up = Vec3::UnitY());
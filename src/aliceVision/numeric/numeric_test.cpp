@@ -110,3 +110,20 @@ BOOST_AUTO_TEST_CASE(Numeric_MeanAndVarianceAlongRows) {
   BOOST_CHECK_SMALL(0.25-variance(0), 1e-8);
   BOOST_CHECK_SMALL(1.25-variance(1), 1e-8);
 }
+
+BOOST_AUTO_TEST_CASE(Numeric_NullspaceBasis) {
+  typedef Eigen::Matrix<double, 7, 9> Mat79;
+  const Mat79 A = Mat79::Random();
+  const Eigen::Matrix<double, 9, 2> N = NullspaceBasis(A);
+
+  // orthonormal basis of the nullspace
+  BOOST_CHECK_SMALL((A * N).norm(), 1e-12);
+  BOOST_CHECK_SMALL((N.transpose() * N - Eigen::Matrix2d::Identity()).norm(), 1e-12);
+
+  // same nullspace as the SVD
+  Mat B = A;
+  Vec9 x1, x2;
+  Nullspace2(&B, &x1, &x2);
+  BOOST_CHECK_SMALL((N * (N.transpose() * x1) - x1).norm(), 1e-10);
+  BOOST_CHECK_SMALL((N * (N.transpose() * x2) - x2).norm(), 1e-10);
+}
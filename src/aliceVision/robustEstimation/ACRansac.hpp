@@ -36,10 +36,13 @@
 #include <iostream>
 #include <iterator>
 #include <limits>
+#include <memory>
 #include <numeric>
+#include <random>
 #include <vector>
 
 #include <aliceVision/robustEstimation/randSampling.hpp>
+#include <aliceVision/robustEstimation/ProsacSampler.hpp>
 #include <aliceVision/system/Logger.hpp>
 
 namespace aliceVision {
@@ -71,9 +74,19 @@ static void makelogcombi_n
   std::vector<Type> & vec_log10 // lookuptable [0,n+1]
 )
 {
+  // logcombi(k, n) is the running sum of logcombi(k-1, n) for k <= n/2 and symmetric,
+  // the values are the same as logcombi<Type>(k, n, vec_log10) in O(n) instead of O(n^2)
   l.resize(n+1);
-  for (size_t k = 0; k <= n; ++k)
-    l[k] = logcombi<Type>(k, n, vec_log10);
+  Type r = 0.0f;
+  l[0] = 0.0f;
+  for (size_t k = 1; k <= n / 2; ++k)
+  {
+    r += vec_log10[n-k+1] - vec_log10[k];
+    l[k] = r;
+  }
+  for (size_t k = n / 2 + 1; k < n; ++k)
+    l[k] = l[n-k];
+  l[n] = 0.0f;
 }
 
 /// tabulate logcombi(k,.)
@@ -112,6 +125,41 @@ static void makelogcombi
 /// NFA and associated index
 typedef std::pair<double,size_t> ErrorIndex;
 
+/**
+ * @brief Buffers of ACRANSAC reused between the estimations of a thread,
+ * e.g. for the geometric filtering of many image pairs.
+ * The log combination tables are kept for estimations with the same number of data.
+ */
+struct ACRansacWorkspace
+{
+  ACRansacWorkspace()
+    : generator(std::random_device()())
+  {}
+
+  /// Update the log combination tables for the sample size k and the number of data n
+  void makelogcombi(size_t k, size_t n)
+  {
+    if (k == logcSizeSample && n == logcNbData)
+      return;
+    for (size_t i = vec_log10.size(); i <= n; ++i)
+      vec_log10.push_back(log10((float)i));
+    makelogcombi_n(n, vec_logc_n, vec_log10);
+    makelogcombi_k(k, n, vec_logc_k, vec_log10);
+    logcSizeSample = k;
+    logcNbData = n;
+  }
+
+  std::vector<ErrorIndex> vec_residuals; // [residual,index]
+  std::vector<double> vec_residuals_;
+  std::vector<size_t> vec_index; // possible sampling indices
+  std::vector<size_t> vec_sample;
+  std::vector<float> vec_log10; // lookuptable of log10 values
+  std::vector<float> vec_logc_n, vec_logc_k;
+  size_t logcSizeSample = 0;
+  size_t logcNbData = 0;
+  std::mt19937 generator;
+};
+
 /// Find best NFA and its index wrt square error threshold in e.
 static ErrorIndex bestNFA(
   int startIndex, //number of point required for estimation
@@ -145,21 +193,27 @@ static ErrorIndex bestNFA(
  * @brief ACRANSAC routine (ErrorThreshold, NFA)
  *
  * @param[in] kernel model and metric object
+ * @param[in,out] workspace buffers reused between the estimations
  * @param[out] vec_inliers points that fit the estimated model
  * @param[in] nIter maximum number of consecutive iterations
  * @param[out] model returned model if found
  * @param[in] precision upper bound of the precision (squared error)
  * @param[in] bVerbose display console log
+ * @param[in] sortedIndices optional data indices sorted by decreasing quality,
+ * if provided the samples are drawn progressively from the best data (PROSAC)
+ * until a meaningful model is found
  *
  * @return (errorMax, minNFA)
  */
 template<typename Kernel>
 std::pair<double, double> ACRANSAC(const Kernel &kernel,
+  ACRansacWorkspace & workspace,
   std::vector<size_t> & vec_inliers,
   size_t nIter = 1024,
   typename Kernel::Model * model = nullptr,
   double precision = std::numeric_limits<double>::infinity(),
-  bool bVerbose = false)
+  bool bVerbose = false,
+  const std::vector<size_t> * sortedIndices = nullptr)
 {
   vec_inliers.clear();
 
@@ -172,17 +226,26 @@ std::pair<double, double> ACRANSAC(const Kernel &kernel,
     std::numeric_limits<double>::infinity() :
     precision * kernel.normalizer2()(0,0) * kernel.normalizer2()(0,0);
 
-  std::vector<ErrorIndex> vec_residuals(nData); // [residual,index]
-  std::vector<double> vec_residuals_(nData);
+  std::vector<ErrorIndex> & vec_residuals = workspace.vec_residuals; // [residual,index]
+  std::vector<double> & vec_residuals_ = workspace.vec_residuals_;
+  vec_residuals.resize(nData);
+  vec_residuals_.resize(nData);
 
   // Possible sampling indices [0,..,nData] (will change in the optimization phase)
-  std::vector<size_t> vec_index(nData);
+  std::vector<size_t> & vec_index = workspace.vec_index;
+  vec_index.resize(nData);
   std::iota(vec_index.begin(), vec_index.end(), 0);
 
   // Precompute log combi
   const double loge0 = log10((double)Kernel::MAX_MODELS * (nData-sizeSample));
-  std::vector<float> vec_logc_n, vec_logc_k;
-  makelogcombi(sizeSample, nData, vec_logc_k, vec_logc_n);
+  workspace.makelogcombi(sizeSample, nData);
+  const std::vector<float> & vec_logc_n = workspace.vec_logc_n;
+  const std::vector<float> & vec_logc_k = workspace.vec_logc_k;
+
+  std::vector<size_t> & vec_sample = workspace.vec_sample; // Sample indices
+  vec_sample.reserve(sizeSample);
+  std::vector<typename Kernel::Model> vec_models; // Up to max_models solutions
+  vec_models.reserve(Kernel::MAX_MODELS);
 
   // Output parameters
   double minNFA = std::numeric_limits<double>::infinity();
@@ -194,16 +257,26 @@ std::pair<double, double> ACRANSAC(const Kernel &kernel,
 
   bool bACRansacMode = (precision == std::numeric_limits<double>::infinity());
 
+  // Progressive sampling among the best data, until the sampling is focused on the inliers
+  std::unique_ptr<ProsacSampler> prosac;
+  if (sortedIndices != nullptr && !sortedIndices->empty())
+  {
+    assert(sortedIndices->size() == nData);
+    prosac.reset(new ProsacSampler(sizeSample, *sortedIndices, nIter));
+  }
+  bool bFocusedSampling = false;
+
   // Main estimation loop.
   for (size_t iter=0; iter < nIter; ++iter)
   {
-    std::vector< std::size_t> vec_sample(sizeSample); // Sample indices
-    if (bACRansacMode)
-      UniformSample(sizeSample, vec_index, vec_sample); // Get random sample
+    if (prosac && !bFocusedSampling)
+      prosac->sample(workspace.generator, vec_sample); // Get progressive sample
+    else if (bACRansacMode)
+      UniformSample(sizeSample, vec_index, workspace.generator, vec_sample); // Get random sample
     else
-      UniformSample(sizeSample, nData, vec_sample); // Get random sample
+      randSample<size_t>(0, nData, sizeSample, workspace.generator, vec_sample); // Get random sample
 
-    std::vector<typename Kernel::Model> vec_models; // Up to max_models solutions
+    vec_models.clear();
     kernel.Fit(vec_sample, &vec_models);
 
     // Evaluate models
@@ -286,6 +359,7 @@ std::pair<double, double> ACRANSAC(const Kernel &kernel,
       {
         // ACRANSAC optimization: draw samples among best set of inliers so far
         vec_index = vec_inliers;
+        bFocusedSampling = true;
         if(nIterReserve)
         {
           nIter = iter + 1 + nIterReserve;
@@ -308,5 +382,31 @@ std::pair<double, double> ACRANSAC(const Kernel &kernel,
   return std::make_pair(errorMax, minNFA);
 }
 
+/**
+ * @brief ACRANSAC routine (ErrorThreshold, NFA) with its own buffers
+ *
+ * @param[in] kernel model and metric object
+ * @param[out] vec_inliers points that fit the estimated model
+ * @param[in] nIter maximum number of consecutive iterations
+ * @param[out] model returned model if found
+ * @param[in] precision upper bound of the precision (squared error)
+ * @param[in] bVerbose display console log
+ * @param[in] sortedIndices optional data indices sorted by decreasing quality (PROSAC)
+ *
+ * @return (errorMax, minNFA)
+ */
+template<typename Kernel>
+std::pair<double, double> ACRANSAC(const Kernel &kernel,
+  std::vector<size_t> & vec_inliers,
+  size_t nIter = 1024,
+  typename Kernel::Model * model = nullptr,
+  double precision = std::numeric_limits<double>::infinity(),
+  bool bVerbose = false,
+  const std::vector<size_t> * sortedIndices = nullptr)
+{
+  ACRansacWorkspace workspace;
+  return ACRANSAC(kernel, workspace, vec_inliers, nIter, model, precision, bVerbose, sortedIndices);
+}
+
 } // namespace robustEstimation
 } // namespace aliceVision
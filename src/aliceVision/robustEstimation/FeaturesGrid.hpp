@@ -0,0 +1,198 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include "aliceVision/numeric/numeric.hpp"
+#include "aliceVision/types.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace aliceVision {
+namespace robustEstimation {
+
+/**
+ * @brief Uniform grid over feature positions.
+ *
+ * The features are sorted by cell in one contiguous array, so the features of a
+ * region of the image can be visited without testing all of them.
+ * The visited regions are conservative: the visitor must test the exact criterion.
+ */
+class FeaturesGrid
+{
+public:
+  FeaturesGrid() = default;
+
+  /**
+   * @brief Build the grid.
+   * @param[in] positions The feature positions.
+   * @param[in] nbFeaturesPerCell The average number of features per cell.
+   */
+  explicit FeaturesGrid(const std::vector<Vec2>& positions, double nbFeaturesPerCell = 4.0)
+    : _positions(positions)
+  {
+    build(nbFeaturesPerCell);
+  }
+
+  /// Feature positions, indexed by feature id
+  const std::vector<Vec2>& positions() const { return _positions; }
+
+  std::size_t nbCols() const { return _nbCols; }
+  std::size_t nbRows() const { return _nbRows; }
+
+  /**
+   * @brief Visit the features in the cells intersecting a disc.
+   * @param[in] center The disc center.
+   * @param[in] radius The disc radius.
+   * @param[in] visitor Called with the feature ids.
+   */
+  template <typename VisitorT>
+  void visitDisc(const Vec2& center, double radius, VisitorT&& visitor) const
+  {
+    if(_positions.empty() || !std::isfinite(center(0)) || !std::isfinite(center(1)))
+      return;
+
+    int colBegin, colEnd, rowBegin, rowEnd;
+    if(!cellRange(center(0) - radius, center(0) + radius, _minX, _nbCols, colBegin, colEnd) ||
+       !cellRange(center(1) - radius, center(1) + radius, _minY, _nbRows, rowBegin, rowEnd))
+      return;
+
+    for(int row = rowBegin; row < rowEnd; ++row)
+      visitCells(row * _nbCols + colBegin, row * _nbCols + colEnd, visitor);
+  }
+
+  /**
+   * @brief Visit the features in the cells intersecting the band around a line.
+   * @param[in] line The line (a, b, c) of equation a.x + b.y + c = 0.
+   * @param[in] halfWidth The maximal distance to the line.
+   * @param[in] visitor Called with the feature ids.
+   */
+  template <typename VisitorT>
+  void visitLineBand(const Vec3& line, double halfWidth, VisitorT&& visitor) const
+  {
+    const double a = line(0);
+    const double b = line(1);
+    const double c = line(2);
+    const double norm = std::hypot(a, b);
+    if(_positions.empty() || norm == 0.0 || !std::isfinite(norm) || !std::isfinite(c))
+      return;
+
+    if(std::abs(b) >= std::abs(a))
+    {
+      // mostly horizontal line: y range of the band in each column
+      const double margin = halfWidth * norm / std::abs(b);
+      for(std::size_t col = 0; col < _nbCols; ++col)
+      {
+        const double x0 = _minX + col * _cellSize;
+        const double x1 = x0 + _cellSize;
+        const double y0 = -(a * x0 + c) / b;
+        const double y1 = -(a * x1 + c) / b;
+        int rowBegin, rowEnd;
+        if(!cellRange(std::min(y0, y1) - margin, std::max(y0, y1) + margin, _minY, _nbRows, rowBegin, rowEnd))
+          continue;
+        for(int row = rowBegin; row < rowEnd; ++row)
+          visitCells(row * _nbCols + col, row * _nbCols + col + 1, visitor);
+      }
+    }
+    else
+    {
+      // mostly vertical line: x range of the band in each row
+      const double margin = halfWidth * norm / std::abs(a);
+      for(std::size_t row = 0; row < _nbRows; ++row)
+      {
+        const double y0 = _minY + row * _cellSize;
+        const double y1 = y0 + _cellSize;
+        const double x0 = -(b * y0 + c) / a;
+        const double x1 = -(b * y1 + c) / a;
+        int colBegin, colEnd;
+        if(!cellRange(std::min(x0, x1) - margin, std::max(x0, x1) + margin, _minX, _nbCols, colBegin, colEnd))
+          continue;
+        visitCells(row * _nbCols + colBegin, row * _nbCols + colEnd, visitor);
+      }
+    }
+  }
+
+private:
+  void build(double nbFeaturesPerCell)
+  {
+    if(_positions.empty())
+      return;
+
+    _minX = _positions.front()(0);
+    _minY = _positions.front()(1);
+    double maxX = _minX;
+    double maxY = _minY;
+    for(const Vec2& position : _positions)
+    {
+      _minX = std::min(_minX, position(0));
+      _minY = std::min(_minY, position(1));
+      maxX = std::max(maxX, position(0));
+      maxY = std::max(maxY, position(1));
+    }
+
+    // square cells with nbFeaturesPerCell features on average
+    const double width = maxX - _minX;
+    const double height = maxY - _minY;
+    _cellSize = std::sqrt(std::max(width * height, 1.0) * nbFeaturesPerCell / _positions.size());
+    _cellSize = std::max(_cellSize, std::max(width, height) / (4.0 * _positions.size() + 1.0));
+    _cellSize = std::max(_cellSize, 1e-6);
+    _nbCols = static_cast<std::size_t>(width / _cellSize) + 1;
+    _nbRows = static_cast<std::size_t>(height / _cellSize) + 1;
+
+    // counting sort of the features by cell
+    std::vector<std::size_t> cells(_positions.size());
+    _cellFirstFeature.assign(_nbCols * _nbRows + 1, 0);
+    for(std::size_t i = 0; i < _positions.size(); ++i)
+    {
+      const std::size_t col = std::min(static_cast<std::size_t>((_positions[i](0) - _minX) / _cellSize), _nbCols - 1);
+      const std::size_t row = std::min(static_cast<std::size_t>((_positions[i](1) - _minY) / _cellSize), _nbRows - 1);
+      cells[i] = row * _nbCols + col;
+      ++_cellFirstFeature[cells[i] + 1];
+    }
+    for(std::size_t cell = 0; cell < _nbCols * _nbRows; ++cell)
+      _cellFirstFeature[cell + 1] += _cellFirstFeature[cell];
+
+    _featureIds.resize(_positions.size());
+    std::vector<std::size_t> nextFeature(_cellFirstFeature.begin(), _cellFirstFeature.end() - 1);
+    for(std::size_t i = 0; i < _positions.size(); ++i)
+      _featureIds[nextFeature[cells[i]]++] = static_cast<IndexT>(i);
+  }
+
+  /// Range of cells [begin, end) intersecting [minValue, maxValue] on one axis
+  bool cellRange(double minValue, double maxValue, double origin, std::size_t nbCells, int& begin, int& end) const
+  {
+    const double first = std::floor((minValue - origin) / _cellSize);
+    const double last = std::floor((maxValue - origin) / _cellSize);
+    if(!(last >= 0.0) || !(first < static_cast<double>(nbCells)))
+      return false;
+    begin = static_cast<int>(std::max(first, 0.0));
+    end = static_cast<int>(std::min(last + 1.0, static_cast<double>(nbCells)));
+    return begin < end;
+  }
+
+  /// Visit the features of the consecutive cells [cellBegin, cellEnd)
+  template <typename VisitorT>
+  void visitCells(std::size_t cellBegin, std::size_t cellEnd, VisitorT& visitor) const
+  {
+    for(std::size_t f = _cellFirstFeature[cellBegin]; f < _cellFirstFeature[cellEnd]; ++f)
+      visitor(_featureIds[f]);
+  }
+
+  std::vector<Vec2> _positions;
+  double _minX = 0.0;
+  double _minY = 0.0;
+  double _cellSize = 1.0;
+  std::size_t _nbCols = 0;
+  std::size_t _nbRows = 0;
+  /// nbCols * nbRows + 1 indexes in the feature ids, cells are stored row by row
+  std::vector<std::size_t> _cellFirstFeature;
+  /// Feature ids sorted by cell
+  std::vector<IndexT> _featureIds;
+};
+
+} // namespace robustEstimation
+} // namespace aliceVision
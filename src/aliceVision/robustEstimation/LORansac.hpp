@@ -8,7 +8,10 @@
 #include "aliceVision/robustEstimation/randSampling.hpp"
 #include "aliceVision/robustEstimation/ACRansac.hpp"
 #include "aliceVision/robustEstimation/ransacTools.hpp"
+#include "aliceVision/robustEstimation/ProsacSampler.hpp"
 #include <limits>
+#include <memory>
+#include <random>
 #include <numeric>
 #include <iostream>
 #include <vector>
@@ -283,6 +286,9 @@ double localOptimization(const Kernel &kernel,
  * @param[in] bVerbose Enable/Disable log messages
  * @param[in] max_iterations Maximum number of iterations for the ransac part.
  * @param[in] outliers_probability The wanted probability of picking outliers.
+ * @param[in] sortedIndices Optional data indices sorted by decreasing quality:
+ * if provided the samples are drawn progressively from the best data and the
+ * iterations stop with the PROSAC termination criterion @see ProsacSampler
  * @return The best model found.
  */
 template<typename Kernel, typename Scorer>
@@ -292,7 +298,8 @@ typename Kernel::Model LO_RANSAC(const Kernel &kernel,
                                 double *best_score = NULL,
                                 bool bVerbose = false,
                                 std::size_t max_iterations = 100,
-                                double outliers_probability = 1e-2)
+                                double outliers_probability = 1e-2,
+                                const std::vector<std::size_t> *sortedIndices = nullptr)
 {
   assert(outliers_probability < 1.0);
   assert(outliers_probability > 0.0);
@@ -320,10 +327,22 @@ typename Kernel::Model LO_RANSAC(const Kernel &kernel,
   std::vector<std::size_t> all_samples(total_samples);
   std::iota(all_samples.begin(), all_samples.end(), 0);
 
+  // progressive sampling among the data sorted by quality
+  std::unique_ptr<ProsacSampler> prosac;
+  std::mt19937 generator(std::random_device{}());
+  if(sortedIndices != nullptr && !sortedIndices->empty())
+  {
+    assert(sortedIndices->size() == total_samples);
+    prosac.reset(new ProsacSampler(min_samples, *sortedIndices, really_max_iterations));
+  }
+
   for(iteration = 0; iteration < max_iterations; ++iteration) 
   {
     std::vector<std::size_t> sample;
-    UniformSample(min_samples, total_samples, sample);
+    if(prosac)
+      prosac->sample(generator, sample);
+    else
+      UniformSample(min_samples, total_samples, sample);
 
     std::vector<typename Kernel::Model> models;
     kernel.Fit(sample, &models);
@@ -367,6 +386,9 @@ typename Kernel::Model LO_RANSAC(const Kernel &kernel,
         
         bestNumInliers = inliers.size();
         bestInlierRatio = inliers.size() / double(total_samples);
+        const std::size_t prosacIterations = prosac ?
+          prosac->iterationsRequired(inliers, outliers_probability) :
+          std::numeric_limits<std::size_t>::max();
 
         if (best_inliers) 
         {
@@ -386,6 +408,8 @@ typename Kernel::Model LO_RANSAC(const Kernel &kernel,
           max_iterations = IterationsRequired(min_samples,
                                               outliers_probability,
                                               bestInlierRatio);
+          // the best data may allow to stop earlier than the uniform sampling
+          max_iterations = std::min(max_iterations, prosacIterations);
           // safeguard to not get stuck in a big number of iterations
           max_iterations = std::min(max_iterations, really_max_iterations);
           if(bVerbose)
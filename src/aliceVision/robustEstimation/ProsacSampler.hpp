@@ -0,0 +1,180 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include "aliceVision/robustEstimation/randSampling.hpp"
+#include "aliceVision/robustEstimation/ransacTools.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace aliceVision {
+namespace robustEstimation{
+
+/**
+ * @brief Progressive sampler (PROSAC) drawing the minimal samples from the data
+ * ordered by decreasing quality (e.g. descriptor distance ratio, number of views
+ * confirming a match).
+ * The samples are first drawn among the best data, then the sampling set grows
+ * progressively until it contains all the data, where it becomes equivalent to
+ * a uniform sampling. It also provides the PROSAC termination criterion, which
+ * allows to stop much earlier than the uniform sampling bound when the best
+ * data have a high inlier ratio.
+ *
+ * Ondrej Chum, Jiri Matas:
+ * Matching with PROSAC - Progressive Sample Consensus. CVPR 2005: 220-226
+ */
+class ProsacSampler
+{
+public:
+
+  /**
+   * @param[in] sampleSize The size of the minimal samples (m).
+   * @param[in] sortedIndices The data indices sorted by decreasing quality (kept by reference).
+   * @param[in] nbIterationsGrowth The number of samples after which the sampling
+   * set contains all the data (T_N), usually the maximum number of iterations.
+   * @param[in] minSubsetSize The minimum size of the subsets of the best data used
+   * by the termination criterion, it avoids to stop on a handful of good data.
+   */
+  ProsacSampler(std::size_t sampleSize,
+                const std::vector<std::size_t>& sortedIndices,
+                std::size_t nbIterationsGrowth,
+                std::size_t minSubsetSize = 20)
+    : _sampleSize(sampleSize)
+    , _sortedIndices(sortedIndices)
+    , _minSubsetSize(std::max(minSubsetSize, sampleSize + 1))
+  {
+    const std::size_t nbData = _sortedIndices.size();
+    assert(sampleSize > 0);
+    assert(nbData >= sampleSize);
+
+    // T_m = T_N * prod_{i=0}^{m-1} (m-i)/(N-i), the average number of samples
+    // drawn among the m best data
+    _Tn = static_cast<double>(std::max<std::size_t>(nbIterationsGrowth, 1));
+    for(std::size_t i = 0; i < _sampleSize; ++i)
+      _Tn *= static_cast<double>(_sampleSize - i) / static_cast<double>(nbData - i);
+    _subsetSize = _sampleSize;
+    _TnPrime = 1;
+
+    _rank.resize(nbData);
+    for(std::size_t r = 0; r < nbData; ++r)
+    {
+      assert(_sortedIndices[r] < nbData);
+      _rank[_sortedIndices[r]] = r;
+    }
+  }
+
+  /**
+   * @brief Draw the next minimal sample.
+   * @param[in,out] generator The random generator.
+   * @param[out] sample The data indices of the sample.
+   */
+  template<typename GeneratorT>
+  void sample(GeneratorT& generator, std::vector<std::size_t>& sample)
+  {
+    const std::size_t nbData = _sortedIndices.size();
+    ++_iteration;
+
+    // grow the sampling set when the samples of the current set are exhausted
+    if(_iteration == _TnPrime && _subsetSize < nbData)
+    {
+      const double Tn1 = _Tn * (_subsetSize + 1) / static_cast<double>(_subsetSize + 1 - _sampleSize);
+      _TnPrime += static_cast<std::size_t>(std::ceil(Tn1 - _Tn));
+      _Tn = Tn1;
+      ++_subsetSize;
+    }
+
+    if(_TnPrime < _iteration || _subsetSize == _sampleSize)
+    {
+      // the samples containing the last datum of the set have all been drawn,
+      // semi-random sampling is over: draw uniformly in the current set
+      randSample<std::size_t>(0, _subsetSize, _sampleSize, generator, sample);
+    }
+    else
+    {
+      // m-1 data among the n-1 best ones, and the n-th datum
+      randSample<std::size_t>(0, _subsetSize - 1, _sampleSize - 1, generator, sample);
+      sample.push_back(_subsetSize - 1);
+    }
+
+    for(std::size_t& s : sample)
+      s = _sortedIndices[s];
+  }
+
+  /**
+   * @brief Number of iterations after which the probability to have missed a
+   * model with more inliers is below outliersProbability (maximality), among
+   * the subsets of the best data whose inliers are not consistent by chance
+   * (non-randomness).
+   * @param[in] inliers The data indices of the inliers of the best model so far.
+   * @param[in] outliersProbability The probability to have missed a better model.
+   * @param[in] beta The probability for an outlier to be consistent with a wrong model.
+   * @return The number of iterations required, counted from the first sample.
+   */
+  std::size_t iterationsRequired(const std::vector<std::size_t>& inliers,
+                                 double outliersProbability,
+                                 double beta = 0.05) const
+  {
+    const std::size_t nbData = _sortedIndices.size();
+    std::vector<std::size_t>& isInlier = _inliersPerRank;
+    isInlier.assign(nbData, 0);
+    for(const std::size_t i : inliers)
+      isInlier[_rank[i]] = 1;
+
+    // quantile of the normal law for the 5% probability of the non-randomness test
+    const double z = 1.645;
+    std::size_t bestIterations = std::numeric_limits<std::size_t>::max();
+    std::size_t nbInliers = 0;
+    for(std::size_t n = 0; n < nbData; ++n)
+    {
+      nbInliers += isInlier[n];
+      const std::size_t subsetSize = n + 1;
+
+      // all the samples drawn so far must belong to the subset
+      if(subsetSize < std::max(_minSubsetSize, _subsetSize) && subsetSize < nbData)
+        continue;
+
+      // non-randomness: binomial law of the outliers consistent with the model,
+      // approximated by a normal law
+      const double mu = (subsetSize - _sampleSize) * beta;
+      const double sigma = std::sqrt(mu * (1.0 - beta));
+      if(nbInliers < _sampleSize + mu + z * sigma)
+        continue;
+
+      const std::size_t iterations = (nbInliers == subsetSize) ? 0 :
+        IterationsRequired(_sampleSize, outliersProbability, nbInliers / static_cast<double>(subsetSize));
+      bestIterations = std::min(bestIterations, iterations);
+    }
+    return bestIterations;
+  }
+
+  /// The number of samples drawn so far
+  std::size_t getNbIterations() const { return _iteration; }
+
+  /// The number of best data in the current sampling set
+  std::size_t getSubsetSize() const { return _subsetSize; }
+
+private:
+  std::size_t _sampleSize;
+  const std::vector<std::size_t>& _sortedIndices;
+  std::size_t _minSubsetSize;
+  /// rank of each datum in the quality order
+  std::vector<std::size_t> _rank;
+  /// buffer of the termination criterion
+  mutable std::vector<std::size_t> _inliersPerRank;
+  std::size_t _iteration = 0;
+  std::size_t _subsetSize;
+  /// average number of samples drawn in the current set (T_n)
+  double _Tn;
+  /// number of samples after which the current set grows (T'_n)
+  std::size_t _TnPrime;
+};
+
+} // namespace robustEstimation
+} // namespace aliceVision
@@ -246,6 +246,50 @@ BOOST_AUTO_TEST_CASE(RansacLineFitter_RealisticCase)
   BOOST_CHECK_SMALL(GTModel(1)-line[1], 1e-9);
 }
 
+// Test ACRANSAC with a progressive sampling (PROSAC) of the data sorted by
+//  quality, whether the best data are the inliers or the outliers.
+
+BOOST_AUTO_TEST_CASE(RansacLineFitter_ProsacSampling)
+{
+  const int NbPoints = 100;
+  const float outlierRatio = .3;
+  Mat2X xy(2, NbPoints);
+
+  Vec2 GTModel; // y = 6.3 x + (-2.0)
+  GTModel << -2.0, 6.3;
+
+  for(Mat::Index i = 0; i < NbPoints; ++i)
+  {
+    xy.col(i) << i, (double) i * GTModel[1] + GTModel[0];
+  }
+
+  // The first points are moved to create outliers
+  std::mt19937 gen;
+  std::normal_distribution<> d(0, 5);
+  const int nbPtToNoise = (int) NbPoints * outlierRatio;
+  for(int i = 0; i < nbPtToNoise; ++i)
+    xy.col(i) << d(gen), d(gen);
+
+  ACRANSACOneViewKernel<LineSolver, pointToLineError, Vec2> lineKernel(xy, 12, 12);
+
+  std::vector<std::size_t> inliersFirst(NbPoints);
+  std::iota(inliersFirst.rbegin(), inliersFirst.rend(), 0);
+  std::vector<std::size_t> outliersFirst(NbPoints);
+  std::iota(outliersFirst.begin(), outliersFirst.end(), 0);
+
+  for(const std::vector<std::size_t>* sortedIndices : {&inliersFirst, &outliersFirst})
+  {
+    ACRansacWorkspace workspace;
+    std::vector<std::size_t> vec_inliers;
+    Vec2 line;
+    ACRANSAC(lineKernel, workspace, vec_inliers, 300, &line, std::numeric_limits<double>::infinity(), false, sortedIndices);
+
+    BOOST_CHECK_EQUAL(NbPoints - nbPtToNoise, vec_inliers.size());
+    BOOST_CHECK_SMALL(GTModel(0)-line[0], 1e-9);
+    BOOST_CHECK_SMALL(GTModel(1)-line[1], 1e-9);
+  }
+}
+
 // Generate nbPoints along a line and add gaussian noise.
 // Move some point in the dataset to create outlier contamined data
 
@@ -360,3 +404,56 @@ BOOST_AUTO_TEST_CASE(RansacLineFitter_ACRANSACSimu)
 
   }
 }
+
+// Check that the tabulated log combinations are the same as the direct computation
+
+BOOST_AUTO_TEST_CASE(RansacLineFitter_LogCombi)
+{
+  for(std::size_t n = 0; n < 64; ++n)
+  {
+    std::vector<double> vec_log10(n + 1);
+    for(std::size_t k = 0; k <= n; ++k)
+      vec_log10[k] = log10((double) k);
+
+    std::vector<double> vec_logc_n;
+    makelogcombi_n(n, vec_logc_n, vec_log10);
+    BOOST_CHECK_EQUAL(n + 1, vec_logc_n.size());
+    for(std::size_t k = 0; k <= n; ++k)
+      BOOST_CHECK_EQUAL(logcombi<double>(k, n, vec_log10), vec_logc_n[k]);
+  }
+}
+
+// Reuse one ACRANSAC workspace for datasets of different sizes
+//  and check that the number of inliers and the model are correct.
+
+BOOST_AUTO_TEST_CASE(RansacLineFitter_Workspace)
+{
+  Vec2 GTModel; // y = 6.3 x + (-2.0)
+  GTModel << -2.0, 6.3;
+
+  std::mt19937 gen;
+  std::normal_distribution<> d(0, 5);
+  ACRansacWorkspace workspace;
+
+  for(const int nbPoints : {100, 40, 250, 100})
+  {
+    Mat2X xy(2, nbPoints);
+    for(Mat::Index i = 0; i < nbPoints; ++i)
+      xy.col(i) << i, (double) i * GTModel[1] + GTModel[0];
+
+    // the first 30% of the points are outliers
+    const int nbPtToNoise = nbPoints * 3 / 10;
+    for(int i = 0; i < nbPtToNoise; ++i)
+      xy.col(i) << d(gen), d(gen);
+
+    ACRANSACOneViewKernel<LineSolver, pointToLineError, Vec2> lineKernel(xy, 12, 12);
+
+    std::vector<std::size_t> vec_inliers;
+    Vec2 line;
+    ACRANSAC(lineKernel, workspace, vec_inliers, 300, &line);
+
+    BOOST_CHECK_EQUAL(nbPoints - nbPtToNoise, vec_inliers.size());
+    BOOST_CHECK_SMALL(GTModel(0)-line[0], 1e-9);
+    BOOST_CHECK_SMALL(GTModel(1)-line[1], 1e-9);
+  }
+}
@@ -11,6 +11,7 @@
 
 #include "aliceVision/feature/Regions.hpp"
 #include "aliceVision/camera/IntrinsicBase.hpp"
+#include "aliceVision/robustEstimation/FeaturesGrid.hpp"
 
 #include <vector>
 
@@ -280,6 +281,93 @@ void GuidedMatching(
   }
 }
 
+/**
+ * @brief Search of the right features compatible with a fundamental matrix:
+ * the features of the grid cells close to the epipolar line of the left point.
+ * To use with an error that is the squared distance to the epipolar line.
+ */
+struct EpipolarLineSearch
+{
+  template <typename VisitorT>
+  static void visit(const Mat3& F, const Vec2& xLeft, const FeaturesGrid& rightGrid, double errorTh, VisitorT&& visitor)
+  {
+    const Vec3 line = F * Vec3(xLeft(0), xLeft(1), 1.0);
+    rightGrid.visitLineBand(line, std::sqrt(errorTh), visitor);
+  }
+};
+
+/**
+ * @brief Search of the right features compatible with a homography:
+ * the features of the grid cells close to the transferred left point.
+ * To use with an error that is the squared distance to the transferred point.
+ */
+struct TransferredPointSearch
+{
+  template <typename VisitorT>
+  static void visit(const Mat3& H, const Vec2& xLeft, const FeaturesGrid& rightGrid, double errorTh, VisitorT&& visitor)
+  {
+    const Vec3 x = H * Vec3(xLeft(0), xLeft(1), 1.0);
+    if(x(2) == 0.0)
+      return;
+    rightGrid.visitDisc(x.head<2>() / x(2), std::sqrt(errorTh), visitor);
+  }
+};
+
+/**
+ * @brief Guided Matching (features + descriptors with distance ratio) with a spatial index:
+ * Use a model to find valid correspondences:
+ * Keep the best corresponding points for the given model under the
+ * user specified distance ratio.
+ * Only the right features of the grid cells selected by SearchArg are tested,
+ * instead of all the right features.
+ * The grids can be built once per view (with undistorted positions) and reused for all the pairs.
+ */
+template<
+  typename ModelArg,  // The used model type
+  typename ErrorArg,  // The metric to compute distance to the model
+  typename SearchArg  // The search of the right features compatible with the model (EpipolarLineSearch, TransferredPointSearch)
+  >
+void GuidedMatching_Grid(
+  const ModelArg & mod, // The model
+  const FeaturesGrid & lGrid,  // left (undistorted) feature positions
+  const feature::Regions & lRegions,  // regions (point features & corresponding descriptors)
+  const FeaturesGrid & rGrid,  // right (undistorted) feature positions
+  const feature::Regions & rRegions,  // regions (point features & corresponding descriptors)
+  double errorTh,       // Maximal authorized error threshold
+  double distRatio,     // Maximal authorized distance ratio
+  matching::IndMatches & out_matches) // Ouput corresponding index
+{
+  assert(lGrid.positions().size() == lRegions.RegionCount());
+  assert(rGrid.positions().size() == rRegions.RegionCount());
+
+  const std::vector<Vec2>& lRegionsPos = lGrid.positions();
+  const std::vector<Vec2>& rRegionsPos = rGrid.positions();
+
+  for(std::size_t i = 0; i < lRegions.RegionCount(); ++i)
+  {
+    distanceRatio<double> dR;
+    SearchArg::visit(mod, lRegionsPos[i], rGrid, errorTh, [&](IndexT j)
+    {
+      // Compute the geometric error: error to the model
+      const double geomErr = ErrorArg::Error(mod, lRegionsPos[i], rRegionsPos[j]);
+      if(geomErr < errorTh)
+      {
+        // Update the corresponding points & distance (if required)
+        dR.update(j, lRegions.SquaredDescriptorDistance(i, &rRegions, j));
+      }
+    });
+    // Add correspondence only iff the distance ratio is valid
+    if(dR.isValid(distRatio))
+    {
+      // save the best corresponding index
+      out_matches.emplace_back(i, dR.idx);
+    }
+  }
+
+  // Remove duplicates (when multiple points at same position exist)
+  matching::IndMatch::getDeduplicated(out_matches);
+}
+
 /// Compute a bucket index from an epipolar point
 ///  (the one that is closer to image border intersection)
 inline unsigned int pix_to_bucket(const Vec2i &x, int W, int H)
@@ -0,0 +1,170 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "aliceVision/robustEstimation/guidedMatching.hpp"
+#include "aliceVision/robustEstimation/FeaturesGrid.hpp"
+#include "aliceVision/feature/regionsFactory.hpp"
+#include "aliceVision/multiview/fundamentalKernelSolver.hpp"
+#include "aliceVision/multiview/homographyKernelSolver.hpp"
+
+#include <algorithm>
+#include <random>
+
+#define BOOST_TEST_MODULE guidedMatching
+#include <boost/test/included/unit_test.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::robustEstimation;
+
+namespace {
+
+/// Random positions in a 1000x800 image with random descriptors
+void generateRegions(std::size_t nbFeatures, std::mt19937& generator, feature::SIFT_Regions& regions)
+{
+  std::uniform_real_distribution<float> x(0.f, 1000.f);
+  std::uniform_real_distribution<float> y(0.f, 800.f);
+  std::uniform_int_distribution<int> value(0, 255);
+  for(std::size_t i = 0; i < nbFeatures; ++i)
+  {
+    regions.Features().emplace_back(x(generator), y(generator));
+    feature::SIFT_Regions::DescriptorT desc;
+    for(std::size_t j = 0; j < desc.size(); ++j)
+      desc[j] = static_cast<unsigned char>(value(generator));
+    regions.Descriptors().push_back(desc);
+  }
+}
+
+/// Right regions with the features of the left regions moved by a function and slightly modified descriptors
+template <typename TransferT>
+void generateCorrespondingRegions(const feature::SIFT_Regions& left, TransferT transfer, std::mt19937& generator, feature::SIFT_Regions& right)
+{
+  std::uniform_int_distribution<int> noise(-5, 5);
+  for(std::size_t i = 0; i < left.RegionCount(); ++i)
+  {
+    const Vec2 x = transfer(left.GetRegionPosition(i));
+    right.Features().emplace_back(x(0), x(1));
+    feature::SIFT_Regions::DescriptorT desc = left.Descriptors()[i];
+    for(std::size_t j = 0; j < desc.size(); ++j)
+      desc[j] = static_cast<unsigned char>(std::min(255, std::max(0, desc[j] + noise(generator))));
+    right.Descriptors().push_back(desc);
+  }
+}
+
+std::vector<Vec2> getPositions(const feature::Regions& regions)
+{
+  std::vector<Vec2> positions(regions.RegionCount());
+  for(std::size_t i = 0; i < regions.RegionCount(); ++i)
+    positions[i] = regions.GetRegionPosition(i);
+  return positions;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(FeaturesGrid_visitIsConservative)
+{
+  std::mt19937 generator(42);
+  std::uniform_real_distribution<double> x(0.0, 1000.0);
+  std::uniform_real_distribution<double> y(0.0, 800.0);
+  std::uniform_real_distribution<double> angle(0.0, M_PI);
+
+  std::vector<Vec2> positions(2000);
+  for(Vec2& position : positions)
+    position = Vec2(x(generator), y(generator));
+  const FeaturesGrid grid(positions);
+
+  for(int test = 0; test < 50; ++test)
+  {
+    // line through a random point with a random direction
+    const Vec2 point(x(generator), y(generator));
+    const double theta = angle(generator);
+    const Vec3 line(std::sin(theta), -std::cos(theta), -std::sin(theta) * point(0) + std::cos(theta) * point(1));
+    const double halfWidth = 4.0;
+
+    std::vector<bool> isVisited(positions.size(), false);
+    grid.visitLineBand(line, halfWidth, [&](IndexT i) { BOOST_CHECK(!isVisited[i]); isVisited[i] = true; });
+    for(std::size_t i = 0; i < positions.size(); ++i)
+    {
+      if(std::abs(line.dot(Vec3(positions[i](0), positions[i](1), 1.0))) <= halfWidth)
+        BOOST_CHECK(isVisited[i]);
+    }
+
+    const double radius = 10.0;
+    std::fill(isVisited.begin(), isVisited.end(), false);
+    grid.visitDisc(point, radius, [&](IndexT i) { BOOST_CHECK(!isVisited[i]); isVisited[i] = true; });
+    for(std::size_t i = 0; i < positions.size(); ++i)
+    {
+      if((positions[i] - point).norm() <= radius)
+        BOOST_CHECK(isVisited[i]);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(GuidedMatching_Grid_Homography)
+{
+  std::mt19937 generator(42);
+  Mat3 H;
+  H << 1.1, 0.05, 20.0,
+       -0.03, 0.95, -15.0,
+       1e-5, 2e-5, 1.0;
+
+  feature::SIFT_Regions left, right;
+  generateRegions(1500, generator, left);
+  generateCorrespondingRegions(left, [&](const Vec2& x) { const Vec3 y = H * Vec3(x(0), x(1), 1.0); return Vec2(y.head<2>() / y(2)); }, generator, right);
+  // unrelated features
+  generateRegions(500, generator, right);
+
+  const double errorTh = Square(4.0);
+  const double distRatio = Square(0.8);
+
+  matching::IndMatches matches;
+  GuidedMatching<Mat3, homography::kernel::AsymmetricError>(H, nullptr, left, nullptr, right, errorTh, distRatio, matches);
+
+  matching::IndMatches gridMatches;
+  GuidedMatching_Grid<Mat3, homography::kernel::AsymmetricError, TransferredPointSearch>(
+    H, FeaturesGrid(getPositions(left)), left, FeaturesGrid(getPositions(right)), right, errorTh, distRatio, gridMatches);
+
+  // the ratio test needs a second candidate close to the transferred point
+  BOOST_CHECK_GT(matches.size(), 100);
+  BOOST_CHECK(matches == gridMatches);
+}
+
+BOOST_AUTO_TEST_CASE(GuidedMatching_Grid_Fundamental)
+{
+  std::mt19937 generator(42);
+  std::uniform_real_distribution<double> depth(5.0, 20.0);
+
+  // two cameras with a horizontal baseline
+  Mat3 K;
+  K << 800.0, 0.0, 500.0,
+       0.0, 800.0, 400.0,
+       0.0, 0.0, 1.0;
+  const Vec3 t(-1.0, 0.1, 0.0);
+  const Mat3 R = Eigen::AngleAxisd(0.05, Vec3::UnitY()).toRotationMatrix();
+  const Mat3 F = K.inverse().transpose() * CrossProductMatrix(t) * R * K.inverse();
+
+  feature::SIFT_Regions left, right;
+  generateRegions(1500, generator, left);
+  generateCorrespondingRegions(left, [&](const Vec2& x)
+  {
+    const Vec3 X = K.inverse() * Vec3(x(0), x(1), 1.0) * depth(generator);
+    const Vec3 y = K * (R * X + t);
+    return Vec2(y.head<2>() / y(2));
+  }, generator, right);
+  // unrelated features
+  generateRegions(500, generator, right);
+
+  const double errorTh = Square(4.0);
+  const double distRatio = Square(0.8);
+
+  matching::IndMatches matches;
+  GuidedMatching<Mat3, fundamental::kernel::EpipolarDistanceError>(F, nullptr, left, nullptr, right, errorTh, distRatio, matches);
+
+  matching::IndMatches gridMatches;
+  GuidedMatching_Grid<Mat3, fundamental::kernel::EpipolarDistanceError, EpipolarLineSearch>(
+    F, FeaturesGrid(getPositions(left)), left, FeaturesGrid(getPositions(right)), right, errorTh, distRatio, gridMatches);
+
+  BOOST_CHECK_GT(matches.size(), 1000);
+  BOOST_CHECK(matches == gridMatches);
+}
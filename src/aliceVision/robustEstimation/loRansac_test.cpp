@@ -11,7 +11,9 @@
 
 #include "aliceVision/numeric/numeric.hpp"
 
+#include <algorithm>
 #include <iostream>
+#include <numeric>
 #include <random>
 #include <fstream>
 #include <vector>
@@ -159,3 +161,43 @@ BOOST_AUTO_TEST_CASE(LoRansacLineFitter_RealCaseLoRansac)
     BOOST_CHECK_EQUAL(expectedInliers, vec_inliers.size());
   }
 }
+
+BOOST_AUTO_TEST_CASE(LoRansacLineFitter_ProsacLoRansac)
+{
+
+  const std::size_t numPoints = 1000;
+  const double outlierRatio = .9;
+  const double gaussianNoiseLevel = 0.0;
+  const std::size_t numTrials = 10;
+
+  Vec2 GTModel; // y = 2x + 6.3
+  GTModel <<  -2.0, 6.3;
+
+  std::mt19937 gen;
+
+  for(std::size_t trial = 0; trial < numTrials; ++trial)
+  {
+    Mat2X xy(2, numPoints);
+    std::vector<std::size_t> vec_inliersGT;
+    generateLine(numPoints, outlierRatio, gaussianNoiseLevel, GTModel, gen, xy, vec_inliersGT);
+
+    // a quality order where the inliers are mostly among the best data
+    std::vector<double> quality(numPoints);
+    std::uniform_real_distribution<double> random(0.0, 1.0);
+    for(auto& q : quality)
+      q = random(gen);
+    for(const auto i : vec_inliersGT)
+      quality[i] += 0.5;
+    std::vector<std::size_t> sortedIndices(numPoints);
+    std::iota(sortedIndices.begin(), sortedIndices.end(), 0);
+    std::sort(sortedIndices.begin(), sortedIndices.end(), [&](std::size_t a, std::size_t b){ return quality[a] > quality[b]; });
+
+    LineKernelLoRansac kernel(xy);
+    std::vector<std::size_t> vec_inliers;
+    const Vec2 model = LO_RANSAC(kernel, ScoreEvaluator<LineKernel>(0.3), &vec_inliers, nullptr, false, 100, 1e-2, &sortedIndices);
+
+    BOOST_CHECK_EQUAL(vec_inliersGT.size(), vec_inliers.size());
+    BOOST_CHECK_SMALL(GTModel[0]-model[0], 1e-2);
+    BOOST_CHECK_SMALL(GTModel[1]-model[1], 1e-2);
+  }
+}
@@ -11,6 +11,8 @@
 #include <cstdlib>
 #include <random>
 #include <cassert>
+#include <numeric>
+#include <vector>
 
 namespace aliceVision {
 namespace robustEstimation{
@@ -79,6 +81,41 @@ inline std::vector<IntT> randSample(IntT lowerBound,
   }
 }
 
+/**
+ * @brief Generate unique random samples without replacement in the range
+ * [lowerBound upperBound) with a given generator.
+ * It uses Robert Floyd's algorithm with a linear search in the drawn samples,
+ * so it is intended for small samples (e.g. the minimal samples of a solver),
+ * and it does not allocate if the samples vector has the capacity.
+ *
+ * @param[in] lowerBound The lower bound of the range.
+ * @param[in] upperBound The upper bound of the range (not included).
+ * @param[in] numSamples Number of unique samples to draw.
+ * @param[in,out] generator The random generator.
+ * @param[out] samples The vector containing the samples.
+ */
+template<typename IntT, typename GeneratorT>
+inline void randSample(IntT lowerBound,
+                       IntT upperBound,
+                       IntT numSamples,
+                       GeneratorT& generator,
+                       std::vector<IntT>& samples)
+{
+  assert(lowerBound < upperBound);
+  assert(numSamples <= upperBound - lowerBound);
+  static_assert(std::is_integral<IntT>::value, "Only integer types are supported");
+
+  samples.clear();
+  for(IntT d = upperBound - numSamples; d < upperBound; ++d)
+  {
+    const IntT t = std::uniform_int_distribution<IntT>(lowerBound, d)(generator);
+    if(std::find(samples.begin(), samples.end(), t) == samples.end())
+      samples.push_back(t);
+    else
+      samples.push_back(d);
+  }
+}
+
 /**
 * @brief Pick a random subset of the integers in the range [0, upperBound).
 *
@@ -154,5 +191,28 @@ inline void UniformSample(std::size_t sampleSize,
   }
 }
 
+/**
+ * @brief Generate a random sampling without replacement of the elements
+ * of the input vector with a given generator, without allocation if the
+ * sample vector has the capacity.
+ *
+ * @param[in] sampleSize The size of the sample to generate.
+ * @param[in] elements The possible data indices.
+ * @param[in,out] generator The random generator.
+ * @param[out] sample The random sample of sizeSample indices.
+ */
+template<typename GeneratorT>
+inline void UniformSample(std::size_t sampleSize,
+                          const std::vector<std::size_t>& elements,
+                          GeneratorT& generator,
+                          std::vector<std::size_t>& sample)
+{
+  randSample<std::size_t>(0, elements.size(), sampleSize, generator, sample);
+  for(auto& s : sample)
+  {
+    s = elements[ s ];
+  }
+}
+
 } // namespace robustEstimation
 } // namespace aliceVision
@@ -4,6 +4,9 @@
 // You can obtain one at https://mozilla.org/MPL/2.0/.
 
 #include "aliceVision/robustEstimation/randSampling.hpp"
+#include "aliceVision/robustEstimation/ProsacSampler.hpp"
+#include <numeric>
+#include <random>
 #include <set>
 #include <vector>
 
@@ -109,3 +112,69 @@ BOOST_AUTO_TEST_CASE(UniformSampleTest_randSample) {
     }
   }
 }
+
+// Assert that the progressive samples are unique, drawn among the best data
+// first, and that the sampling set grows until it contains all the data
+BOOST_AUTO_TEST_CASE(ProsacSamplerTest_Progression) {
+
+  const std::size_t nbData = 500;
+  const std::size_t sampleSize = 3;
+  const std::size_t nbIterations = 1000;
+
+  // the best data are the last indices
+  std::vector<std::size_t> sortedIndices(nbData);
+  std::iota(sortedIndices.rbegin(), sortedIndices.rend(), 0);
+
+  std::mt19937 generator(0);
+  ProsacSampler sampler(sampleSize, sortedIndices, nbIterations);
+  std::vector<std::size_t> sample;
+  std::size_t subsetSize = sampleSize;
+  for(std::size_t iter = 0; iter < 2 * nbIterations; ++iter)
+  {
+    sampler.sample(generator, sample);
+    BOOST_CHECK_GE(sampler.getSubsetSize(), subsetSize);
+    subsetSize = sampler.getSubsetSize();
+
+    BOOST_CHECK_EQUAL(sample.size(), sampleSize);
+    const std::set<std::size_t> uniqueSample(sample.begin(), sample.end());
+    BOOST_CHECK_EQUAL(uniqueSample.size(), sampleSize);
+    for(const auto& s : sample)
+    {
+      BOOST_CHECK(s < nbData);
+      // rank of the datum in the quality order
+      BOOST_CHECK(nbData - 1 - s < subsetSize);
+    }
+  }
+  BOOST_CHECK_EQUAL(sampler.getNbIterations(), 2 * nbIterations);
+  BOOST_CHECK_EQUAL(sampler.getSubsetSize(), nbData);
+}
+
+// Assert that the termination criterion stops earlier when the best data are
+// the inliers, and that it matches the uniform sampling bound otherwise
+BOOST_AUTO_TEST_CASE(ProsacSamplerTest_IterationsRequired) {
+
+  const std::size_t nbData = 1000;
+  const std::size_t sampleSize = 3;
+  const double outliersProbability = 0.01;
+
+  std::vector<std::size_t> sortedIndices(nbData);
+  std::iota(sortedIndices.begin(), sortedIndices.end(), 0);
+  ProsacSampler sampler(sampleSize, sortedIndices, 4096);
+
+  // 20% of inliers spread over the data: the whole data is the best subset
+  std::vector<std::size_t> spreadInliers;
+  for(std::size_t i = 4; i < nbData; i += 5)
+    spreadInliers.push_back(i);
+  const std::size_t uniformIterations = IterationsRequired(sampleSize, outliersProbability, 0.2);
+  BOOST_CHECK_EQUAL(sampler.iterationsRequired(spreadInliers, outliersProbability), uniformIterations);
+
+  // the same number of inliers among the best data
+  std::vector<std::size_t> bestInliers;
+  for(std::size_t i = 0; i < spreadInliers.size(); ++i)
+    bestInliers.push_back(i + (i % 10 == 0 ? spreadInliers.size() : 0));
+  BOOST_CHECK_LT(sampler.iterationsRequired(bestInliers, outliersProbability), 10);
+
+  // too few inliers to be a non random consensus
+  const std::vector<std::size_t> fewInliers = {0, 1, 2};
+  BOOST_CHECK_EQUAL(sampler.iterationsRequired(fewInliers, outliersProbability), std::numeric_limits<std::size_t>::max());
+}
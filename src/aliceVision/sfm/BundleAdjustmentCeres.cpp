@@ -4,6 +4,7 @@
 // You can obtain one at https://mozilla.org/MPL/2.0/.
 
 #include <aliceVision/sfm/BundleAdjustmentCeres.hpp>
+#include <aliceVision/sfm/PackedLandmarks.hpp>
 #include <aliceVision/config.hpp>
 #include <aliceVision/alicevision_omp.hpp>
 
@@ -365,15 +366,20 @@ bool BundleAdjustmentCeres::Adjust(
   // TODO: make the LOSS function and the parameter an option
 
 
+  // Pack the landmarks: the positions are refined in contiguous arrays and
+  // copied back to the scene only if the solution is usable
+  PackedLandmarks landmarks(sfm_data.structure);
+
   // For all visibility add reprojections errors:
-  for(auto& landmarkIt: sfm_data.structure)
+  for(std::size_t i = 0; i < landmarks.size(); ++i)
   {
-    const Observations & observations = landmarkIt.second.observations;
+    double* landmark_ptr = landmarks.X(i).data();
     // Iterate over 2D observation associated to the 3D landmark
-    for (const auto& observationIt: observations)
+    for(std::size_t o = landmarks.observationsBegin(i); o < landmarks.observationsEnd(i); ++o)
     {
       // Build the residual block corresponding to the track observation:
-      const View * view = sfm_data.views.at(observationIt.first).get();
+      const View * view = sfm_data.views.at(landmarks.viewId(o)).get();
+      const Vec2 observation = landmarks.x(o);
 
       // Each Residual block takes a point and a camera as input and outputs a 2
       // dimensional residual. Internally, the cost function stores the observed
@@ -381,7 +387,7 @@ bool BundleAdjustmentCeres::Adjust(
 
       if(view->isPartOfRig())
       {
-        ceres::CostFunction* costFunction = createRigCostFunctionFromIntrinsics(sfm_data.intrinsics[view->getIntrinsicId()].get(), observationIt.second.x);
+        ceres::CostFunction* costFunction = createRigCostFunctionFromIntrinsics(sfm_data.intrinsics[view->getIntrinsicId()].get(), observation);
 
         const Rig& rig = sfm_data.getRig(*view);
         const RigSubPose& rigSubPose = rig.getSubPose(view->getSubPoseId());
@@ -395,22 +401,22 @@ bool BundleAdjustmentCeres::Adjust(
           &map_intrinsics[view->getIntrinsicId()][0],
           &map_poses[view->getPoseId()][0],
           subpose_ptr, // subpose of the cameras rig
-          landmarkIt.second.X.data()); //Do we need to copy 3D point to avoid false motion, if failure ?
+          landmark_ptr);
       }
       else
       {
-        ceres::CostFunction* costFunction = createCostFunctionFromIntrinsics(sfm_data.intrinsics[view->getIntrinsicId()].get(), observationIt.second.x);
+        ceres::CostFunction* costFunction = createCostFunctionFromIntrinsics(sfm_data.intrinsics[view->getIntrinsicId()].get(), observation);
 
         problem.AddResidualBlock(
           costFunction,
           p_LossFunction,
           &map_intrinsics[view->getIntrinsicId()][0],
           &map_poses[view->getPoseId()][0],
-          landmarkIt.second.X.data()); //Do we need to copy 3D point to avoid false motion, if failure ?
+          landmark_ptr);
       }
     }
     if (!(refineOptions & BA_REFINE_STRUCTURE))
-      problem.SetParameterBlockConstant(landmarkIt.second.X.data());
+      problem.SetParameterBlockConstant(landmark_ptr);
   }
 
   // Configure a BA engine and run it
@@ -488,6 +494,10 @@ bool BundleAdjustmentCeres::Adjust(
     }
   }
 
+  // Update the landmarks with refined data
+  if (refineOptions & BA_REFINE_STRUCTURE)
+    landmarks.updatePositions(sfm_data.structure);
+
   // Update camera intrinsics with refined data
   if (refineIntrinsics)
   {
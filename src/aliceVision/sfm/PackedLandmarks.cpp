@@ -0,0 +1,129 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "PackedLandmarks.hpp"
+
+#include <algorithm>
+
+namespace aliceVision {
+namespace sfm {
+
+namespace {
+
+template <typename T>
+std::size_t vectorMemorySize(const std::vector<T>& v)
+{
+  return v.capacity() * sizeof(T);
+}
+
+} // namespace
+
+void PackedLandmarks::assign(const Landmarks& landmarks)
+{
+  // the HashMap may be unordered, the landmarks are packed by id
+  std::vector<const Landmarks::value_type*> sortedLandmarks;
+  sortedLandmarks.reserve(landmarks.size());
+  std::size_t nbObservations = 0;
+  for(const auto& landmark : landmarks)
+  {
+    sortedLandmarks.push_back(&landmark);
+    nbObservations += landmark.second.observations.size();
+  }
+  std::sort(sortedLandmarks.begin(), sortedLandmarks.end(),
+            [](const Landmarks::value_type* a, const Landmarks::value_type* b) { return a->first < b->first; });
+
+  const std::size_t nbLandmarks = sortedLandmarks.size();
+
+  _landmarkIds.resize(nbLandmarks);
+  _positions.resize(3 * nbLandmarks);
+  _colors.resize(nbLandmarks);
+  _descTypes.resize(nbLandmarks);
+  _observationRanges.resize(nbLandmarks + 1);
+  _viewIds.resize(nbObservations);
+  _featureIds.resize(nbObservations);
+  _coords.resize(2 * nbObservations);
+
+  std::size_t o = 0;
+  for(std::size_t i = 0; i < nbLandmarks; ++i)
+  {
+    const Landmark& landmark = sortedLandmarks[i]->second;
+    _landmarkIds[i] = sortedLandmarks[i]->first;
+    X(i) = landmark.X;
+    _colors[i] = landmark.rgb;
+    _descTypes[i] = landmark.descType;
+    _observationRanges[i] = o;
+    for(const auto& observation : landmark.observations)
+    {
+      _viewIds[o] = observation.first;
+      _featureIds[o] = observation.second.id_feat;
+      _coords[2 * o] = observation.second.x(0);
+      _coords[2 * o + 1] = observation.second.x(1);
+      ++o;
+    }
+  }
+  _observationRanges[nbLandmarks] = o;
+}
+
+void PackedLandmarks::toLandmarks(Landmarks& landmarks) const
+{
+  landmarks.clear();
+  for(std::size_t i = 0; i < size(); ++i)
+  {
+    Landmark& landmark = landmarks[_landmarkIds[i]];
+    landmark.X = X(i);
+    landmark.rgb = _colors[i];
+    landmark.descType = _descTypes[i];
+    landmark.observations.reserve(observationsEnd(i) - observationsBegin(i));
+    // the observations are packed by increasing view id
+    for(std::size_t o = observationsBegin(i); o < observationsEnd(i); ++o)
+      landmark.observations.emplace_hint(landmark.observations.end(), _viewIds[o], Observation(x(o), _featureIds[o]));
+  }
+}
+
+void PackedLandmarks::updatePositions(Landmarks& landmarks) const
+{
+  for(std::size_t i = 0; i < size(); ++i)
+    landmarks.at(_landmarkIds[i]).X = X(i);
+}
+
+std::size_t PackedLandmarks::find(IndexT landmarkId) const
+{
+  const auto it = std::lower_bound(_landmarkIds.begin(), _landmarkIds.end(), landmarkId);
+  if(it == _landmarkIds.end() || *it != landmarkId)
+    return size();
+  return std::distance(_landmarkIds.begin(), it);
+}
+
+std::size_t PackedLandmarks::memorySize() const
+{
+  return vectorMemorySize(_landmarkIds) +
+         vectorMemorySize(_positions) +
+         vectorMemorySize(_colors) +
+         vectorMemorySize(_descTypes) +
+         vectorMemorySize(_observationRanges) +
+         vectorMemorySize(_viewIds) +
+         vectorMemorySize(_featureIds) +
+         vectorMemorySize(_coords);
+}
+
+std::size_t PackedLandmarks::estimateMemorySize(const Landmarks& landmarks)
+{
+  // typical allocator overhead per allocation
+  const std::size_t allocationOverhead = 16;
+  // a container node holds the value and at least 2 pointers (tree or hash chain + bucket)
+  const std::size_t nodeSize = sizeof(Landmarks::value_type) + 2 * sizeof(void*) + allocationOverhead;
+
+  std::size_t size = landmarks.size() * nodeSize;
+  for(const auto& landmark : landmarks)
+  {
+    const std::size_t capacity = landmark.second.observations.capacity();
+    if(capacity > 0)
+      size += capacity * sizeof(Observations::value_type) + allocationOverhead;
+  }
+  return size;
+}
+
+} // namespace sfm
+} // namespace aliceVision
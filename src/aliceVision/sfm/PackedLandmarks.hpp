@@ -0,0 +1,265 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/types.hpp>
+#include <aliceVision/sfm/SfMData.hpp>
+
+#include <cstddef>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+namespace aliceVision {
+namespace sfm {
+
+/**
+ * @brief Landmarks stored as a structure of arrays.
+ *
+ * The positions, colors and describer types are stored in contiguous arrays
+ * ordered by landmark id, and the observations of all the landmarks are packed
+ * in contiguous arrays, each landmark referencing a range of observations.
+ * It avoids the allocations of the Landmarks HashMap (one per landmark and
+ * per observations container) for read-mostly processing of large scenes.
+ *
+ * The landmarks can be iterated like the Landmarks HashMap: the iterators
+ * give a pair of the landmark id and a LandmarkRef with the same members
+ * as a Landmark, so read-only code using SfMData::GetLandmarks() can be
+ * written once for both storages.
+ */
+class PackedLandmarks
+{
+public:
+  /**
+   * @brief Holds a value built on dereference, for the operator-> of the iterators.
+   */
+  template <typename T>
+  struct ArrowProxy
+  {
+    explicit ArrowProxy(const T& value)
+      : _value(value)
+    {}
+
+    const T* operator->() const { return &_value; }
+
+  private:
+    T _value;
+  };
+
+  /**
+   * @brief Read-only reference to a packed observation, with the members of an Observation.
+   */
+  struct ObservationRef
+  {
+    ObservationRef(const double* coords, IndexT featId)
+      : x(coords)
+      , id_feat(featId)
+    {}
+
+    Eigen::Map<const Vec2> x;
+    IndexT id_feat;
+  };
+
+  /**
+   * @brief Read-only range of the packed observations of a landmark,
+   * iterated as Observations: pairs of view id and observation.
+   */
+  class ObservationsRef
+  {
+  public:
+    /**
+     * @brief Input iterator: the pairs are built on dereference and returned by value.
+     */
+    class const_iterator
+    {
+    public:
+      using iterator_category = std::input_iterator_tag;
+      using value_type = std::pair<IndexT, ObservationRef>;
+      using difference_type = std::ptrdiff_t;
+      using reference = value_type;
+      using pointer = ArrowProxy<value_type>;
+
+      const_iterator(const PackedLandmarks& landmarks, std::size_t index)
+        : _landmarks(&landmarks)
+        , _index(index)
+      {}
+
+      reference operator*() const
+      {
+        return value_type(_landmarks->viewId(_index),
+                          ObservationRef(&_landmarks->_coords[2 * _index], _landmarks->featureId(_index)));
+      }
+      pointer operator->() const { return pointer(**this); }
+      const_iterator& operator++() { ++_index; return *this; }
+      const_iterator operator++(int) { const_iterator it = *this; ++_index; return it; }
+      bool operator==(const const_iterator& other) const { return _index == other._index; }
+      bool operator!=(const const_iterator& other) const { return _index != other._index; }
+
+    private:
+      const PackedLandmarks* _landmarks;
+      std::size_t _index;
+    };
+
+    ObservationsRef(const PackedLandmarks& landmarks, std::size_t first, std::size_t last)
+      : _landmarks(landmarks)
+      , _first(first)
+      , _last(last)
+    {}
+
+    const_iterator begin() const { return const_iterator(_landmarks, _first); }
+    const_iterator end() const { return const_iterator(_landmarks, _last); }
+    std::size_t size() const { return _last - _first; }
+    bool empty() const { return _last == _first; }
+
+  private:
+    const PackedLandmarks& _landmarks;
+    std::size_t _first;
+    std::size_t _last;
+  };
+
+  /**
+   * @brief Read-only reference to a packed landmark, with the members of a Landmark.
+   */
+  struct LandmarkRef
+  {
+    LandmarkRef(const PackedLandmarks& landmarks, std::size_t index)
+      : X(&landmarks._positions[3 * index])
+      , descType(landmarks._descTypes[index])
+      , observations(landmarks, landmarks._observationRanges[index], landmarks._observationRanges[index + 1])
+      , rgb(landmarks._colors[index])
+    {}
+
+    Eigen::Map<const Vec3> X;
+    feature::EImageDescriberType descType;
+    ObservationsRef observations;
+    const image::RGBColor& rgb;
+  };
+
+  /**
+   * @brief Iterator on the landmarks, ordered by landmark id, giving pairs of landmark id and LandmarkRef.
+   * Input iterator: the pairs are built on dereference and returned by value.
+   */
+  class const_iterator
+  {
+  public:
+    using iterator_category = std::input_iterator_tag;
+    using value_type = std::pair<IndexT, LandmarkRef>;
+    using difference_type = std::ptrdiff_t;
+    using reference = value_type;
+    using pointer = ArrowProxy<value_type>;
+
+    const_iterator(const PackedLandmarks& landmarks, std::size_t index)
+      : _landmarks(&landmarks)
+      , _index(index)
+    {}
+
+    reference operator*() const
+    {
+      return value_type(_landmarks->landmarkId(_index), LandmarkRef(*_landmarks, _index));
+    }
+    pointer operator->() const { return pointer(**this); }
+    const_iterator& operator++() { ++_index; return *this; }
+    const_iterator operator++(int) { const_iterator it = *this; ++_index; return it; }
+    bool operator==(const const_iterator& other) const { return _index == other._index; }
+    bool operator!=(const const_iterator& other) const { return _index != other._index; }
+
+  private:
+    const PackedLandmarks* _landmarks;
+    std::size_t _index;
+  };
+
+  PackedLandmarks() = default;
+
+  /**
+   * @brief Pack landmarks.
+   * @param[in] landmarks The landmarks to pack.
+   */
+  explicit PackedLandmarks(const Landmarks& landmarks)
+  {
+    assign(landmarks);
+  }
+
+  /**
+   * @brief Replace the content by the given landmarks.
+   * @param[in] landmarks The landmarks to pack.
+   */
+  void assign(const Landmarks& landmarks);
+
+  /**
+   * @brief Unpack the landmarks.
+   * @param[out] landmarks The landmarks, the previous content is replaced.
+   */
+  void toLandmarks(Landmarks& landmarks) const;
+
+  /**
+   * @brief Copy the positions to the landmarks they were packed from.
+   * @param[in,out] landmarks The landmarks, with the same ids as the packed ones.
+   */
+  void updatePositions(Landmarks& landmarks) const;
+
+  /// Number of landmarks
+  std::size_t size() const { return _landmarkIds.size(); }
+  bool empty() const { return _landmarkIds.empty(); }
+  /// Number of observations of all the landmarks
+  std::size_t nbObservations() const { return _viewIds.size(); }
+
+  /**
+   * @brief Find a landmark.
+   * @param[in] landmarkId The landmark id.
+   * @return the landmark index or size() if the landmark does not exist.
+   */
+  std::size_t find(IndexT landmarkId) const;
+
+  IndexT landmarkId(std::size_t index) const { return _landmarkIds[index]; }
+  Eigen::Map<Vec3> X(std::size_t index) { return Eigen::Map<Vec3>(&_positions[3 * index]); }
+  Eigen::Map<const Vec3> X(std::size_t index) const { return Eigen::Map<const Vec3>(&_positions[3 * index]); }
+  image::RGBColor& rgb(std::size_t index) { return _colors[index]; }
+  const image::RGBColor& rgb(std::size_t index) const { return _colors[index]; }
+  feature::EImageDescriberType descType(std::size_t index) const { return _descTypes[index]; }
+
+  /// Index of the first observation of a landmark
+  std::size_t observationsBegin(std::size_t index) const { return _observationRanges[index]; }
+  /// Index after the last observation of a landmark
+  std::size_t observationsEnd(std::size_t index) const { return _observationRanges[index + 1]; }
+
+  IndexT viewId(std::size_t observationIndex) const { return _viewIds[observationIndex]; }
+  IndexT featureId(std::size_t observationIndex) const { return _featureIds[observationIndex]; }
+  Eigen::Map<const Vec2> x(std::size_t observationIndex) const { return Eigen::Map<const Vec2>(&_coords[2 * observationIndex]); }
+
+  const_iterator begin() const { return const_iterator(*this, 0); }
+  const_iterator end() const { return const_iterator(*this, size()); }
+
+  /**
+   * @brief Get the size of the allocated arrays.
+   * @return the size in bytes
+   */
+  std::size_t memorySize() const;
+
+  /**
+   * @brief Estimate the memory used by landmarks stored in a HashMap,
+   * with the containers nodes, the observations containers and an allocation overhead.
+   * @param[in] landmarks The landmarks.
+   * @return the estimated size in bytes
+   */
+  static std::size_t estimateMemorySize(const Landmarks& landmarks);
+
+private:
+  std::vector<IndexT> _landmarkIds;
+  /// 3 coordinates per landmark
+  std::vector<double> _positions;
+  std::vector<image::RGBColor> _colors;
+  std::vector<feature::EImageDescriberType> _descTypes;
+  /// size() + 1 indexes in the observations arrays
+  std::vector<std::size_t> _observationRanges;
+
+  std::vector<IndexT> _viewIds;
+  std::vector<IndexT> _featureIds;
+  /// 2 coordinates per observation
+  std::vector<double> _coords;
+};
+
+} // namespace sfm
+} // namespace aliceVision
@@ -5,10 +5,7 @@
 
 #include "aliceVision/sfm/SfMData.hpp"
 #include "aliceVision/sfm/sfmDataIO.hpp"
-#include "aliceVision/image/io.hpp"
-#include "aliceVision/stl/stl.hpp"
-
-#include <boost/progress.hpp>
+#include "aliceVision/sfm/sfmDataColorize.hpp"
 
 namespace aliceVision {
 namespace sfm {
@@ -181,113 +178,9 @@ bool ColorizeTracks( SfMData & sfm_data )
   // Colorize each track
   //  Start with the most representative image
   //    and iterate to provide a color to each 3D point
-
-  std::vector<Vec3> vec_3dPoints;
-  std::vector<Vec3> vec_tracksColor;
-
-  boost::progress_display my_progress_bar(sfm_data.GetLandmarks().size(),
-                                     std::cout,
-                                     "\nCompute scene structure color\n");
-
-  vec_3dPoints.resize(sfm_data.GetLandmarks().size());
-
-  //Build a list of contiguous index for the trackIds
-  std::map<IndexT, IndexT> trackIds_to_contiguousIndexes;
-  IndexT cpt = 0;
-  for (Landmarks::const_iterator it = sfm_data.GetLandmarks().begin();
-    it != sfm_data.GetLandmarks().end(); ++it, ++cpt)
-  {
-    trackIds_to_contiguousIndexes[it->first] = cpt;
-    vec_3dPoints[cpt] = it->second.X;
-  }
-
-  // The track list that will be colored (point removed during the process)
-  std::set<IndexT> remainingTrackToColor;
-  std::transform(sfm_data.GetLandmarks().begin(), sfm_data.GetLandmarks().end(),
-    std::inserter(remainingTrackToColor, remainingTrackToColor.begin()),
-    stl::RetrieveKey());
-  
-  while( !remainingTrackToColor.empty() )
-  {
-    // Find the most representative image (for the remaining 3D points)
-    //  a. Count the number of observation per view for each 3Dpoint Index
-    //  b. Sort to find the most representative view index
-
-    std::map<IndexT, IndexT> map_IndexCardinal; // ViewId, Cardinal
-    for (std::set<IndexT>::const_iterator
-      iterT = remainingTrackToColor.begin();
-      iterT != remainingTrackToColor.end();
-      ++iterT)
-    {
-      const size_t trackId = *iterT;
-      const Observations & observations = sfm_data.GetLandmarks().at(trackId).observations;
-      for( Observations::const_iterator iterObs = observations.begin();
-        iterObs != observations.end(); ++iterObs)
-      {
-        const size_t viewId = iterObs->first;
-        if (map_IndexCardinal.find(viewId) == map_IndexCardinal.end())
-          map_IndexCardinal[viewId] = 1;
-        else
-          ++map_IndexCardinal[viewId];
-      }
-    }
-
-    // Find the View index that is the most represented
-    std::vector<IndexT> vec_cardinal;
-    std::transform(map_IndexCardinal.begin(),
-      map_IndexCardinal.end(),
-      std::back_inserter(vec_cardinal),
-      stl::RetrieveValue());
-    using namespace stl::indexed_sort;
-    std::vector< sort_index_packet_descend< IndexT, IndexT> > packet_vec(vec_cardinal.size());
-    sort_index_helper(packet_vec, &vec_cardinal[0], 1);
-
-    // First image index with the most of occurrence
-    std::map<IndexT, IndexT>::const_iterator iterTT = map_IndexCardinal.begin();
-    std::advance(iterTT, packet_vec[0].index);
-    const size_t view_index = iterTT->first;
-    const View * view = sfm_data.GetViews().at(view_index).get();
-    const std::string sView_filename = stlplus::create_filespec(sfm_data.s_root_path,
-      view->getImagePath());
-    Image<RGBColor> image;
-    if(!ReadImage(sView_filename.c_str(), &image))
-    {
-      ALICEVISION_LOG_WARNING("Unable to read image: " << sView_filename);
-      return false;
-    }
-
-    // Iterate through the remaining track to color
-    // - look if the current view is present to color the track
-    std::set<IndexT> set_toRemove;
-    for (std::set<IndexT>::const_iterator
-      iterT = remainingTrackToColor.begin();
-      iterT != remainingTrackToColor.end();
-      ++iterT)
-    {
-      const size_t trackId = *iterT;
-      const Observations & observations = sfm_data.GetLandmarks().at(trackId).observations;
-      Observations::const_iterator it = observations.find(view_index);
-
-      if (it != observations.end())
-      {
-        // Color the track
-        Vec2 pt = it->second.x;
-        // Clamp the pixel position if the feature/marker center is outside the image.
-        pt.x() = clamp(pt.x(), 0.0, double(image.Width()-1));
-        pt.y() = clamp(pt.y(), 0.0, double(image.Height()-1));
-        sfm_data.structure.at(trackId).rgb = image(pt.y(), pt.x());
-        set_toRemove.insert(trackId);
-        ++my_progress_bar;
-      }
-    }
-    // Remove colored track
-    for (std::set<IndexT>::const_iterator iter = set_toRemove.begin();
-      iter != set_toRemove.end(); ++iter)
-    {
-      remainingTrackToColor.erase(*iter);
-    }
-  }
-  return true;
+  std::vector<ViewColorization> plan;
+  computeColorizationPlan(sfm_data, plan);
+  return colorizeTracks(sfm_data, plan);
 }
 
 } // namespace sfm
@@ -0,0 +1,149 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/sfm/SfMData.hpp>
+#include <aliceVision/sfm/PackedLandmarks.hpp>
+
+#include <random>
+
+#define BOOST_TEST_MODULE packedLandmarks
+#include <boost/test/included/unit_test.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::sfm;
+
+namespace {
+
+Landmarks createLandmarks(std::size_t nbLandmarks, std::size_t nbViews)
+{
+  Landmarks landmarks;
+  std::mt19937 generator(42);
+  std::uniform_real_distribution<double> coordinate(-10.0, 10.0);
+  std::uniform_int_distribution<int> color(0, 255);
+  std::uniform_int_distribution<std::size_t> nbObservations(2, 8);
+  std::uniform_int_distribution<IndexT> viewId(0, nbViews - 1);
+
+  for(std::size_t l = 0; l < nbLandmarks; ++l)
+  {
+    // sparse landmark ids
+    Landmark& landmark = landmarks[3 * l + 1];
+    landmark.X = Vec3(coordinate(generator), coordinate(generator), coordinate(generator));
+    landmark.rgb = image::RGBColor(color(generator), color(generator), color(generator));
+    landmark.descType = (l % 2) ? feature::EImageDescriberType::SIFT : feature::EImageDescriberType::AKAZE;
+    const std::size_t n = nbObservations(generator);
+    for(std::size_t o = 0; o < n; ++o)
+      landmark.observations[viewId(generator)] = Observation(Vec2(coordinate(generator), coordinate(generator)), l * 10 + o);
+  }
+  return landmarks;
+}
+
+/// Read-only processing written once for Landmarks and PackedLandmarks
+template <typename LandmarksT>
+double sumObservations(const LandmarksT& landmarks)
+{
+  double sum = 0.0;
+  for(const auto& landmarkIt : landmarks)
+  {
+    const auto& landmark = landmarkIt.second;
+    for(const auto& observationIt : landmark.observations)
+      sum += (observationIt.second.x - landmark.X.template head<2>()).norm();
+  }
+  return sum;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(PackedLandmarks_roundTrip)
+{
+  const Landmarks landmarks = createLandmarks(1000, 20);
+  const PackedLandmarks packed(landmarks);
+
+  BOOST_CHECK_EQUAL(packed.size(), landmarks.size());
+
+  std::size_t nbObservations = 0;
+  for(const auto& landmarkIt : landmarks)
+    nbObservations += landmarkIt.second.observations.size();
+  BOOST_CHECK_EQUAL(packed.nbObservations(), nbObservations);
+
+  Landmarks unpacked;
+  packed.toLandmarks(unpacked);
+  BOOST_CHECK(unpacked == landmarks);
+}
+
+BOOST_AUTO_TEST_CASE(PackedLandmarks_access)
+{
+  const Landmarks landmarks = createLandmarks(1000, 20);
+  PackedLandmarks packed(landmarks);
+
+  BOOST_CHECK_EQUAL(packed.find(0), packed.size());
+  BOOST_CHECK_EQUAL(packed.find(3 * 1000 + 1), packed.size());
+
+  for(const auto& landmarkIt : landmarks)
+  {
+    const std::size_t i = packed.find(landmarkIt.first);
+    BOOST_REQUIRE(i < packed.size());
+    BOOST_CHECK_EQUAL(packed.landmarkId(i), landmarkIt.first);
+    BOOST_CHECK(packed.X(i) == landmarkIt.second.X);
+    BOOST_CHECK(packed.rgb(i) == landmarkIt.second.rgb);
+    BOOST_CHECK(packed.descType(i) == landmarkIt.second.descType);
+    BOOST_REQUIRE_EQUAL(packed.observationsEnd(i) - packed.observationsBegin(i), landmarkIt.second.observations.size());
+
+    std::size_t o = packed.observationsBegin(i);
+    for(const auto& observationIt : landmarkIt.second.observations)
+    {
+      BOOST_CHECK_EQUAL(packed.viewId(o), observationIt.first);
+      BOOST_CHECK_EQUAL(packed.featureId(o), observationIt.second.id_feat);
+      BOOST_CHECK(packed.x(o) == observationIt.second.x);
+      ++o;
+    }
+  }
+
+  // the landmarks are iterated by increasing id, as in Landmarks
+  IndexT previousId = 0;
+  std::size_t nbLandmarks = 0;
+  for(const auto& landmarkIt : packed)
+  {
+    BOOST_CHECK(nbLandmarks == 0 || landmarkIt.first > previousId);
+    BOOST_CHECK(landmarkIt.second.X == landmarks.at(landmarkIt.first).X);
+    BOOST_CHECK_EQUAL(landmarkIt.second.observations.size(), landmarks.at(landmarkIt.first).observations.size());
+    previousId = landmarkIt.first;
+    ++nbLandmarks;
+  }
+  BOOST_CHECK_EQUAL(nbLandmarks, landmarks.size());
+
+  // modify the positions and unpack
+  const std::size_t i = packed.find(landmarks.begin()->first);
+  packed.X(i) = Vec3(1.0, 2.0, 3.0);
+  Landmarks unpacked;
+  packed.toLandmarks(unpacked);
+  BOOST_CHECK(unpacked.at(landmarks.begin()->first).X == Vec3(1.0, 2.0, 3.0));
+}
+
+BOOST_AUTO_TEST_CASE(PackedLandmarks_updatePositions)
+{
+  Landmarks landmarks = createLandmarks(1000, 20);
+  PackedLandmarks packed(landmarks);
+
+  for(std::size_t i = 0; i < packed.size(); ++i)
+    packed.X(i) *= 2.0;
+  packed.updatePositions(landmarks);
+
+  for(auto it = packed.begin(); it != packed.end(); ++it)
+  {
+    const Landmark& landmark = landmarks.at(it->first);
+    BOOST_CHECK(landmark.X == it->second.X);
+    BOOST_CHECK_EQUAL(landmark.observations.size(), it->second.observations.size());
+  }
+}
+
+BOOST_AUTO_TEST_CASE(PackedLandmarks_memory)
+{
+  const Landmarks landmarks = createLandmarks(10000, 200);
+  const PackedLandmarks packed(landmarks);
+
+  BOOST_CHECK_CLOSE(sumObservations(landmarks), sumObservations(packed), 1e-6);
+  BOOST_CHECK_LT(packed.memorySize(), PackedLandmarks::estimateMemorySize(landmarks));
+}
@@ -44,6 +44,7 @@ bool SfMLocalizer::Localize
   // --
   Mat34 P;
   resection_data.vec_inliers.clear();
+  const std::vector<std::size_t>* sortedIndices = resection_data.vec_sortedIndices.empty() ? nullptr : &resection_data.vec_sortedIndices;
 
   // Setup the admissible upper bound residual error
   const double dPrecision =
@@ -68,7 +69,7 @@ bool SfMLocalizer::Localize
       resection_data.pt3D);
     // Robust estimation of the Projection matrix and its precision
     const std::pair<double,double> ACRansacOut =
-      aliceVision::robustEstimation::ACRANSAC(kernel, resection_data.vec_inliers, resection_data.max_iteration, &P, dPrecision, true);
+      aliceVision::robustEstimation::ACRANSAC(kernel, resection_data.vec_inliers, resection_data.max_iteration, &P, dPrecision, true, sortedIndices);
     // Update the upper bound precision of the model found by AC-RANSAC
     resection_data.error_max = ACRansacOut.first;
   }
@@ -105,7 +106,7 @@ bool SfMLocalizer::Localize
 
         // Robust estimation of the Projection matrix and its precision
         const std::pair<double, double> ACRansacOut =
-                aliceVision::robustEstimation::ACRANSAC(kernel, resection_data.vec_inliers, resection_data.max_iteration, &P, dPrecision, true);
+                aliceVision::robustEstimation::ACRANSAC(kernel, resection_data.vec_inliers, resection_data.max_iteration, &P, dPrecision, true, sortedIndices);
         // Update the upper bound precision of the model found by AC-RANSAC
         resection_data.error_max = ACRansacOut.first;
         break;
@@ -144,7 +145,7 @@ bool SfMLocalizer::Localize
         // @todo refactor, maybe move scorer directly inside the kernel
         const double threshold = resection_data.error_max * resection_data.error_max * (kernel.normalizer2()(0, 0) * kernel.normalizer2()(0, 0));
         robustEstimation::ScoreEvaluator<KernelType> scorer(threshold);
-        P = robustEstimation::LO_RANSAC(kernel, scorer, &resection_data.vec_inliers);
+        P = robustEstimation::LO_RANSAC(kernel, scorer, &resection_data.vec_inliers, nullptr, false, 100, 1e-2, sortedIndices);
         break;
       }
 
@@ -36,6 +36,11 @@ struct ImageLocalizerMatchData
   std::vector<std::size_t> vec_inliers;
 
   std::vector<feature::EImageDescriberType> vec_descType;
+
+  /// Optional column indices of pt2D and pt3D sorted by decreasing quality of
+  /// the associations: if not empty, the robust estimation draws its samples
+  /// progressively from the best associations (PROSAC).
+  std::vector<std::size_t> vec_sortedIndices;
   
   /// Upper bound pixel(s) tolerance for residual errors
   double error_max = std::numeric_limits<double>::infinity();
@@ -38,5 +38,29 @@ inline bool loadPairwiseMatches(
   return true;
 }
 
+/**
+ * @brief Load match files in packed pairwise matches.
+ *
+ * @param[out] out_pairwiseMatches
+ * @param[in] sfmData
+ * @param[in] folder
+ * @param[in] matchesMode
+ */
+inline bool loadPairwiseMatches(
+    matching::PackedPairwiseMatches& out_pairwiseMatches,
+    const SfMData& sfmData,
+    const std::string& folder,
+    const std::vector<feature::EImageDescriberType>& descTypes,
+    const std::string& matchesMode)
+{
+  ALICEVISION_LOG_DEBUG("- Loading matches...");
+  if (!matching::Load(out_pairwiseMatches, sfmData.GetViewsKeys(), folder, descTypes, matchesMode))
+  {
+    ALICEVISION_LOG_WARNING("Unable to read the matches file(s) from: " << folder << " (mode: " << matchesMode << ")");
+    return false;
+  }
+  return true;
+}
+
 } // namespace sfm
 } // namespace aliceVision
@@ -8,6 +8,7 @@
 #include <boost/progress.hpp>
 
 #include <atomic>
+#include <fstream>
 
 
 namespace aliceVision {
@@ -143,6 +144,39 @@ bool loadFeaturesPerView(feature::FeaturesPerView& featuresPerView,
   return !invalid;
 }
 
-  
+bool loadNbFeaturesPerView(std::map<IndexT, std::size_t>& nbFeaturesPerView,
+                    const SfMData& sfmData,
+                    const std::string& folder,
+                    const std::vector<feature::EImageDescriberType>& imageDescriberTypes,
+                    const std::set<IndexT>& filter)
+{
+  bool isValid = true;
+  for(const auto& viewPair : sfmData.GetViews())
+  {
+    const IndexT viewId = viewPair.second->getViewId();
+    if(!filter.empty() && filter.find(viewId) == filter.end())
+      continue;
+
+    std::size_t& nbFeatures = nbFeaturesPerView[viewId];
+    for(const feature::EImageDescriberType descType : imageDescriberTypes)
+    {
+      const std::string descFilename = stlplus::create_filespec(folder, std::to_string(viewId),
+                                                                feature::EImageDescriberType_enumToString(descType) + ".desc");
+
+      // the binary descriptor files start with the number of descriptors
+      std::ifstream fileIn(descFilename.c_str(), std::ios::in | std::ios::binary);
+      std::size_t nbDescriptors = 0;
+      if(!fileIn.is_open() || !fileIn.read(reinterpret_cast<char*>(&nbDescriptors), sizeof(std::size_t)))
+      {
+        ALICEVISION_LOG_WARNING("Invalid descriptor file: " << descFilename);
+        isValid = false;
+        continue;
+      }
+      nbFeatures += nbDescriptors;
+    }
+  }
+  return isValid;
+}
+
 } // namespace sfm
 } // namespace aliceVision
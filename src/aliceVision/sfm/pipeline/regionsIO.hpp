@@ -13,6 +13,7 @@
 #include <aliceVision/feature/RegionsPerView.hpp>
 #include <aliceVision/feature/FeaturesPerView.hpp>
 
+#include <map>
 #include <memory>
 
 namespace aliceVision {
@@ -59,6 +60,21 @@ bool loadFeaturesPerView(feature::FeaturesPerView& featuresPerView,
                     const std::string& folder,
                     const std::vector<feature::EImageDescriberType>& imageDescriberTypes);
 
+/**
+ * @brief Get the number of features of each view without loading them.
+ *        The counts are read in the headers of the binary descriptor files.
+ * @param[out] nbFeaturesPerView The number of features of each view (summed over the describer types)
+ * @param[in] sfmData
+ * @param[in] folder
+ * @param[in] imageDescriberTypes
+ * @param[in] filter: to count the features only for a sub-set of the views contained in the sfmData
+ * @return true if all the descriptor files are readable
+ */
+bool loadNbFeaturesPerView(std::map<IndexT, std::size_t>& nbFeaturesPerView,
+                    const SfMData& sfmData,
+                    const std::string& folder,
+                    const std::vector<feature::EImageDescriberType>& imageDescriberTypes,
+                    const std::set<IndexT>& filter = std::set<IndexT>());
 
 } // namespace sfm
 } // namespace aliceVision
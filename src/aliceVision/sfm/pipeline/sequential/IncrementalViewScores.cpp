@@ -0,0 +1,231 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "IncrementalViewScores.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace aliceVision {
+namespace sfm {
+
+void IncrementalViewScores::init(const track::TracksMap& tracks,
+                                 const track::TracksPyramidPerView& tracksPyramidPerView,
+                                 std::size_t pyramidBase,
+                                 const std::vector<int>& pyramidWeights)
+{
+  _tracks = &tracks;
+  _tracksPyramidPerView = &tracksPyramidPerView;
+  _pyramidWeights = pyramidWeights;
+
+  _nbCells = 0;
+  for(std::size_t level = 0; level < _pyramidWeights.size(); ++level)
+  {
+    const std::size_t width = std::pow(pyramidBase, level + 1);
+    _nbCells += width * width;
+  }
+
+  _views.clear();
+  _heap.clear();
+  _updatedViewIds.clear();
+  _trackIds.clear();
+  _isTrackReconstructed.assign(tracks.empty() ? 0 : tracks.rbegin()->first + 1, false);
+}
+
+std::size_t IncrementalViewScores::update(const Landmarks& landmarks)
+{
+  std::size_t nbChanges = 0;
+
+  // discard the removed landmarks
+  std::size_t nbKept = 0;
+  for(std::size_t i = 0; i < _trackIds.size(); ++i)
+  {
+    const std::size_t trackId = _trackIds[i];
+    if(landmarks.count(trackId))
+    {
+      _trackIds[nbKept++] = trackId;
+      continue;
+    }
+    _isTrackReconstructed[trackId] = false;
+    updateTrack(trackId, false);
+    ++nbChanges;
+  }
+  _trackIds.resize(nbKept);
+
+  // add the new landmarks
+  for(const auto& landmarkIt : landmarks)
+  {
+    const std::size_t trackId = landmarkIt.first;
+    if(trackId >= _isTrackReconstructed.size() || _isTrackReconstructed[trackId] || !_tracks->count(trackId))
+      continue;
+    _isTrackReconstructed[trackId] = true;
+    _trackIds.push_back(trackId);
+    updateTrack(trackId, true);
+    ++nbChanges;
+  }
+  pushUpdatedViews();
+  return nbChanges;
+}
+
+void IncrementalViewScores::addTrack(std::size_t trackId)
+{
+  if(_isTrackReconstructed.at(trackId))
+    return;
+  _isTrackReconstructed[trackId] = true;
+  _trackIds.push_back(trackId);
+  updateTrack(trackId, true);
+  pushUpdatedViews();
+}
+
+void IncrementalViewScores::removeTrack(std::size_t trackId)
+{
+  if(!_isTrackReconstructed.at(trackId))
+    return;
+  _isTrackReconstructed[trackId] = false;
+  _trackIds.erase(std::find(_trackIds.begin(), _trackIds.end(), trackId));
+  updateTrack(trackId, false);
+  pushUpdatedViews();
+}
+
+void IncrementalViewScores::removeView(IndexT viewId)
+{
+  ViewData& viewData = _views[viewId];
+  viewData.isRemoved = true;
+  // the heap entries of the view are outdated
+  ++viewData.version;
+}
+
+IncrementalViewScores::ViewScore IncrementalViewScores::getViewScore(IndexT viewId) const
+{
+  ViewScore viewScore;
+  viewScore.viewId = viewId;
+  const auto it = _views.find(viewId);
+  if(it != _views.end())
+  {
+    viewScore.nbTracks = it->second.nbTracks;
+    viewScore.score = it->second.score;
+  }
+  return viewScore;
+}
+
+void IncrementalViewScores::visitBestViews(const std::function<bool(IndexT)>& isCandidate,
+                                           const std::function<bool(const ViewScore&)>& visit)
+{
+  // the valid entries are popped while visiting and pushed back at the end
+  std::vector<HeapEntry> validEntries;
+
+  while(!_heap.empty())
+  {
+    std::pop_heap(_heap.begin(), _heap.end());
+    const HeapEntry entry = _heap.back();
+    _heap.pop_back();
+
+    if(!isValid(entry))
+      continue;
+    validEntries.push_back(entry);
+
+    if(!isCandidate(entry.viewId))
+      continue;
+
+    ViewScore viewScore;
+    viewScore.viewId = entry.viewId;
+    viewScore.nbTracks = _views.at(entry.viewId).nbTracks;
+    viewScore.score = entry.score;
+    if(!visit(viewScore))
+      break;
+  }
+
+  for(const HeapEntry& entry : validEntries)
+  {
+    _heap.push_back(entry);
+    std::push_heap(_heap.begin(), _heap.end());
+  }
+}
+
+void IncrementalViewScores::updateTrack(std::size_t trackId, bool isAdded)
+{
+  const std::size_t pyramidDepth = _pyramidWeights.size();
+  const track::Track& track = _tracks->at(trackId);
+
+  for(const auto& featIt : track.featPerView)
+  {
+    const IndexT viewId = featIt.first;
+    ViewData& viewData = _views[viewId];
+
+    if(viewData.cellCounts.empty())
+      viewData.cellCounts.assign(_nbCells, 0);
+
+#ifdef ALICEVISION_NEXTBESTVIEW_WITHOUT_SCORE
+    if(isAdded)
+      ++viewData.nbTracks;
+    else
+      --viewData.nbTracks;
+    viewData.score = viewData.nbTracks;
+#else
+    const auto& featsPyramid = _tracksPyramidPerView->at(viewId);
+    for(std::size_t level = 0; level < pyramidDepth; ++level)
+    {
+      unsigned int& cellCount = viewData.cellCounts[featsPyramid.at(trackId * pyramidDepth + level)];
+      // the score counts the non empty cells of each level
+      if(isAdded)
+      {
+        if(cellCount++ == 0)
+          viewData.score += _pyramidWeights[level];
+      }
+      else
+      {
+        if(--cellCount == 0)
+          viewData.score -= _pyramidWeights[level];
+      }
+    }
+    if(isAdded)
+      ++viewData.nbTracks;
+    else
+      --viewData.nbTracks;
+#endif
+
+    if(!viewData.isUpdated)
+    {
+      viewData.isUpdated = true;
+      _updatedViewIds.push_back(viewId);
+    }
+  }
+}
+
+void IncrementalViewScores::pushUpdatedViews()
+{
+  for(const IndexT viewId : _updatedViewIds)
+  {
+    ViewData& viewData = _views.at(viewId);
+    viewData.isUpdated = false;
+    // the previous heap entries of the view are outdated
+    ++viewData.version;
+
+    if(viewData.isRemoved || viewData.nbTracks == 0)
+      continue;
+
+    _heap.push_back(HeapEntry{viewData.score, viewId, viewData.version});
+    std::push_heap(_heap.begin(), _heap.end());
+  }
+  _updatedViewIds.clear();
+
+  // rebuild the heap with the valid entries only when the outdated ones dominate
+  if(_heap.size() > 4 * _views.size() + 64)
+  {
+    _heap.erase(std::remove_if(_heap.begin(), _heap.end(),
+                               [this](const HeapEntry& entry) { return !isValid(entry); }),
+                _heap.end());
+    std::make_heap(_heap.begin(), _heap.end());
+  }
+}
+
+bool IncrementalViewScores::isValid(const HeapEntry& entry) const
+{
+  const ViewData& viewData = _views.at(entry.viewId);
+  return !viewData.isRemoved && entry.version == viewData.version;
+}
+
+} // namespace sfm
+} // namespace aliceVision
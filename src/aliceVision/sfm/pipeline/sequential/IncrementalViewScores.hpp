@@ -0,0 +1,147 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include "aliceVision/types.hpp"
+#include "aliceVision/sfm/SfMData.hpp"
+#include "aliceVision/track/Track.hpp"
+
+#include <functional>
+#include <vector>
+
+namespace aliceVision {
+namespace sfm {
+
+/**
+ * @brief Next best view scores of the sequential SfM, updated incrementally.
+ *
+ * For each view, the reconstructed tracks are counted globally and per cell
+ * of the view pyramid (see computeTracksPyramidPerView). The pyramid score is
+ * the weighted number of non empty cells, so adding or removing a track only
+ * updates the cells of its observations.
+ * The views are ordered by a lazy max-heap: a new entry is pushed once per
+ * update for each view whose score changed and the outdated entries are skipped.
+ */
+class IncrementalViewScores
+{
+public:
+  /**
+   * @brief Score of a view.
+   */
+  struct ViewScore
+  {
+    IndexT viewId = UndefinedIndexT;
+    /// number of reconstructed tracks visible in the view
+    std::size_t nbTracks = 0;
+    /// next best view score
+    std::size_t score = 0;
+  };
+
+  /**
+   * @brief Initialize the scores, no track is reconstructed.
+   * @param[in] tracks The putative tracks, they must outlive this object.
+   * @param[in] tracksPyramidPerView The pyramid cell index of each track per view, it must outlive this object.
+   * @param[in] pyramidBase The pyramid base.
+   * @param[in] pyramidWeights The weight of each pyramid level.
+   */
+  void init(const track::TracksMap& tracks,
+            const track::TracksPyramidPerView& tracksPyramidPerView,
+            std::size_t pyramidBase,
+            const std::vector<int>& pyramidWeights);
+
+  /**
+   * @brief Synchronize the reconstructed tracks with the landmarks:
+   * the new landmarks are added and the removed ones are discarded.
+   * @param[in] landmarks The landmarks (a landmark id is a track id).
+   * @return the number of added and removed tracks.
+   */
+  std::size_t update(const Landmarks& landmarks);
+
+  /**
+   * @brief Add a reconstructed track.
+   * @param[in] trackId The track id.
+   */
+  void addTrack(std::size_t trackId);
+
+  /**
+   * @brief Remove a reconstructed track.
+   * @param[in] trackId The track id.
+   */
+  void removeTrack(std::size_t trackId);
+
+  /**
+   * @brief Remove a view from the queue, e.g. once it is reconstructed.
+   * Its counts are still updated.
+   * @param[in] viewId The view id.
+   */
+  void removeView(IndexT viewId);
+
+  /**
+   * @brief Get the score of a view.
+   * @param[in] viewId The view id.
+   * @return the view score, nbTracks is 0 if the view sees no reconstructed track.
+   */
+  ViewScore getViewScore(IndexT viewId) const;
+
+  /**
+   * @brief Visit the views seeing reconstructed tracks by decreasing score
+   * (the smallest view id first on equality).
+   * The cost is logarithmic per visited, skipped or outdated entry.
+   * @param[in] isCandidate Predicate selecting the views to visit.
+   * @param[in] visit Called on the candidate views, returns false to stop.
+   */
+  void visitBestViews(const std::function<bool(IndexT)>& isCandidate,
+                      const std::function<bool(const ViewScore&)>& visit);
+
+private:
+  struct ViewData
+  {
+    std::size_t nbTracks = 0;
+    std::size_t score = 0;
+    /// incremented when the score changes, the heap entries of an older version are outdated
+    std::size_t version = 0;
+    bool isRemoved = false;
+    /// the score changed since the last push in the heap
+    bool isUpdated = false;
+    /// number of reconstructed tracks per pyramid cell, allocated with the first track
+    std::vector<unsigned int> cellCounts;
+  };
+
+  struct HeapEntry
+  {
+    std::size_t score;
+    IndexT viewId;
+    std::size_t version;
+
+    /// heap order: the greatest score, then the smallest view id
+    bool operator<(const HeapEntry& other) const
+    {
+      return (score < other.score) || (score == other.score && viewId > other.viewId);
+    }
+  };
+
+  void updateTrack(std::size_t trackId, bool isAdded);
+  /// push a heap entry for each view updated since the last call
+  void pushUpdatedViews();
+  bool isValid(const HeapEntry& entry) const;
+
+  const track::TracksMap* _tracks = nullptr;
+  const track::TracksPyramidPerView* _tracksPyramidPerView = nullptr;
+  std::vector<int> _pyramidWeights;
+  /// number of cells of all the pyramid levels
+  std::size_t _nbCells = 0;
+
+  HashMap<IndexT, ViewData> _views;
+  std::vector<HeapEntry> _heap;
+  std::vector<IndexT> _updatedViewIds;
+
+  /// reconstructed tracks
+  std::vector<std::size_t> _trackIds;
+  std::vector<bool> _isTrackReconstructed;
+};
+
+} // namespace sfm
+} // namespace aliceVision
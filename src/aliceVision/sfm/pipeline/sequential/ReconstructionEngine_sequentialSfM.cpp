@@ -6,6 +6,7 @@
 #include "aliceVision/sfm/pipeline/sequential/ReconstructionEngine_sequentialSfM.hpp"
 #include "aliceVision/sfm/pipeline/RelativePoseInfo.hpp"
 #include "aliceVision/sfm/sfmDataIO.hpp"
+#include "aliceVision/sfm/sfmDataIO_cereal.hpp"
 #include "aliceVision/sfm/BundleAdjustmentCeres.hpp"
 #include "aliceVision/sfm/sfmDataFilters.hpp"
 #include "aliceVision/sfm/pipeline/localization/SfMLocalizer.hpp"
@@ -26,10 +27,14 @@
 
 #include <boost/progress.hpp>
 #include <boost/format.hpp>
+#include <boost/filesystem.hpp>
+
+#include <cereal/types/set.hpp>
 
 #include <tuple>
 #include <iostream>
 #include <algorithm>
+#include <atomic>
 
 #ifdef _MSC_VER
 #pragma warning( once : 4267 ) //warning C4267: 'argument' : conversion from 'size_t' to 'const int', possible loss of data
@@ -221,6 +226,7 @@ void ReconstructionEngine_sequentialSfM::RobustResectionOfImages(
                               << "RigID=" << view.getRigId() << " Sub-poseID=" << view.getSubPoseId()
                               << " sub-pose and pose defined.");
             set_remainingViewId.erase(possible_resection_index);
+            _viewScores.removeView(possible_resection_index);
             continue;
           }
 
@@ -256,6 +262,7 @@ void ReconstructionEngine_sequentialSfM::RobustResectionOfImages(
         ALICEVISION_LOG_DEBUG("Resection of image: " << currentIndex << " ID=" << possible_resection_index << " succeed.");
         _sfm_data.GetViews().at(possible_resection_index)->setResectionId(resectionId);
         ++resectionId;
+        _viewScores.removeView(possible_resection_index);
       }
       set_remainingViewId.erase(possible_resection_index);
 
@@ -318,6 +325,17 @@ void ReconstructionEngine_sequentialSfM::RobustResectionOfImages(
       chrono_start = std::chrono::steady_clock::now();
       eraseUnstablePosesAndObservations(this->_sfm_data, _minPointsPerPose, _minTrackLength);
       ALICEVISION_LOG_DEBUG("eraseUnstablePosesAndObservations took " << std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - chrono_start).count() << " msec.");
+
+      if(!_checkpointFolder.empty() && _checkpointInterval > 0 && ((resectionGroupIndex + 1) % _checkpointInterval) == 0)
+      {
+        // The views rejected in this loop are retried at the next loop, so
+        // only the reconstructed views are removed from the remaining views.
+        std::set<size_t> remainingViewIds;
+        std::set_difference(viewIds.begin(), viewIds.end(),
+                            set_reconstructedViewId.begin(), set_reconstructedViewId.end(),
+                            std::inserter(remainingViewIds, remainingViewIds.end()));
+        saveCheckpoint(remainingViewIds);
+      }
     }
     ++resectionGroupIndex;
   }
@@ -352,48 +370,61 @@ bool ReconstructionEngine_sequentialSfM::Process()
   if (!InitLandmarkTracks())
     return false;
 
-  // Initial pair choice
-  std::vector<Pair> initialImagePairCandidates;
-  if(_userInitialImagePair == Pair(0,0))
+  _viewScores.init(_map_tracks, _map_featsPyramidPerView, _pyramidBase, _pyramidWeights);
+
+  bool isResumed = false;
+  if(_resumeFromCheckpoint)
+  {
+    isResumed = loadCheckpoint();
+    if(!isResumed)
+      ALICEVISION_LOG_WARNING("No valid checkpoint in '" << _checkpointFolder << "', the reconstruction starts from scratch.");
+  }
+
+  if(!isResumed)
   {
-    if(!getBestInitialImagePairs(initialImagePairCandidates))
+    // Initial pair choice
+    std::vector<Pair> initialImagePairCandidates;
+    if(_userInitialImagePair == Pair(0,0))
     {
-      if(_userInteraction)
+      if(!getBestInitialImagePairs(initialImagePairCandidates))
       {
-        // Cannot find a valid initial pair, try to set it by hand?
-        if(!ChooseInitialPair(_userInitialImagePair))
+        if(_userInteraction)
+        {
+          // Cannot find a valid initial pair, try to set it by hand?
+          if(!ChooseInitialPair(_userInitialImagePair))
+            return false;
+        }
+        else
+        {
           return false;
+        }
       }
-      else
+    }
+    if(_userInitialImagePair != Pair(0,0))
+    {
+      //double, double, double, std::size_t, Pair
+      initialImagePairCandidates.emplace_back(_userInitialImagePair);
+    }
+
+    bool successfullInitialization = false;
+    // Initial pair Essential Matrix and [R|t] estimation.
+    for(const auto& initialPairCandidate: initialImagePairCandidates)
+    {
+      if(MakeInitialPair3D(initialPairCandidate))
       {
-        return false;
+        // Successfully found an initial image pair
+        ALICEVISION_LOG_DEBUG("Initial pair is: " << initialPairCandidate.first << ", " << initialPairCandidate.second);
+        successfullInitialization = true;
+        break;
       }
     }
-  }
-  if(_userInitialImagePair != Pair(0,0))
-  {
-    //double, double, double, std::size_t, Pair
-    initialImagePairCandidates.emplace_back(_userInitialImagePair);
-  }
-
-  bool successfullInitialization = false;
-  // Initial pair Essential Matrix and [R|t] estimation.
-  for(const auto& initialPairCandidate: initialImagePairCandidates)
-  {
-    if(MakeInitialPair3D(initialPairCandidate))
+    if(!successfullInitialization)
     {
-      // Successfully found an initial image pair
-      ALICEVISION_LOG_DEBUG("Initial pair is: " << initialPairCandidate.first << ", " << initialPairCandidate.second);
-      successfullInitialization = true;
-      break;
+      ALICEVISION_LOG_ERROR("Initialization failed after trying all possible initial image pairs.");
+      return false;
     }
   }
-  if(!successfullInitialization)
-  {
-    ALICEVISION_LOG_ERROR("Initialization failed after trying all possible initial image pairs.");
-    return false;
-  }
-  
+
   // timer for stats
   aliceVision::system::Timer timer_sfm;
 
@@ -480,6 +511,137 @@ bool ReconstructionEngine_sequentialSfM::Process()
   return true;
 }
 
+namespace {
+
+const std::string checkpointSfMDataFilename = "checkpoint_sfmData";
+const std::string checkpointStateFilename = "checkpoint_state";
+const int checkpointVersion = 2;
+
+/// The SfMData file of a checkpoint, its name contains the checkpoint sequence number
+std::string getCheckpointSfMDataFilepath(const std::string& checkpointFolder, std::size_t sequence)
+{
+  return stlplus::create_filespec(checkpointFolder, checkpointSfMDataFilename + "_" + std::to_string(sequence), "bin");
+}
+
+} // namespace
+
+bool ReconstructionEngine_sequentialSfM::saveCheckpoint(const std::set<size_t>& remainingViewIds)
+{
+  const auto chrono_start = std::chrono::steady_clock::now();
+
+  if(!stlplus::folder_exists(_checkpointFolder))
+    stlplus::folder_create(_checkpointFolder);
+
+  // The SfMData is written in a new file named after the checkpoint sequence number,
+  // the state file refers to it and is written in a temporary file then renamed:
+  // this rename commits the checkpoint, so an interruption while saving keeps
+  // the previous checkpoint and the two files always belong to the same one.
+  const std::size_t sequence = _checkpointSequence + 1;
+  const std::string sfmDataFilepath = getCheckpointSfMDataFilepath(_checkpointFolder, sequence);
+  const std::string stateFilepath = stlplus::create_filespec(_checkpointFolder, checkpointStateFilename, "bin");
+  const std::string stateTmpFilepath = stlplus::create_filespec(_checkpointFolder, checkpointStateFilename + "_tmp", "bin");
+
+  if(!Save(_sfm_data, sfmDataFilepath, ESfMData(ALL)))
+  {
+    ALICEVISION_LOG_WARNING("Cannot write the checkpoint file: " << sfmDataFilepath);
+    return false;
+  }
+
+  {
+    std::ofstream stream(stateTmpFilepath.c_str(), std::ios::binary | std::ios::out);
+    if(!stream.is_open())
+    {
+      ALICEVISION_LOG_WARNING("Cannot write the checkpoint file: " << stateTmpFilepath);
+      return false;
+    }
+    cereal::PortableBinaryOutputArchive archive(stream);
+    const std::map<IndexT, double> acThresholds(_map_ACThreshold.begin(), _map_ACThreshold.end());
+    archive(checkpointVersion, sequence, remainingViewIds, acThresholds);
+  }
+
+  boost::system::error_code error;
+  boost::filesystem::rename(stateTmpFilepath, stateFilepath, error);
+  if(error)
+  {
+    ALICEVISION_LOG_WARNING("Cannot write the checkpoint in '" << _checkpointFolder << "': " << error.message());
+    return false;
+  }
+
+  // the SfMData files of the previous checkpoints are not needed anymore
+  for(const std::string& filename : stlplus::folder_wildcard(_checkpointFolder, checkpointSfMDataFilename + "_*.bin", false, true))
+  {
+    const std::string filepath = stlplus::create_filespec(_checkpointFolder, filename);
+    if(filepath != sfmDataFilepath)
+      boost::filesystem::remove(filepath, error);
+  }
+  _checkpointSequence = sequence;
+
+  ALICEVISION_LOG_INFO("Checkpoint " << sequence << " saved with " << _sfm_data.GetPoses().size() << " poses, " << _sfm_data.GetLandmarks().size() << " landmarks and "
+                       << remainingViewIds.size() << " remaining views in " << std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - chrono_start).count() << " msec.");
+  return true;
+}
+
+bool ReconstructionEngine_sequentialSfM::loadCheckpoint()
+{
+  const std::string stateFilepath = stlplus::create_filespec(_checkpointFolder, checkpointStateFilename, "bin");
+
+  if(!stlplus::file_exists(stateFilepath))
+    return false;
+
+  int version = 0;
+  std::size_t sequence = 0;
+  std::set<size_t> remainingViewIds;
+  std::map<IndexT, double> acThresholds;
+  {
+    std::ifstream stream(stateFilepath.c_str(), std::ios::binary | std::ios::in);
+    if(!stream.is_open())
+    {
+      ALICEVISION_LOG_WARNING("Cannot read the checkpoint file: " << stateFilepath);
+      return false;
+    }
+    try
+    {
+      cereal::PortableBinaryInputArchive archive(stream);
+      archive(version);
+      if(version != checkpointVersion)
+      {
+        ALICEVISION_LOG_WARNING("The checkpoint in '" << _checkpointFolder << "' has an unsupported version: " << version << ".");
+        return false;
+      }
+      archive(sequence, remainingViewIds, acThresholds);
+    }
+    catch(const cereal::Exception& e)
+    {
+      ALICEVISION_LOG_WARNING("Cannot read the checkpoint file: " << stateFilepath << ": " << e.what());
+      return false;
+    }
+  }
+
+  const std::string sfmDataFilepath = getCheckpointSfMDataFilepath(_checkpointFolder, sequence);
+  SfMData sfmData;
+  if(!stlplus::file_exists(sfmDataFilepath) || !Load(sfmData, sfmDataFilepath, ESfMData(ALL)))
+  {
+    ALICEVISION_LOG_WARNING("Cannot read the checkpoint file: " << sfmDataFilepath);
+    return false;
+  }
+
+  if(sfmData.GetViews().size() != _sfm_data.GetViews().size())
+  {
+    ALICEVISION_LOG_WARNING("The checkpoint in '" << _checkpointFolder << "' does not match the input views.");
+    return false;
+  }
+
+  _sfm_data = sfmData;
+  _set_remainingViewId = remainingViewIds;
+  _map_ACThreshold.clear();
+  _map_ACThreshold.insert(acThresholds.begin(), acThresholds.end());
+  _checkpointSequence = sequence;
+
+  ALICEVISION_LOG_INFO("Reconstruction resumed from the checkpoint " << sequence << " with " << _sfm_data.GetPoses().size() << " poses, "
+                       << _sfm_data.GetLandmarks().size() << " landmarks and " << _set_remainingViewId.size() << " remaining views.");
+  return true;
+}
+
 /// Select a candidate initial pair
 bool ReconstructionEngine_sequentialSfM::ChooseInitialPair(Pair & initialPairIndex) const
 {
@@ -520,8 +682,8 @@ bool ReconstructionEngine_sequentialSfM::ChooseInitialPair(Pair & initialPairInd
     //  - valid intrinsics,
     //  - valid estimated Fundamental matrix.
     std::vector< size_t > vec_NbMatchesPerPair;
-    std::vector<aliceVision::matching::PairwiseMatches::const_iterator> vec_MatchesIterator;
-    for (aliceVision::matching::PairwiseMatches::const_iterator
+    std::vector<aliceVision::matching::PackedPairwiseMatches::const_iterator> vec_MatchesIterator;
+    for (aliceVision::matching::PackedPairwiseMatches::const_iterator
       iter = _pairwiseMatches->begin();
       iter != _pairwiseMatches->end(); ++iter)
     {
@@ -540,7 +702,7 @@ bool ReconstructionEngine_sequentialSfM::ChooseInitialPair(Pair & initialPairInd
 
     for (size_t i = 0; i < std::min((size_t)10, vec_NbMatchesPerPair.size()); ++i) {
       const size_t index = packet_vec[i].index;
-      aliceVision::matching::PairwiseMatches::const_iterator iter = vec_MatchesIterator[index];
+      aliceVision::matching::PackedPairwiseMatches::const_iterator iter = vec_MatchesIterator[index];
       ALICEVISION_COUT("(" << iter->first.first << "," << iter->first.second <<")\t\t"
         << iter->second.getNbAllMatches() << " matches");
     }
@@ -574,7 +736,7 @@ bool ReconstructionEngine_sequentialSfM::InitLandmarkTracks()
 
   {
     // List of features matches for each couple of images
-    const aliceVision::matching::PairwiseMatches & map_Matches = *_pairwiseMatches;
+    const aliceVision::matching::PackedPairwiseMatches & map_Matches = *_pairwiseMatches;
     ALICEVISION_LOG_DEBUG("Track building");
 
     tracksBuilder.Build(map_Matches);
@@ -625,7 +787,7 @@ bool ReconstructionEngine_sequentialSfM::InitLandmarkTracks()
   return _map_tracks.size() > 0;
 }
 
-bool ReconstructionEngine_sequentialSfM::getBestInitialImagePairs(std::vector<Pair>& out_bestImagePairs) const
+bool ReconstructionEngine_sequentialSfM::getBestInitialImagePairs(std::vector<Pair>& out_bestImagePairs, bool exhaustiveSearch) const
 {
   // From the k view pairs with the highest number of verified matches
   // select a pair that have the largest baseline (mean angle between its bearing vectors).
@@ -653,31 +815,80 @@ bool ReconstructionEngine_sequentialSfM::getBestInitialImagePairs(std::vector<Pa
     return false;
   }
   
-    /// ImagePairScore contains <imagePairScore*scoring_angle, imagePairScore, scoring_angle, numberOfInliers, imagePair>
+  /// ImagePairScore contains <imagePairScore*scoring_angle, imagePairScore, scoring_angle, numberOfInliers, imagePair>
   typedef std::tuple<double, double, double, std::size_t, Pair> ImagePairScore;
   std::vector<ImagePairScore> bestImagePairs;
   bestImagePairs.reserve(_pairwiseMatches->size());
 
-  // Compute the relative pose & the 'baseline score'
-  boost::progress_display my_progress_bar( _pairwiseMatches->size(),
-    std::cout,
-    "Automatic selection of an initial pair:\n" );
+  // List the candidate pairs with an upper bound of their score:
+  // the inliers are a subset of the common tracks and the angle is below fLimit_max_angle.
+  /// PairCandidate contains <scoreUpperBound, imagePair>
+  typedef std::pair<double, Pair> PairCandidate;
+  std::vector<PairCandidate> pairCandidates;
+  pairCandidates.reserve(_pairwiseMatches->size());
+  for(const auto& matchesIt : *_pairwiseMatches)
+  {
+    const Pair& pair = matchesIt.first;
+    if(valid_views.count(pair.first) && valid_views.count(pair.second))
+      pairCandidates.emplace_back(0.0, pair);
+  }
 
   #pragma omp parallel for schedule(dynamic)
-  for (int i = 0; i < _pairwiseMatches->size(); ++i)
+  for(int i = 0; i < pairCandidates.size(); ++i)
   {
-    matching::PairwiseMatches::const_iterator iter = _pairwiseMatches->begin();
-    std::advance(iter, i);
+    const Pair& pair = pairCandidates[i].second;
+    const auto tracksIIt = _map_tracksPerView.find(pair.first);
+    const auto tracksJIt = _map_tracksPerView.find(pair.second);
+    if(tracksIIt == _map_tracksPerView.end() || tracksJIt == _map_tracksPerView.end())
+      continue;
+    std::vector<std::size_t> commonTracksIds;
+    std::set_intersection(tracksIIt->second.begin(), tracksIIt->second.end(),
+                          tracksJIt->second.begin(), tracksJIt->second.end(),
+                          std::back_inserter(commonTracksIds));
+    if(commonTracksIds.size() <= iMin_inliers_count)
+      continue;
+    pairCandidates[i].first = fLimit_max_angle * std::min(computeImageScore(pair.first, commonTracksIds), computeImageScore(pair.second, commonTracksIds));
+  }
+
+  // Evaluate the candidates by decreasing upper bound, the search is cancelled
+  // when no remaining candidate can beat the best pair found.
+  pairCandidates.erase(std::remove_if(pairCandidates.begin(), pairCandidates.end(),
+                                      [](const PairCandidate& c) { return c.first <= 0.0; }),
+                       pairCandidates.end());
+  std::sort(pairCandidates.begin(), pairCandidates.end(), std::greater<PairCandidate>());
+
+  std::atomic<std::size_t> nextCandidate(0);
+  std::atomic<std::size_t> nbEvaluatedCandidates(0);
+  std::vector<char> isEvaluated(pairCandidates.size(), 0);
+  std::atomic<bool> isCancelled(false);
+  double bestScore = 0.0;
 
-    #pragma omp critical
-    ++my_progress_bar;
+  ALICEVISION_LOG_INFO("Automatic selection of an initial pair: " << pairCandidates.size() << " candidate pairs.");
+
+  #pragma omp parallel
+  while(!isCancelled)
+  {
+    const std::size_t candidateIndex = nextCandidate++;
+    if(candidateIndex >= pairCandidates.size())
+      break;
 
-    const Pair current_pair = iter->first;
+    double currentBestScore;
+    #pragma omp critical(initialPairBestScore)
+    currentBestScore = bestScore;
+
+    if(!exhaustiveSearch && pairCandidates[candidateIndex].first <= currentBestScore)
+    {
+      // the candidates are sorted, the next ones cannot be better
+      isCancelled = true;
+      break;
+    }
+    ++nbEvaluatedCandidates;
+    isEvaluated[candidateIndex] = 1;
+
+    const Pair current_pair = pairCandidates[candidateIndex].second;
 
     const size_t I = std::min(current_pair.first, current_pair.second);
     const size_t J = std::max(current_pair.first, current_pair.second);
-    if (!valid_views.count(I) || !valid_views.count(J))
-      continue;
 
     const View * view_I = _sfm_data.GetViews().at(I).get();
     const Intrinsics::const_iterator iterIntrinsic_I = _sfm_data.GetIntrinsics().find(view_I->getIntrinsicId());
@@ -763,11 +974,16 @@ bool ReconstructionEngine_sequentialSfM::getBestInitialImagePairs(std::vector<Pa
         const double imagePairScore = std::min(computeImageScore(I, validCommonTracksIds), computeImageScore(J, validCommonTracksIds));
         const double score = scoring_angle * imagePairScore;
 
-        #pragma omp critical
-        bestImagePairs.emplace_back(score, imagePairScore, scoring_angle, relativePose_info.vec_inliers.size(), current_pair);
+        #pragma omp critical(initialPairBestScore)
+        {
+          bestImagePairs.emplace_back(score, imagePairScore, scoring_angle, relativePose_info.vec_inliers.size(), current_pair);
+          bestScore = std::max(bestScore, score);
+        }
       }
     }
   }
+  ALICEVISION_LOG_INFO("Automatic selection of an initial pair: " << nbEvaluatedCandidates << " / " << pairCandidates.size() << " candidate pairs evaluated"
+                       << (isCancelled ? " (search stopped, the remaining candidates cannot beat the best pair)." : "."));
   // We print the N best scores and return the best one.
   const std::size_t nBestScores = std::min(std::size_t(50), bestImagePairs.size());
   std::sort(bestImagePairs.begin(), bestImagePairs.end(), std::greater<ImagePairScore>());
@@ -786,10 +1002,18 @@ bool ReconstructionEngine_sequentialSfM::getBestInitialImagePairs(std::vector<Pa
     ALICEVISION_LOG_ERROR("Error: No valid initial pair found automatically.");
     return false;
   }
-  out_bestImagePairs.reserve(bestImagePairs.size());
+  out_bestImagePairs.reserve(bestImagePairs.size() + pairCandidates.size() - nbEvaluatedCandidates);
   for(const auto& imagePair: bestImagePairs)
     out_bestImagePairs.push_back(std::get<4>(imagePair));
 
+  // the candidates not evaluated are kept as fallbacks if the initialization
+  // fails with all the evaluated pairs
+  for(std::size_t i = 0; i < pairCandidates.size(); ++i)
+  {
+    if(!isEvaluated[i])
+      out_bestImagePairs.push_back(pairCandidates[i].second);
+  }
+
   return true;
 }
 
@@ -993,20 +1217,34 @@ double ReconstructionEngine_sequentialSfM::ComputeResidualsHistogram(Histogram<d
   if (_sfm_data.GetLandmarks().empty())
     return -1.0;
 
+  // Index of the first residual of each track
+  std::vector<Landmarks::const_iterator> tracks;
+  std::vector<std::size_t> firstResidual;
+  tracks.reserve(_sfm_data.GetLandmarks().size());
+  firstResidual.reserve(_sfm_data.GetLandmarks().size());
+  std::size_t nbResiduals = 0;
+  for(Landmarks::const_iterator it = _sfm_data.GetLandmarks().begin(); it != _sfm_data.GetLandmarks().end(); ++it)
+  {
+    tracks.push_back(it);
+    firstResidual.push_back(nbResiduals);
+    nbResiduals += 2 * it->second.observations.size();
+  }
+
   // Collect residuals for each observation
-  std::vector<float> vec_residuals;
-  vec_residuals.reserve(_sfm_data.structure.size());
-  for(const auto &track : _sfm_data.GetLandmarks())
+  std::vector<float> vec_residuals(nbResiduals);
+  #pragma omp parallel for schedule(dynamic, 256)
+  for(int i = 0; i < tracks.size(); ++i)
   {
-    const Observations & observations = track.second.observations;
-    for(const auto& obs: observations)
+    const Landmark& track = tracks[i]->second;
+    std::size_t r = firstResidual[i];
+    for(const auto& obs: track.observations)
     {
       const View * view = _sfm_data.GetViews().find(obs.first)->second.get();
       const Pose3 pose = _sfm_data.getPose(*view);
       const std::shared_ptr<IntrinsicBase> intrinsic = _sfm_data.GetIntrinsics().find(view->getIntrinsicId())->second;
-      const Vec2 residual = intrinsic->residual(pose, track.second.X, obs.second.x);
-      vec_residuals.push_back( fabs(residual(0)) );
-      vec_residuals.push_back( fabs(residual(1)) );
+      const Vec2 residual = intrinsic->residual(pose, track.X, obs.second.x);
+      vec_residuals[r++] = fabs(residual(0));
+      vec_residuals[r++] = fabs(residual(1));
     }
   }
 
@@ -1090,87 +1328,61 @@ std::size_t ReconstructionEngine_sequentialSfM::computeImageScore(std::size_t vi
 
 bool ReconstructionEngine_sequentialSfM::FindConnectedViews(
   std::vector<ViewConnectionScore>& out_connectedViews,
-  const std::set<size_t>& remainingViewIds) const
+  const std::set<size_t>& remainingViewIds,
+  const std::function<bool(const std::vector<ViewConnectionScore>&, const ViewConnectionScore&)>& isNextViewNeeded)
 {
   out_connectedViews.clear();
 
   if (remainingViewIds.empty() || _sfm_data.GetLandmarks().empty())
     return false;
 
-  // Collect tracksIds
-  std::set<size_t> reconstructed_trackId;
-  std::transform(_sfm_data.GetLandmarks().begin(), _sfm_data.GetLandmarks().end(),
-    std::inserter(reconstructed_trackId, reconstructed_trackId.begin()),
-    stl::RetrieveKey());
-  
+  // Update the view scores with the landmarks added or removed since the last call
+  const std::size_t nbChangedTracks = _viewScores.update(_sfm_data.GetLandmarks());
+  ALICEVISION_LOG_DEBUG("FindConnectedViews: " << nbChangedTracks << " reconstructed tracks added or removed.");
+
   const std::set<IndexT> reconstructedIntrinsics = _sfm_data.getReconstructedIntrinsics();
 
-#pragma omp parallel for
-  for (int i = 0; i < remainingViewIds.size(); ++i)
+  const auto isCandidate = [&](IndexT viewId)
   {
-    std::set<size_t>::const_iterator iter = remainingViewIds.cbegin();
-    std::advance(iter, i);
-    const size_t viewId = *iter;
-    const size_t intrinsicId = _sfm_data.GetViews().at(viewId)->getIntrinsicId();
-    const bool isIntrinsicsReconstructed = reconstructedIntrinsics.count(intrinsicId);
-
-    // Compute 2D - 3D possible content
-    aliceVision::track::TracksPerView::const_iterator tracksIdsIt = _map_tracksPerView.find(viewId);
-    if(tracksIdsIt == _map_tracksPerView.end())
-      continue;
-
-    const aliceVision::track::TrackIdSet& set_tracksIds = tracksIdsIt->second;
-    if (set_tracksIds.empty())
-      continue;
+    if(!remainingViewIds.count(viewId))
+      return false;
 
     // Check if the view is part of a rig
-    {
-      const View& view = *_sfm_data.views.at(viewId);
+    const View& view = *_sfm_data.views.at(viewId);
 
-      if(view.isPartOfRig())
-      {
-        // Some views can become indirectly localized when the sub-pose becomes defined
-        if(_sfm_data.IsPoseAndIntrinsicDefined(view.getViewId()))
-        {
-          continue;
-        }
+    if(view.isPartOfRig())
+    {
+      // Some views can become indirectly localized when the sub-pose becomes defined
+      if(_sfm_data.IsPoseAndIntrinsicDefined(view.getViewId()))
+        return false;
 
-        // We cannot localize a view if it is part of an initialized RIG with unknown Rig Pose
-        const bool knownPose = _sfm_data.existsPose(view);
-        const Rig& rig = _sfm_data.getRig(view);
-        const RigSubPose& subpose = rig.getSubPose(view.getSubPoseId());
+      // We cannot localize a view if it is part of an initialized RIG with unknown Rig Pose
+      const bool knownPose = _sfm_data.existsPose(view);
+      const Rig& rig = _sfm_data.getRig(view);
+      const RigSubPose& subpose = rig.getSubPose(view.getSubPoseId());
 
-        if(rig.isInitialized() &&
-           !knownPose &&
-           (subpose.status == ERigSubPoseStatus::UNINITIALIZED))
-        {
-          continue;
-        }
-      }
+      if(rig.isInitialized() &&
+         !knownPose &&
+         (subpose.status == ERigSubPoseStatus::UNINITIALIZED))
+        return false;
     }
+    return true;
+  };
 
-    // Count the common possible putative point
-    //  with the already 3D reconstructed trackId
-    std::vector<size_t> vec_trackIdForResection;
-    vec_trackIdForResection.reserve(set_tracksIds.size());
-    std::set_intersection(set_tracksIds.begin(), set_tracksIds.end(),
-      reconstructed_trackId.begin(),
-      reconstructed_trackId.end(),
-      std::back_inserter(vec_trackIdForResection));
-    // Compute an image score based on the number of matches to the 3D scene
-    // and the repartition of these features in the image.
-    std::size_t score = computeImageScore(viewId, vec_trackIdForResection);
-#pragma omp critical
-    {
-      out_connectedViews.emplace_back(viewId, vec_trackIdForResection.size(), score, isIntrinsicsReconstructed);
-    }
-  }
+  // Visit the views by decreasing image score, based on the number of matches
+  // to the 3D scene and the repartition of these features in the image.
+  _viewScores.visitBestViews(isCandidate, [&](const IncrementalViewScores::ViewScore& viewScore)
+  {
+    const size_t intrinsicId = _sfm_data.GetViews().at(viewScore.viewId)->getIntrinsicId();
+    const bool isIntrinsicsReconstructed = reconstructedIntrinsics.count(intrinsicId);
+    const ViewConnectionScore viewConnectionScore(viewScore.viewId, viewScore.nbTracks, viewScore.score, isIntrinsicsReconstructed);
+
+    if(!out_connectedViews.empty() && !isNextViewNeeded(out_connectedViews, viewConnectionScore))
+      return false;
 
-  // Sort by the image score
-  std::sort(out_connectedViews.begin(), out_connectedViews.end(),
-      [](const ViewConnectionScore& t1, const ViewConnectionScore& t2) {
-        return std::get<2>(t1) > std::get<2>(t2);
-      });
+    out_connectedViews.push_back(viewConnectionScore);
+    return true;
+  });
 
   return !out_connectedViews.empty();
 }
@@ -1178,76 +1390,61 @@ bool ReconstructionEngine_sequentialSfM::FindConnectedViews(
 
 bool ReconstructionEngine_sequentialSfM::FindNextImagesGroupForResection(
   std::vector<size_t> & out_selectedViewIds,
-  const std::set<size_t>& remainingViewIds) const
+  const std::set<size_t>& remainingViewIds)
 {
   out_selectedViewIds.clear();
   auto chrono_start = std::chrono::steady_clock::now();
-  std::vector<ViewConnectionScore> vec_viewsScore;
-  if(!FindConnectedViews(vec_viewsScore, remainingViewIds))
-    return false;
 
   // Impose a minimal number of points to ensure that it makes sense to try the pose estimation.
   static const std::size_t minPointsThreshold = 30;
 
-  ALICEVISION_LOG_DEBUG("FindNextImagesGroupForResection -- Scores (features): ");
-  // print the 30 best scores
-  for(std::size_t i = 0; i < vec_viewsScore.size() && i < 30; ++i)
+#ifdef ALICEVISION_NEXTBESTVIEW_WITHOUT_SCORE
+  static const float dThresholdGroup = 0.75f;
+#endif
+
+  std::size_t scoreThreshold = _pyramidThreshold;
+
+  // Add the image view index with the best score, then all the following ones
+  // above the thresholds
+  const auto isNextViewNeeded = [&](const std::vector<ViewConnectionScore>& viewsScore, const ViewConnectionScore& nextViewScore)
   {
-    ALICEVISION_LOG_DEBUG_OBJ << std::get<2>(vec_viewsScore[i]) << "(" << std::get<1>(vec_viewsScore[i]) << "), ";
-  }
-  ALICEVISION_LOG_DEBUG_OBJ << std::endl;
+#ifdef ALICEVISION_NEXTBESTVIEW_WITHOUT_SCORE
+    // Number of 2D-3D correspondences for the best view.
+    const IndexT bestScore = std::get<2>(viewsScore.front());
+    // Add all the image view indexes that have at least N% of the score of the best image.
+    scoreThreshold = dThresholdGroup * bestScore;
+#endif
+    // If we add a new intrinsic, it is a sensitive stage in the process,
+    // so it is better to perform a Bundle Adjustment just after.
+    if(viewsScore.size() > 1 && !std::get<3>(viewsScore.back()))
+      return false;
+
+    return std::get<1>(nextViewScore) > minPointsThreshold && // ensure min number of points
+           std::get<2>(nextViewScore) > scoreThreshold; // ensure score level
+  };
 
-  // If the list is empty or if the list contains images with no correspondences
-  // -> (no resection will be possible)
-  if (vec_viewsScore.empty() || std::get<1>(vec_viewsScore[0]) == 0)
+  std::vector<ViewConnectionScore> vec_viewsScore;
+  if(!FindConnectedViews(vec_viewsScore, remainingViewIds, isNextViewNeeded))
   {
-    ALICEVISION_LOG_DEBUG("FindNextImagesGroupForResection failed:");
-    if(vec_viewsScore.empty())
-    {
-      ALICEVISION_LOG_DEBUG("No putative image.");
-    }
-    else
-    {
-      ALICEVISION_LOG_DEBUG_OBJ << "Not enough point in the putative images: ";
-      for(auto v: vec_viewsScore)
-        ALICEVISION_LOG_DEBUG_OBJ << std::get<1>(v) << ", ";
-    }
-    ALICEVISION_LOG_DEBUG_OBJ << std::endl;
+    // If the list is empty, the remaining images have no correspondences
+    // with the reconstruction -> (no resection will be possible)
+    ALICEVISION_LOG_DEBUG("FindNextImagesGroupForResection failed:" << std::endl << "No putative image.");
     // All remaining images cannot be used for pose estimation
     return false;
   }
 
-  // Add the image view index with the best score
-  out_selectedViewIds.push_back(std::get<0>(vec_viewsScore[0]));
-
-#ifdef ALICEVISION_NEXTBESTVIEW_WITHOUT_SCORE
-  static const float dThresholdGroup = 0.75f;
-  // Number of 2D-3D correspondences for the best view.
-  const IndexT bestScore = std::get<2>(vec_viewsScore[0]);
-  // Add all the image view indexes that have at least N% of the score of the best image.
-  const size_t scoreThreshold = dThresholdGroup * bestScore;
-#else
-  const size_t scoreThreshold = _pyramidThreshold;
-#endif
-
-  for (size_t i = 1;
-       i < vec_viewsScore.size() &&
-       std::get<1>(vec_viewsScore[i]) > minPointsThreshold && // ensure min number of points
-       std::get<2>(vec_viewsScore[i]) > scoreThreshold; // ensure score level
-       ++i)
+  ALICEVISION_LOG_DEBUG("FindNextImagesGroupForResection -- Scores (features): ");
+  for(const ViewConnectionScore& viewScore : vec_viewsScore)
   {
-    out_selectedViewIds.push_back(std::get<0>(vec_viewsScore[i]));
-    if(!std::get<3>(vec_viewsScore[i]))
-    {
-      // If we add a new intrinsic, it is a sensitive stage in the process,
-      // so it is better to perform a Bundle Adjustment just after.
-      break;
-    }
+    out_selectedViewIds.push_back(std::get<0>(viewScore));
+    ALICEVISION_LOG_DEBUG_OBJ << std::get<2>(viewScore) << "(" << std::get<1>(viewScore) << "), ";
   }
+  ALICEVISION_LOG_DEBUG_OBJ << std::endl;
+
   ALICEVISION_LOG_DEBUG(
     "FindNextImagesGroupForResection with " << out_selectedViewIds.size() << " images took: " << std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - chrono_start).count() << " msec\n"
-    " - Scores: " << std::get<2>(vec_viewsScore.front()) << " to " << std::get<2>(vec_viewsScore[out_selectedViewIds.size()-1]) << " (threshold was " << scoreThreshold << ")\n"
-    " - Features: " << std::get<1>(vec_viewsScore.front()) << " to " << std::get<1>(vec_viewsScore[out_selectedViewIds.size()-1]) << " (threshold was " << minPointsThreshold << ")");
+    " - Scores: " << std::get<2>(vec_viewsScore.front()) << " to " << std::get<2>(vec_viewsScore.back()) << " (threshold was " << scoreThreshold << ")\n"
+    " - Features: " << std::get<1>(vec_viewsScore.front()) << " to " << std::get<1>(vec_viewsScore.back()) << " (threshold was " << minPointsThreshold << ")");
   return true;
 }
 
@@ -1639,10 +1836,20 @@ bool ReconstructionEngine_sequentialSfM::BundleAdjustment(bool fixedIntrinsics)
  */
 bool ReconstructionEngine_sequentialSfM::badTrackRejector(double dPrecision, std::size_t count)
 {
-  const std::size_t nbOutliers_residualErr = RemoveOutliers_PixelResidualError(_sfm_data, dPrecision, 2);
-  const std::size_t nbOutliers_angleErr = RemoveOutliers_AngleError(_sfm_data, 2.0);
+  // The residuals of the kept observations are collected in the same pass
+  IndexT nbOutliers_residualErr = 0;
+  IndexT nbOutliers_angleErr = 0;
+  std::vector<float> residuals;
+  RemoveOutliers_PixelResidualAndAngleError(_sfm_data, dPrecision, 2.0, 2, nbOutliers_residualErr, nbOutliers_angleErr, &residuals);
 
   ALICEVISION_LOG_DEBUG("badTrackRejector: nbOutliers_residualErr: " << nbOutliers_residualErr << ", nbOutliers_angleErr: " << nbOutliers_angleErr);
+  if(!residuals.empty())
+  {
+    // The kept residuals are below dPrecision, so the histogram range is known without sorting
+    Histogram<double> histo(0.0, dPrecision, 10);
+    histo.Add(residuals.begin(), residuals.end());
+    ALICEVISION_LOG_DEBUG("badTrackRejector: histogram of residuals:" << histo.ToString());
+  }
   return (nbOutliers_residualErr + nbOutliers_angleErr) > count;
 }
 
@@ -9,6 +9,7 @@
 #include "aliceVision/sfm/pipeline/ReconstructionEngine.hpp"
 #include "aliceVision/feature/FeaturesPerView.hpp"
 #include "aliceVision/sfm/pipeline/pairwiseMatchesIO.hpp"
+#include "aliceVision/sfm/pipeline/sequential/IncrementalViewScores.hpp"
 #include "aliceVision/track/Track.hpp"
 
 #include "dependencies/htmlDoc/htmlDoc.hpp"
@@ -37,7 +38,7 @@ public:
     _featuresPerView = featuresPerView;
   }
 
-  void setMatches(matching::PairwiseMatches * pairwiseMatches)
+  void setMatches(const matching::PackedPairwiseMatches * pairwiseMatches)
   {
     _pairwiseMatches = pairwiseMatches;
   }
@@ -63,8 +64,16 @@ public:
   /// Compute the initial 3D seed (First camera t=0; R=Id, second estimated by 5 point algorithm)
   bool MakeInitialPair3D(const Pair & initialPair);
 
-  /// Automatic initial pair selection (based on a 'baseline' computation score)
-  bool getBestInitialImagePairs(std::vector<Pair>& out_bestImagePairs) const;
+  /**
+   * @brief Automatic initial pair selection (based on a 'baseline' computation score).
+   * The candidates are evaluated by decreasing upper bound of their score, and the
+   * search stops when no remaining candidate can beat the best pair found.
+   * @param[out] out_bestImagePairs The evaluated pairs sorted by decreasing score,
+   * followed by the candidates not evaluated sorted by decreasing score upper bound.
+   * @param[in] exhaustiveSearch Evaluate all the candidates.
+   * @return true if a valid pair has been found
+   */
+  bool getBestInitialImagePairs(std::vector<Pair>& out_bestImagePairs, bool exhaustiveSearch = false) const;
 
   /**
    * Set the default lens distortion type to use if it is declared unknown
@@ -100,6 +109,27 @@ public:
     _minTrackLength = minTrackLength;
   }
 
+  /**
+   * @brief Enable the checkpoints: the reconstruction state is saved in a fast
+   * binary format every checkpointInterval resection groups.
+   * @param[in] checkpointFolder folder of the checkpoint files
+   * @param[in] checkpointInterval number of resection groups between two checkpoints (0 to disable the checkpoints)
+   */
+  void setCheckpoint(const std::string& checkpointFolder, std::size_t checkpointInterval)
+  {
+    _checkpointFolder = checkpointFolder;
+    _checkpointInterval = checkpointInterval;
+  }
+
+  /**
+   * @brief Resume the reconstruction from the last checkpoint of the checkpoint folder.
+   * If there is no valid checkpoint, the reconstruction starts from scratch.
+   */
+  void setResumeFromCheckpoint(bool v)
+  {
+    _resumeFromCheckpoint = v;
+  }
+
 protected:
 
 
@@ -134,17 +164,23 @@ private:
   std::size_t computeImageScore(std::size_t viewId, const std::vector<std::size_t>& trackIds) const;
 
   /**
-   * @brief Return all the images containing matches with already reconstructed 3D points.
+   * @brief Return the images containing matches with already reconstructed 3D points.
    * The images are sorted by a score based on the number of features id shared with
    * the reconstruction and the repartition of these points in the image.
+   * The scores are updated incrementally with the landmarks added or removed since
+   * the previous call and the images are taken from a priority queue, so only the
+   * returned images are visited.
    *
    * @param[out] out_connectedViews: output list of view IDs connected with the 3D reconstruction.
    * @param[in] remainingViewIds: input list of remaining view IDs in which we will search for connected views.
+   * @param[in] isNextViewNeeded: called with the views found so far and the next one,
+   *            returns false to stop the search (the best view is always returned).
    * @return False if there is no view connected.
    */
   bool FindConnectedViews(
     std::vector<ViewConnectionScore>& out_connectedViews,
-    const std::set<size_t>& remainingViewIds) const;
+    const std::set<size_t>& remainingViewIds,
+    const std::function<bool(const std::vector<ViewConnectionScore>&, const ViewConnectionScore&)>& isNextViewNeeded);
 
   /**
    * @brief Estimate the best images on which we can compute the resectioning safely.
@@ -157,7 +193,7 @@ private:
    */
   bool FindNextImagesGroupForResection(
     std::vector<size_t>& out_selectedViewIds,
-    const std::set<size_t>& remainingViewIds) const;
+    const std::set<size_t>& remainingViewIds);
 
   /**
    * @brief Add a single Image to the scene and triangulate new possible tracks.
@@ -186,6 +222,23 @@ private:
   /// Export statistics in a JSON file
   void exportStatistics(double time_sfm);
 
+  /**
+   * @brief Save the reconstruction state in the checkpoint folder:
+   * the SfMData, the remaining views and the per camera confidences.
+   * The checkpoints are numbered, the state file refers to the SfMData file
+   * of its checkpoint and is renamed last to commit the checkpoint.
+   * @param[in] remainingViewIds the views still to reconstruct
+   * @return true if the checkpoint is saved
+   */
+  bool saveCheckpoint(const std::set<size_t>& remainingViewIds);
+
+  /**
+   * @brief Restore the reconstruction state from the checkpoint folder.
+   * The tracks are not saved as they are recomputed from the matches.
+   * @return true if a valid checkpoint is loaded
+   */
+  bool loadCheckpoint();
+
   //----
   //-- Data
   //----
@@ -205,10 +258,17 @@ private:
   int _minInputTrackLength = 2;
   int _minTrackLength = 2;
   int _minPointsPerPose = 30;
+
+  // Checkpoints
+  std::string _checkpointFolder;
+  std::size_t _checkpointInterval = 0;
+  bool _resumeFromCheckpoint = false;
+  /// sequence number of the last checkpoint saved or loaded (0 if none)
+  std::size_t _checkpointSequence = 0;
   
   //-- Data provider
   feature::FeaturesPerView  * _featuresPerView;
-  matching::PairwiseMatches  * _pairwiseMatches;
+  const matching::PackedPairwiseMatches * _pairwiseMatches;
 
   // Pyramid scoring
   const int _pyramidBase = 2;
@@ -227,6 +287,8 @@ private:
   track::TracksPerView _map_tracksPerView;
   /// Precomputed pyramid index for each trackId of each viewId.
   track::TracksPyramidPerView _map_featsPyramidPerView;
+  /// Next best view scores of the remaining views, updated with the landmarks
+  IncrementalViewScores _viewScores;
   /// Per camera confidence (A contrario estimated threshold error)
   HashMap<IndexT, double> _map_ACThreshold;
 
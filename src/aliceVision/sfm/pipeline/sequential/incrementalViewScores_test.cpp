@@ -0,0 +1,197 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/sfm/pipeline/sequential/IncrementalViewScores.hpp>
+
+#include <cmath>
+#include <limits>
+#include <random>
+#include <set>
+
+#define BOOST_TEST_MODULE incrementalViewScores
+#include <boost/test/included/unit_test.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::sfm;
+
+namespace {
+
+const std::size_t pyramidBase = 2;
+const std::size_t pyramidDepth = 3;
+
+/// random tracks seen by a subset of the views with a random pyramid cell per level
+void createTracks(std::size_t nbViews, std::size_t nbTracks, std::mt19937& generator,
+                  track::TracksMap& tracks, track::TracksPyramidPerView& tracksPyramidPerView)
+{
+  std::uniform_int_distribution<std::size_t> viewDistribution(0, nbViews - 1);
+  for(std::size_t trackId = 0; trackId < nbTracks; ++trackId)
+  {
+    track::Track& track = tracks[trackId];
+    for(int i = 0; i < 4; ++i)
+      track.featPerView[viewDistribution(generator)] = trackId;
+
+    for(const auto& featIt : track.featPerView)
+    {
+      std::size_t levelStart = 0;
+      for(std::size_t level = 0; level < pyramidDepth; ++level)
+      {
+        const std::size_t nbLevelCells = std::pow(pyramidBase, 2 * (level + 1));
+        std::uniform_int_distribution<std::size_t> cellDistribution(0, nbLevelCells - 1);
+        tracksPyramidPerView[featIt.first][trackId * pyramidDepth + level] = levelStart + cellDistribution(generator);
+        levelStart += nbLevelCells;
+      }
+    }
+  }
+}
+
+/// score of a view computed from scratch, as ReconstructionEngine_sequentialSfM::computeImageScore
+std::size_t computeScore(IndexT viewId, const std::set<std::size_t>& trackIds,
+                         const track::TracksMap& tracks, const track::TracksPyramidPerView& tracksPyramidPerView,
+                         const std::vector<int>& pyramidWeights, std::size_t& nbTracks)
+{
+  nbTracks = 0;
+  std::size_t score = 0;
+  for(std::size_t level = 0; level < pyramidDepth; ++level)
+  {
+    std::set<std::size_t> cells;
+    for(std::size_t trackId : trackIds)
+    {
+      if(!tracks.at(trackId).featPerView.count(viewId))
+        continue;
+      cells.insert(tracksPyramidPerView.at(viewId).at(trackId * pyramidDepth + level));
+      if(level == 0)
+        ++nbTracks;
+    }
+    score += cells.size() * pyramidWeights[level];
+  }
+#ifdef ALICEVISION_NEXTBESTVIEW_WITHOUT_SCORE
+  score = nbTracks;
+#endif
+  return score;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(IncrementalViewScores_compareWithBruteForce)
+{
+  const std::size_t nbViews = 20;
+  const std::size_t nbTracks = 500;
+  const std::vector<int> pyramidWeights = {4, 2, 1};
+
+  std::mt19937 generator(42);
+  track::TracksMap tracks;
+  track::TracksPyramidPerView tracksPyramidPerView;
+  createTracks(nbViews, nbTracks, generator, tracks, tracksPyramidPerView);
+
+  IncrementalViewScores viewScores;
+  viewScores.init(tracks, tracksPyramidPerView, pyramidBase, pyramidWeights);
+
+  Landmarks landmarks;
+  std::set<std::size_t> removedViewIds;
+  std::uniform_int_distribution<std::size_t> trackDistribution(0, nbTracks - 1);
+
+  for(int iteration = 0; iteration < 10; ++iteration)
+  {
+    // add and remove landmarks
+    for(int i = 0; i < 80; ++i)
+      landmarks[trackDistribution(generator)] = Landmark();
+    for(int i = 0; i < 20; ++i)
+      landmarks.erase(trackDistribution(generator));
+
+    if(iteration == 5)
+    {
+      viewScores.removeView(3);
+      removedViewIds.insert(3);
+    }
+
+    viewScores.update(landmarks);
+
+    std::set<std::size_t> trackIds;
+    for(const auto& landmarkIt : landmarks)
+      trackIds.insert(landmarkIt.first);
+
+    for(IndexT viewId = 0; viewId < nbViews; ++viewId)
+    {
+      std::size_t expectedNbTracks = 0;
+      const std::size_t expectedScore = computeScore(viewId, trackIds, tracks, tracksPyramidPerView, pyramidWeights, expectedNbTracks);
+      const IncrementalViewScores::ViewScore viewScore = viewScores.getViewScore(viewId);
+      BOOST_CHECK_EQUAL(viewScore.nbTracks, expectedNbTracks);
+      BOOST_CHECK_EQUAL(viewScore.score, expectedScore);
+    }
+
+    // the views are visited once by decreasing score
+    std::set<IndexT> visitedViewIds;
+    std::size_t previousScore = std::numeric_limits<std::size_t>::max();
+    viewScores.visitBestViews([](IndexT) { return true; },
+                              [&](const IncrementalViewScores::ViewScore& viewScore)
+    {
+      BOOST_CHECK(visitedViewIds.insert(viewScore.viewId).second);
+      BOOST_CHECK_LE(viewScore.score, previousScore);
+      BOOST_CHECK_GT(viewScore.nbTracks, 0);
+      previousScore = viewScore.score;
+      return true;
+    });
+
+    for(IndexT viewId = 0; viewId < nbViews; ++viewId)
+    {
+      const bool isExpected = !removedViewIds.count(viewId) && viewScores.getViewScore(viewId).nbTracks > 0;
+      BOOST_CHECK_EQUAL(visitedViewIds.count(viewId) == 1, isExpected);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(IncrementalViewScores_visitBestViewsStop)
+{
+  const std::vector<int> pyramidWeights = {4, 2, 1};
+
+  std::mt19937 generator(7);
+  track::TracksMap tracks;
+  track::TracksPyramidPerView tracksPyramidPerView;
+  createTracks(10, 200, generator, tracks, tracksPyramidPerView);
+
+  IncrementalViewScores viewScores;
+  viewScores.init(tracks, tracksPyramidPerView, pyramidBase, pyramidWeights);
+  for(std::size_t trackId = 0; trackId < 100; ++trackId)
+    viewScores.addTrack(trackId);
+
+  // stop after the best candidate with an even view id
+  std::vector<IndexT> visitedViewIds;
+  const auto isEven = [](IndexT viewId) { return viewId % 2 == 0; };
+  viewScores.visitBestViews(isEven, [&](const IncrementalViewScores::ViewScore& viewScore)
+  {
+    visitedViewIds.push_back(viewScore.viewId);
+    return false;
+  });
+  BOOST_REQUIRE_EQUAL(visitedViewIds.size(), 1);
+
+  // the same view is found again as the stopped visit keeps the queue unchanged
+  IndexT bestViewId = UndefinedIndexT;
+  std::size_t bestScore = 0;
+  for(IndexT viewId = 0; viewId < 10; viewId += 2)
+  {
+    const std::size_t score = viewScores.getViewScore(viewId).score;
+    if(score > bestScore)
+    {
+      bestScore = score;
+      bestViewId = viewId;
+    }
+  }
+  BOOST_CHECK_EQUAL(visitedViewIds.front(), bestViewId);
+
+  viewScores.visitBestViews(isEven, [&](const IncrementalViewScores::ViewScore& viewScore)
+  {
+    BOOST_CHECK_EQUAL(viewScore.viewId, bestViewId);
+    return false;
+  });
+
+  // removing all the tracks empties the queue
+  for(std::size_t trackId = 0; trackId < 100; ++trackId)
+    viewScores.removeTrack(trackId);
+
+  bool isVisited = false;
+  viewScores.visitBestViews([](IndexT) { return true; },
+                            [&](const IncrementalViewScores::ViewScore&) { isVisited = true; return true; });
+  BOOST_CHECK(!isVisited);
+}
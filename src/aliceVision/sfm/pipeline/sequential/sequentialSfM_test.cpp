@@ -61,10 +61,11 @@ BOOST_AUTO_TEST_CASE(SEQUENTIAL_SFM_Known_Intrinsics)
 
   matching::PairwiseMatches pairwiseMatches;
   generateSyntheticMatches(pairwiseMatches, sfmData, feature::EImageDescriberType::UNKNOWN);
+  const matching::PackedPairwiseMatches packedMatches(pairwiseMatches);
 
   // Configure data provider (Features and Matches)
   sfmEngine.setFeatures(&featuresPerView);
-  sfmEngine.setMatches(&pairwiseMatches);
+  sfmEngine.setMatches(&packedMatches);
 
   // Set an initial pair
   sfmEngine.setInitialPair(Pair(0,1));
@@ -121,10 +122,11 @@ BOOST_AUTO_TEST_CASE(SEQUENTIAL_SFM_Partially_Known_Intrinsics)
 
   matching::PairwiseMatches pairwiseMatches;
   generateSyntheticMatches(pairwiseMatches, sfmData, feature::EImageDescriberType::UNKNOWN);
+  const matching::PackedPairwiseMatches packedMatches(pairwiseMatches);
 
   // Configure data provider (Features and Matches)
   sfmEngine.setFeatures(&featuresPerView);
-  sfmEngine.setMatches(&pairwiseMatches);
+  sfmEngine.setMatches(&packedMatches);
 
   // Set an initial pair
   sfmEngine.setInitialPair(Pair(0,1));
@@ -171,10 +173,11 @@ BOOST_AUTO_TEST_CASE(SEQUENTIAL_SFM_Known_Rig)
 
   matching::PairwiseMatches pairwiseMatches;
   generateSyntheticMatches(pairwiseMatches, sfmData, feature::EImageDescriberType::UNKNOWN);
+  const matching::PackedPairwiseMatches packedMatches(pairwiseMatches);
 
   // Configure data provider (Features and Matches)
   sfmEngine.setFeatures(&featuresPerView);
-  sfmEngine.setMatches(&pairwiseMatches);
+  sfmEngine.setMatches(&packedMatches);
 
   // Set an initial pair
   sfmEngine.setInitialPair(Pair(0,2));
@@ -191,3 +194,132 @@ BOOST_AUTO_TEST_CASE(SEQUENTIAL_SFM_Known_Rig)
   BOOST_CHECK_EQUAL(sfmEngine.Get_SfMData().GetLandmarks().size(), nbPoints);
 }
 
+
+// Test the resume of a reconstruction from its last checkpoint
+// Test that the search of the initial pair stopped by the score upper bounds
+// finds the same best pair as the evaluation of all the candidates
+BOOST_AUTO_TEST_CASE(SEQUENTIAL_SFM_Initial_Pair_Pruned_Search)
+{
+  const int nviews = 12;
+  const int npoints = 256;
+  const NViewDatasetConfigurator config;
+  const NViewDataSet d = NRealisticCamerasRing(nviews, npoints, config);
+
+  // Translate the input dataset to a SfMData scene
+  const SfMData sfmData = getInputScene(d, config, PINHOLE_CAMERA);
+
+  // Remove poses and structure
+  SfMData sfmData2 = sfmData;
+  sfmData2.GetPoses().clear();
+  sfmData2.structure.clear();
+
+  // Add a tiny noise in 2D observations to make data more realistic
+  std::normal_distribution<double> distribution(0.0,0.5);
+
+  // Configure the featuresPerView & the matches_provider from the synthetic dataset
+  feature::FeaturesPerView featuresPerView;
+  generateSyntheticFeatures(featuresPerView, feature::EImageDescriberType::UNKNOWN, sfmData, distribution);
+
+  matching::PairwiseMatches pairwiseMatches;
+  generateSyntheticMatches(pairwiseMatches, sfmData, feature::EImageDescriberType::UNKNOWN);
+  const matching::PackedPairwiseMatches packedMatches(pairwiseMatches);
+
+  ReconstructionEngine_sequentialSfM sfmEngine(sfmData2, "./");
+  sfmEngine.setFeatures(&featuresPerView);
+  sfmEngine.setMatches(&packedMatches);
+  BOOST_CHECK(sfmEngine.InitLandmarkTracks());
+
+  std::vector<Pair> exhaustivePairs;
+  BOOST_CHECK(sfmEngine.getBestInitialImagePairs(exhaustivePairs, true));
+  std::vector<Pair> prunedPairs;
+  BOOST_CHECK(sfmEngine.getBestInitialImagePairs(prunedPairs));
+
+  BOOST_REQUIRE(!exhaustivePairs.empty());
+  BOOST_REQUIRE(!prunedPairs.empty());
+  BOOST_CHECK(prunedPairs.front() == exhaustivePairs.front());
+
+  // the candidates not evaluated are kept after the evaluated ones
+  BOOST_CHECK_GE(prunedPairs.size(), exhaustivePairs.size());
+}
+
+BOOST_AUTO_TEST_CASE(SEQUENTIAL_SFM_Resume_From_Checkpoint)
+{
+  const int nviews = 6;
+  const int npoints = 128;
+  const NViewDatasetConfigurator config;
+  const NViewDataSet d = NRealisticCamerasRing(nviews, npoints, config);
+
+  // Translate the input dataset to a SfMData scene
+  const SfMData sfmData = getInputScene(d, config, PINHOLE_CAMERA);
+
+  // Remove poses and structure
+  SfMData sfmData2 = sfmData;
+  sfmData2.GetPoses().clear();
+  sfmData2.structure.clear();
+
+  // Add a tiny noise in 2D observations to make data more realistic
+  std::normal_distribution<double> distribution(0.0,0.5);
+
+  // Configure the featuresPerView & the matches_provider from the synthetic dataset
+  feature::FeaturesPerView featuresPerView;
+  generateSyntheticFeatures(featuresPerView, feature::EImageDescriberType::UNKNOWN, sfmData, distribution);
+
+  matching::PairwiseMatches pairwiseMatches;
+  generateSyntheticMatches(pairwiseMatches, sfmData, feature::EImageDescriberType::UNKNOWN);
+  const matching::PackedPairwiseMatches packedMatches(pairwiseMatches);
+
+  const std::string checkpointFolder = stlplus::create_filespec("./", "checkpoint_test");
+  stlplus::folder_delete(checkpointFolder, true);
+
+  // Uninterrupted reconstruction.
+  // The first views are resected one by one after the initial pair, so with a
+  // checkpoint every 3 resection groups the only checkpoint has nviews - 1 poses.
+  ReconstructionEngine_sequentialSfM fullEngine(sfmData2, "./");
+  fullEngine.setFeatures(&featuresPerView);
+  fullEngine.setMatches(&packedMatches);
+  fullEngine.setInitialPair(Pair(0,1));
+  fullEngine.Set_bFixedIntrinsics(true);
+  fullEngine.setCheckpoint(checkpointFolder, 3);
+
+  BOOST_CHECK(fullEngine.Process());
+  BOOST_CHECK_EQUAL(fullEngine.Get_SfMData().GetPoses().size(), nviews);
+
+  // the checkpoint is committed by its state file, which refers to a single SfMData file
+  BOOST_CHECK(stlplus::file_exists(stlplus::create_filespec(checkpointFolder, "checkpoint_state", "bin")));
+  const std::vector<std::string> sfmDataFiles = stlplus::folder_wildcard(checkpointFolder, "checkpoint_sfmData_*.bin", false, true);
+  BOOST_REQUIRE_EQUAL(sfmDataFiles.size(), 1);
+
+  SfMData checkpointSfMData;
+  BOOST_REQUIRE(Load(checkpointSfMData, stlplus::create_filespec(checkpointFolder, sfmDataFiles.front()), ESfMData(ALL)));
+  BOOST_CHECK_EQUAL(checkpointSfMData.GetPoses().size(), nviews - 1);
+
+  // Reconstruction resumed from the mid-reconstruction checkpoint, without initial pair
+  ReconstructionEngine_sequentialSfM resumedEngine(sfmData2, "./");
+  resumedEngine.setFeatures(&featuresPerView);
+  resumedEngine.setMatches(&packedMatches);
+  resumedEngine.Set_bFixedIntrinsics(true);
+  resumedEngine.setAllowUserInteraction(false);
+  resumedEngine.setCheckpoint(checkpointFolder, 0);
+  resumedEngine.setResumeFromCheckpoint(true);
+
+  BOOST_CHECK(resumedEngine.Process());
+
+  const SfMData& fullSfMData = fullEngine.Get_SfMData();
+  const SfMData& resumedSfMData = resumedEngine.Get_SfMData();
+
+  const double dResidual = RMSE(resumedSfMData);
+  BOOST_CHECK_LT(dResidual, 0.5);
+  BOOST_CHECK_EQUAL(resumedSfMData.GetPoses().size(), fullSfMData.GetPoses().size());
+  BOOST_CHECK_EQUAL(resumedSfMData.GetLandmarks().size(), fullSfMData.GetLandmarks().size());
+
+  // both reconstructions share the frame of the checkpoint
+  for(const auto& posePair : fullSfMData.GetPoses())
+  {
+    BOOST_REQUIRE(resumedSfMData.GetPoses().count(posePair.first));
+    const Vec3 fullCenter = posePair.second.center();
+    const Vec3 resumedCenter = resumedSfMData.GetPoses().at(posePair.first).center();
+    BOOST_CHECK_SMALL((fullCenter - resumedCenter).norm(), 1e-2);
+  }
+
+  stlplus::folder_delete(checkpointFolder, true);
+}
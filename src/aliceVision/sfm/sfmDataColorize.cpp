@@ -0,0 +1,172 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "sfmDataColorize.hpp"
+#include <aliceVision/image/io.hpp>
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/alicevision_omp.hpp>
+
+#include <dependencies/stlplus3/filesystemSimplified/file_system.hpp>
+
+#include <boost/progress.hpp>
+
+#include <algorithm>
+#include <queue>
+
+namespace aliceVision {
+namespace sfm {
+
+void computeColorizationPlan(const SfMData& sfmData, std::vector<ViewColorization>& plan)
+{
+  plan.clear();
+  const Landmarks& landmarks = sfmData.GetLandmarks();
+
+  // contiguous indexes of the landmarks and of the observing views
+  std::vector<IndexT> landmarkIds;
+  landmarkIds.reserve(landmarks.size());
+  std::vector<IndexT> viewIds;
+  HashMap<IndexT, std::size_t> viewIndexes;
+  std::vector<std::size_t> nbObservationsPerView;
+
+  for(const auto& landmarkIt : landmarks)
+  {
+    landmarkIds.push_back(landmarkIt.first);
+    for(const auto& observationIt : landmarkIt.second.observations)
+    {
+      const auto viewIt = viewIndexes.emplace(observationIt.first, viewIds.size());
+      if(viewIt.second)
+      {
+        viewIds.push_back(observationIt.first);
+        nbObservationsPerView.push_back(0);
+      }
+      ++nbObservationsPerView[viewIt.first->second];
+    }
+  }
+
+  // invert the observations: the landmarks observed by the view v are
+  // viewLandmarks[viewOffsets[v], viewOffsets[v+1])
+  const std::size_t nbViews = viewIds.size();
+  std::vector<std::size_t> viewOffsets(nbViews + 1, 0);
+  for(std::size_t v = 0; v < nbViews; ++v)
+    viewOffsets[v + 1] = viewOffsets[v] + nbObservationsPerView[v];
+
+  std::vector<std::size_t> viewLandmarks(viewOffsets.back());
+  // the views observing the landmark l are landmarkViews[landmarkOffsets[l], landmarkOffsets[l+1])
+  std::vector<std::size_t> landmarkOffsets(landmarkIds.size() + 1, 0);
+  std::vector<std::size_t> landmarkViews(viewOffsets.back());
+  {
+    std::vector<std::size_t> viewFill(viewOffsets.begin(), viewOffsets.end() - 1);
+    std::size_t l = 0;
+    for(const auto& landmarkIt : landmarks)
+    {
+      landmarkOffsets[l + 1] = landmarkOffsets[l] + landmarkIt.second.observations.size();
+      std::size_t i = landmarkOffsets[l];
+      for(const auto& observationIt : landmarkIt.second.observations)
+      {
+        const std::size_t v = viewIndexes.at(observationIt.first);
+        viewLandmarks[viewFill[v]++] = l;
+        landmarkViews[i++] = v;
+      }
+      ++l;
+    }
+  }
+
+  // max-heap of the views on their number of landmarks to colorize.
+  // As the counts only decrease, an entry is outdated if its count is greater
+  // than the current one: it is then pushed again with the current count.
+  typedef std::pair<std::size_t, IndexT> HeapEntry; // (count, view id)
+  const auto compare = [](const HeapEntry& a, const HeapEntry& b)
+  {
+    return (a.first < b.first) || (a.first == b.first && a.second > b.second);
+  };
+  std::priority_queue<HeapEntry, std::vector<HeapEntry>, decltype(compare)> heap(compare);
+  for(std::size_t v = 0; v < nbViews; ++v)
+    heap.emplace(nbObservationsPerView[v], viewIds[v]);
+
+  std::vector<bool> isColorized(landmarkIds.size(), false);
+  std::vector<std::size_t>& remainingPerView = nbObservationsPerView;
+
+  while(!heap.empty())
+  {
+    const HeapEntry entry = heap.top();
+    heap.pop();
+    const std::size_t v = viewIndexes.at(entry.second);
+    if(remainingPerView[v] == 0)
+      continue;
+    if(entry.first != remainingPerView[v])
+    {
+      heap.emplace(remainingPerView[v], entry.second);
+      continue;
+    }
+
+    plan.emplace_back();
+    ViewColorization& viewColorization = plan.back();
+    viewColorization.viewId = entry.second;
+    viewColorization.landmarkIds.reserve(remainingPerView[v]);
+
+    for(std::size_t i = viewOffsets[v]; i < viewOffsets[v + 1]; ++i)
+    {
+      const std::size_t l = viewLandmarks[i];
+      if(isColorized[l])
+        continue;
+      isColorized[l] = true;
+      viewColorization.landmarkIds.push_back(landmarkIds[l]);
+      // the landmark is not to colorize anymore for all its views
+      for(std::size_t j = landmarkOffsets[l]; j < landmarkOffsets[l + 1]; ++j)
+        --remainingPerView[landmarkViews[j]];
+    }
+    assert(remainingPerView[v] == 0);
+  }
+}
+
+bool colorizeTracks(SfMData& sfmData, const std::vector<ViewColorization>& plan, int nbThreads)
+{
+  if(nbThreads <= 0)
+    nbThreads = omp_get_max_threads();
+
+  std::size_t nbLandmarks = 0;
+  for(const ViewColorization& viewColorization : plan)
+    nbLandmarks += viewColorization.landmarkIds.size();
+
+  boost::progress_display my_progress_bar(nbLandmarks,
+                                     std::cout,
+                                     "\nCompute scene structure color\n");
+  bool isValid = true;
+
+  // each landmark is colorized by a single view, the landmarks can be updated concurrently
+  #pragma omp parallel for schedule(dynamic) num_threads(nbThreads)
+  for(int i = 0; i < plan.size(); ++i)
+  {
+    const ViewColorization& viewColorization = plan[i];
+    const View * view = sfmData.GetViews().at(viewColorization.viewId).get();
+    const std::string sView_filename = stlplus::create_filespec(sfmData.s_root_path,
+      view->getImagePath());
+    image::Image<image::RGBColor> image;
+    if(!image::ReadImage(sView_filename.c_str(), &image))
+    {
+      ALICEVISION_LOG_WARNING("Unable to read image: " << sView_filename);
+      #pragma omp critical
+      isValid = false;
+      continue;
+    }
+
+    for(const IndexT landmarkId : viewColorization.landmarkIds)
+    {
+      Landmark& landmark = sfmData.structure.at(landmarkId);
+      Vec2 pt = landmark.observations.at(viewColorization.viewId).x;
+      // Clamp the pixel position if the feature/marker center is outside the image.
+      pt.x() = clamp(pt.x(), 0.0, double(image.Width()-1));
+      pt.y() = clamp(pt.y(), 0.0, double(image.Height()-1));
+      landmark.rgb = image(pt.y(), pt.x());
+    }
+
+    #pragma omp critical
+    my_progress_bar += viewColorization.landmarkIds.size();
+  }
+  return isValid;
+}
+
+} // namespace sfm
+} // namespace aliceVision
@@ -0,0 +1,53 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/types.hpp>
+#include <aliceVision/sfm/SfMData.hpp>
+
+#include <vector>
+
+namespace aliceVision {
+namespace sfm {
+
+/**
+ * @brief The landmarks to colorize from a view.
+ */
+struct ViewColorization
+{
+  IndexT viewId = UndefinedIndexT;
+  std::vector<IndexT> landmarkIds;
+};
+
+/**
+ * @brief Compute which view gives its color to each landmark.
+ *
+ * The views are selected greedily: the view observing the most landmarks not
+ * colorized yet is selected first (the smallest view id on equality), its
+ * landmarks are assigned to it, and so on.
+ * The observations are inverted once into per view lists and the views are
+ * selected with a max-heap whose counts are decremented as the landmarks are
+ * assigned, so the cost is linear in the number of observations (up to a log).
+ *
+ * @param[in] sfmData The scene.
+ * @param[out] plan The selected views in the selection order with the landmarks they colorize.
+ */
+void computeColorizationPlan(const SfMData& sfmData, std::vector<ViewColorization>& plan);
+
+/**
+ * @brief Colorize the landmarks with the given plan.
+ * The images are read in parallel, each thread holds one image at a time, so
+ * at most nbThreads images are in memory.
+ *
+ * @param[in,out] sfmData The scene.
+ * @param[in] plan The colorization plan (see computeColorizationPlan()).
+ * @param[in] nbThreads The number of threads reading the images, 0 to use all the cores.
+ * @return false if an image cannot be read, the landmarks of the other images are colorized.
+ */
+bool colorizeTracks(SfMData& sfmData, const std::vector<ViewColorization>& plan, int nbThreads = 0);
+
+} // namespace sfm
+} // namespace aliceVision
@@ -0,0 +1,134 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/sfm/sfmDataColorize.hpp>
+#include <aliceVision/image/io.hpp>
+
+#include <dependencies/stlplus3/filesystemSimplified/file_system.hpp>
+
+#include <cstdlib>
+#include <map>
+#include <set>
+
+#define BOOST_TEST_MODULE sfmDataColorize
+#include <boost/test/included/unit_test.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::sfm;
+
+namespace {
+
+/// Random scene, each landmark is observed by 1 to 5 views
+SfMData createScene(std::size_t nbViews, std::size_t nbLandmarks)
+{
+  SfMData sfmData;
+  for(IndexT viewId = 0; viewId < nbViews; ++viewId)
+    sfmData.views[viewId] = std::make_shared<View>("view_" + std::to_string(viewId) + ".png", viewId, 0, viewId, 16, 16);
+
+  std::srand(0);
+  for(IndexT landmarkId = 0; landmarkId < nbLandmarks; ++landmarkId)
+  {
+    Landmark& landmark = sfmData.structure[landmarkId * 3];
+    const std::size_t nbObservations = 1 + std::rand() % 5;
+    for(std::size_t i = 0; i < nbObservations; ++i)
+    {
+      const IndexT viewId = std::rand() % nbViews;
+      landmark.observations[viewId] = Observation(Vec2(std::rand() % 20 - 2, std::rand() % 20 - 2), landmarkId);
+    }
+  }
+  return sfmData;
+}
+
+/// Reference greedy selection: recount the observations of the remaining landmarks at each step
+void computeColorizationPlanReference(const SfMData& sfmData, std::vector<ViewColorization>& plan)
+{
+  std::set<IndexT> remaining;
+  for(const auto& landmarkIt : sfmData.GetLandmarks())
+    remaining.insert(landmarkIt.first);
+
+  while(!remaining.empty())
+  {
+    std::map<IndexT, std::size_t> counts;
+    for(const IndexT landmarkId : remaining)
+      for(const auto& observationIt : sfmData.GetLandmarks().at(landmarkId).observations)
+        ++counts[observationIt.first];
+
+    // the first view (smallest id) with the most observations
+    IndexT bestViewId = counts.begin()->first;
+    for(const auto& countIt : counts)
+      if(countIt.second > counts.at(bestViewId))
+        bestViewId = countIt.first;
+
+    plan.emplace_back();
+    plan.back().viewId = bestViewId;
+    for(auto it = remaining.begin(); it != remaining.end();)
+    {
+      const Observations& observations = sfmData.GetLandmarks().at(*it).observations;
+      if(observations.count(bestViewId))
+      {
+        plan.back().landmarkIds.push_back(*it);
+        it = remaining.erase(it);
+      }
+      else
+        ++it;
+    }
+  }
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(SfMData_colorizationPlan)
+{
+  const SfMData sfmData = createScene(30, 2000);
+
+  std::vector<ViewColorization> plan;
+  computeColorizationPlan(sfmData, plan);
+  std::vector<ViewColorization> planReference;
+  computeColorizationPlanReference(sfmData, planReference);
+
+  // same views in the same order, each landmark is colorized once
+  BOOST_REQUIRE_EQUAL(plan.size(), planReference.size());
+  std::size_t nbLandmarks = 0;
+  for(std::size_t i = 0; i < plan.size(); ++i)
+  {
+    BOOST_CHECK_EQUAL(plan[i].viewId, planReference[i].viewId);
+    std::set<IndexT> landmarkIds(plan[i].landmarkIds.begin(), plan[i].landmarkIds.end());
+    std::set<IndexT> landmarkIdsReference(planReference[i].landmarkIds.begin(), planReference[i].landmarkIds.end());
+    BOOST_CHECK(landmarkIds == landmarkIdsReference);
+    nbLandmarks += plan[i].landmarkIds.size();
+  }
+  BOOST_CHECK_EQUAL(nbLandmarks, sfmData.GetLandmarks().size());
+}
+
+BOOST_AUTO_TEST_CASE(SfMData_colorizeTracks)
+{
+  const std::string folder = "colorize_test_images";
+  stlplus::folder_create(folder);
+
+  SfMData sfmData = createScene(4, 200);
+  sfmData.s_root_path = folder;
+
+  // each view has a uniform color
+  for(const auto& viewIt : sfmData.GetViews())
+  {
+    const image::RGBColor color(viewIt.first * 50, 100, 200);
+    const image::Image<image::RGBColor> image(16, 16, true, color);
+    BOOST_REQUIRE(image::WriteImage(stlplus::create_filespec(folder, viewIt.second->getImagePath()).c_str(), image));
+  }
+
+  std::vector<ViewColorization> plan;
+  computeColorizationPlan(sfmData, plan);
+  BOOST_CHECK(colorizeTracks(sfmData, plan, 2));
+
+  for(const ViewColorization& viewColorization : plan)
+    for(const IndexT landmarkId : viewColorization.landmarkIds)
+      BOOST_CHECK(sfmData.GetLandmarks().at(landmarkId).rgb == image::RGBColor(viewColorization.viewId * 50, 100, 200));
+
+  // a missing image is reported
+  stlplus::file_delete(stlplus::create_filespec(folder, sfmData.GetViews().at(plan.front().viewId)->getImagePath()));
+  BOOST_CHECK(!colorizeTracks(sfmData, plan, 2));
+
+  stlplus::folder_delete(folder, true);
+}
@@ -7,87 +7,235 @@
 #include <aliceVision/stl/stl.hpp>
 #include <aliceVision/system/Logger.hpp>
 
+#include <algorithm>
+#include <cmath>
 #include <iterator>
 
 namespace aliceVision {
 namespace sfm {
 
-IndexT RemoveOutliers_PixelResidualError
-(
-  SfMData & sfm_data,
-  const double dThresholdPixel,
-  const unsigned int minTrackLength
-)
+namespace {
+
+/**
+ * @brief Outlier flags of the landmarks, evaluated in parallel and applied in a single pass.
+ */
+struct LandmarksOutliers
 {
-  IndexT outlier_count = 0;
-  Landmarks::iterator iterTracks = sfm_data.structure.begin();
-  while (iterTracks != sfm_data.structure.end())
+  /// landmarks to evaluate, in the container order
+  std::vector<Landmarks::iterator> landmarks;
+  /// index of the first observation of each landmark in isObservationOutlier
+  std::vector<std::size_t> firstObservation;
+  std::vector<char> isObservationOutlier;
+  std::vector<char> isLandmarkOutlier;
+
+  explicit LandmarksOutliers(Landmarks& structure)
   {
-    Observations & observations = iterTracks->second.observations;
-    Observations::iterator itObs = observations.begin();
-    while (itObs != observations.end())
+    landmarks.reserve(structure.size());
+    firstObservation.reserve(structure.size() + 1);
+    std::size_t nbObservations = 0;
+    for(Landmarks::iterator it = structure.begin(); it != structure.end(); ++it)
     {
-      const View * view = sfm_data.views.at(itObs->first).get();
-      const geometry::Pose3 pose = sfm_data.getPose(*view);
-      const camera::IntrinsicBase * intrinsic = sfm_data.intrinsics.at(view->getIntrinsicId()).get();
-      const Vec2 residual = intrinsic->residual(pose, iterTracks->second.X, itObs->second.x);
-      if((pose.depth(iterTracks->second.X) < 0) ||
-         (residual.norm() > dThresholdPixel))
+      landmarks.push_back(it);
+      firstObservation.push_back(nbObservations);
+      nbObservations += it->second.observations.size();
+    }
+    firstObservation.push_back(nbObservations);
+    isObservationOutlier.assign(nbObservations, 0);
+    isLandmarkOutlier.assign(landmarks.size(), 0);
+  }
+
+  /// Remove the flagged observations and landmarks
+  void erase(Landmarks& structure) const
+  {
+    for(std::size_t i = 0; i < landmarks.size(); ++i)
+    {
+      if(isLandmarkOutlier[i])
       {
-        ++outlier_count;
-        itObs = observations.erase(itObs);
+        structure.erase(landmarks[i]);
+        continue;
+      }
+      Observations& observations = landmarks[i]->second.observations;
+      const char* isOutlier = &isObservationOutlier[firstObservation[i]];
+      std::size_t j = 0;
+      for(Observations::iterator itObs = observations.begin(); itObs != observations.end(); ++j)
+      {
+        if(isOutlier[j])
+          itObs = observations.erase(itObs);
+        else
+          ++itObs;
       }
-      else
-        ++itObs;
     }
-    if (observations.empty() || observations.size() < minTrackLength)
-      iterTracks = sfm_data.structure.erase(iterTracks);
-    else
-      ++iterTracks;
   }
+};
+
+/**
+ * @brief Flag the observations with too large reprojection error, and the landmarks with
+ * too few observations left.
+ * @param[out] residuals if not null, the absolute residual coordinates of the observations
+ * @return the number of observation outliers of the landmark
+ */
+IndexT flagResidualOutliers(const SfMData& sfm_data,
+                            const Landmark& landmark,
+                            const double dThresholdPixel,
+                            const unsigned int minTrackLength,
+                            char* isObservationOutlier,
+                            char& isLandmarkOutlier,
+                            float* residuals)
+{
+  IndexT outlier_count = 0;
+  std::size_t j = 0;
+  for(const auto& obs : landmark.observations)
+  {
+    const View * view = sfm_data.views.at(obs.first).get();
+    const geometry::Pose3 pose = sfm_data.getPose(*view);
+    const camera::IntrinsicBase * intrinsic = sfm_data.intrinsics.at(view->getIntrinsicId()).get();
+    const Vec2 residual = intrinsic->residual(pose, landmark.X, obs.second.x);
+    if(residuals != nullptr)
+    {
+      residuals[2 * j] = std::abs(residual(0));
+      residuals[2 * j + 1] = std::abs(residual(1));
+    }
+    if((pose.depth(landmark.X) < 0) ||
+       (residual.norm() > dThresholdPixel))
+    {
+      ++outlier_count;
+      isObservationOutlier[j] = 1;
+    }
+    ++j;
+  }
+  const std::size_t nbInliers = landmark.observations.size() - outlier_count;
+  if(nbInliers == 0 || nbInliers < minTrackLength)
+    isLandmarkOutlier = 1;
   return outlier_count;
 }
 
-IndexT RemoveOutliers_AngleError(SfMData& sfm_data, const double dMinAcceptedAngle)
+/**
+ * @brief Compute the maximum angle between the rays of the observations which are not flagged.
+ */
+double computeMaxAngle(const SfMData& sfm_data, const Observations& observations, const char* isObservationOutlier)
 {
-  IndexT removedTrack_count = 0;
-  Landmarks::iterator iterTracks = sfm_data.structure.begin();
-  while (iterTracks != sfm_data.structure.end())
+  double max_angle = 0.0;
+  std::size_t j1 = 0;
+  for (Observations::const_iterator itObs1 = observations.begin();
+    itObs1 != observations.end(); ++itObs1, ++j1)
   {
-    Observations & observations = iterTracks->second.observations;
-    double max_angle = 0.0;
-    for (Observations::const_iterator itObs1 = observations.begin();
-      itObs1 != observations.end(); ++itObs1)
+    if(isObservationOutlier[j1])
+      continue;
+    const View * view1 = sfm_data.views.at(itObs1->first).get();
+    const geometry::Pose3 pose1 = sfm_data.getPose(*view1);
+    const camera::IntrinsicBase * intrinsic1 = sfm_data.intrinsics.at(view1->getIntrinsicId()).get();
+
+    Observations::const_iterator itObs2 = itObs1;
+    ++itObs2;
+    std::size_t j2 = j1 + 1;
+    for (; itObs2 != observations.end(); ++itObs2, ++j2)
     {
-      const View * view1 = sfm_data.views.at(itObs1->first).get();
-      const geometry::Pose3 pose1 = sfm_data.getPose(*view1);
-      const camera::IntrinsicBase * intrinsic1 = sfm_data.intrinsics.at(view1->getIntrinsicId()).get();
+      if(isObservationOutlier[j2])
+        continue;
+      const View * view2 = sfm_data.views.at(itObs2->first).get();
+      const geometry::Pose3 pose2 = sfm_data.getPose(*view2);
+      const camera::IntrinsicBase * intrinsic2 = sfm_data.intrinsics.at(view2->getIntrinsicId()).get();
 
-      Observations::const_iterator itObs2 = itObs1;
-      ++itObs2;
-      for (; itObs2 != observations.end(); ++itObs2)
-      {
-        const View * view2 = sfm_data.views.at(itObs2->first).get();
-        const geometry::Pose3 pose2 = sfm_data.getPose(*view2);
-        const camera::IntrinsicBase * intrinsic2 = sfm_data.intrinsics.at(view2->getIntrinsicId()).get();
-
-        const double angle = AngleBetweenRay(
-          pose1, intrinsic1, pose2, intrinsic2,
-          itObs1->second.x, itObs2->second.x);
-        max_angle = std::max(angle, max_angle);
-      }
+      const double angle = AngleBetweenRay(
+        pose1, intrinsic1, pose2, intrinsic2,
+        itObs1->second.x, itObs2->second.x);
+      max_angle = std::max(angle, max_angle);
     }
+  }
+  return max_angle;
+}
+
+} // namespace
+
+IndexT RemoveOutliers_PixelResidualError
+(
+  SfMData & sfm_data,
+  const double dThresholdPixel,
+  const unsigned int minTrackLength
+)
+{
+  IndexT nbResidualOutliers = 0;
+  IndexT nbAngleOutliers = 0;
+  RemoveOutliers_PixelResidualAndAngleError(sfm_data, dThresholdPixel, 0.0, minTrackLength, nbResidualOutliers, nbAngleOutliers);
+  return nbResidualOutliers;
+}
+
+IndexT RemoveOutliers_AngleError(SfMData& sfm_data, const double dMinAcceptedAngle)
+{
+  LandmarksOutliers outliers(sfm_data.structure);
+  IndexT removedTrack_count = 0;
+
+  #pragma omp parallel for schedule(dynamic, 256) reduction(+:removedTrack_count)
+  for(int i = 0; i < outliers.landmarks.size(); ++i)
+  {
+    const Observations& observations = outliers.landmarks[i]->second.observations;
+    const double max_angle = computeMaxAngle(sfm_data, observations, &outliers.isObservationOutlier[outliers.firstObservation[i]]);
     if (max_angle < dMinAcceptedAngle)
     {
-      iterTracks = sfm_data.structure.erase(iterTracks);
+      outliers.isLandmarkOutlier[i] = 1;
       ++removedTrack_count;
     }
-    else
-      ++iterTracks;
   }
+  outliers.erase(sfm_data.structure);
   return removedTrack_count;
 }
 
+void RemoveOutliers_PixelResidualAndAngleError(SfMData& sfm_data,
+                                               const double dThresholdPixel,
+                                               const double dMinAcceptedAngle,
+                                               const unsigned int minTrackLength,
+                                               IndexT& nbResidualOutliers,
+                                               IndexT& nbAngleOutliers,
+                                               std::vector<float>* residuals)
+{
+  LandmarksOutliers outliers(sfm_data.structure);
+  IndexT residualOutlier_count = 0;
+  IndexT angleOutlier_count = 0;
+  std::vector<float> allResiduals(residuals != nullptr ? 2 * outliers.isObservationOutlier.size() : 0);
+
+  #pragma omp parallel for schedule(dynamic, 256) reduction(+:residualOutlier_count, angleOutlier_count)
+  for(int i = 0; i < outliers.landmarks.size(); ++i)
+  {
+    const Landmark& landmark = outliers.landmarks[i]->second;
+    char* isObservationOutlier = &outliers.isObservationOutlier[outliers.firstObservation[i]];
+    char& isLandmarkOutlier = outliers.isLandmarkOutlier[i];
+
+    float* landmarkResiduals = allResiduals.empty() ? nullptr : &allResiduals[2 * outliers.firstObservation[i]];
+
+    residualOutlier_count += flagResidualOutliers(sfm_data, landmark, dThresholdPixel, minTrackLength, isObservationOutlier, isLandmarkOutlier, landmarkResiduals);
+
+    if(!isLandmarkOutlier && dMinAcceptedAngle > 0.0 &&
+       computeMaxAngle(sfm_data, landmark.observations, isObservationOutlier) < dMinAcceptedAngle)
+    {
+      isLandmarkOutlier = 1;
+      ++angleOutlier_count;
+    }
+  }
+
+  if(residuals != nullptr)
+  {
+    // Residuals of the kept observations, in the landmarks order
+    residuals->clear();
+    residuals->reserve(allResiduals.size());
+    for(std::size_t i = 0; i < outliers.landmarks.size(); ++i)
+    {
+      if(outliers.isLandmarkOutlier[i])
+        continue;
+      for(std::size_t j = outliers.firstObservation[i]; j < outliers.firstObservation[i + 1]; ++j)
+      {
+        if(outliers.isObservationOutlier[j])
+          continue;
+        residuals->push_back(allResiduals[2 * j]);
+        residuals->push_back(allResiduals[2 * j + 1]);
+      }
+    }
+  }
+
+  outliers.erase(sfm_data.structure);
+  nbResidualOutliers = residualOutlier_count;
+  nbAngleOutliers = angleOutlier_count;
+}
+
 bool eraseUnstablePoses(SfMData& sfm_data, const IndexT min_points_per_pose)
 {
   IndexT removed_elements = 0;
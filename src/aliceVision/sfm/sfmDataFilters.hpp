@@ -8,6 +8,8 @@
 #include <aliceVision/types.hpp>
 #include <aliceVision/sfm/SfMData.hpp>
 
+#include <vector>
+
 namespace aliceVision {
 namespace sfm {
 
@@ -34,6 +36,26 @@ IndexT RemoveOutliers_PixelResidualError(SfMData& sfm_data,
 // Return the number of removed tracks
 IndexT RemoveOutliers_AngleError(SfMData& sfm_data, const double dMinAcceptedAngle);
 
+/**
+ * @brief Remove observations with too large reprojection error, then the tracks that have
+ *        a small angle, as RemoveOutliers_PixelResidualError followed by RemoveOutliers_AngleError.
+ *        The landmarks are evaluated in parallel and the outliers are removed in a single pass.
+ * @param[in,out] sfm_data the SfM scene
+ * @param[in] dThresholdPixel the maximum reprojection error in pixels
+ * @param[in] dMinAcceptedAngle the minimum angle of a track in degrees
+ * @param[in] minTrackLength the minimum number of observations of a track
+ * @param[out] nbResidualOutliers the number of removed observations
+ * @param[out] nbAngleOutliers the number of tracks removed for their angle
+ * @param[out] residuals if not null, the absolute residual coordinates of the kept observations
+ */
+void RemoveOutliers_PixelResidualAndAngleError(SfMData& sfm_data,
+                                               const double dThresholdPixel,
+                                               const double dMinAcceptedAngle,
+                                               const unsigned int minTrackLength,
+                                               IndexT& nbResidualOutliers,
+                                               IndexT& nbAngleOutliers,
+                                               std::vector<float>* residuals = nullptr);
+
 bool eraseUnstablePoses(SfMData& sfm_data, const IndexT min_points_per_pose);
 
 bool eraseObservationsWithMissingPoses(SfMData& sfm_data, const IndexT min_points_per_landmark);
@@ -0,0 +1,193 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/sfm/sfm.hpp>
+
+#include <random>
+
+#define BOOST_TEST_MODULE sfmDataFilters
+#include <boost/test/included/unit_test.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::camera;
+using namespace aliceVision::geometry;
+using namespace aliceVision::sfm;
+
+namespace {
+
+/// Scene seen by a row of cameras with noisy observations, residual outliers and tracks with a tiny angle
+SfMData createScene()
+{
+  SfMData sfmData;
+  const int nbViews = 5;
+  const int nbLandmarks = 400;
+
+  sfmData.intrinsics[0] = std::make_shared<Pinhole>(1000, 1000, 1000.0, 500.0, 500.0);
+  for(int i = 0; i < nbViews; ++i)
+  {
+    sfmData.views[i] = std::make_shared<View>("", i, 0, i);
+    sfmData.setPose(*sfmData.views[i], Pose3(Mat3::Identity(), Vec3(i - 2.0, 0.0, 0.0)));
+  }
+
+  std::mt19937 generator(42);
+  std::uniform_real_distribution<double> position(-1.0, 1.0);
+  std::uniform_real_distribution<double> probability(0.0, 1.0);
+  std::normal_distribution<double> noise(0.0, 0.5);
+
+  for(int l = 0; l < nbLandmarks; ++l)
+  {
+    Landmark& landmark = sfmData.structure[l];
+    const bool isFar = (l % 10 == 0);
+    landmark.X = Vec3(position(generator), position(generator), 7.5 + 2.5 * position(generator));
+    if(isFar)
+      landmark.X *= 100.0;
+
+    for(int i = 0; i < nbViews; ++i)
+    {
+      if(probability(generator) < 0.3)
+        continue;
+      const View& view = *sfmData.views.at(i);
+      Vec2 x = sfmData.intrinsics.at(0)->project(sfmData.getPose(view), landmark.X);
+      x += Vec2(noise(generator), noise(generator));
+      if(probability(generator) < 0.15)
+        x(0) += 20.0;
+      landmark.observations[i] = Observation(x, l);
+    }
+  }
+  return sfmData;
+}
+
+/// Serial reference of RemoveOutliers_PixelResidualError
+IndexT removeResidualOutliersReference(SfMData& sfmData, double dThresholdPixel, unsigned int minTrackLength)
+{
+  IndexT outlier_count = 0;
+  Landmarks::iterator iterTracks = sfmData.structure.begin();
+  while(iterTracks != sfmData.structure.end())
+  {
+    Observations& observations = iterTracks->second.observations;
+    Observations::iterator itObs = observations.begin();
+    while(itObs != observations.end())
+    {
+      const View* view = sfmData.views.at(itObs->first).get();
+      const Pose3 pose = sfmData.getPose(*view);
+      const IntrinsicBase* intrinsic = sfmData.intrinsics.at(view->getIntrinsicId()).get();
+      const Vec2 residual = intrinsic->residual(pose, iterTracks->second.X, itObs->second.x);
+      if(pose.depth(iterTracks->second.X) < 0 || residual.norm() > dThresholdPixel)
+      {
+        ++outlier_count;
+        itObs = observations.erase(itObs);
+      }
+      else
+        ++itObs;
+    }
+    if(observations.empty() || observations.size() < minTrackLength)
+      iterTracks = sfmData.structure.erase(iterTracks);
+    else
+      ++iterTracks;
+  }
+  return outlier_count;
+}
+
+/// Serial reference of RemoveOutliers_AngleError
+IndexT removeAngleOutliersReference(SfMData& sfmData, double dMinAcceptedAngle)
+{
+  IndexT removedTrack_count = 0;
+  Landmarks::iterator iterTracks = sfmData.structure.begin();
+  while(iterTracks != sfmData.structure.end())
+  {
+    const Observations& observations = iterTracks->second.observations;
+    double max_angle = 0.0;
+    for(auto itObs1 = observations.begin(); itObs1 != observations.end(); ++itObs1)
+    {
+      const View* view1 = sfmData.views.at(itObs1->first).get();
+      for(auto itObs2 = std::next(itObs1); itObs2 != observations.end(); ++itObs2)
+      {
+        const View* view2 = sfmData.views.at(itObs2->first).get();
+        max_angle = std::max(max_angle, AngleBetweenRay(
+          sfmData.getPose(*view1), sfmData.intrinsics.at(view1->getIntrinsicId()).get(),
+          sfmData.getPose(*view2), sfmData.intrinsics.at(view2->getIntrinsicId()).get(),
+          itObs1->second.x, itObs2->second.x));
+      }
+    }
+    if(max_angle < dMinAcceptedAngle)
+    {
+      iterTracks = sfmData.structure.erase(iterTracks);
+      ++removedTrack_count;
+    }
+    else
+      ++iterTracks;
+  }
+  return removedTrack_count;
+}
+
+void checkSameStructure(const SfMData& sfmData, const SfMData& sfmDataReference)
+{
+  BOOST_REQUIRE_EQUAL(sfmData.GetLandmarks().size(), sfmDataReference.GetLandmarks().size());
+  for(const auto& landmarkIt : sfmDataReference.GetLandmarks())
+  {
+    BOOST_REQUIRE(sfmData.GetLandmarks().count(landmarkIt.first));
+    const Observations& observations = sfmData.GetLandmarks().at(landmarkIt.first).observations;
+    BOOST_REQUIRE_EQUAL(observations.size(), landmarkIt.second.observations.size());
+    for(const auto& obsIt : landmarkIt.second.observations)
+      BOOST_CHECK(observations.count(obsIt.first));
+  }
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(SfMDataFilters_RemoveOutliers_PixelResidualError)
+{
+  SfMData sfmData = createScene();
+  SfMData sfmDataReference = sfmData;
+
+  const IndexT nbOutliers = RemoveOutliers_PixelResidualError(sfmData, 4.0, 2);
+  const IndexT nbOutliersReference = removeResidualOutliersReference(sfmDataReference, 4.0, 2);
+
+  BOOST_CHECK_GT(nbOutliersReference, 0);
+  BOOST_CHECK_EQUAL(nbOutliers, nbOutliersReference);
+  checkSameStructure(sfmData, sfmDataReference);
+}
+
+BOOST_AUTO_TEST_CASE(SfMDataFilters_RemoveOutliers_AngleError)
+{
+  SfMData sfmData = createScene();
+  SfMData sfmDataReference = sfmData;
+
+  const IndexT nbOutliers = RemoveOutliers_AngleError(sfmData, 2.0);
+  const IndexT nbOutliersReference = removeAngleOutliersReference(sfmDataReference, 2.0);
+
+  BOOST_CHECK_GT(nbOutliersReference, 0);
+  BOOST_CHECK_EQUAL(nbOutliers, nbOutliersReference);
+  checkSameStructure(sfmData, sfmDataReference);
+}
+
+BOOST_AUTO_TEST_CASE(SfMDataFilters_RemoveOutliers_PixelResidualAndAngleError)
+{
+  SfMData sfmData = createScene();
+  SfMData sfmDataReference = sfmData;
+
+  IndexT nbResidualOutliers = 0;
+  IndexT nbAngleOutliers = 0;
+  std::vector<float> residuals;
+  RemoveOutliers_PixelResidualAndAngleError(sfmData, 4.0, 2.0, 2, nbResidualOutliers, nbAngleOutliers, &residuals);
+
+  const IndexT nbResidualOutliersReference = removeResidualOutliersReference(sfmDataReference, 4.0, 2);
+  const IndexT nbAngleOutliersReference = removeAngleOutliersReference(sfmDataReference, 2.0);
+
+  BOOST_CHECK_EQUAL(nbResidualOutliers, nbResidualOutliersReference);
+  BOOST_CHECK_EQUAL(nbAngleOutliers, nbAngleOutliersReference);
+  checkSameStructure(sfmData, sfmDataReference);
+
+  // the residuals of the kept observations
+  std::size_t nbObservations = 0;
+  for(const auto& landmarkIt : sfmData.GetLandmarks())
+    nbObservations += landmarkIt.second.observations.size();
+  BOOST_CHECK_EQUAL(residuals.size(), 2 * nbObservations);
+  for(const float residual : residuals)
+  {
+    BOOST_CHECK_GE(residual, 0.f);
+    BOOST_CHECK_LE(residual, 4.f);
+  }
+}
@@ -0,0 +1,96 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "MappedFile.hpp"
+#include "system.hpp"
+
+#include <fstream>
+#include <stdexcept>
+
+#if defined(__UNIX__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace aliceVision {
+namespace system {
+
+MappedFile::MappedFile(const std::string& filepath)
+{
+  open(filepath);
+}
+
+MappedFile::~MappedFile()
+{
+  close();
+}
+
+void MappedFile::open(const std::string& filepath)
+{
+  close();
+
+#if defined(__UNIX__)
+  const int fd = ::open(filepath.c_str(), O_RDONLY);
+  if(fd < 0)
+    throw std::runtime_error("Failed to open file " + filepath);
+
+  struct stat fileStat;
+  if(::fstat(fd, &fileStat) != 0)
+  {
+    ::close(fd);
+    throw std::runtime_error("Failed to get the size of file " + filepath);
+  }
+  _size = static_cast<std::size_t>(fileStat.st_size);
+
+  if(_size > 0)
+  {
+    void* mapping = ::mmap(nullptr, _size, PROT_READ, MAP_SHARED, fd, 0);
+    if(mapping != MAP_FAILED)
+    {
+      _data = static_cast<const char*>(mapping);
+      _isMapped = true;
+    }
+  }
+  ::close(fd);
+  if(_isMapped)
+    return;
+#endif
+
+  // fallback: read the whole file
+  std::ifstream in(filepath.c_str(), std::ios_base::binary | std::ios_base::ate);
+  if(!in.is_open())
+    throw std::runtime_error("Failed to open file " + filepath);
+  _size = static_cast<std::size_t>(in.tellg());
+  in.seekg(0);
+
+  // over-allocate to align the data on 64 bytes
+  const std::size_t alignment = 64;
+  _buffer.resize(_size + alignment);
+  const std::size_t offset = (alignment - reinterpret_cast<std::size_t>(_buffer.data()) % alignment) % alignment;
+  char* data = _buffer.data() + offset;
+  if(!in.read(data, _size))
+  {
+    close();
+    throw std::runtime_error("Failed to read file " + filepath);
+  }
+  _data = data;
+}
+
+void MappedFile::close()
+{
+#if defined(__UNIX__)
+  if(_isMapped)
+    ::munmap(const_cast<char*>(_data), _size);
+#endif
+  _data = nullptr;
+  _size = 0;
+  _isMapped = false;
+  std::vector<char>().swap(_buffer);
+}
+
+} // namespace system
+} // namespace aliceVision
@@ -0,0 +1,82 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace aliceVision {
+namespace system {
+
+/**
+ * @brief Read-only view of the content of a file.
+ *
+ * The file is memory-mapped when the system supports it, so that opening it
+ * is immediate and its pages are loaded on demand and shared between processes.
+ * Otherwise the whole file is read into memory.
+ * The data is at least aligned on the page size (resp. 64 bytes).
+ */
+class MappedFile
+{
+public:
+  MappedFile() = default;
+
+  /**
+   * @brief Open and map the given file.
+   * @param[in] filepath The path of the file.
+   * @throw std::runtime_error if the file cannot be opened.
+   */
+  explicit MappedFile(const std::string& filepath);
+
+  ~MappedFile();
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  /**
+   * @brief Open and map the given file, the previous file is closed.
+   * @param[in] filepath The path of the file.
+   * @throw std::runtime_error if the file cannot be opened.
+   */
+  void open(const std::string& filepath);
+
+  /// Unmap the file.
+  void close();
+
+  /// Get the beginning of the file content, nullptr if no file is opened.
+  const char* data() const
+  {
+    return _data;
+  }
+
+  /// Get the size of the file in bytes.
+  std::size_t size() const
+  {
+    return _size;
+  }
+
+  bool isOpen() const
+  {
+    return _data != nullptr;
+  }
+
+  /// Whether the file is memory-mapped or read into memory.
+  bool isMapped() const
+  {
+    return _isMapped;
+  }
+
+private:
+  const char* _data = nullptr;
+  std::size_t _size = 0;
+  bool _isMapped = false;
+  /// storage used when the file cannot be mapped
+  std::vector<char> _buffer;
+};
+
+} // namespace system
+} // namespace aliceVision
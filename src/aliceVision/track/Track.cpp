@@ -14,32 +14,49 @@ using namespace lemon;
 /// Build tracks for a given series of pairWise matches
 bool TracksBuilder::Build( const PairwiseMatches &  pairwiseMatches)
 {
-  typedef std::set<IndexedFeaturePair> SetIndexedPair;
-  // Set of all features of all images: (imageIndex, featureIndex)
-  SetIndexedPair allFeatures;
-  // For each couple of images
+  return buildFromMatches(pairwiseMatches);
+}
 
-  // Make the union according the pair matches
+bool TracksBuilder::Build(const PackedPairwiseMatches& pairwiseMatches)
+{
+  return buildFromMatches(pairwiseMatches);
+}
+
+template <typename PairwiseMatchesT>
+bool TracksBuilder::buildFromMatches(const PairwiseMatchesT& pairwiseMatches)
+{
+  // All features of all images: (imageIndex, featureIndex)
+  // collected in a vector and deduplicated by sorting, in the order of a std::set
+  std::vector<IndexedFeaturePair> allFeatures;
+  std::size_t nbMatches = 0;
+  for(const auto& matchesPerDescIt: pairwiseMatches)
+    nbMatches += matchesPerDescIt.second.getNbAllMatches();
+  allFeatures.reserve(2 * nbMatches);
+
+  // For each couple of images
   for(const auto& matchesPerDescIt: pairwiseMatches)
   {
-    const size_t & I = matchesPerDescIt.first.first;
-    const size_t & J = matchesPerDescIt.first.second;
-    const MatchesPerDescType& matchesPerDesc = matchesPerDescIt.second;
+    const size_t I = matchesPerDescIt.first.first;
+    const size_t J = matchesPerDescIt.first.second;
+    const auto& matchesPerDesc = matchesPerDescIt.second;
 
     for(const auto& matchesIt: matchesPerDesc)
     {
       const feature::EImageDescriberType descType = matchesIt.first;
-      const IndMatches& matches = matchesIt.second;
+      const auto& matches = matchesIt.second;
       // We have correspondences between I and J image index.
       for(const IndMatch& m: matches)
       {
-        IndexedFeaturePair pairI(I, KeypointId(descType, m._i));
-        IndexedFeaturePair pairJ(J, KeypointId(descType, m._j));
-        allFeatures.insert(pairI);
-        allFeatures.insert(pairJ);
+        allFeatures.emplace_back(I, KeypointId(descType, m._i));
+        allFeatures.emplace_back(J, KeypointId(descType, m._j));
       }
     }
   }
+  std::sort(allFeatures.begin(), allFeatures.end());
+  // sorted features are equal if they are not ordered
+  allFeatures.erase(std::unique(allFeatures.begin(), allFeatures.end(),
+                                [](const IndexedFeaturePair& a, const IndexedFeaturePair& b) { return !(a < b); }),
+                    allFeatures.end());
 
   // Build the node indirection for each referenced feature
   MapIndexToNode map_indexToNode;
@@ -64,14 +81,14 @@ bool TracksBuilder::Build( const PairwiseMatches &  pairwiseMatches)
   // Make the union according the pair matches
   for(const auto& matchesPerDescIt: pairwiseMatches)
   {
-    const size_t & I = matchesPerDescIt.first.first;
-    const size_t & J = matchesPerDescIt.first.second;
-    const MatchesPerDescType& matchesPerDesc = matchesPerDescIt.second;
+    const size_t I = matchesPerDescIt.first.first;
+    const size_t J = matchesPerDescIt.first.second;
+    const auto& matchesPerDesc = matchesPerDescIt.second;
 
     for(const auto& matchesIt: matchesPerDesc)
     {
       const feature::EImageDescriberType descType = matchesIt.first;
-      const IndMatches& matches = matchesIt.second;
+      const auto& matches = matchesIt.second;
       // We have correspondences between I and J image index.
       for(const IndMatch& m: matches)
       {
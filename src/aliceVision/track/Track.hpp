@@ -8,6 +8,7 @@
 #include <aliceVision/config.hpp>
 #include <aliceVision/feature/imageDescriberCommon.hpp>
 #include <aliceVision/matching/IndMatch.hpp>
+#include <aliceVision/matching/PackedPairwiseMatches.hpp>
 #include <aliceVision/stl/FlatMap.hpp>
 #include <aliceVision/stl/FlatSet.hpp>
 #include <aliceVision/config.hpp>
@@ -151,6 +152,9 @@ struct TracksBuilder
   /// Build tracks for a given series of pairWise matches
   bool Build(const PairwiseMatches&  pairwiseMatches);
 
+  /// Build tracks for packed pairwise matches
+  bool Build(const PackedPairwiseMatches& pairwiseMatches);
+
   /// Remove bad tracks (too short or track with ids collision)
   bool Filter(size_t nLengthSupTo = 2, bool bMultithread = true);
 
@@ -170,6 +174,11 @@ struct TracksBuilder
    *        {TrackIndex => {(imageIndex, keypointId), ... ,(imageIndex, keypointId)}
    */
   void ExportToSTL(TracksMap & allTracks) const;
+
+private:
+  /// Build tracks for a container iterated like PairwiseMatches
+  template <typename PairwiseMatchesT>
+  bool buildFromMatches(const PairwiseMatchesT& pairwiseMatches);
 };
 
 struct TracksUtilsMap
@@ -5,6 +5,7 @@
 
 #include "aliceVision/track/Track.hpp"
 #include "aliceVision/matching/IndMatch.hpp"
+#include "aliceVision/matching/PackedPairwiseMatches.hpp"
 
 #include <vector>
 #include <utility>
@@ -176,6 +177,40 @@ BOOST_AUTO_TEST_CASE(Track_Conflict) {
   }
 }
 
+BOOST_AUTO_TEST_CASE(Track_PackedPairwiseMatches) {
+
+  //A    B    C
+  //0 -> 0 -> 0
+  //1 -> 1 -> 6
+  //2 -> 3
+  // and SIFT matches 5 -> 7 between A and C
+
+  PairwiseMatches map_pairwisematches;
+  map_pairwisematches[ std::make_pair(0,1) ][EImageDescriberType::UNKNOWN] = {IndMatch(0,0), IndMatch(1,1), IndMatch(2,3)};
+  map_pairwisematches[ std::make_pair(1,2) ][EImageDescriberType::UNKNOWN] = {IndMatch(0,0), IndMatch(1,6)};
+  map_pairwisematches[ std::make_pair(0,2) ][EImageDescriberType::SIFT] = {IndMatch(5,7)};
+
+  TracksBuilder trackBuilder;
+  trackBuilder.Build( map_pairwisematches );
+  TracksMap map_tracks;
+  trackBuilder.ExportToSTL(map_tracks);
+
+  // the packed matches give the same tracks
+  TracksBuilder packedTrackBuilder;
+  packedTrackBuilder.Build( PackedPairwiseMatches(map_pairwisematches) );
+  TracksMap packed_tracks;
+  packedTrackBuilder.ExportToSTL(packed_tracks);
+
+  BOOST_CHECK_EQUAL(4, map_tracks.size());
+  BOOST_CHECK_EQUAL(map_tracks.size(), packed_tracks.size());
+  for (const auto& trackIt: map_tracks)
+  {
+    const Track& packedTrack = packed_tracks.at(trackIt.first);
+    BOOST_CHECK(trackIt.second.descType == packedTrack.descType);
+    BOOST_CHECK(trackIt.second.featPerView == packedTrack.featPerView);
+  }
+}
+
 BOOST_AUTO_TEST_CASE(Track_GetCommonTracksInImages)
 {
   {
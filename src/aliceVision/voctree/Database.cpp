@@ -46,6 +46,8 @@ DocId Database::insert(DocId doc_id, const SparseHistogram& document)
   }
 
   database_[doc_id] = document;
+  // the inverted index is not up to date anymore
+  inverted_index_.clear();
 
   return doc_id;
 }
@@ -109,6 +111,13 @@ void Database::find(const std::vector<Word>& document, size_t N, std::vector<Doc
  */
 void Database::find( const SparseHistogram& query, size_t N, std::vector<DocMatch>& matches, const std::string &distanceMethod) const
 {
+  if(!inverted_index_.empty() && InvertedIndex::isSupported(distanceMethod))
+  {
+    // only score the documents sharing words with the query
+    inverted_index_.find(query, N, matches, distanceMethod);
+    return;
+  }
+
   // Accumulate the best N matches
   using bestN_tag = boost::accumulators::tag::tail<boost::accumulators::left>;
   boost::accumulators::accumulator_set<DocMatch, boost::accumulators::features<bestN_tag> > acc(bestN_tag::cache_size = N);
@@ -128,6 +137,27 @@ void Database::find( const SparseHistogram& query, size_t N, std::vector<DocMatc
   std::copy(bestN(acc).begin(), bestN(acc).end(), matches.begin());
 }
 
+void Database::buildInvertedIndex()
+{
+  inverted_index_.build(database_, word_files_.size());
+}
+
+void Database::saveInvertedIndex(const std::string& file) const
+{
+  inverted_index_.save(file);
+}
+
+void Database::loadInvertedIndex(const std::string& file)
+{
+  inverted_index_.load(file);
+  if(inverted_index_.nbWords() != word_files_.size())
+  {
+    const std::size_t nbWords = inverted_index_.nbWords();
+    inverted_index_.clear();
+    throw std::runtime_error((boost::format("The inverted index '%s' has %d words instead of %d") % file % nbWords % word_files_.size()).str());
+  }
+}
+
 /**
  * @brief Compute the TF-IDF weights of all the words. To be called after inserting a corpus of
  * training examples into the database.
@@ -197,7 +227,8 @@ void Database::loadWeights(const std::string& file)
  */
 size_t Database::size() const
 {
-  return database_.size();
+  // the documents may only be in a loaded inverted index
+  return database_.empty() ? inverted_index_.nbDocuments() : database_.size();
 }
 
 } //namespace voctree
@@ -6,6 +6,8 @@
 #pragma once
 
 #include "VocabularyTree.hpp"
+#include "DocMatch.hpp"
+#include "InvertedIndex.hpp"
 
 #include <cereal/cereal.hpp> // Serialization
 #include <cereal/archives/binary.hpp>
@@ -21,48 +23,6 @@
 namespace aliceVision{
 namespace voctree{
 
-/**
- * @brief Struct representing a single database match.
- *
- * \c score is in the range [0,2], where 0 is best and 2 is worst.
- */
-struct DocMatch
-{
-  DocId id;
-  float score;
-
-  DocMatch() { }
-
-  DocMatch(DocId _id, float _score) : id(_id), score(_score) { }
-
-  /// Allows sorting DocMatches in best-to-worst order with std::sort.
-
-  bool operator<(const DocMatch& other) const
-  {
-    return score < other.score;
-  }
-
-  bool operator==(const DocMatch& other) const
-  {
-    return id == other.id &&
-           score == other.score;
-  }
-  bool operator!=(const DocMatch& other) const
-  {
-    return !(*this == other);
-  }
-
-  // Serialization
-  template <class Archive>
-  void serialize(Archive & ar)
-  {
-    ar(cereal::make_nvp("id", id),
-       cereal::make_nvp("score", score));
-  }
-};
-
-typedef std::vector<DocMatch> DocMatches;
-
 /**
  * @brief Class for efficiently matching a bag-of-words representation of a document (image) against
  * a database of known documents.
@@ -96,6 +56,29 @@ public:
    */
    void sanityCheck(std::size_t N, std::map<std::size_t, DocMatches>& matches) const;
 
+  /**
+   * @brief Build the compressed inverted index of the inserted documents.
+   *
+   * Once built, find() scores only the documents sharing words with the query
+   * for the distance methods supported by InvertedIndex. The index is cleared
+   * by insert(), so it has to be built after inserting all the documents.
+   */
+  void buildInvertedIndex();
+
+  /// Save the compressed inverted index to a file.
+  void saveInvertedIndex(const std::string& file) const;
+
+  /**
+   * @brief Load the compressed inverted index from a file. The database can
+   * then be queried without inserting the documents.
+   */
+  void loadInvertedIndex(const std::string& file);
+
+  const InvertedIndex& getInvertedIndex() const
+  {
+    return inverted_index_;
+  }
+
   /**
    * @brief Find the top N matches in the database for the query document.
    *
@@ -186,6 +169,7 @@ private:
   std::vector<InvertedFile> word_files_;
   std::vector<float> word_weights_;
   SparseHistogramPerImage database_; // Precomputed for inserted documents
+  InvertedIndex inverted_index_; // Built from database_ by buildInvertedIndex()
 
   /**
    * Normalize a document vector representing the histogram of visual words for a given image
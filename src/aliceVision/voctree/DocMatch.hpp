@@ -0,0 +1,60 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include "VocabularyTree.hpp"
+
+#include <cereal/cereal.hpp> // Serialization
+
+#include <vector>
+
+namespace aliceVision{
+namespace voctree{
+
+/**
+ * @brief Struct representing a single database match.
+ *
+ * \c score is in the range [0,2], where 0 is best and 2 is worst.
+ */
+struct DocMatch
+{
+  DocId id;
+  float score;
+
+  DocMatch() { }
+
+  DocMatch(DocId _id, float _score) : id(_id), score(_score) { }
+
+  /// Allows sorting DocMatches in best-to-worst order with std::sort.
+
+  bool operator<(const DocMatch& other) const
+  {
+    return score < other.score;
+  }
+
+  bool operator==(const DocMatch& other) const
+  {
+    return id == other.id &&
+           score == other.score;
+  }
+  bool operator!=(const DocMatch& other) const
+  {
+    return !(*this == other);
+  }
+
+  // Serialization
+  template <class Archive>
+  void serialize(Archive & ar)
+  {
+    ar(cereal::make_nvp("id", id),
+       cereal::make_nvp("score", score));
+  }
+};
+
+typedef std::vector<DocMatch> DocMatches;
+
+}//namespace voctree
+}//namespace aliceVision
@@ -0,0 +1,346 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "InvertedIndex.hpp"
+
+#include <boost/format.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+
+namespace aliceVision{
+namespace voctree{
+
+namespace {
+
+/// Magic number at the beginning of an inverted index file
+const char INVERTED_INDEX_MAGIC[8] = {'A', 'V', 'I', 'N', 'V', 'I', 'D', 'X'};
+/// Current version of the inverted index file
+const uint32_t INVERTED_INDEX_VERSION = 1;
+
+enum class EScoring
+{
+  COMMON_POINTS,
+  STRONG_COMMON_POINTS
+};
+
+EScoring stringToScoring(const std::string& distanceMethod)
+{
+  if(distanceMethod == "commonPoints")
+    return EScoring::COMMON_POINTS;
+  if(distanceMethod == "strongCommonPoints")
+    return EScoring::STRONG_COMMON_POINTS;
+  throw std::invalid_argument("Distance method not supported by the inverted index: " + distanceMethod);
+}
+
+/// Append an unsigned integer encoded with 7 bits per byte, the high bit tells whether more bytes follow
+inline void writeVarint(std::vector<uint8_t>& buffer, uint32_t value)
+{
+  while(value >= 0x80)
+  {
+    buffer.push_back(static_cast<uint8_t>(value | 0x80));
+    value >>= 7;
+  }
+  buffer.push_back(static_cast<uint8_t>(value));
+}
+
+inline uint32_t readVarint(const uint8_t*& data)
+{
+  uint32_t value = 0;
+  int shift = 0;
+  while(*data & 0x80)
+  {
+    value |= static_cast<uint32_t>(*data++ & 0x7F) << shift;
+    shift += 7;
+  }
+  value |= static_cast<uint32_t>(*data++) << shift;
+  return value;
+}
+
+/// Read an unsigned integer written by writeVarint() without reading past end
+inline bool readVarint(const uint8_t*& data, const uint8_t* end, uint32_t& value)
+{
+  value = 0;
+  for(int shift = 0; data != end && shift < 32; shift += 7)
+  {
+    const uint8_t byte = *data++;
+    value |= static_cast<uint32_t>(byte & 0x7F) << shift;
+    if(!(byte & 0x80))
+      return true;
+  }
+  return false;
+}
+
+/**
+ * @brief Check that the posting list of each word is decoded up to its end offset
+ * and only refers to the indexed documents.
+ */
+bool isValidPostings(const std::vector<uint64_t>& wordOffsets, const std::vector<uint8_t>& postings, std::size_t nbDocs)
+{
+  if(wordOffsets.front() != 0 || wordOffsets.back() != postings.size())
+    return false;
+
+  for(std::size_t w = 0; w + 1 < wordOffsets.size(); ++w)
+  {
+    if(wordOffsets[w] > wordOffsets[w + 1])
+      return false;
+
+    const uint8_t* it = postings.data() + wordOffsets[w];
+    const uint8_t* end = postings.data() + wordOffsets[w + 1];
+    uint64_t docIndex = 0;
+    while(it != end)
+    {
+      uint32_t docDelta = 0;
+      uint32_t docCount = 0;
+      if(!readVarint(it, end, docDelta) || !readVarint(it, end, docCount))
+        return false;
+      docIndex += docDelta;
+      if(docIndex >= nbDocs)
+        return false;
+    }
+  }
+  return true;
+}
+
+template<typename T>
+void writeVector(std::ostream& out, const std::vector<T>& v)
+{
+  if(!v.empty())
+    out.write(reinterpret_cast<const char*>(v.data()), v.size() * sizeof(T));
+}
+
+template<typename T>
+void readVector(std::istream& in, std::vector<T>& v, std::size_t size)
+{
+  v.resize(size);
+  if(!v.empty())
+    in.read(reinterpret_cast<char*>(v.data()), v.size() * sizeof(T));
+}
+
+} // namespace
+
+void InvertedIndex::build(const SparseHistogramPerImage& documents, uint32_t nbWords)
+{
+  clear();
+
+  _docIds.reserve(documents.size());
+
+  std::vector< std::vector<uint8_t> > wordPostings(nbWords);
+  std::vector<uint32_t> lastDocIndex(nbWords, 0);
+
+  for(const auto& document : documents)
+  {
+    const uint32_t docIndex = static_cast<uint32_t>(_docIds.size());
+    // the words of a sparse histogram are sorted and unique
+    for(const auto& word : document.second)
+    {
+      if(word.first < 0 || static_cast<uint32_t>(word.first) >= nbWords)
+        throw std::out_of_range((boost::format("Invalid word %d in document %d, the vocabulary has %d words") % word.first % document.first % nbWords).str());
+
+      const uint32_t count = static_cast<uint32_t>(word.second.size());
+      writeVarint(wordPostings[word.first], docIndex - lastDocIndex[word.first]);
+      writeVarint(wordPostings[word.first], count);
+      lastDocIndex[word.first] = docIndex;
+    }
+    _docIds.push_back(document.first);
+  }
+
+  // concatenate the postings of all the words
+  _wordOffsets.resize(nbWords + 1);
+  _wordOffsets[0] = 0;
+  for(uint32_t w = 0; w < nbWords; ++w)
+    _wordOffsets[w + 1] = _wordOffsets[w] + wordPostings[w].size();
+
+  _postings.reserve(_wordOffsets.back());
+  for(std::vector<uint8_t>& postings : wordPostings)
+  {
+    _postings.insert(_postings.end(), postings.begin(), postings.end());
+    std::vector<uint8_t>().swap(postings);
+  }
+}
+
+bool InvertedIndex::isSupported(const std::string& distanceMethod)
+{
+  return distanceMethod == "commonPoints" ||
+         distanceMethod == "strongCommonPoints";
+}
+
+void InvertedIndex::find(const SparseHistogram& query, std::size_t N, std::vector<DocMatch>& matches, const std::string& distanceMethod) const
+{
+  const EScoring scoring = stringToScoring(distanceMethod);
+  const std::size_t nbDocs = _docIds.size();
+
+  // per thread buffers, only the entries of the touched documents are reset after each query
+  thread_local std::vector<uint32_t> commonScores;
+  thread_local std::vector<uint8_t> isTouched;
+  thread_local std::vector<uint32_t> touchedDocs;
+  if(commonScores.size() < nbDocs)
+  {
+    commonScores.assign(nbDocs, 0);
+    isTouched.assign(nbDocs, 0);
+  }
+  touchedDocs.clear();
+
+  // accumulate the scores of the documents sharing words with the query
+  for(const auto& word : query)
+  {
+    const uint32_t queryCount = static_cast<uint32_t>(word.second.size());
+    if(word.first < 0 || static_cast<std::size_t>(word.first) >= nbWords())
+      continue;
+
+    const uint8_t* it = _postings.data() + _wordOffsets[word.first];
+    const uint8_t* end = _postings.data() + _wordOffsets[word.first + 1];
+    uint32_t docIndex = 0;
+    while(it != end)
+    {
+      docIndex += readVarint(it);
+      const uint32_t docCount = readVarint(it);
+
+      if(!isTouched[docIndex])
+      {
+        isTouched[docIndex] = 1;
+        touchedDocs.push_back(docIndex);
+      }
+      if(scoring == EScoring::STRONG_COMMON_POINTS)
+        commonScores[docIndex] += (queryCount == 1 && docCount == 1) ? 1 : 0;
+      else
+        commonScores[docIndex] += std::min(queryCount, docCount);
+    }
+  }
+
+  // as in sparseDistance(), the distance of a document is minus its number of common points
+  const std::size_t nbMatches = std::min(N, nbDocs);
+  std::vector<DocMatch> candidates;
+  candidates.reserve(touchedDocs.size() + nbMatches);
+  for(const uint32_t docIndex : touchedDocs)
+    candidates.emplace_back(_docIds[docIndex], -static_cast<float>(commonScores[docIndex]));
+
+  // the documents not sharing any word with the query have a distance of 0,
+  // only the first ones are needed to complete the N matches
+  std::size_t nbUntouched = 0;
+  for(uint32_t docIndex = 0; docIndex < nbDocs && nbUntouched < nbMatches; ++docIndex)
+  {
+    if(isTouched[docIndex])
+      continue;
+    candidates.emplace_back(_docIds[docIndex], -0.0f);
+    ++nbUntouched;
+  }
+
+  // reset the buffers for the next query
+  for(const uint32_t docIndex : touchedDocs)
+  {
+    commonScores[docIndex] = 0;
+    isTouched[docIndex] = 0;
+  }
+
+  // extract the best N
+  const auto compare = [](const DocMatch& a, const DocMatch& b)
+  {
+    return (a.score < b.score) || (a.score == b.score && a.id < b.id);
+  };
+  std::partial_sort(candidates.begin(), candidates.begin() + nbMatches, candidates.end(), compare);
+  matches.assign(candidates.begin(), candidates.begin() + nbMatches);
+}
+
+void InvertedIndex::clear()
+{
+  _docIds.clear();
+  _wordOffsets.clear();
+  _postings.clear();
+}
+
+std::size_t InvertedIndex::memorySize() const
+{
+  return _docIds.capacity() * sizeof(DocId) +
+         _wordOffsets.capacity() * sizeof(uint64_t) +
+         _postings.capacity() * sizeof(uint8_t);
+}
+
+void InvertedIndex::save(const std::string& file) const
+{
+  std::ofstream out(file.c_str(), std::ios_base::binary);
+  if(!out.is_open())
+    throw std::runtime_error((boost::format("Failed to open inverted index file '%s'") % file).str());
+
+  const uint32_t version = INVERTED_INDEX_VERSION;
+  const uint32_t nbWordsFile = static_cast<uint32_t>(nbWords());
+  const uint64_t nbDocs = _docIds.size();
+  const uint64_t nbPostingBytes = _postings.size();
+
+  out.write(INVERTED_INDEX_MAGIC, sizeof(INVERTED_INDEX_MAGIC));
+  out.write((const char*) (&version), sizeof(uint32_t));
+  out.write((const char*) (&nbWordsFile), sizeof(uint32_t));
+  out.write((const char*) (&nbDocs), sizeof(uint64_t));
+  out.write((const char*) (&nbPostingBytes), sizeof(uint64_t));
+  writeVector(out, _docIds);
+  writeVector(out, _wordOffsets);
+  writeVector(out, _postings);
+
+  if(!out.good())
+    throw std::runtime_error((boost::format("Failed to write inverted index file '%s'") % file).str());
+}
+
+void InvertedIndex::load(const std::string& file)
+{
+  clear();
+
+  std::ifstream in;
+  in.exceptions(std::ifstream::eofbit | std::ifstream::failbit | std::ifstream::badbit);
+
+  try
+  {
+    in.open(file.c_str(), std::ios_base::binary);
+
+    char magic[sizeof(INVERTED_INDEX_MAGIC)];
+    uint32_t version = 0;
+    uint32_t nbWordsFile = 0;
+    uint64_t nbDocs = 0;
+    uint64_t nbPostingBytes = 0;
+
+    in.read(magic, sizeof(magic));
+    if(std::memcmp(magic, INVERTED_INDEX_MAGIC, sizeof(magic)) != 0)
+      throw std::runtime_error((boost::format("Invalid inverted index file '%s'") % file).str());
+    in.read((char*) (&version), sizeof(uint32_t));
+    if(version != INVERTED_INDEX_VERSION)
+      throw std::runtime_error((boost::format("Unsupported inverted index file version %d: '%s'") % version % file).str());
+    in.read((char*) (&nbWordsFile), sizeof(uint32_t));
+    in.read((char*) (&nbDocs), sizeof(uint64_t));
+    in.read((char*) (&nbPostingBytes), sizeof(uint64_t));
+
+    // the counts must match the size of the file before allocating anything
+    const std::streampos dataStart = in.tellg();
+    in.seekg(0, std::ios_base::end);
+    const uint64_t dataSize = static_cast<uint64_t>(in.tellg() - dataStart);
+    in.seekg(dataStart);
+
+    const uint64_t offsetsSize = (nbWordsFile + uint64_t(1)) * sizeof(uint64_t);
+    if(nbDocs > std::numeric_limits<uint32_t>::max() ||
+       offsetsSize > dataSize ||
+       nbDocs > (dataSize - offsetsSize) / sizeof(DocId) ||
+       nbPostingBytes != dataSize - offsetsSize - nbDocs * sizeof(DocId))
+      throw std::runtime_error((boost::format("Invalid inverted index file '%s'") % file).str());
+
+    readVector(in, _docIds, nbDocs);
+    readVector(in, _wordOffsets, nbWordsFile + std::size_t(1));
+    readVector(in, _postings, nbPostingBytes);
+  }
+  catch(std::ifstream::failure& e)
+  {
+    clear();
+    throw std::runtime_error((boost::format("Failed to load inverted index file '%s'") % file).str());
+  }
+
+  if(!isValidPostings(_wordOffsets, _postings, _docIds.size()))
+  {
+    clear();
+    throw std::runtime_error((boost::format("Invalid inverted index file '%s'") % file).str());
+  }
+}
+
+}//namespace voctree
+}//namespace aliceVision
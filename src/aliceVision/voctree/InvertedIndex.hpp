@@ -0,0 +1,114 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include "VocabularyTree.hpp"
+#include "DocMatch.hpp"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace aliceVision{
+namespace voctree{
+
+/**
+ * @brief Compressed inverted index of a database of documents.
+ *
+ * For each word, the list of the documents containing it (postings) is stored
+ * in a single contiguous buffer: the document indexes are delta-encoded and each
+ * posting is written as two varints (document index delta, number of occurrences
+ * of the word in the document), so most postings take 2 bytes.
+ *
+ * The documents are scored only through the postings of the query words, so the
+ * cost of a query depends on the number of documents sharing words with the query
+ * and not on the size of the database. It supports the distance methods that only
+ * depend on the shared words: "commonPoints" and "strongCommonPoints".
+ * It gives the same scores as sparseDistance().
+ */
+class InvertedIndex
+{
+public:
+  InvertedIndex() = default;
+
+  /**
+   * @brief Build the index of the given documents.
+   * @param[in] documents The documents, ie the sparse histograms of visual words of the images.
+   * @param[in] nbWords The number of words of the vocabulary.
+   */
+  void build(const SparseHistogramPerImage& documents, uint32_t nbWords);
+
+  /**
+   * @brief Whether the given distance method can be computed with the inverted index.
+   * @param[in] distanceMethod The distance method (see sparseDistance()).
+   */
+  static bool isSupported(const std::string& distanceMethod);
+
+  /**
+   * @brief Find the top N matches in the index for the query document.
+   *
+   * @param[in] query The query document, a set of quantized words.
+   * @param[in] N The number of matches to return.
+   * @param[out] matches IDs and scores for the top N matching documents, sorted by
+   * increasing score then by increasing ID.
+   * @param[in] distanceMethod The distance method, it must be supported.
+   */
+  void find(const SparseHistogram& query, std::size_t N, std::vector<DocMatch>& matches, const std::string& distanceMethod) const;
+
+  /// Remove all the documents.
+  void clear();
+
+  bool empty() const
+  {
+    return _docIds.empty();
+  }
+
+  /// Get the number of indexed documents.
+  std::size_t nbDocuments() const
+  {
+    return _docIds.size();
+  }
+
+  /// Get the number of words of the vocabulary.
+  std::size_t nbWords() const
+  {
+    return _wordOffsets.empty() ? 0 : _wordOffsets.size() - 1;
+  }
+
+  /// Get the memory used by the index in bytes.
+  std::size_t memorySize() const;
+
+  /**
+   * @brief Save the index to a binary file.
+   * @param[in] file The file path.
+   */
+  void save(const std::string& file) const;
+
+  /**
+   * @brief Load the index from a binary file written by save().
+   * @param[in] file The file path.
+   * @throw std::runtime_error if the file cannot be read or is not a valid index.
+   */
+  void load(const std::string& file);
+
+  bool operator==(const InvertedIndex& other) const
+  {
+    return _docIds == other._docIds &&
+           _wordOffsets == other._wordOffsets &&
+           _postings == other._postings;
+  }
+
+private:
+  /// the document ids, sorted, a document is referenced by its index in this vector
+  std::vector<DocId> _docIds;
+  /// the postings of the word w are in [_wordOffsets[w], _wordOffsets[w+1])
+  std::vector<uint64_t> _wordOffsets;
+  /// the compressed postings of all the words
+  std::vector<uint8_t> _postings;
+};
+
+}//namespace voctree
+}//namespace aliceVision
@@ -25,6 +25,8 @@ class MutableVocabularyTree : public VocabularyTree<Feature, Distance, FeatureAl
 public:
   MutableVocabularyTree()
   {
+    // the centers are modified in place, they cannot be memory-mapped
+    this->allow_mapping_ = false;
   }
 
   void setSize(uint32_t levels, uint32_t splits)
@@ -9,6 +9,7 @@
 #include "DefaultAllocator.hpp"
 
 #include <aliceVision/system/Logger.hpp>
+#include <aliceVision/alicevision_omp.hpp>
 
 #include <boost/function.hpp>
 #include <boost/foreach.hpp>
@@ -17,6 +18,8 @@
 #include <numeric>
 #include <vector>
 #include <limits>
+#include <cmath>
+#include <random>
 #include <stdio.h>
 #include <stdlib.h>
 #include <iostream>
@@ -31,14 +34,14 @@ struct InitRandom
 {
 
   template<class Feature, class Distance, class FeatureAllocator>
-  void operator()(const std::vector<Feature*>& features, size_t k, std::vector<Feature, FeatureAllocator>& centers, Distance distance, const int verbose = 0)
+  void operator()(const std::vector<Feature*>& features, size_t k, std::vector<Feature, FeatureAllocator>& centers, Distance distance, std::mt19937& generator, const int verbose = 0)
   {
     ALICEVISION_LOG_DEBUG("#\t\tRandom initialization");
     // Construct a random permutation of the features using a Fisher-Yates shuffle
     std::vector<Feature*> features_perm = features;
     for(size_t i = features.size(); i > 1; --i)
     {
-      size_t k = rand() % i;
+      size_t k = std::uniform_int_distribution<size_t>(0, i - 1)(generator);
       std::swap(features_perm[i - 1], features_perm[k]);
     }
     // Take the first k permuted features as the initial centers
@@ -59,7 +62,7 @@ struct InitKmeanspp
 {
 
   template<class Feature, class Distance, class FeatureAllocator>
-  void operator()(const std::vector<Feature*>& features, size_t k, std::vector<Feature, FeatureAllocator>& centers, Distance distance, const int verbose = 0)
+  void operator()(const std::vector<Feature*>& features, size_t k, std::vector<Feature, FeatureAllocator>& centers, Distance distance, std::mt19937& generator, const int verbose = 0)
   {
     typedef typename Distance::result_type squared_distance_type;
 
@@ -82,10 +85,9 @@ struct InitKmeanspp
     std::vector<squared_distance_type> distsTemp(features.size(), std::numeric_limits<squared_distance_type>::max());
     std::vector<squared_distance_type> distsTempBest(features.size(), std::numeric_limits<squared_distance_type>::max());
     typename std::vector<squared_distance_type>::iterator dstiter;
-    typename std::vector<Feature*>::const_iterator featiter;
 
     // 1. Choose a random center
-    size_t randCenter = rand() % features.size();
+    size_t randCenter = std::uniform_int_distribution<size_t>(0, features.size() - 1)(generator);
 
     // add it to the centers
     centers[0] = *features[ randCenter ];
@@ -93,10 +95,11 @@ struct InitKmeanspp
     if(verbose > 2) ALICEVISION_LOG_DEBUG("First center picked randomly " << randCenter << ": " << centers[0]);
 
     // compute the distances
-    for(dstiter = dists.begin(), featiter = features.begin(); dstiter != dists.end(); ++dstiter, ++featiter)
+    #pragma omp parallel for reduction(+:currSum)
+    for(ptrdiff_t it = 0; it < static_cast<ptrdiff_t>(features.size()); ++it)
     {
-      *dstiter = distance(*(*featiter), centers[0]);
-      currSum += *dstiter;
+      dists[it] = distance(*(features[it]), centers[0]);
+      currSum += dists[it];
     }
 
     // iterate k-1 times
@@ -117,7 +120,7 @@ struct InitKmeanspp
         // 0 and this sum, then start compute the sum from the first element again
         // until the partial sum is greater than the number drawn: the
         // the previous element is what we are looking for
-        const float perc = (float)rand() / RAND_MAX;
+        const float perc = std::uniform_real_distribution<float>(0.f, 1.f)(generator);
         squared_distance_type partial = (squared_distance_type)(currSum * perc);
         // look for the element that cap the partial sum that has been
         // drawn
@@ -185,7 +188,7 @@ struct InitGiven
 {
 
   template<class Feature, class Distance, class FeatureAllocator>
-  void operator()(const std::vector<Feature*>& features, size_t k, std::vector<Feature, FeatureAllocator>& centers, Distance distance, const int verbose = 0)
+  void operator()(const std::vector<Feature*>& features, size_t k, std::vector<Feature, FeatureAllocator>& centers, Distance distance, std::mt19937& generator, const int verbose = 0)
   {
     // Do nothing!
   }
@@ -255,7 +258,17 @@ bool checkVectorElements(const std::vector<Feature, FeatureAllocator> &f, const
 /**
  * @brief Class for performing K-means clustering, optimized for a particular feature type and metric.
  *
- * The standard Lloyd's algorithm is used. By default, cluster centers are initialized randomly.
+ * The standard Lloyd's algorithm is used. By default, cluster centers are initialized with K-means++.
+ *
+ * The assignment step is accelerated with the triangle inequality as proposed in
+ *  Hamerly, G. (2010). "Making k-means even faster" Proceedings of the 2010 SIAM
+ *  International Conference on Data Mining. pp. 130-140.
+ * For each feature an upper bound of the distance to its center and a lower bound of
+ * the distance to the second closest center are maintained, so that most features
+ * skip the search of the nearest center. The result is the same as the standard
+ * algorithm but it requires the square root of Distance to be a metric (which is
+ * the case of the default squared L2 distance), otherwise it can be disabled with
+ * setUseTriangleInequality(false).
  */
 template<class Feature,
          class Distance = L2<Feature, Feature>,
@@ -264,7 +277,7 @@ class SimpleKmeans
 {
 public:
   typedef typename Distance::result_type squared_distance_type;
-  typedef boost::function<void(const std::vector<Feature*>&, size_t, std::vector<Feature, FeatureAllocator>&, Distance, const int verbose) > Initializer;
+  typedef boost::function<void(const std::vector<Feature*>&, size_t, std::vector<Feature, FeatureAllocator>&, Distance, std::mt19937& generator, const int verbose) > Initializer;
 
   /**
    * @brief Constructor
@@ -313,6 +326,16 @@ public:
     verbose_ = verboseLevel;
   }
 
+  bool getUseTriangleInequality() const
+  {
+    return use_triangle_inequality_;
+  }
+
+  void setUseTriangleInequality(bool useTriangleInequality)
+  {
+    use_triangle_inequality_ = useTriangleInequality;
+  }
+
   /**
    * @brief Partition a set of features into k clusters.
    *
@@ -325,6 +348,21 @@ public:
                                 std::vector<Feature, FeatureAllocator>& centers,
                                 std::vector<unsigned int>& membership) const;
 
+  /**
+   * @brief Partition a set of features into k clusters.
+   *
+   * @param      features   The features to be clustered.
+   * @param      k          The number of clusters.
+   * @param[out] centers    A set of k cluster centers.
+   * @param[out] membership Cluster assignment for each feature
+   * @param[in,out] generator The random generator of the initialization and
+   * of the reseeding of the empty clusters.
+   */
+  squared_distance_type cluster(const std::vector<Feature, FeatureAllocator>& features, size_t k,
+                                std::vector<Feature, FeatureAllocator>& centers,
+                                std::vector<unsigned int>& membership,
+                                std::mt19937& generator) const;
+
   /**
    * @brief Partition a set of features into k clusters.
    *
@@ -340,11 +378,30 @@ public:
                                         std::vector<Feature, FeatureAllocator>& centers,
                                         std::vector<unsigned int>& membership) const;
 
+  /**
+   * @brief Partition a set of features into k clusters.
+   *
+   * This version does not share any random state, several sets of features
+   * can be clustered concurrently, each one with its own generator.
+   *
+   * @param      features   The features to be clustered.
+   * @param      k          The number of clusters.
+   * @param[out] centers    A set of k cluster centers.
+   * @param[out] membership Cluster assignment for each feature
+   * @param[in,out] generator The random generator of the initialization and
+   * of the reseeding of the empty clusters.
+   */
+  squared_distance_type clusterPointers(const std::vector<Feature*>& features, size_t k,
+                                        std::vector<Feature, FeatureAllocator>& centers,
+                                        std::vector<unsigned int>& membership,
+                                        std::mt19937& generator) const;
+
 private:
 
   squared_distance_type clusterOnce(const std::vector<Feature*>& features, size_t k,
                                     std::vector<Feature, FeatureAllocator>& centers,
-                                    std::vector<unsigned int>& membership) const;
+                                    std::vector<unsigned int>& membership,
+                                    std::mt19937& generator) const;
 
   Feature zero_;
   Distance distance_;
@@ -352,6 +409,7 @@ private:
   size_t max_iterations_;
   size_t restarts_;
   int verbose_;
+  bool use_triangle_inequality_;
 };
 
 template < class Feature, class Distance, class FeatureAllocator >
@@ -361,8 +419,9 @@ distance_(d),
 //    choose_centers_( InitRandom( ) ),
 choose_centers_(InitKmeanspp()),
 max_iterations_(100),
+restarts_(1),
 verbose_(verbose),
-restarts_(1)
+use_triangle_inequality_(true)
 {
 }
 
@@ -379,11 +438,37 @@ SimpleKmeans<Feature, Distance, FeatureAllocator>::cluster(const std::vector<Fea
   return clusterPointers(feature_ptrs, k, centers, membership);
 }
 
+template < class Feature, class Distance, class FeatureAllocator >
+typename SimpleKmeans<Feature, Distance, FeatureAllocator>::squared_distance_type
+SimpleKmeans<Feature, Distance, FeatureAllocator>::cluster(const std::vector<Feature, FeatureAllocator>& features, size_t k,
+                                                           std::vector<Feature, FeatureAllocator>& centers,
+                                                           std::vector<unsigned int>& membership,
+                                                           std::mt19937& generator) const
+{
+  std::vector<Feature*> feature_ptrs;
+  feature_ptrs.reserve(features.size());
+  BOOST_FOREACH(const Feature& f, features)
+  feature_ptrs.push_back(const_cast<Feature*> (&f));
+  return clusterPointers(feature_ptrs, k, centers, membership, generator);
+}
+
 template < class Feature, class Distance, class FeatureAllocator >
 typename SimpleKmeans<Feature, Distance, FeatureAllocator>::squared_distance_type
 SimpleKmeans<Feature, Distance, FeatureAllocator>::clusterPointers(const std::vector<Feature*>& features, size_t k,
                                                                    std::vector<Feature, FeatureAllocator>& centers,
                                                                    std::vector<unsigned int>& membership) const
+{
+  // the generator is seeded from rand() so that srand() still controls the clustering
+  std::mt19937 generator(rand());
+  return clusterPointers(features, k, centers, membership, generator);
+}
+
+template < class Feature, class Distance, class FeatureAllocator >
+typename SimpleKmeans<Feature, Distance, FeatureAllocator>::squared_distance_type
+SimpleKmeans<Feature, Distance, FeatureAllocator>::clusterPointers(const std::vector<Feature*>& features, size_t k,
+                                                                   std::vector<Feature, FeatureAllocator>& centers,
+                                                                   std::vector<unsigned int>& membership,
+                                                                   std::mt19937& generator) const
 {
   std::vector<Feature, FeatureAllocator> new_centers(centers);
   new_centers.resize(k);
@@ -394,8 +479,8 @@ SimpleKmeans<Feature, Distance, FeatureAllocator>::clusterPointers(const std::ve
   for(size_t starts = 0; starts < restarts_; ++starts)
   {
     if(verbose_ > 0) ALICEVISION_LOG_DEBUG("Trial " << starts + 1 << "/" << restarts_);
-    choose_centers_(features, k, new_centers, distance_, verbose_);
-    squared_distance_type sse = clusterOnce(features, k, new_centers, new_membership);
+    choose_centers_(features, k, new_centers, distance_, generator, verbose_);
+    squared_distance_type sse = clusterOnce(features, k, new_centers, new_membership, generator);
     if(verbose_ > 0) ALICEVISION_LOG_DEBUG("End of Trial " << starts + 1 << "/" << restarts_);
     if(sse < least_sse)
     {
@@ -414,74 +499,134 @@ template < class Feature, class Distance, class FeatureAllocator >
 typename SimpleKmeans<Feature, Distance, FeatureAllocator>::squared_distance_type
 SimpleKmeans<Feature, Distance, FeatureAllocator>::clusterOnce(const std::vector<Feature*>& features, size_t k,
                                                                std::vector<Feature, FeatureAllocator>& centers,
-                                                               std::vector<unsigned int>& membership) const
+                                                               std::vector<unsigned int>& membership,
+                                                               std::mt19937& generator) const
 {
-  typedef typename std::vector<Feature, FeatureAllocator>::value_type centerType;
-  typedef typename Distance::value_type feature_value_type;
-
   std::vector<size_t> new_center_counts(k);
   std::vector<Feature, FeatureAllocator> new_centers(k);
   squared_distance_type max_center_shift = std::numeric_limits<squared_distance_type>::max();
 
+  // bounds used to skip the search of the nearest center (see Hamerly 2010),
+  // they are expressed in distance units, ie the square root of Distance:
+  // upper bound of the distance of each feature to its center
+  std::vector<squared_distance_type> upper_bounds(features.size(), std::numeric_limits<squared_distance_type>::max());
+  // lower bound of the distance of each feature to its second closest center
+  std::vector<squared_distance_type> lower_bounds(features.size(), 0);
+  // half of the distance of each center to its closest center
+  std::vector<squared_distance_type> half_center_dists(k);
+  // the distance moved by each center during the last update
+  std::vector<squared_distance_type> center_moves(k);
+
+  // each thread accumulates its features in its own centers
+  const int nb_threads = omp_get_max_threads();
+  std::vector< std::vector<Feature, FeatureAllocator> > thread_centers(nb_threads, std::vector<Feature, FeatureAllocator>(k, zero_));
+  std::vector< std::vector<size_t> > thread_center_counts(nb_threads, std::vector<size_t>(k));
+
   if(verbose_ > 0) ALICEVISION_LOG_DEBUG("Iterations");
   for(size_t iter = 0; iter < max_iterations_; ++iter)
   {
     if(verbose_ > 0) ALICEVISION_LOG_DEBUG("*");
-    // Zero out new centers and counts
-    std::fill(new_center_counts.begin(), new_center_counts.end(), 0);
-    //		for(size_t i = 0; i < k; checkElements(new_centers[i++], "bef"));
-    std::fill(new_centers.begin(), new_centers.end(), zero_);
-    //		for(size_t i = 0; i < k; checkElements(new_centers[i++], "aft"));
-    assert(checkVectorElements(new_centers, "newcenters init"));
-    bool is_stable = true;
+    const bool use_bounds = use_triangle_inequality_ && (iter > 0);
 
+    if(use_bounds)
+    {
+      // a feature whose upper bound is lower than half the distance between its
+      // center and any other center cannot change its membership
+      #pragma omp parallel for
+      for(ptrdiff_t i = 0; i < static_cast<ptrdiff_t>(k); ++i)
+      {
+        squared_distance_type d_min = std::numeric_limits<squared_distance_type>::max();
+        for(size_t j = 0; j < k; ++j)
+        {
+          if(j != static_cast<size_t>(i))
+            d_min = std::min(d_min, distance_(centers[i], centers[j]));
+        }
+        half_center_dists[i] = (k > 1) ? 0.5 * std::sqrt(d_min) : std::numeric_limits<squared_distance_type>::max();
+      }
+    }
 
     // Assign data objects to current centers
-    #pragma omp parallel for shared( new_centers, new_center_counts, features, centers, membership)
+    size_t nb_changes = 0;
+    #pragma omp parallel for reduction(+:nb_changes)
     for(ptrdiff_t i = 0; i < static_cast<ptrdiff_t>(features.size()); ++i)
     {
+      if(use_bounds)
+      {
+        const unsigned int current = membership[i];
+        const squared_distance_type bound = std::max(half_center_dists[current], lower_bounds[i]);
+        if(upper_bounds[i] <= bound)
+          continue;
+        // tighten the upper bound and test again
+        upper_bounds[i] = std::sqrt(distance_(*features[i], centers[current]));
+        if(upper_bounds[i] <= bound)
+          continue;
+      }
+
       squared_distance_type d_min = std::numeric_limits<squared_distance_type>::max();
+      squared_distance_type d_second = std::numeric_limits<squared_distance_type>::max();
       unsigned int nearest = 0;
       bool found = false;
 
-      // @todo if k is large, let's say k>100 use FLAAN to retrieve the 
-      // cluster center
-
       // Find the nearest cluster center to feature i
       for(unsigned int j = 0; j < k; ++j)
       {
         squared_distance_type distance = distance_(*features[i], centers[j]);
-        //		printf("\t\tdistance %f\n", (float)distance);
-        //		PrintFeat(*features[i] );
         if(distance < d_min)
         {
+          d_second = d_min;
           d_min = distance;
           nearest = j;
           found = true;
         }
-        //		 printf("\t distance %f %f\n", (double)distance, (double)d_min);
+        else if(distance < d_second)
+        {
+          d_second = distance;
+        }
       }
       assert(found);
+      upper_bounds[i] = std::sqrt(d_min);
+      lower_bounds[i] = (k > 1) ? std::sqrt(d_second) : std::numeric_limits<squared_distance_type>::max();
+
       // Assign feature i to the cluster it is nearest to
-      if(membership[i] != nearest)
+      if(membership[i] != nearest || iter == 0)
       {
-        is_stable = false;
+        ++nb_changes;
         membership[i] = nearest;
       }
-      // Accumulate the cluster center and its membership count
-      //	  printf("\t nearest %d\n", nearest);
-      //			checkElements(*features[i], "feat");
-      #pragma omp critical
+    }//for
+
+    if(nb_changes == 0) break;
+
+    // Accumulate the cluster centers and their membership count
+    #pragma omp parallel
+    {
+      std::vector<Feature, FeatureAllocator>& local_centers = thread_centers[omp_get_thread_num()];
+      std::vector<size_t>& local_counts = thread_center_counts[omp_get_thread_num()];
+      std::fill(local_centers.begin(), local_centers.end(), zero_);
+      std::fill(local_counts.begin(), local_counts.end(), 0);
+
+      #pragma omp for
+      for(ptrdiff_t i = 0; i < static_cast<ptrdiff_t>(features.size()); ++i)
       {
-        new_centers[nearest] += *features[i];
-        //			checkElements(new_centers[nearest], "sum");
-        //	  printf("\t new_centers[nearest] += *features[i];\n");
-        ++new_center_counts[nearest];
-        //	  printf("\taccumulate\n");
+        local_centers[membership[i]] += *features[i];
+        ++local_counts[membership[i]];
       }
-    }//for
+    }
 
-    if(is_stable) break;
+    // Zero out new centers and counts
+    std::fill(new_center_counts.begin(), new_center_counts.end(), 0);
+    std::fill(new_centers.begin(), new_centers.end(), zero_);
+    assert(checkVectorElements(new_centers, "newcenters init"));
+    for(int t = 0; t < nb_threads; ++t)
+    {
+      for(size_t i = 0; i < k; ++i)
+      {
+        if(thread_center_counts[t][i] == 0)
+          continue;
+        new_centers[i] += thread_centers[t][i];
+        new_center_counts[i] += thread_center_counts[t][i];
+      }
+    }
 
     if(iter > 0)
       max_center_shift = 0;
@@ -490,31 +635,52 @@ SimpleKmeans<Feature, Distance, FeatureAllocator>::clusterOnce(const std::vector
     {
       if(new_center_counts[i] > 0)
       {
-        //		  printf("%d - %d\n", i, new_center_counts[i] );
-        //		  PrintFeat(new_centers[i] );
-        //		checkElements(new_centers[i], "bef");
         new_centers[i] = new_centers[i] / new_center_counts[i];
 
         squared_distance_type shift = distance_(new_centers[i], centers[i]);
 
         max_center_shift = std::max(max_center_shift, shift);
+        center_moves[i] = std::sqrt(shift);
 
         centers[i] = new_centers[i];
-        //					centers[i] = new_centers[i] / new_center_counts[i];
-        //		checkElements(new_centers[i], "aft");
-        //		PrintFeat(centers[i] );
       }
       else
       {
         // Choose a new center randomly from the input features
         // @todo use a better strategy like taking splitting the largest cluster
-        unsigned int index = rand() % features.size();
+        unsigned int index = std::uniform_int_distribution<unsigned int>(0, features.size() - 1)(generator);
+        center_moves[i] = std::sqrt(distance_(*features[index], centers[i]));
         centers[i] = *features[index];
         ALICEVISION_LOG_DEBUG("Choosing a new center: " << index);
       }
     }
     //			ALICEVISION_LOG_DEBUG("max_center_shift: " << max_center_shift);  
     if(max_center_shift <= 10e-10) break;
+
+    if(use_triangle_inequality_)
+    {
+      // update the bounds with the distance moved by the centers
+      size_t farthest = 0;
+      for(size_t i = 1; i < k; ++i)
+      {
+        if(center_moves[i] > center_moves[farthest])
+          farthest = i;
+      }
+      squared_distance_type second_move = 0;
+      for(size_t i = 0; i < k; ++i)
+      {
+        if(i != farthest)
+          second_move = std::max(second_move, center_moves[i]);
+      }
+
+      #pragma omp parallel for
+      for(ptrdiff_t i = 0; i < static_cast<ptrdiff_t>(features.size()); ++i)
+      {
+        const unsigned int current = membership[i];
+        upper_bounds[i] += center_moves[current];
+        lower_bounds[i] -= (current == farthest) ? second_move : center_moves[farthest];
+      }
+    }
   }
   if(verbose_ > 0) ALICEVISION_LOG_DEBUG("");
 
@@ -522,7 +688,8 @@ SimpleKmeans<Feature, Distance, FeatureAllocator>::clusterOnce(const std::vector
   /// @todo Kahan summation?
   squared_distance_type sse = squared_distance_type(0);
   assert(features.size() > 0);
-  for(size_t i = 0; i < features.size(); ++i)
+  #pragma omp parallel for reduction(+:sse)
+  for(ptrdiff_t i = 0; i < static_cast<ptrdiff_t>(features.size()); ++i)
   {
     sse += distance_(*features[i], centers[membership[i]]);
   }
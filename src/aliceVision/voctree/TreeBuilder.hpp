@@ -7,7 +7,11 @@
 
 #include "MutableVocabularyTree.hpp"
 #include "SimpleKmeans.hpp"
-#include <deque>
+#include <aliceVision/alicevision_omp.hpp>
+
+#include <algorithm>
+#include <random>
+#include <vector>
 //#include <cstdio> //DEBUG
 
 namespace aliceVision {
@@ -78,19 +82,38 @@ public:
     return verbose_;
   }
 
+  /**
+   * @brief Set the seed of the random generators of the k-means.
+   *
+   * Each subset is clustered with its own generator, seeded from this seed and
+   * the index of the subset in the tree, so that the tree does not depend on
+   * the number of threads nor on the order in which the subsets are clustered.
+   */
+  void setSeed(unsigned int seed)
+  {
+    seed_ = seed;
+  }
+
+  unsigned int getSeed() const
+  {
+    return seed_;
+  }
+
 protected:
   Tree tree_;
   Kmeans kmeans_;
   Feature zero_;
 private:
   unsigned char verbose_;
+  unsigned int seed_;
 };
 
 template<class Feature, template<typename, typename> class DistanceT, class FeatureAllocator>
 TreeBuilder<Feature, DistanceT, FeatureAllocator>::TreeBuilder(const Feature& zero, Distance d, unsigned char verbose)
 : kmeans_(zero, d, verbose),
 zero_(zero),
-verbose_(verbose)
+verbose_(verbose),
+seed_(std::mt19937::default_seed)
 {
 }
 
@@ -104,29 +127,40 @@ void TreeBuilder<Feature, DistanceT, FeatureAllocator>::build(const FeatureVecto
   tree_.centers().reserve(tree_.nodes());
   tree_.validCenters().reserve(tree_.nodes());
 
-  // We keep a queue of disjoint feature subsets to cluster.
+  // We keep the disjoint feature subsets to cluster at the current level.
   // Feature* is used to avoid copying features.
-  std::deque< std::vector<Feature*> > subset_queue(1);
+  std::vector< std::vector<Feature*> > subsets(1);
 
   {
-    // At first the queue contains one "subset" containing all the features.
-    std::vector<Feature*> &feature_ptrs = subset_queue.front();
+    // At first there is one "subset" containing all the features.
+    std::vector<Feature*> &feature_ptrs = subsets.front();
     feature_ptrs.reserve(training_features.size());
     for(const Feature& f: training_features)
     {
       feature_ptrs.push_back(const_cast<Feature*> (&f));
     }
   }
-  FeatureVector centers; // always size k
   for(uint32_t level = 0; level < levels; ++level)
   {
     if(verbose_) printf("# Level %u\n", level);
-    std::vector<unsigned int> membership;
 
-    for(size_t i = 0, ie = subset_queue.size(); i < ie; ++i)
+    // The subsets of a level are independent: they are clustered in parallel
+    // and their k centers (resp. children subsets) are stored at [i*k, (i+1)*k)
+    // so that the tree has the same layout as a breadth-first construction.
+    const std::ptrdiff_t nbSubsets = subsets.size();
+    FeatureVector levelCenters(nbSubsets * k, zero_);
+    std::vector<uint8_t> levelValidCenters(nbSubsets * k, 0);
+    std::vector< std::vector<Feature*> > nextSubsets(nbSubsets * k);
+    // index in the tree of the first subset of the level
+    const std::size_t firstSubset = tree_.centers().size() / k;
+
+    // At the first levels there are few big subsets, the k-means is then
+    // parallelized internally.
+    #pragma omp parallel for schedule(dynamic) if(nbSubsets > 1)
+    for(std::ptrdiff_t i = 0; i < nbSubsets; ++i)
     {
-      std::vector<Feature*> &subset = subset_queue.front();
-      if(verbose_ > 1) printf("#\tClustering subset %lu/%lu of size %lu\n", i + 1, ie, subset.size());
+      std::vector<Feature*> &subset = subsets[i];
+      if(verbose_ > 1) printf("#\tClustering subset %lu/%lu of size %lu\n", i + 1, nbSubsets, subset.size());
 
       // If the subset already has k or fewer elements, just use those as the centers.
       if(subset.size() <= k)
@@ -134,39 +168,38 @@ void TreeBuilder<Feature, DistanceT, FeatureAllocator>::build(const FeatureVecto
         if(verbose_ > 2) printf("#\tno need to cluster %lu elements\n", subset.size());
         for(size_t j = 0; j < subset.size(); ++j)
         {
-          tree_.centers().push_back(*subset[j]);
-          tree_.validCenters().push_back(1);
+          levelCenters[i * k + j] = *subset[j];
+          levelValidCenters[i * k + j] = 1;
         }
-        // Mark non-existent centers as invalid.
-        tree_.centers().insert(tree_.centers().end(), k - subset.size(), zero_);
-        tree_.validCenters().insert(tree_.validCenters().end(), k - subset.size(), 0);
-
-        // Push k empty subsets into the queue so all children get marked invalid.
-        subset_queue.pop_front();
-        subset_queue.insert(subset_queue.end(), k, std::vector<Feature*>());
+        // Non-existent centers stay invalid and all their children are empty.
       }
       else
       {
         // Cluster the current subset into k centers.
         if(verbose_ > 2) printf("#\tclustering the current subset of %lu elements into %d centers\n", subset.size(), k);
-        kmeans_.clusterPointers(subset, k, centers, membership);
+        FeatureVector centers; // always size k
+        std::vector<unsigned int> membership;
+        std::mt19937 generator(seed_ + firstSubset + i);
+        kmeans_.clusterPointers(subset, k, centers, membership, generator);
         // Add the centers and mark them as valid.
-        tree_.centers().insert(tree_.centers().end(), centers.begin(), centers.end());
-        tree_.validCenters().insert(tree_.validCenters().end(), k, 1);
+        std::copy(centers.begin(), centers.end(), levelCenters.begin() + i * k);
+        std::fill(levelValidCenters.begin() + i * k, levelValidCenters.begin() + (i + 1) * k, 1);
         // Partition the current subset into k new subsets based on the cluster assignments.
-        std::vector< std::vector<Feature*> > new_subsets(k);
         assert(membership.size() >= subset.size());
         for(size_t j = 0; j < subset.size(); ++j)
         {
           assert(membership[j] < k);
-          assert(membership[j] < new_subsets.size());
-          new_subsets[ membership[j] ].push_back(subset[j]);
+          nextSubsets[i * k + membership[j]].push_back(subset[j]);
         }
-        // Update the queue
-        subset_queue.pop_front();
-        subset_queue.insert(subset_queue.end(), new_subsets.begin(), new_subsets.end());
       }
+      // release the memory of the processed subset
+      std::vector<Feature*>().swap(subset);
     }
+
+    tree_.centers().insert(tree_.centers().end(), levelCenters.begin(), levelCenters.end());
+    tree_.validCenters().insert(tree_.validCenters().end(), levelValidCenters.begin(), levelValidCenters.end());
+    subsets.swap(nextSubsets);
+
     if(verbose_) printf("# centers so far = %lu\n", tree_.centers().size());
   }
 }
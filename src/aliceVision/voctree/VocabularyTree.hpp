@@ -14,15 +14,21 @@
 
 #include <aliceVision/types.hpp>
 #include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/MappedFile.hpp>
 
 #include <stdint.h>
 #include <vector>
 #include <map>
+#include <algorithm>
 #include <cassert>
+#include <cmath>
+#include <cstring>
 #include <limits>
 #include <fstream>
+#include <memory>
 #include <stdexcept>
 #include <iostream>
+#include <type_traits>
 
 
 namespace aliceVision {
@@ -56,6 +62,87 @@ inline void computeSparseHistogram(const std::vector<Word>& document, SparseHist
   }
 }
 
+/**
+ * @brief Type of the center values stored in a vocabulary tree file.
+ */
+enum class EVocTreeCenterType : uint32_t
+{
+  RAW = 0,     //< the memory representation of the Feature type of the tree
+  FLOAT32 = 1,
+  UINT8 = 2    //< quantized centers, 4x smaller for SIFT-like descriptors
+};
+
+/// Current version of the vocabulary tree file
+static const uint32_t VOCTREE_FILE_VERSION = 2;
+/// Alignment in bytes of the centers in the vocabulary tree file
+static const uint32_t VOCTREE_FILE_ALIGNMENT = 64;
+/// Magic number at the beginning of a versioned vocabulary tree file
+static const char VOCTREE_FILE_MAGIC[8] = {'A', 'V', 'V', 'T', 'R', 'E', 'E', '\0'};
+
+/**
+ * @brief Header of the versioned vocabulary tree file.
+ *
+ * The file is laid out so that it can be memory-mapped and used in place:
+ * | header | centers | valid centers |
+ * The centers are stored in breadth-first order, so the children of a node are
+ * contiguous, and they start at an offset aligned on VOCTREE_FILE_ALIGNMENT bytes.
+ * Files without header (ie without magic number) are read with the legacy layout.
+ */
+struct VocTreeFileHeader
+{
+  char magic[8];
+  uint32_t version;
+  uint32_t k;
+  uint32_t levels;
+  /// number of centers (ie nodes of the tree)
+  uint32_t nbNodes;
+  /// EVocTreeCenterType
+  uint32_t centerType;
+  /// number of values per center
+  uint32_t dimension;
+  /// number of bytes per center
+  uint32_t centerSize;
+  uint32_t reserved;
+  uint64_t centersOffset;
+  uint64_t validCentersOffset;
+  uint64_t padding;
+};
+
+static_assert(sizeof(VocTreeFileHeader) == 64, "The vocabulary tree file header must be 64 bytes long.");
+
+/**
+ * @brief Type of the values of a feature, works with any feature with
+ * array-indexed element access (eg feature::Descriptor or Eigen::Matrix).
+ */
+template<class Feature>
+struct FeatureValueType
+{
+  typedef typename std::decay<decltype(std::declval<const Feature&>()[0])>::type type;
+};
+
+/**
+ * @brief Get the file center type corresponding to a descriptor value type.
+ */
+template<typename ValueT>
+constexpr EVocTreeCenterType getVocTreeCenterType()
+{
+  return std::is_same<ValueT, float>::value ? EVocTreeCenterType::FLOAT32 :
+         std::is_same<ValueT, unsigned char>::value ? EVocTreeCenterType::UINT8 :
+         EVocTreeCenterType::RAW;
+}
+
+/**
+ * @brief Convert a center value between the file and the tree types.
+ * Values converted to uint8 are rounded and clamped to [0, 255].
+ */
+template<typename To, typename From>
+inline To convertCenterValue(From value)
+{
+  if(std::is_same<To, unsigned char>::value && !std::is_same<From, unsigned char>::value)
+    return static_cast<To>(std::min(std::max(std::round(static_cast<double>(value)), 0.0), 255.0));
+  return static_cast<To>(value);
+}
+
 class IVocabularyTree
 {
 public:
@@ -141,14 +228,40 @@ public:
   void clear() override;
 
   /// Save vocabulary to a file.
-  void save(const std::string& file) const override;
-  /// Load vocabulary from a file.
+  void save(const std::string& file) const override
+  {
+    save(file, getVocTreeCenterType<typename FeatureValueType<Feature>::type>());
+  }
+
+  /**
+   * @brief Save vocabulary to a file with the versioned layout.
+   * @param[in] file The vocabulary file path.
+   * @param[in] centerType The type of the stored center values, eg UINT8 to
+   * quantize the centers of a SIFT vocabulary.
+   */
+  void save(const std::string& file, EVocTreeCenterType centerType) const;
+
+  /**
+   * @brief Load vocabulary from a file.
+   *
+   * If the file has the versioned layout and its centers have the type of the
+   * tree, the file is memory-mapped and its centers are used in place.
+   * Otherwise the centers are converted to the type of the tree.
+   */
   void load(const std::string& file) override;
 
+  /// Whether the centers are used in place from a memory-mapped file.
+  bool isMapped() const
+  {
+    return mapped_centers_ != nullptr;
+  }
+
   bool operator==(const VocabularyTree& other) const
   {
-    return (centers_ == other.centers_) &&
-        (valid_centers_ == other.valid_centers_) &&
+    const std::size_t nbNodes = storedNodes();
+    return (nbNodes == other.storedNodes()) &&
+        std::equal(centersData(), centersData() + nbNodes, other.centersData()) &&
+        std::equal(validCentersData(), validCentersData() + nbNodes, other.validCentersData()) &&
         (k_ == other.k_) &&
         (levels_ == other.levels_) &&
         (num_words_ == other.num_words_) &&
@@ -159,6 +272,15 @@ protected:
   std::vector<Feature, FeatureAllocator> centers_;
   std::vector<uint8_t> valid_centers_; /// @todo Consider bit-vector
 
+  /// the versioned vocabulary file, when its centers are used in place
+  std::shared_ptr<system::MappedFile> mapped_file_;
+  const Feature* mapped_centers_ = nullptr;
+  const uint8_t* mapped_valid_centers_ = nullptr;
+  std::size_t mapped_nodes_ = 0;
+  /// whether load() can use the centers of a file in place (the centers
+  /// are always copied for a tree that can be modified)
+  bool allow_mapping_ = true;
+
   uint32_t k_; // splits, or branching factor
   uint32_t levels_;
   uint32_t num_words_; // number of leaf nodes
@@ -169,7 +291,32 @@ protected:
     return num_words_ != 0;
   }
 
+  const Feature* centersData() const
+  {
+    return mapped_centers_ ? mapped_centers_ : centers_.data();
+  }
+
+  const uint8_t* validCentersData() const
+  {
+    return mapped_valid_centers_ ? mapped_valid_centers_ : valid_centers_.data();
+  }
+
+  std::size_t storedNodes() const
+  {
+    return mapped_valid_centers_ ? mapped_nodes_ : valid_centers_.size();
+  }
+
   void setNodeCounts();
+
+private:
+  void loadLegacy(const std::string& file);
+  void loadVersioned(const std::string& file);
+
+  template<typename FileValueT>
+  void readCenters(const char* data, uint32_t nbNodes, uint32_t dimension);
+
+  template<typename FileValueT>
+  void writeCenters(std::ostream& out, uint32_t dimension) const;
 };
 
 template<class Feature, template<typename, typename> class Distance, class FeatureAllocator>
@@ -194,6 +341,8 @@ Word VocabularyTree<Feature, Distance, FeatureAllocator>::quantize(const Descrip
   //	printf("asserting\n");
   assert(initialized());
   //	printf("initialized\n");
+  const Feature* centers = centersData();
+  const uint8_t* valid_centers = validCentersData();
   int32_t index = -1; // virtual "root" index, which has no associated center.
   for(unsigned level = 0; level < levels_; ++level)
   {
@@ -204,9 +353,9 @@ Word VocabularyTree<Feature, Distance, FeatureAllocator>::quantize(const Descrip
     distance_type best_distance = std::numeric_limits<distance_type>::max();
     for(int32_t child = first_child; child < first_child + (int32_t) splits(); ++child)
     {
-      if(!valid_centers_[child])
+      if(!valid_centers[child])
         break; // Fewer than splits() children.
-      distance_type child_distance = Distance<DescriptorT, Feature>()(feature, centers_[child]);
+      distance_type child_distance = Distance<DescriptorT, Feature>()(feature, centers[child]);
       if(child_distance < best_distance)
       {
         best_child = child;
@@ -271,23 +420,76 @@ void VocabularyTree<Feature, Distance, FeatureAllocator>::clear()
 {
   centers_.clear();
   valid_centers_.clear();
+  mapped_file_.reset();
+  mapped_centers_ = nullptr;
+  mapped_valid_centers_ = nullptr;
+  mapped_nodes_ = 0;
   k_ = levels_ = num_words_ = word_start_ = 0;
 }
 
 template<class Feature, template<typename, typename> class Distance, class FeatureAllocator>
-void VocabularyTree<Feature, Distance, FeatureAllocator>::save(const std::string& file) const
+void VocabularyTree<Feature, Distance, FeatureAllocator>::save(const std::string& file, EVocTreeCenterType centerType) const
 {
   /// @todo Support serializing of non-"simple" feature classes
   /// @todo Some identifying name for the distance used
   assert(initialized());
 
+  typedef typename FeatureValueType<Feature>::type ValueT;
+  const uint32_t dimension = static_cast<uint32_t>(Feature().size());
+
+  VocTreeFileHeader header;
+  std::memset(&header, 0, sizeof(header));
+  std::memcpy(header.magic, VOCTREE_FILE_MAGIC, sizeof(header.magic));
+  header.version = VOCTREE_FILE_VERSION;
+  header.k = k_;
+  header.levels = levels_;
+  header.nbNodes = static_cast<uint32_t>(storedNodes());
+  header.centerType = static_cast<uint32_t>(centerType);
+  header.dimension = dimension;
+
+  switch(centerType)
+  {
+    case EVocTreeCenterType::RAW:     header.centerSize = sizeof(Feature); break;
+    case EVocTreeCenterType::FLOAT32: header.centerSize = dimension * sizeof(float); break;
+    case EVocTreeCenterType::UINT8:   header.centerSize = dimension * sizeof(unsigned char); break;
+    default: throw std::invalid_argument("Invalid vocabulary tree center type");
+  }
+  header.centersOffset = (sizeof(VocTreeFileHeader) + VOCTREE_FILE_ALIGNMENT - 1) / VOCTREE_FILE_ALIGNMENT * VOCTREE_FILE_ALIGNMENT;
+  header.validCentersOffset = header.centersOffset + uint64_t(header.nbNodes) * header.centerSize;
+
   std::ofstream out(file.c_str(), std::ios_base::binary);
-  out.write((char*) (&k_), sizeof (uint32_t));
-  out.write((char*) (&levels_), sizeof (uint32_t));
-  uint32_t size = centers_.size();
-  out.write((char*) (&size), sizeof (uint32_t));
-  out.write((char*) (&centers_[0]), centers_.size() * sizeof (Feature));
-  out.write((char*) (&valid_centers_[0]), valid_centers_.size());
+  if(!out.is_open())
+    throw std::runtime_error("Failed to open vocabulary tree file " + file);
+
+  out.write((const char*) (&header), sizeof(header));
+  out.write(std::string(header.centersOffset - sizeof(header), '\0').data(), header.centersOffset - sizeof(header));
+
+  if(centerType == EVocTreeCenterType::RAW ||
+     (centerType == getVocTreeCenterType<ValueT>() && header.centerSize == sizeof(Feature)))
+    out.write((const char*) (centersData()), uint64_t(header.nbNodes) * sizeof(Feature));
+  else if(centerType == EVocTreeCenterType::FLOAT32)
+    writeCenters<float>(out, dimension);
+  else
+    writeCenters<unsigned char>(out, dimension);
+
+  out.write((const char*) (validCentersData()), header.nbNodes);
+
+  if(!out.good())
+    throw std::runtime_error("Failed to write vocabulary tree file " + file);
+}
+
+template<class Feature, template<typename, typename> class Distance, class FeatureAllocator>
+template<typename FileValueT>
+void VocabularyTree<Feature, Distance, FeatureAllocator>::writeCenters(std::ostream& out, uint32_t dimension) const
+{
+  const Feature* centers = centersData();
+  std::vector<FileValueT> buffer(dimension);
+  for(std::size_t i = 0; i < storedNodes(); ++i)
+  {
+    for(uint32_t d = 0; d < dimension; ++d)
+      buffer[d] = convertCenterValue<FileValueT>(centers[i][d]);
+    out.write((const char*) (buffer.data()), dimension * sizeof(FileValueT));
+  }
 }
 
 template<class Feature, template<typename, typename> class Distance, class FeatureAllocator>
@@ -295,6 +497,106 @@ void VocabularyTree<Feature, Distance, FeatureAllocator>::load(const std::string
 {
   clear();
 
+  char magic[sizeof(VOCTREE_FILE_MAGIC)] = {0};
+  {
+    std::ifstream in(file.c_str(), std::ios_base::binary);
+    if(!in.is_open())
+      throw std::runtime_error("Failed to load vocabulary tree file" + file);
+    in.read(magic, sizeof(magic));
+  }
+
+  if(std::memcmp(magic, VOCTREE_FILE_MAGIC, sizeof(magic)) == 0)
+    loadVersioned(file);
+  else
+    loadLegacy(file);
+}
+
+template<class Feature, template<typename, typename> class Distance, class FeatureAllocator>
+void VocabularyTree<Feature, Distance, FeatureAllocator>::loadVersioned(const std::string& file)
+{
+  typedef typename FeatureValueType<Feature>::type ValueT;
+  const uint32_t dimension = static_cast<uint32_t>(Feature().size());
+
+  std::shared_ptr<system::MappedFile> mappedFile = std::make_shared<system::MappedFile>(file);
+
+  if(mappedFile->size() < sizeof(VocTreeFileHeader))
+    throw std::runtime_error("Invalid vocabulary tree file " + file);
+
+  VocTreeFileHeader header;
+  std::memcpy(&header, mappedFile->data(), sizeof(header));
+
+  if(header.version != VOCTREE_FILE_VERSION)
+    throw std::runtime_error("Unsupported vocabulary tree file version " + std::to_string(header.version) + ": " + file);
+
+  const EVocTreeCenterType centerType = static_cast<EVocTreeCenterType>(header.centerType);
+  const bool isRawCompatible = (centerType == EVocTreeCenterType::RAW || centerType == getVocTreeCenterType<ValueT>()) &&
+                               header.centerSize == sizeof(Feature) && header.dimension == dimension;
+
+  if(header.dimension != dimension)
+    throw std::runtime_error("Invalid vocabulary tree file " + file + ": the centers have " + std::to_string(header.dimension) +
+                             " dimensions instead of " + std::to_string(dimension));
+  if((centerType == EVocTreeCenterType::RAW && !isRawCompatible) ||
+     header.validCentersOffset != header.centersOffset + uint64_t(header.nbNodes) * header.centerSize ||
+     mappedFile->size() < header.validCentersOffset + header.nbNodes)
+    throw std::runtime_error("Invalid vocabulary tree file " + file);
+
+  k_ = header.k;
+  levels_ = header.levels;
+  setNodeCounts();
+  if(header.nbNodes != num_words_ + word_start_)
+  {
+    clear();
+    throw std::runtime_error("Invalid vocabulary tree file " + file + ": wrong number of nodes");
+  }
+
+  const char* centers = mappedFile->data() + header.centersOffset;
+  const char* validCenters = mappedFile->data() + header.validCentersOffset;
+
+  if(allow_mapping_ && isRawCompatible && reinterpret_cast<std::size_t>(centers) % alignof(Feature) == 0)
+  {
+    // use the centers in place
+    mapped_centers_ = reinterpret_cast<const Feature*>(centers);
+    mapped_valid_centers_ = reinterpret_cast<const uint8_t*>(validCenters);
+    mapped_nodes_ = header.nbNodes;
+    mapped_file_ = mappedFile;
+    return;
+  }
+
+  if(isRawCompatible)
+  {
+    centers_.resize(header.nbNodes);
+    std::memcpy(static_cast<void*>(centers_.data()), centers, uint64_t(header.nbNodes) * sizeof(Feature));
+  }
+  else if(centerType == EVocTreeCenterType::FLOAT32)
+    readCenters<float>(centers, header.nbNodes, dimension);
+  else if(centerType == EVocTreeCenterType::UINT8)
+    readCenters<unsigned char>(centers, header.nbNodes, dimension);
+  else
+    throw std::runtime_error("Invalid vocabulary tree file " + file + ": unknown center type");
+
+  valid_centers_.assign(validCenters, validCenters + header.nbNodes);
+}
+
+template<class Feature, template<typename, typename> class Distance, class FeatureAllocator>
+template<typename FileValueT>
+void VocabularyTree<Feature, Distance, FeatureAllocator>::readCenters(const char* data, uint32_t nbNodes, uint32_t dimension)
+{
+  typedef typename FeatureValueType<Feature>::type ValueT;
+
+  centers_.resize(nbNodes);
+  std::vector<FileValueT> buffer(dimension);
+  for(uint32_t i = 0; i < nbNodes; ++i)
+  {
+    // the file data may not be aligned for FileValueT
+    std::memcpy(buffer.data(), data + uint64_t(i) * dimension * sizeof(FileValueT), dimension * sizeof(FileValueT));
+    for(uint32_t d = 0; d < dimension; ++d)
+      centers_[i][d] = convertCenterValue<ValueT>(buffer[d]);
+  }
+}
+
+template<class Feature, template<typename, typename> class Distance, class FeatureAllocator>
+void VocabularyTree<Feature, Distance, FeatureAllocator>::loadLegacy(const std::string& file)
+{
   std::ifstream in;
   in.exceptions(std::ifstream::eofbit | std::ifstream::failbit | std::ifstream::badbit);
 
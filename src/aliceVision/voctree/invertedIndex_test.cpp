@@ -0,0 +1,189 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/voctree/Database.hpp>
+#include <aliceVision/voctree/InvertedIndex.hpp>
+
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <vector>
+
+#define BOOST_TEST_MODULE invertedIndex
+#include <boost/test/included/unit_test.hpp>
+
+using namespace aliceVision::voctree;
+
+const uint32_t nbWords = 500;
+
+SparseHistogramPerImage generateDocuments(std::size_t nbDocuments, std::mt19937& generator)
+{
+  std::uniform_int_distribution<Word> wordDistribution(0, nbWords - 1);
+  SparseHistogramPerImage documents;
+  for(std::size_t i = 0; i < nbDocuments; ++i)
+  {
+    std::vector<Word> document(100);
+    for(Word& word : document)
+      word = wordDistribution(generator);
+    // sparse document ids
+    computeSparseHistogram(document, documents[3 * i + 1]);
+  }
+  return documents;
+}
+
+BOOST_AUTO_TEST_CASE(invertedIndex_sameScoresAsSparseDistance)
+{
+  std::mt19937 generator(0);
+  const SparseHistogramPerImage documents = generateDocuments(200, generator);
+
+  Database db(nbWords);
+  for(const auto& document : documents)
+    db.insert(document.first, document.second);
+
+  InvertedIndex index;
+  index.build(documents, nbWords);
+  BOOST_CHECK_EQUAL(index.nbDocuments(), documents.size());
+
+  const SparseHistogramPerImage queries = generateDocuments(10, generator);
+
+  for(const std::string distanceMethod : {"commonPoints", "strongCommonPoints"})
+  {
+    BOOST_CHECK(InvertedIndex::isSupported(distanceMethod));
+    for(const std::size_t N : {std::size_t(1), std::size_t(10), documents.size() + 10})
+    {
+      for(const auto& query : queries)
+      {
+        // the database is queried without the inverted index
+        std::vector<DocMatch> expectedMatches;
+        db.find(query.second, N, expectedMatches, distanceMethod);
+
+        std::vector<DocMatch> matches;
+        index.find(query.second, N, matches, distanceMethod);
+
+        BOOST_REQUIRE_EQUAL(matches.size(), expectedMatches.size());
+        for(std::size_t i = 0; i < matches.size(); ++i)
+        {
+          // the order of the documents with the same score is not specified
+          BOOST_CHECK_EQUAL(matches[i].score, expectedMatches[i].score);
+          BOOST_CHECK_EQUAL(matches[i].score, sparseDistance(query.second, documents.at(matches[i].id), distanceMethod));
+        }
+      }
+    }
+  }
+  BOOST_CHECK(!InvertedIndex::isSupported("classic"));
+}
+
+BOOST_AUTO_TEST_CASE(invertedIndex_database)
+{
+  std::mt19937 generator(1);
+  const SparseHistogramPerImage documents = generateDocuments(50, generator);
+
+  Database db(nbWords);
+  for(const auto& document : documents)
+    db.insert(document.first, document.second);
+  db.buildInvertedIndex();
+  BOOST_CHECK_EQUAL(db.getInvertedIndex().nbDocuments(), documents.size());
+
+  // each document is its best match
+  for(const auto& document : documents)
+  {
+    std::vector<DocMatch> matches;
+    db.find(document.second, 3, matches, "commonPoints");
+    BOOST_REQUIRE_EQUAL(matches.size(), 3);
+    BOOST_CHECK_EQUAL(matches[0].id, document.first);
+  }
+
+  // a database with the loaded index gives the same results
+  db.saveInvertedIndex("test_invertedIndex.bin");
+  Database loadedDb(nbWords);
+  loadedDb.loadInvertedIndex("test_invertedIndex.bin");
+  BOOST_CHECK(loadedDb.getInvertedIndex() == db.getInvertedIndex());
+  BOOST_CHECK_EQUAL(loadedDb.size(), db.size());
+
+  for(const auto& document : documents)
+  {
+    std::vector<DocMatch> matches, loadedMatches;
+    db.find(document.second, 5, matches);
+    loadedDb.find(document.second, 5, loadedMatches);
+    BOOST_CHECK(matches == loadedMatches);
+  }
+
+  // the index is cleared by an insertion
+  db.insert(1000, documents.begin()->second);
+  BOOST_CHECK(db.getInvertedIndex().empty());
+
+  // the number of words must match the vocabulary
+  Database otherDb(nbWords + 1);
+  BOOST_CHECK_THROW(otherDb.loadInvertedIndex("test_invertedIndex.bin"), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(invertedIndex_loadInvalid)
+{
+  std::mt19937 generator(2);
+  const SparseHistogramPerImage documents = generateDocuments(40, generator);
+
+  InvertedIndex index;
+  index.build(documents, nbWords);
+  index.save("test_invertedIndex_valid.bin");
+
+  std::vector<char> validFile;
+  {
+    std::ifstream in("test_invertedIndex_valid.bin", std::ios_base::binary);
+    validFile.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+  }
+
+  // header: magic, version, number of words, number of documents, number of posting bytes
+  const std::size_t nbDocsPos = 16;
+  const std::size_t offsetsPos = 32 + documents.size() * sizeof(DocId);
+  const std::size_t postingsPos = offsetsPos + (nbWords + 1) * sizeof(uint64_t);
+  BOOST_REQUIRE_GT(validFile.size(), postingsPos);
+
+  const auto checkInvalid = [&](const std::vector<char>& file)
+  {
+    {
+      std::ofstream out("test_invertedIndex_invalid.bin", std::ios_base::binary);
+      out.write(file.data(), file.size());
+    }
+    InvertedIndex loadedIndex;
+    BOOST_CHECK_THROW(loadedIndex.load("test_invertedIndex_invalid.bin"), std::runtime_error);
+    BOOST_CHECK(loadedIndex.empty());
+  };
+
+  // number of documents not consistent with the file size
+  {
+    std::vector<char> file = validFile;
+    const uint64_t nbDocs = uint64_t(1) << 40;
+    std::memcpy(&file[nbDocsPos], &nbDocs, sizeof(nbDocs));
+    checkInvalid(file);
+  }
+
+  // decreasing word offsets
+  {
+    std::vector<char> file = validFile;
+    const uint64_t lastOffset = file.size() - postingsPos;
+    std::memcpy(&file[offsetsPos + sizeof(uint64_t)], &lastOffset, sizeof(lastOffset));
+    checkInvalid(file);
+  }
+
+  // document index out of range (the deltas of the first postings fit in one byte)
+  {
+    std::vector<char> file = validFile;
+    file[postingsPos] = static_cast<char>(0x7F);
+    checkInvalid(file);
+  }
+
+  // last posting list not ending at its offset
+  {
+    std::vector<char> file = validFile;
+    file.back() = static_cast<char>(file.back() | 0x80);
+    checkInvalid(file);
+  }
+
+  // the valid file is still loaded
+  InvertedIndex loadedIndex;
+  loadedIndex.load("test_invertedIndex_valid.bin");
+  BOOST_CHECK(loadedIndex == index);
+}
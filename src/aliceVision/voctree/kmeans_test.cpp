@@ -43,8 +43,9 @@ BOOST_AUTO_TEST_CASE(kmeanInitializer)
   }
 
   voctree::InitKmeanspp initializer;
+  std::mt19937 generator(0);
 
-  initializer(featPtr, K, centers, voctree::L2<FeatureFloat, FeatureFloat>());
+  initializer(featPtr, K, centers, voctree::L2<FeatureFloat, FeatureFloat>(), generator);
 
   // it's difficult to check the result as it is random, just check there are no weird things
   BOOST_CHECK(voctree::checkVectorElements(centers, "initializer1"));
@@ -64,7 +65,7 @@ BOOST_AUTO_TEST_CASE(kmeanInitializer)
     }
   }
 
-  initializer(featPtr, K, centers, voctree::L2<FeatureFloat,FeatureFloat>());
+  initializer(featPtr, K, centers, voctree::L2<FeatureFloat,FeatureFloat>(), generator);
 
   // it's difficult to check the result as it is random, just check there are no weird things
   BOOST_CHECK(voctree::checkVectorElements(centers, "initializer2"));
@@ -103,6 +104,7 @@ BOOST_AUTO_TEST_CASE(kmeanInitializerVarying)
     FeatureFloatVector centers;
 
     voctree::InitKmeanspp initializer;
+    std::mt19937 initGenerator(0);
 
     features.reserve(FEATURENUMBER * K);
     featPtr.reserve(features.size());
@@ -118,7 +120,7 @@ BOOST_AUTO_TEST_CASE(kmeanInitializerVarying)
       }
     }
 
-    initializer(featPtr, K, centers, voctree::L2<FeatureFloat,FeatureFloat>());
+    initializer(featPtr, K, centers, voctree::L2<FeatureFloat,FeatureFloat>(), initGenerator);
 
     // it's difficult to check the result as it is random, just check there are no weird things
     BOOST_CHECK(voctree::checkVectorElements(centers, "initializer"));
@@ -289,3 +291,44 @@ BOOST_AUTO_TEST_CASE(kmeanVarying)
     }
   }
 }
+
+BOOST_AUTO_TEST_CASE(kmeanTriangleInequality)
+{
+  using namespace aliceVision;
+
+  ALICEVISION_LOG_DEBUG("Testing kmeans with and without the triangle inequality acceleration...");
+
+  const std::size_t DIMENSION = 16;
+  const std::size_t FEATURENUMBER = 5000;
+  const std::size_t K = 40;
+
+  typedef Eigen::Matrix<float, 1, DIMENSION> FeatureFloat;
+  typedef std::vector<FeatureFloat, Eigen::aligned_allocator<FeatureFloat> > FeatureFloatVector;
+
+  // random features without any cluster structure, so that many iterations are needed
+  FeatureFloatVector features;
+  features.reserve(FEATURENUMBER);
+  for(std::size_t i = 0; i < FEATURENUMBER; ++i)
+    features.push_back(FeatureFloat::Random(1, DIMENSION));
+
+  voctree::SimpleKmeans<FeatureFloat> kmeans(FeatureFloat::Zero());
+  kmeans.setVerbose(0);
+  kmeans.setMaxIterations(20);
+
+  FeatureFloatVector centers;
+  FeatureFloatVector centersLloyd;
+  std::vector<unsigned int> membership;
+  std::vector<unsigned int> membershipLloyd;
+
+  // the same seed gives the same initial centers
+  srand(0);
+  BOOST_CHECK(kmeans.getUseTriangleInequality());
+  const double sse = kmeans.cluster(features, K, centers, membership);
+
+  srand(0);
+  kmeans.setUseTriangleInequality(false);
+  const double sseLloyd = kmeans.cluster(features, K, centersLloyd, membershipLloyd);
+
+  BOOST_CHECK_CLOSE(sse, sseLloyd, 1e-6);
+  BOOST_CHECK(membership == membershipLloyd);
+}
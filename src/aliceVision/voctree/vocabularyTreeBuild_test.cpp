@@ -4,6 +4,7 @@
 // You can obtain one at https://mozilla.org/MPL/2.0/.
 
 #include <aliceVision/voctree/TreeBuilder.hpp>
+#include <aliceVision/feature/Descriptor.hpp>
 #include <aliceVision/system/Logger.hpp>
 
 #include <Eigen/Core>
@@ -11,6 +12,7 @@
 #include <iostream>
 #include <fstream>
 #include <vector>
+#include <random>
 
 #define BOOST_TEST_MODULE voctreeBuilder
 #include <boost/test/included/unit_test.hpp>
@@ -82,3 +84,113 @@ BOOST_AUTO_TEST_CASE(voctreeBuilder)
   }
 //  voctree::printFeatVector( features ); 
 }
+
+BOOST_AUTO_TEST_CASE(voctreeVersionedFile)
+{
+  using namespace aliceVision;
+
+  const std::string treeName = "testVersioned.tree";
+  const std::string quantizedTreeName = "testQuantized.tree";
+
+  const std::size_t DIMENSION = 8;
+  const std::size_t FEATURENUMBER = 50;
+  const std::size_t K = 4;
+  const std::size_t LEVELS = 2;
+  const std::size_t LEAVESNUMBER = std::pow(K, LEVELS);
+
+  typedef feature::Descriptor<float, DIMENSION> FeatureFloat;
+  typedef feature::Descriptor<unsigned char, DIMENSION> FeatureUChar;
+  typedef std::vector<FeatureFloat> FeatureFloatVector;
+
+  // well separated clusters with values in [0, 255] like SIFT descriptors
+  std::mt19937 generator(0);
+  std::uniform_real_distribution<float> noise(-10.f, 10.f);
+  FeatureFloatVector features;
+  features.reserve(FEATURENUMBER * LEAVESNUMBER);
+  for(std::size_t i = 0; i < LEAVESNUMBER; ++i)
+  {
+    for(std::size_t j = 0; j < FEATURENUMBER; ++j)
+    {
+      FeatureFloat feature(20.f);
+      feature[i % DIMENSION] += 200.f * (i / DIMENSION) + 20.f;
+      for(std::size_t d = 0; d < DIMENSION; ++d)
+        feature[d] += noise(generator);
+      features.push_back(feature);
+    }
+  }
+
+  voctree::TreeBuilder<FeatureFloat> builder(FeatureFloat(0));
+  builder.setVerbose(0);
+  builder.build(features, K, LEVELS);
+  builder.tree().save(treeName);
+  builder.tree().save(quantizedTreeName, voctree::EVocTreeCenterType::UINT8);
+
+  // the centers of a versioned file are used in place
+  voctree::VocabularyTree<FeatureFloat> mappedTree(treeName);
+  BOOST_CHECK(mappedTree.isMapped());
+  BOOST_CHECK(mappedTree == builder.tree());
+
+  // the quantized centers are used in place by a tree of uint8 centers
+  // and converted for a tree of float centers
+  voctree::VocabularyTree<FeatureUChar> quantizedTree(quantizedTreeName);
+  voctree::VocabularyTree<FeatureFloat> convertedTree(quantizedTreeName);
+  BOOST_CHECK(quantizedTree.isMapped());
+  BOOST_CHECK(!convertedTree.isMapped());
+  BOOST_CHECK_EQUAL(quantizedTree.words(), builder.tree().words());
+
+  for(const FeatureFloat& feature : features)
+  {
+    const voctree::Word word = builder.tree().quantize(feature);
+    BOOST_CHECK_EQUAL(mappedTree.quantize(feature), word);
+    BOOST_CHECK_EQUAL(quantizedTree.quantize(feature), word);
+    BOOST_CHECK_EQUAL(convertedTree.quantize(feature), word);
+  }
+
+  // a modifiable tree owns its centers
+  voctree::MutableVocabularyTree<FeatureFloat> mutableTree;
+  mutableTree.load(treeName);
+  BOOST_CHECK(!mutableTree.isMapped());
+  BOOST_CHECK_EQUAL(mutableTree.centers().size(), builder.tree().centers().size());
+}
+
+BOOST_AUTO_TEST_CASE(voctreeBuilderDeterministic)
+{
+  using namespace aliceVision;
+
+  const std::size_t DIMENSION = 8;
+  const std::size_t FEATURENUMBER = 2000;
+  const std::size_t K = 4;
+  const std::size_t LEVELS = 3;
+
+  typedef feature::Descriptor<float, DIMENSION> FeatureFloat;
+  typedef std::vector<FeatureFloat> FeatureFloatVector;
+
+  // features without any cluster structure, so that the result depends on the initialization
+  std::mt19937 generator(0);
+  std::uniform_real_distribution<float> values(0.f, 255.f);
+  FeatureFloatVector features(FEATURENUMBER);
+  for(FeatureFloat& feature : features)
+  {
+    for(std::size_t d = 0; d < DIMENSION; ++d)
+      feature[d] = values(generator);
+  }
+
+  // the subsets of a level are clustered in parallel, each one with its own
+  // generator: the same seed gives the same tree
+  voctree::TreeBuilder<FeatureFloat> builder(FeatureFloat(0));
+  builder.setVerbose(0);
+  builder.kmeans().setRestarts(2);
+  builder.setSeed(42);
+  builder.build(features, K, LEVELS);
+  const voctree::MutableVocabularyTree<FeatureFloat> firstTree = builder.tree();
+
+  // rand() must not be used anymore
+  std::srand(1234);
+  builder.build(features, K, LEVELS);
+  BOOST_CHECK(builder.tree() == firstTree);
+
+  // another seed gives another tree
+  builder.setSeed(43);
+  builder.build(features, K, LEVELS);
+  BOOST_CHECK(!(builder.tree() == firstTree));
+}
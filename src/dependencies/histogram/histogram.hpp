@@ -72,18 +72,26 @@ public:
   // value that is in range for this histogram or
   // the under-/overflow count if it is not in range.
   void Add(const T& x)
+  {
+    Add(x, 1);
+  }
+
+  // Increase by count the count for the bin that holds a
+  // value that is in range for this histogram or
+  // the under-/overflow count if it is not in range.
+  void Add(const T& x, size_t count)
   {
     if( x < Start )
-      ++underflow;
+      underflow += count;
     else if( x > End )
-      ++overflow;
+      overflow += count;
     else
     {
       const size_t i(
         static_cast<size_t>(
         (x-Start)*nBins_by_interval) );
       // clamp for the particular case when (x == End)
-      ++freq[std::min(i, nBins-1)];
+      freq[std::min(i, nBins-1)] += count;
     }
   }
   // Get the sum of all counts in the histogram.
@@ -0,0 +1,103 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "aliceVision/sfm/PackedLandmarks.hpp"
+#include "aliceVision/sfm/SfMData.hpp"
+#include "aliceVision/system/Timer.hpp"
+
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+
+using namespace aliceVision;
+using namespace aliceVision::sfm;
+
+/**
+ * Microbenchmark of the landmarks storages: memory and iteration time of the
+ * Landmarks HashMap against the PackedLandmarks structure of arrays.
+ */
+
+namespace {
+
+Landmarks generateLandmarks(std::size_t nbLandmarks, std::size_t nbViews, std::mt19937& generator)
+{
+  std::uniform_real_distribution<double> coordinate(-10.0, 10.0);
+  std::uniform_int_distribution<std::size_t> nbObservations(2, 8);
+  std::uniform_int_distribution<IndexT> viewId(0, nbViews - 1);
+
+  Landmarks landmarks;
+  for(std::size_t l = 0; l < nbLandmarks; ++l)
+  {
+    Landmark& landmark = landmarks[3 * l + 1];
+    landmark.X = Vec3(coordinate(generator), coordinate(generator), coordinate(generator));
+    const std::size_t n = nbObservations(generator);
+    for(std::size_t o = 0; o < n; ++o)
+      landmark.observations[viewId(generator)] = Observation(Vec2(coordinate(generator), coordinate(generator)), l * 10 + o);
+  }
+  return landmarks;
+}
+
+/// Read-only pass over all the observations, written once for both storages
+template <typename LandmarksT>
+double sumObservations(const LandmarksT& landmarks)
+{
+  double sum = 0.0;
+  for(const auto& landmarkIt : landmarks)
+  {
+    const auto& landmark = landmarkIt.second;
+    for(const auto& observationIt : landmark.observations)
+      sum += (observationIt.second.x - landmark.X.template head<2>()).norm();
+  }
+  return sum;
+}
+
+/// Iterate over all the observations nbPasses times, return the time per pass in milliseconds
+template <typename LandmarksT>
+double passTime(const LandmarksT& landmarks, std::size_t nbPasses, double& sum)
+{
+  sum = 0.0;
+  system::Timer timer;
+  for(std::size_t i = 0; i < nbPasses; ++i)
+    sum += sumObservations(landmarks);
+  return timer.elapsedMs() / nbPasses;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+  // usage: aliceVision_samples_landmarksStorageBenchmark [nbLandmarks] [nbViews] [nbPasses]
+  const std::size_t nbLandmarks = (argc > 1) ? std::atoi(argv[1]) : 1000000;
+  const std::size_t nbViews = (argc > 2) ? std::atoi(argv[2]) : 1000;
+  const std::size_t nbPasses = (argc > 3) ? std::atoi(argv[3]) : 10;
+
+  std::mt19937 generator(0);
+  const Landmarks landmarks = generateLandmarks(nbLandmarks, nbViews, generator);
+
+  system::Timer timer;
+  const PackedLandmarks packed(landmarks);
+  const double packTime = timer.elapsedMs();
+
+  double landmarksSum, packedSum;
+  const double landmarksTime = passTime(landmarks, nbPasses, landmarksSum);
+  const double packedTime = passTime(packed, nbPasses, packedSum);
+
+  std::cout << landmarks.size() << " landmarks, " << packed.nbObservations() << " observations" << std::endl
+            << std::left << std::setw(12) << "storage" << std::right
+            << std::setw(14) << "memory (MB)" << std::setw(14) << "pass (ms)" << std::endl
+            << std::fixed << std::setprecision(1)
+            << std::left << std::setw(12) << "HashMap" << std::right
+            << std::setw(14) << PackedLandmarks::estimateMemorySize(landmarks) / (1024.0 * 1024.0)
+            << std::setw(14) << landmarksTime << std::endl
+            << std::left << std::setw(12) << "packed" << std::right
+            << std::setw(14) << packed.memorySize() / (1024.0 * 1024.0)
+            << std::setw(14) << packedTime << std::endl
+            << "packing: " << packTime << " ms" << std::endl;
+
+  // both passes must give the same result
+  return (std::abs(landmarksSum - packedSum) <= 1e-6 * std::abs(landmarksSum)) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,218 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "aliceVision/multiview/essentialFivePointSolver.hpp"
+#include "aliceVision/multiview/fundamentalKernelSolver.hpp"
+#include "aliceVision/multiview/homographyKernelSolver.hpp"
+#include "aliceVision/multiview/projection.hpp"
+#include "aliceVision/multiview/resection/P3PSolver.hpp"
+#include "aliceVision/system/Timer.hpp"
+
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace aliceVision;
+
+/**
+ * Microbenchmark of the minimal solvers: number of solver calls per second of the
+ * fixed size implementations against the previous dynamic size implementations
+ * (zero padded square systems solved by SVD, heap allocated matrices).
+ */
+
+namespace {
+
+/// Two views of random points, in normalized camera coordinates
+struct TwoViewProblem
+{
+  Mat x1, x2;
+  /// Unit bearing vectors of the first view and the 3D points, for P3P
+  Mat3 bearings, X;
+};
+
+std::vector<TwoViewProblem> generateProblems(std::size_t nbProblems, int nbPoints, std::mt19937& generator)
+{
+  std::uniform_real_distribution<double> position(-1.0, 1.0);
+  std::uniform_real_distribution<double> depth(4.0, 8.0);
+  std::uniform_real_distribution<double> angle(-0.2, 0.2);
+
+  std::vector<TwoViewProblem> problems(nbProblems);
+  for(TwoViewProblem& problem : problems)
+  {
+    const Mat3 R = (Eigen::AngleAxisd(angle(generator), Vec3::UnitX()) *
+                    Eigen::AngleAxisd(angle(generator), Vec3::UnitY()) *
+                    Eigen::AngleAxisd(angle(generator), Vec3::UnitZ())).toRotationMatrix();
+    const Vec3 t(position(generator), 0.2 * position(generator), 0.1 * position(generator));
+
+    problem.x1.resize(2, nbPoints);
+    problem.x2.resize(2, nbPoints);
+    for(int i = 0; i < nbPoints; ++i)
+    {
+      const Vec3 X1(position(generator), position(generator), depth(generator));
+      const Vec3 X2 = R * X1 + t;
+      problem.x1.col(i) = X1.head<2>() / X1(2);
+      problem.x2.col(i) = X2.head<2>() / X2(2);
+      if(i < 3)
+      {
+        problem.bearings.col(i) = X1.normalized();
+        problem.X.col(i) = X1;
+      }
+    }
+  }
+  return problems;
+}
+
+// Previous dynamic size implementations of the minimal solvers
+
+void sevenPointDynamic(const Mat& x1, const Mat& x2, std::vector<Mat3>* Fs)
+{
+  Eigen::Matrix<double, 9, 9> A = Mat::Zero(9, 9);
+  fundamental::kernel::EncodeEpipolarEquation(x1, x2, &A);
+  Vec9 f1, f2;
+  Nullspace2(&A, &f1, &f2);
+  fundamental::kernel::SolveSevenPointRankConstraint(f1, f2, Fs);
+}
+
+void eightPointDynamic(const Mat& x1, const Mat& x2, std::vector<Mat3>* Fs)
+{
+  Eigen::Matrix<double, 9, 9> A = Mat::Zero(9, 9);
+  fundamental::kernel::EncodeEpipolarEquation(x1, x2, &A);
+  Vec9 f;
+  Nullspace(&A, &f);
+  Fs->push_back(Map<RMat3>(f.data()));
+}
+
+void fourPointDynamic(const Mat& x, const Mat& y, std::vector<Mat3>* Hs)
+{
+  Eigen::Matrix<double, 16, 9> L = Mat::Zero(16, 9);
+  homography::kernel::BuildActionMatrix(L, x, y);
+  Vec9 h;
+  Nullspace(&L, &h);
+  Hs->push_back(Map<RMat3>(h.data()));
+}
+
+void fivePointDynamic(const Mat& x1, const Mat& x2, std::vector<Mat3>* Es)
+{
+  const Eigen::Matrix<double, 9, 4> E_basis = FivePointsNullspaceBasis(Mat2X(x1), Mat2X(x2));
+  const Eigen::Matrix<double, 10, 20> E_constraints = FivePointsPolynomialConstraints(E_basis);
+  FivePointsRelativePoseFromConstraints(E_basis, E_constraints, Es);
+}
+
+void p3pDynamic(const TwoViewProblem& problem, std::vector<Mat34>* Ps)
+{
+  Mat solutions = Mat(3, 4 * 4);
+  if(resection::compute_P3P_Poses(problem.bearings, problem.X, solutions))
+  {
+    for(int i = 0; i < 4; ++i)
+    {
+      const Mat3 R = solutions.block<3, 3>(0, i * 4 + 1);
+      Mat34 P;
+      P_From_KRt(Mat3::Identity(), R, -R * solutions.col(i * 4), &P);
+      Ps->push_back(P);
+    }
+  }
+}
+
+void p3pFixed(const TwoViewProblem& problem, std::vector<Mat34>* Ps)
+{
+  Eigen::Matrix<double, 3, 16> solutions;
+  if(resection::compute_P3P_Poses(problem.bearings, problem.X, solutions))
+  {
+    for(int i = 0; i < 4; ++i)
+    {
+      const Mat3 R = solutions.block<3, 3>(0, i * 4 + 1);
+      Mat34 P;
+      P_From_KRt(Mat3::Identity(), R, -R * solutions.col(i * 4), &P);
+      Ps->push_back(P);
+    }
+  }
+}
+
+/// Call the solver on all the problems until minDuration seconds, return the number of calls per second
+template <typename ModelT, typename SolverT>
+double callsPerSecond(const std::vector<TwoViewProblem>& problems, double minDuration, SolverT solver, double& modelsPerCall)
+{
+  std::vector<ModelT> models;
+  models.reserve(10);
+  std::size_t nbCalls = 0;
+  std::size_t nbModels = 0;
+  system::Timer timer;
+  do
+  {
+    for(const TwoViewProblem& problem : problems)
+    {
+      models.clear();
+      solver(problem, models);
+      nbModels += models.size();
+    }
+    nbCalls += problems.size();
+  }
+  while(timer.elapsed() < minDuration);
+  const double elapsed = timer.elapsed();
+  modelsPerCall = static_cast<double>(nbModels) / nbCalls;
+  return nbCalls / elapsed;
+}
+
+template <typename ModelT, typename DynamicSolverT, typename FixedSolverT>
+void benchmark(const std::string& name, const std::vector<TwoViewProblem>& problems, double minDuration,
+               DynamicSolverT dynamicSolver, FixedSolverT fixedSolver)
+{
+  double dynamicModels, fixedModels;
+  const double dynamicRate = callsPerSecond<ModelT>(problems, minDuration, dynamicSolver, dynamicModels);
+  const double fixedRate = callsPerSecond<ModelT>(problems, minDuration, fixedSolver, fixedModels);
+
+  // the number of models per call checks that both versions find the same solutions
+  std::cout << std::left << std::setw(24) << name << std::right
+            << std::setw(14) << static_cast<std::size_t>(dynamicRate)
+            << std::setw(14) << static_cast<std::size_t>(fixedRate)
+            << std::setw(10) << std::fixed << std::setprecision(2) << fixedRate / dynamicRate << "x"
+            << std::setw(12) << dynamicModels
+            << std::setw(12) << fixedModels
+            << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+  // usage: aliceVision_samples_minimalSolversBenchmark [nbProblems] [minDurationPerSolver(s)]
+  const std::size_t nbProblems = (argc > 1) ? std::atoi(argv[1]) : 1000;
+  const double minDuration = (argc > 2) ? std::atof(argv[2]) : 1.0;
+
+  std::mt19937 generator(0);
+  const std::vector<TwoViewProblem> problems4 = generateProblems(nbProblems, 4, generator);
+  const std::vector<TwoViewProblem> problems5 = generateProblems(nbProblems, 5, generator);
+  const std::vector<TwoViewProblem> problems7 = generateProblems(nbProblems, 7, generator);
+  const std::vector<TwoViewProblem> problems8 = generateProblems(nbProblems, 8, generator);
+
+  std::cout << std::left << std::setw(24) << "solver (calls/s)" << std::right
+            << std::setw(14) << "dynamic" << std::setw(14) << "fixed" << std::setw(11) << "speedup"
+            << std::setw(12) << "models dyn." << std::setw(12) << "models fix." << std::endl;
+
+  benchmark<Mat3>("fundamental 7 points", problems7, minDuration,
+    [](const TwoViewProblem& p, std::vector<Mat3>& Fs) { sevenPointDynamic(p.x1, p.x2, &Fs); },
+    [](const TwoViewProblem& p, std::vector<Mat3>& Fs) { fundamental::kernel::SevenPointSolver::Solve(p.x1, p.x2, &Fs); });
+
+  benchmark<Mat3>("fundamental 8 points", problems8, minDuration,
+    [](const TwoViewProblem& p, std::vector<Mat3>& Fs) { eightPointDynamic(p.x1, p.x2, &Fs); },
+    [](const TwoViewProblem& p, std::vector<Mat3>& Fs) { fundamental::kernel::EightPointSolver::Solve(p.x1, p.x2, &Fs); });
+
+  benchmark<Mat3>("homography 4 points", problems4, minDuration,
+    [](const TwoViewProblem& p, std::vector<Mat3>& Hs) { fourPointDynamic(p.x1, p.x2, &Hs); },
+    [](const TwoViewProblem& p, std::vector<Mat3>& Hs) { homography::kernel::FourPointSolver::Solve(p.x1, p.x2, &Hs); });
+
+  benchmark<Mat3>("essential 5 points", problems5, minDuration,
+    [](const TwoViewProblem& p, std::vector<Mat3>& Es) { fivePointDynamic(p.x1, p.x2, &Es); },
+    [](const TwoViewProblem& p, std::vector<Mat3>& Es) { FivePointsRelativePose(p.x1, p.x2, &Es); });
+
+  benchmark<Mat34>("P3P", problems4, minDuration,
+    [](const TwoViewProblem& p, std::vector<Mat34>& Ps) { p3pDynamic(p, &Ps); },
+    [](const TwoViewProblem& p, std::vector<Mat34>& Ps) { p3pFixed(p, &Ps); });
+
+  return EXIT_SUCCESS;
+}
@@ -126,7 +126,7 @@ int main(int argc, char ** argv)
   }
 
   // Read the matches
-  matching::PairwiseMatches pairwiseMatches;
+  matching::PackedPairwiseMatches pairwiseMatches;
   if (!loadPairwiseMatches(pairwiseMatches, sfm_data, matchesFolder, describerMethodTypes, matchesGeometricModel))
   {
     std::cerr << "\nInvalid matches file." << std::endl;
@@ -138,9 +138,8 @@ int main(int argc, char ** argv)
   //---------------------------------------
   track::TracksMap map_tracks;
   {
-    const aliceVision::matching::PairwiseMatches & map_Matches = pairwiseMatches;
     track::TracksBuilder tracksBuilder;
-    tracksBuilder.Build(map_Matches);
+    tracksBuilder.Build(pairwiseMatches);
     tracksBuilder.Filter();
     tracksBuilder.ExportToSTL(map_tracks);
   }
@@ -5,11 +5,13 @@
 
 #include "aliceVision/sfm/sfm.hpp"
 #include "aliceVision/image/image.hpp"
+#include "aliceVision/image/ImageProcessingPipeline.hpp"
 
 #include <boost/program_options.hpp>
 #include <boost/progress.hpp>
 
 #include <stdlib.h>
+#include <mutex>
 
 using namespace aliceVision;
 using namespace aliceVision::camera;
@@ -25,6 +27,8 @@ int main(int argc, char *argv[])
   std::string verboseLevel = system::EVerboseLevel_enumToString(system::Logger::getDefaultVerboseLevel());
   std::string sfmDataFilename;
   std::string outDirectory;
+  ImagePipelineParams pipelineParams;
+  std::size_t maxInFlightMemory = pipelineParams.maxInFlightBytes / (1024 * 1024);
 
   po::options_description allParams(
     "Export undistorted images related to a sfm_data file.\n"
@@ -37,12 +41,23 @@ int main(int argc, char *argv[])
     ("output,o", po::value<std::string>(&outDirectory)->required(),
       "Output folder.");
 
+  po::options_description optionalParams("Optional parameters");
+  optionalParams.add_options()
+    ("nbDecodeThreads", po::value<std::size_t>(&pipelineParams.nbDecodeThreads)->default_value(pipelineParams.nbDecodeThreads),
+      "Number of threads reading the images.")
+    ("nbTransformThreads", po::value<std::size_t>(&pipelineParams.nbTransformThreads)->default_value(pipelineParams.nbTransformThreads),
+      "Number of threads undistorting the images (0: use all the cores).")
+    ("nbEncodeThreads", po::value<std::size_t>(&pipelineParams.nbEncodeThreads)->default_value(pipelineParams.nbEncodeThreads),
+      "Number of threads writing the images.")
+    ("maxInFlightMemory", po::value<std::size_t>(&maxInFlightMemory)->default_value(maxInFlightMemory),
+      "Maximum memory used by the images being processed (in MB).");
+
   po::options_description logParams("Log parameters");
   logParams.add_options()
     ("verboseLevel,v", po::value<std::string>(&verboseLevel)->default_value(verboseLevel),
       "verbosity level (fatal,  error, warning, info, debug, trace).");
 
-  allParams.add(requiredParams).add(logParams);
+  allParams.add(requiredParams).add(optionalParams).add(logParams);
 
   po::variables_map vm;
   try
@@ -72,6 +87,8 @@ int main(int argc, char *argv[])
   // set verbose level
   system::Logger::get()->setLogLevel(verboseLevel);
 
+  pipelineParams.maxInFlightBytes = maxInFlightMemory * 1024 * 1024;
+
   // Create output dir
   if (!stlplus::folder_exists(outDirectory))
     stlplus::folder_create( outDirectory );
@@ -85,31 +102,25 @@ int main(int argc, char *argv[])
 
   bool bOk = true;
   {
-    // Export views as undistorted images (those with valid Intrinsics)
-    Image<RGBColor> image, image_ud;
-    boost::progress_display my_progress_bar( sfm_data.GetViews().size() );
+    // Copy the images without distortion, the others are undistorted below
+    std::vector<std::pair<std::string, std::string> > imagesToUndistort;
+    std::vector<const IntrinsicBase*> imagesIntrinsic;
     for(Views::const_iterator iter = sfm_data.GetViews().begin();
-      iter != sfm_data.GetViews().end(); ++iter, ++my_progress_bar)
+      iter != sfm_data.GetViews().end(); ++iter)
     {
       const View * view = iter->second.get();
       bool bIntrinsicDefined = view->getIntrinsicId() != UndefinedIndexT &&
         sfm_data.GetIntrinsics().find(view->getIntrinsicId()) != sfm_data.GetIntrinsics().end();
 
-      Intrinsics::const_iterator iterIntrinsic = sfm_data.GetIntrinsics().find(view->getIntrinsicId());
-
       const std::string srcImage = stlplus::create_filespec(sfm_data.s_root_path, view->getImagePath());
       const std::string dstImage = stlplus::create_filespec(
         outDirectory, stlplus::filename_part(srcImage));
 
-      const IntrinsicBase * cam = iterIntrinsic->second.get();
-      if (cam->isValid() && cam->have_disto())
+      const IntrinsicBase * cam = bIntrinsicDefined ? sfm_data.GetIntrinsics().at(view->getIntrinsicId()).get() : nullptr;
+      if (cam && cam->isValid() && cam->have_disto())
       {
-        // undistort the image and save it
-        if (ReadImage( srcImage.c_str(), &image))
-        {
-          UndistortImage(image, cam, image_ud, BLACK);
-          bOk &= WriteImage(dstImage.c_str(), image_ud);
-        }
+        imagesToUndistort.emplace_back(srcImage, dstImage);
+        imagesIntrinsic.push_back(cam);
       }
       else // (no distortion)
       {
@@ -117,6 +128,40 @@ int main(int argc, char *argv[])
         stlplus::file_copy(srcImage, dstImage);
       }
     }
+
+    // Export views as undistorted images (those with valid Intrinsics)
+    // The images are read, undistorted and written concurrently
+    boost::progress_display my_progress_bar( imagesToUndistort.size() );
+    std::mutex progressMutex;
+    // The undistortion maps are computed once per camera and image size
+    UndistortionMapCache undistortionMaps;
+
+    const ImageProcessingPipeline<RGBColor> pipeline(pipelineParams);
+    const ImagePipelineStats stats = pipeline.run(imagesToUndistort.size(),
+      // read
+      [&](std::size_t i, Image<RGBColor>& image)
+      {
+        return ReadImage(imagesToUndistort[i].first.c_str(), &image) != 0;
+      },
+      // undistort
+      [&](std::size_t i, Image<RGBColor>& image)
+      {
+        Image<RGBColor> image_ud;
+        UndistortImage(image, *undistortionMaps.get(*imagesIntrinsic[i], image.Width(), image.Height()), image_ud, BLACK);
+        image.swap(image_ud);
+      },
+      // write
+      [&](std::size_t i, const Image<RGBColor>& image)
+      {
+        const bool isWritten = WriteImage(imagesToUndistort[i].second.c_str(), image) != 0;
+
+        std::lock_guard<std::mutex> lock(progressMutex);
+        bOk &= isWritten;
+        ++my_progress_bar;
+        return isWritten;
+      });
+
+    ALICEVISION_LOG_INFO(stats);
   }
 
   // Exit program
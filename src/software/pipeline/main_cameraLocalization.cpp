@@ -10,6 +10,7 @@
 #include <aliceVision/localization/CCTagLocalizer.hpp>
 #endif
 #include <aliceVision/localization/LocalizationResult.hpp>
+#include <aliceVision/localization/LocalizationPipeline.hpp>
 #include <aliceVision/localization/optimization.hpp>
 #include <aliceVision/image/io.hpp>
 #include <aliceVision/dataio/FeedProvider.hpp>
@@ -143,6 +144,8 @@ int main(int argc, char** argv)
   /// enable/disable the robust matching (geometric validation) when matching query image
   /// and databases images
   bool robustMatching = true;
+  /// Number of database views whose matchers are kept in memory between frames
+  std::size_t matcherCacheSize = 0;
   
   /// the Alembic export file
   std::string exportAlembicFile = "trackedcameras.abc";
@@ -167,6 +170,12 @@ int main(int argc, char** argv)
   /// whether to save visual debug info
   std::string visualDebug = "";
 
+  // parameters for the pipelined localization
+  /// number of feature extraction threads, if 0 the frames are processed serially
+  std::size_t nbExtractionThreads = 0;
+  /// maximum number of frames waiting between two stages of the pipeline
+  std::size_t pipelineBufferSize = 4;
+
   po::options_description allParams(
       "This program takes as input a media (image, image sequence, video) and a database (vocabulary tree, 3D scene data) \n"
       "and returns for each frame a pose estimation for the camera.");
@@ -199,6 +208,12 @@ int main(int argc, char** argv)
           "Calibration file")
       ("refineIntrinsics", po::value<bool>(&refineIntrinsics), 
           "Enable/Disable camera intrinsics refinement for each localized image")
+      ("nbExtractionThreads", po::value<std::size_t>(&nbExtractionThreads)->default_value(nbExtractionThreads),
+          "Enable the pipelined localization: the frames are decoded by a dedicated thread "
+          "and their features are extracted by this number of threads while the previous frames "
+          "are localized (0 = Disable, the frames are processed serially)")
+      ("pipelineBufferSize", po::value<std::size_t>(&pipelineBufferSize)->default_value(pipelineBufferSize),
+          "Maximum number of frames waiting between two stages of the pipelined localization")
       ("reprojectionError", po::value<double>(&resectionErrorMax)->default_value(resectionErrorMax), 
           "Maximum reprojection error (in pixels) allowed for resectioning. If set "
           "to 0 it lets the ACRansac select an optimal value.");
@@ -230,6 +245,9 @@ int main(int argc, char** argv)
       ("robustMatching", po::value<bool>(&robustMatching)->default_value(robustMatching), 
           "[voctree] Enable/Disable the robust matching between query and database images, "
           "all putative matches will be considered.")
+      ("matcherCacheSize", po::value<std::size_t>(&matcherCacheSize)->default_value(matcherCacheSize),
+          "[voctree] Number of database images whose matching structures are kept "
+          "in memory and reused by the following frames (0 = Disable)")
 // cctag specific options
 #if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_CCTAG)
       ("nNearestKeyFrames", po::value<size_t>(&nNearestKeyFrames)->default_value(nNearestKeyFrames), 
@@ -380,6 +398,7 @@ int main(int argc, char** argv)
     tmpParam->_matchingError = matchingErrorMax;
     tmpParam->_nbFrameBufferMatching = nbFrameBufferMatching;
     tmpParam->_useRobustMatching = robustMatching;
+    tmpParam->_matcherCacheSize = matcherCacheSize;
   }
   
   assert(localizer);
@@ -432,32 +451,18 @@ int main(int argc, char** argv)
   bacc::accumulator_set<double, bacc::stats<bacc::tag::mean, bacc::tag::min, bacc::tag::max, bacc::tag::sum > > stats;
   
   std::vector<localization::LocalizationResult> vec_localizationResults;
-  
-  while(feed.readImage(imageGrey, queryIntrinsics, currentImgName, hasIntrinsics))
+
+  // save the result of the current frame
+  const auto saveFrameResult = [&](const camera::PinholeRadialK3& frameIntrinsics,
+                                   const localization::LocalizationResult& localizationResult)
   {
-    ALICEVISION_COUT("******************************");
-    ALICEVISION_COUT("FRAME " << myToString(frameCounter,4));
-    ALICEVISION_COUT("******************************");
-    localization::LocalizationResult localizationResult;
-    auto detect_start = std::chrono::steady_clock::now();
-    localizer->localize(imageGrey, 
-                       param.get(),
-                       hasIntrinsics /*useInputIntrinsics*/,
-                       queryIntrinsics,
-                       localizationResult,
-                       currentImgName);
-    auto detect_end = std::chrono::steady_clock::now();
-    auto detect_elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(detect_end - detect_start);
-    ALICEVISION_COUT("\nLocalization took  " << detect_elapsed.count() << " [ms]");
-    stats(detect_elapsed.count());
-    
     vec_localizationResults.emplace_back(localizationResult);
 
     // save data
     if(localizationResult.isValid())
     {
 #if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_ALEMBIC)
-      exporter.addCameraKeyframe(localizationResult.getPose(), &queryIntrinsics, currentImgName, frameCounter, frameCounter);
+      exporter.addCameraKeyframe(localizationResult.getPose(), &frameIntrinsics, currentImgName, frameCounter, frameCounter);
 #endif
       
       goodFrameCounter++;
@@ -471,7 +476,52 @@ int main(int argc, char** argv)
 #endif
     }
     ++frameCounter;
-    feed.goToNextFrame();
+  };
+
+  if(nbExtractionThreads > 0)
+  {
+    // decoding, feature extraction and localization of consecutive frames overlap
+    localization::LocalizationPipeline pipeline(*localizer, param.get(), nbExtractionThreads, pipelineBufferSize);
+
+    const localization::LocalizationPipelineStats pipelineStats = pipeline.run(feed,
+      [&](std::size_t frameId,
+          const std::string& imagePath,
+          const camera::PinholeRadialK3& frameIntrinsics,
+          const localization::LocalizationResult& localizationResult)
+      {
+        ALICEVISION_COUT("FRAME " << myToString(frameId,4) << " processed");
+        currentImgName = imagePath;
+        saveFrameResult(frameIntrinsics, localizationResult);
+      });
+
+    // the time taken for each frame is its latency through the whole pipeline
+    for(const double latency : pipelineStats.latenciesMs)
+      stats(latency);
+    ALICEVISION_COUT(pipelineStats);
+  }
+  else
+  {
+    while(feed.readImage(imageGrey, queryIntrinsics, currentImgName, hasIntrinsics))
+    {
+      ALICEVISION_COUT("******************************");
+      ALICEVISION_COUT("FRAME " << myToString(frameCounter,4));
+      ALICEVISION_COUT("******************************");
+      localization::LocalizationResult localizationResult;
+      auto detect_start = std::chrono::steady_clock::now();
+      localizer->localize(imageGrey, 
+                         param.get(),
+                         hasIntrinsics /*useInputIntrinsics*/,
+                         queryIntrinsics,
+                         localizationResult,
+                         currentImgName);
+      auto detect_end = std::chrono::steady_clock::now();
+      auto detect_elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(detect_end - detect_start);
+      ALICEVISION_COUT("\nLocalization took  " << detect_elapsed.count() << " [ms]");
+      stats(detect_elapsed.count());
+
+      saveFrameResult(queryIntrinsics, localizationResult);
+      feed.goToNextFrame();
+    }
   }
 
   if(wantsBinaryOutput)
@@ -14,6 +14,7 @@
 #include <aliceVision/matchingImageCollection/matchingCommon.hpp>
 #include <aliceVision/matchingImageCollection/ImageCollectionMatcher_generic.hpp>
 #include <aliceVision/matchingImageCollection/ImageCollectionMatcher_cascadeHashing.hpp>
+#include <aliceVision/matchingImageCollection/ImageCollectionMatcher_productQuantization.hpp>
 #include <aliceVision/matchingImageCollection/GeometricFilter.hpp>
 #include <aliceVision/matchingImageCollection/GeometricFilterMatrix_F_AC.hpp>
 #include <aliceVision/matchingImageCollection/GeometricFilterMatrix_E_AC.hpp>
@@ -57,7 +58,8 @@ enum EPairMode
   PAIR_FROM_FILE  = 2
 };
 
-void getStatsMap(const PairwiseMatches& map)
+template <typename PairwiseMatchesT>
+void getStatsMap(const PairwiseMatchesT& map)
 {
 #ifdef ALICEVISION_DEBUG_MATCHING
   std::map<int,int> stats;
@@ -106,9 +108,12 @@ int main(int argc, char **argv)
   int rangeStart = -1;
   int rangeSize = 0;
   std::string nearestMatchingMethod = "ANN_L2";
+  std::string loadCodebooksFolder;
+  std::string saveCodebooksFolder;
   std::string geometricEstimatorName = robustEstimation::ERobustEstimator_enumToString(robustEstimation::ERobustEstimator::ACRANSAC);
   bool savePutativeMatches = false;
   bool guidedMatching = false;
+  bool prebuildIndexes = false;
   int maxIteration = 2048;
   bool matchFilePerImage = false;
   size_t numMatchesToKeep = 0;
@@ -151,8 +156,14 @@ int main(int argc, char **argv)
       "* CASCADE_HASHING_L2: L2 Cascade Hashing matching\n"
       "* FAST_CASCADE_HASHING_L2: L2 Cascade Hashing with precomputed hashed regions\n"
       "(faster than CASCADE_HASHING_L2 but use more memory)\n"
+      "* PRODUCT_QUANTIZATION_L2: L2 matching of product quantized descriptors with exact re-ranking,\n"
+      "one codebook is trained for all the images (8x less descriptor data scanned for SIFT)\n"
       "For Binary based descriptor:\n"
       "* BRUTE_FORCE_HAMMING: BruteForce Hamming matching")
+    ("loadCodebooksFolder", po::value<std::string>(&loadCodebooksFolder)->default_value(loadCodebooksFolder),
+      "PRODUCT_QUANTIZATION_L2: folder of the codebooks (<describerType>.pq) loaded instead of trained.")
+    ("saveCodebooksFolder", po::value<std::string>(&saveCodebooksFolder)->default_value(saveCodebooksFolder),
+      "PRODUCT_QUANTIZATION_L2: folder where the codebooks (<describerType>.pq) are saved.")
     ("geometricEstimator", po::value<std::string>(&geometricEstimatorName)->default_value(geometricEstimatorName),
       "Geometric estimator:\n"
       "* acransac: A-Contrario Ransac\n"
@@ -161,6 +172,9 @@ int main(int argc, char **argv)
       "Save putative matches.")
     ("guidedMatching", po::value<bool>(&guidedMatching)->default_value(guidedMatching),
       "Use the found model to improve the pairwise correspondences.")
+    ("prebuildIndexes", po::value<bool>(&prebuildIndexes)->default_value(prebuildIndexes),
+      "Build the matching structures of all the images in parallel before matching, they are all kept in memory.\n"
+      "Not available with the ANN_L2 matcher.")
     ("matchFilePerImage", po::value<bool>(&matchFilePerImage)->default_value(matchFilePerImage),
       "Save matches in a separate file per image.")
     ("distanceRatio", po::value<float>(&distRatio)->default_value(distRatio),
@@ -248,6 +262,18 @@ int main(int argc, char **argv)
     featuresFolder = matchesFolder;
   }
 
+  if(!loadCodebooksFolder.empty() && !stlplus::is_folder(loadCodebooksFolder))
+  {
+    std::cerr << "\nInvalid codebooks folder: " << loadCodebooksFolder << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  if(!saveCodebooksFolder.empty() && !stlplus::is_folder(saveCodebooksFolder) && !stlplus::folder_create(saveCodebooksFolder))
+  {
+    std::cerr << "\nCannot create the codebooks folder: " << saveCodebooksFolder << std::endl;
+    return EXIT_FAILURE;
+  }
+
   EGeometricModel geometricModelToCompute = FUNDAMENTAL_MATRIX;
   if(geometricModel.size() != 1)
   {
@@ -345,7 +371,10 @@ int main(int argc, char **argv)
 
   // Allocate the right Matcher according the Matching requested method
   EMatcherType collectionMatcherType = EMatcherType_stringToEnum(nearestMatchingMethod);
-  std::unique_ptr<IImageCollectionMatcher> imageCollectionMatcher = createImageCollectionMatcher(collectionMatcherType, distRatio);
+  std::unique_ptr<IImageCollectionMatcher> imageCollectionMatcher = createImageCollectionMatcher(collectionMatcherType, distRatio, prebuildIndexes);
+
+  if(ImageCollectionMatcher_productQuantization* pqMatcher = dynamic_cast<ImageCollectionMatcher_productQuantization*>(imageCollectionMatcher.get()))
+    pqMatcher->setCodebooksFolders(loadCodebooksFolder, saveCodebooksFolder);
 
   const std::vector<feature::EImageDescriberType> describerTypes = feature::EImageDescriberType_stringToEnums(describerTypesName);
 
@@ -369,22 +398,35 @@ int main(int argc, char **argv)
     std::cout << "-> " << EImageDescriberType_enumToString(descType) << " Regions Matching" << std::endl;
 
     // Photometric matching of putative pairs
-    imageCollectionMatcher->Match(sfmData, regionPerView, pairs, descType, mapPutativesMatches);
-
-    // TODO: DELI
-    // if(!guided_matching) regionPerView.clearDescriptors()
+    try
+    {
+      imageCollectionMatcher->Match(sfmData, regionPerView, pairs, descType, mapPutativesMatches);
+    }
+    catch(const std::exception& e)
+    {
+      std::cerr << std::endl << "Matching failed: " << e.what() << std::endl;
+      return EXIT_FAILURE;
+    }
   }
 
-  if(mapPutativesMatches.empty())
+  // the geometric filtering only needs the descriptors for the guided matching
+  if(!guidedMatching)
+    regionPerView.clearDescriptors();
+
+  // the putative matches are packed in one buffer for the export and the geometric filtering
+  const PackedPairwiseMatches putativeMatches(mapPutativesMatches);
+  PairwiseMatches().swap(mapPutativesMatches);
+
+  if(putativeMatches.empty())
   {
     std::cout << "No putative matches." << std::endl;
     // If we only compute a selection of matches, we may have no match.
     return rangeSize ? EXIT_SUCCESS : EXIT_FAILURE;
   }
 
-  std::cout << mapPutativesMatches.size() << " putative image pair matches" << std::endl;
+  std::cout << putativeMatches.size() << " putative image pair matches" << std::endl;
 
-  for(const auto& imageMatch: mapPutativesMatches)
+  for(const auto& imageMatch: putativeMatches)
   {
     std::cout << " * image pair " << imageMatch.first.first << ", " << imageMatch.first.second << ": " << imageMatch.second.getNbAllMatches() << " putative matches." << std::endl;
   }
@@ -393,7 +435,7 @@ int main(int argc, char **argv)
   //-- Export putative matches
   //---------------------------------------
   if(savePutativeMatches)
-    Save(mapPutativesMatches, matchesFolder, "putative", fileExtension, matchFilePerImage);
+    Save(putativeMatches, matchesFolder, "putative", fileExtension, matchFilePerImage);
 
   std::cout << "Task (Regions Matching) done in (s): " << timer.elapsed() << std::endl;
 
@@ -424,7 +466,7 @@ int main(int argc, char **argv)
 #ifdef ALICEVISION_DEBUG_MATCHING
     {
       std::cout << "PUTATIVE" << std::endl;
-      getStatsMap(mapPutativesMatches);
+      getStatsMap(putativeMatches);
     }
 #endif
 
@@ -446,7 +488,7 @@ int main(int argc, char **argv)
     {
       const bool bGeometric_only_guided_matching = true;
       geometricFilter.Robust_model_estimation(GeometricFilterMatrix_H_AC(std::numeric_limits<double>::infinity(), maxIteration),
-        mapPutativesMatches, guidedMatching,
+        putativeMatches, guidedMatching,
         bGeometric_only_guided_matching ? -1.0 : 0.6);
       map_GeometricMatches = geometricFilter.Get_geometric_matches();
     }
@@ -454,14 +496,14 @@ int main(int argc, char **argv)
     case FUNDAMENTAL_MATRIX:
     {
       geometricFilter.Robust_model_estimation(GeometricFilterMatrix_F_AC(std::numeric_limits<double>::infinity(), maxIteration, geometricEstimator),
-        mapPutativesMatches, guidedMatching);
+        putativeMatches, guidedMatching);
       map_GeometricMatches = geometricFilter.Get_geometric_matches();
     }
     break;
     case ESSENTIAL_MATRIX:
     {
       geometricFilter.Robust_model_estimation(GeometricFilterMatrix_E_AC(std::numeric_limits<double>::infinity(), maxIteration),
-        mapPutativesMatches, guidedMatching);
+        putativeMatches, guidedMatching);
       map_GeometricMatches = geometricFilter.Get_geometric_matches();
 
       //-- Perform an additional check to remove pairs with poor overlap
@@ -469,7 +511,7 @@ int main(int argc, char **argv)
       for(PairwiseMatches::const_iterator iterMap = map_GeometricMatches.begin();
         iterMap != map_GeometricMatches.end(); ++iterMap)
       {
-        const size_t putativePhotometricCount = mapPutativesMatches.find(iterMap->first)->second.getNbAllMatches();
+        const size_t putativePhotometricCount = putativeMatches.at(iterMap->first).second.getNbAllMatches();
         const size_t putativeGeometricCount = iterMap->second.getNbAllMatches();
         const float ratio = putativeGeometricCount / (float)putativePhotometricCount;
         if (putativeGeometricCount < 50 || ratio < .3f)
@@ -494,6 +536,8 @@ int main(int argc, char **argv)
     std::cout << " * Image pair (" << matchGeo.first.first << ", " << matchGeo.first.second << ") contains " << matchGeo.second.getNbAllMatches() << " geometric matches." << std::endl;
   }
 
+  std::cout << "Task (Geometric filtering) done in (s): " << timer.elapsed() << std::endl;
+
   //---------------------------------------
   //-- Grid Filtering
   //---------------------------------------
@@ -505,60 +549,80 @@ int main(int argc, char **argv)
   }
   else
   {
-    for(const auto& matchGeo: map_GeometricMatches)
+    timer.reset();
+
+    // the pairs are filtered in parallel in place, the map structure is not modified
+    std::vector<PairwiseMatches::iterator> pairsToFilter;
+    pairsToFilter.reserve(map_GeometricMatches.size());
+    for(PairwiseMatches::iterator matchGeo = map_GeometricMatches.begin(); matchGeo != map_GeometricMatches.end(); ++matchGeo)
+      pairsToFilter.push_back(matchGeo);
+
+    #pragma omp parallel
     {
-      //Get the image pair and their matches.
-      const Pair& indexImagePair = matchGeo.first;
-      const aliceVision::matching::MatchesPerDescType& matchesPerDesc = matchGeo.second;
+      // one filter per thread, its buffers are reused for all the pairs
+      feature::MatchesGridFilter gridFilter;
 
-      for(const auto& match: matchesPerDesc)
+      #pragma omp for schedule(dynamic)
+      for(int i = 0; i < static_cast<int>(pairsToFilter.size()); ++i)
       {
-        const feature::EImageDescriberType descType = match.first;
-        assert(descType != feature::EImageDescriberType::UNINITIALIZED);
-        const aliceVision::matching::IndMatches& inputMatches = match.second;
-
-        const feature::FeatRegions<feature::SIOPointFeature>* rRegions = dynamic_cast<const feature::FeatRegions<feature::SIOPointFeature>*>(&regionPerView.getRegions(indexImagePair.second, descType));
-        const feature::FeatRegions<feature::SIOPointFeature>* lRegions = dynamic_cast<const feature::FeatRegions<feature::SIOPointFeature>*>(&regionPerView.getRegions(indexImagePair.first, descType));
+        //Get the image pair and their matches.
+        const Pair& indexImagePair = pairsToFilter[i]->first;
+        aliceVision::matching::MatchesPerDescType& matchesPerDesc = pairsToFilter[i]->second;
+        const sfm::View& lView = *sfmData.GetViews().at(indexImagePair.first);
+        const sfm::View& rView = *sfmData.GetViews().at(indexImagePair.second);
 
-        //Get the regions for the current view pair:
-        if(rRegions && lRegions)
+        for(auto& match: matchesPerDesc)
         {
-          //Sorting function:
-          aliceVision::matching::IndMatches outMatches;
-          sortMatches(inputMatches, *lRegions, *rRegions, outMatches);
+          const feature::EImageDescriberType descType = match.first;
+          assert(descType != feature::EImageDescriberType::UNINITIALIZED);
 
-          if(useGridSort)
+          const feature::FeatRegions<feature::SIOPointFeature>* rRegions = dynamic_cast<const feature::FeatRegions<feature::SIOPointFeature>*>(&regionPerView.getRegions(indexImagePair.second, descType));
+          const feature::FeatRegions<feature::SIOPointFeature>* lRegions = dynamic_cast<const feature::FeatRegions<feature::SIOPointFeature>*>(&regionPerView.getRegions(indexImagePair.first, descType));
+
+          //Get the regions for the current view pair:
+          if(rRegions && lRegions)
           {
-            matchesGridFiltering(*lRegions, *rRegions, indexImagePair, sfmData, outMatches);
+            gridFilter.filter(*lRegions, *rRegions,
+                              std::make_pair(lView.getWidth(), lView.getHeight()),
+                              std::make_pair(rView.getWidth(), rView.getHeight()),
+                              numMatchesToKeep, useGridSort, match.second);
+          }
+          else
+          {
+            #pragma omp critical
+            std::cout << "You cannot perform the grid filtering with these regions" << std::endl;
+            match.second.clear();
           }
-
-          size_t finalSize = std::min(numMatchesToKeep, outMatches.size());
-          outMatches.resize(finalSize);
-
-          // std::cout << "Left features: " << lRegions->Features().size() << ", right features: " << rRegions->Features().size() << ", num matches: " << inputMatches.size() << ", num filtered matches: " << outMatches.size() << std::endl;
-          finalMatches[indexImagePair].insert(std::make_pair(descType, outMatches));
-        }
-        else
-        {
-          std::cout << "You cannot perform the grid filtering with these regions" << std::endl;
         }
       }
     }
 
+    for(auto& matchGeo: map_GeometricMatches)
+    {
+      for(auto& match: matchGeo.second)
+      {
+        if(!match.second.empty())
+          finalMatches[matchGeo.first].insert(std::make_pair(match.first, std::move(match.second)));
+      }
+    }
+
     std::cout << "After grid filtering:" << std::endl;
     for(const auto& matchGridFiltering: finalMatches)
     {
       std::cout << " * Image pair (" << matchGridFiltering.first.first << ", " << matchGridFiltering.first.second << ") contains " << matchGridFiltering.second.getNbAllMatches() << " geometric matches." << std::endl;
     }
+
+    std::cout << "Task (Grid filtering) done in (s): " << timer.elapsed() << std::endl;
   }
 
   //---------------------------------------
   //-- Export geometric filtered matches
   //---------------------------------------
+  timer.reset();
   std::cout << "Save geometric matches." << std::endl;
   Save(finalMatches, matchesFolder, geometricMode, fileExtension, matchFilePerImage);
 
-  std::cout << "Task done in (s): " << timer.elapsed() << std::endl;
+  std::cout << "Task (Export) done in (s): " << timer.elapsed() << std::endl;
 
   if(exportDebugFiles)
   {
@@ -376,6 +376,9 @@ int main(int argc, char** argv)
       db.computeTfIdfWeights();
     }
 
+    // all the documents are inserted, build the inverted index for the queries
+    db.buildInvertedIndex();
+
     //**********************************************************
     // Query the database to get all the pair list
     //**********************************************************
@@ -88,6 +88,9 @@ int main(int argc, char **argv)
   int userCameraModel = static_cast<int>(PINHOLE_CAMERA_RADIAL3);
   bool refineIntrinsics = true;
   bool allowUserInteraction = true;
+  std::string checkpointFolder;
+  int checkpointInterval = 0;
+  bool resume = false;
 
   po::options_description allParams(
     "Sequential/Incremental reconstruction\n"
@@ -129,7 +132,13 @@ int main(int argc, char **argv)
       "Refine intrinsic parameters.")
     ("allowUserInteraction", po::value<bool>(&allowUserInteraction)->default_value(allowUserInteraction),
       "Enable/Disable user interactions.\n"
-      "If the process is done on renderfarm, it doesn't make sense to wait for user inputs");
+      "If the process is done on renderfarm, it doesn't make sense to wait for user inputs")
+    ("checkpointInterval", po::value<int>(&checkpointInterval)->default_value(checkpointInterval),
+      "Number of resection groups between two checkpoints of the reconstruction (0 to disable the checkpoints).")
+    ("checkpointFolder", po::value<std::string>(&checkpointFolder)->default_value(checkpointFolder),
+      "Folder of the checkpoint files (by default, the 'checkpoint' folder in extraInfoFolder).")
+    ("resume", po::value<bool>(&resume)->default_value(resume),
+      "Resume the reconstruction from the last checkpoint of the checkpoint folder.");
 
   po::options_description logParams("Log parameters");
   logParams.add_options()
@@ -200,7 +209,7 @@ int main(int argc, char **argv)
   }
   
   // Matches reading
-  matching::PairwiseMatches pairwiseMatches;
+  matching::PackedPairwiseMatches pairwiseMatches;
 
   if(!loadPairwiseMatches(pairwiseMatches, sfmData, matchesFolder, describerTypes, "f"))
   {
@@ -217,6 +226,9 @@ int main(int argc, char **argv)
   if (!stlplus::folder_exists(extraInfoFolder))
     stlplus::folder_create(extraInfoFolder);
 
+  if(checkpointFolder.empty())
+    checkpointFolder = stlplus::folder_append_separator(extraInfoFolder) + "checkpoint";
+
   // Sequential reconstruction process
   aliceVision::system::Timer timer;
   ReconstructionEngine_sequentialSfM sfmEngine(
@@ -235,6 +247,9 @@ int main(int argc, char **argv)
   sfmEngine.setSfmdataInterFileExtension(outInterFileExtension);
   sfmEngine.setAllowUserInteraction(allowUserInteraction);
 
+  sfmEngine.setCheckpoint(checkpointFolder, std::max(checkpointInterval, 0));
+  sfmEngine.setResumeFromCheckpoint(resume);
+
   // Handle Initial pair parameter
   if(!initialPairString.first.empty() && !initialPairString.second.empty())
   {
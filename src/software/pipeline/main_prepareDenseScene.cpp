@@ -6,6 +6,7 @@
 #include <aliceVision/sfm/sfm.hpp>
 #include <aliceVision/image/image.hpp>
 #include <aliceVision/image/convertion.hpp>
+#include <aliceVision/image/ImageProcessingPipeline.hpp>
 #include <aliceVision/config.hpp>
 
 #include <boost/program_options.hpp>
@@ -16,6 +17,7 @@
 #include <cmath>
 #include <iterator>
 #include <iomanip>
+#include <mutex>
 
 using namespace aliceVision;
 using namespace aliceVision::camera;
@@ -160,7 +162,8 @@ std::string replaceAll( std::string const& original, std::string const& from, st
 bool prepareDenseScene(
   const SfMData & sfm_data,
   int scale,
-  const std::string & sOutDirectory // Output CMPMVS files folder
+  const std::string & sOutDirectory, // Output CMPMVS files folder
+  const ImagePipelineParams & pipelineParams
   )
 {
   // Create basis folder structure
@@ -194,31 +197,34 @@ bool prepareDenseScene(
   SeedsPerView seedsPerView;
   retrieveSeedsPerView(sfm_data, map_viewIdToContiguous, seedsPerView);
   
-  // Export data
-  boost::progress_display my_progress_bar(map_viewIdToContiguous.size(),
-                                     std::cout, "\n- Exporting Data -\n");
+  // Views in the contiguous index order
+  std::vector<std::pair<IndexT, IndexT> > viewsToExport(map_viewIdToContiguous.size());
+  for(const auto& viewIdToContiguous : map_viewIdToContiguous)
+    viewsToExport[viewIdToContiguous.second - 1] = viewIdToContiguous;
+
+  const auto getBaseFilename = [](IndexT contiguousViewIndex)
+  {
+    std::ostringstream baseFilenameSS;
+    baseFilenameSS << std::setw(5) << std::setfill('0') << contiguousViewIndex;
+    return baseFilenameSS.str();
+  };
 
   // Export views:
   //   - 00001_P.txt (Pose of the reconstructed camera)
-  //   - 00001._c.png (undistorted & scaled colored image)
   //   - 00001_seeds.bin (3d points visible in this image)
   #pragma omp parallel for num_threads(3)
-  for(int i = 0; i < map_viewIdToContiguous.size(); ++i)
+  for(int i = 0; i < viewsToExport.size(); ++i)
   {
-    auto viewIdToContiguous = map_viewIdToContiguous.cbegin();
-    std::advance(viewIdToContiguous, i);
-    const IndexT viewId = viewIdToContiguous->first;
+    const IndexT viewId = viewsToExport[i].first;
     const View * view = sfm_data.GetViews().at(viewId).get();
 
     assert(view->getViewId() == viewId);
-    const IndexT contiguousViewIndex = viewIdToContiguous->second;
+    const IndexT contiguousViewIndex = viewsToExport[i].second;
     Intrinsics::const_iterator iterIntrinsic = sfm_data.GetIntrinsics().find(view->getIntrinsicId());
     // We have a valid view with a corresponding camera & pose
-    assert(viewIdToContiguous->second == i + 1);
+    assert(contiguousViewIndex == i + 1);
 
-    std::ostringstream baseFilenameSS;
-    baseFilenameSS << std::setw(5) << std::setfill('0') << contiguousViewIndex;
-    const std::string baseFilename = baseFilenameSS.str();
+    const std::string baseFilename = getBaseFilename(contiguousViewIndex);
 
     // Export camera pose
     {
@@ -233,35 +239,71 @@ bool prepareDenseScene(
            << P(2, 0) << " " << P(2, 1) << " "  << P(2, 2) << " "  << P(2, 3) << "\n";
       file.close();
     }
-    
-    // Export undistort image
+
+    // Export Seeds
     {
-      const std::string srcImage = stlplus::create_filespec(sfm_data.s_root_path, view->getImagePath());
+      const std::string seedsFilepath = stlplus::create_filespec(
+        stlplus::folder_append_separator(sOutDirectory), baseFilename + "_seeds", "bin");
+      std::ofstream seedsFile(seedsFilepath, std::ios::binary);
+      
+      const int nbSeeds = seedsPerView[contiguousViewIndex].size();
+      seedsFile.write((char*)&nbSeeds, sizeof(int));
+      
+      for(const Seed& seed: seedsPerView[contiguousViewIndex])
+      {
+        seedsFile.write((char*)&seed, sizeof(seed_io_block) + sizeof(unsigned short) + 2 * sizeof(point2d)); //sizeof(Seed));
+      }
+      seedsFile.close();
+    }
+  }
 
-      std::string dstColorImage = stlplus::create_filespec(
-        stlplus::folder_append_separator(sOutDirectory), baseFilename + "._c", "png");
+  // Export images:
+  //   - 00001._c.png (undistorted & scaled colored image)
+  // The images are read, undistorted & scaled and written concurrently
+  boost::progress_display my_progress_bar(viewsToExport.size(),
+                                     std::cout, "\n- Exporting Images -\n");
+  std::mutex progressMutex;
+
+  // The undistortion maps are computed once per camera and image size
+  UndistortionMapCache undistortionMaps;
+
+  const ImageProcessingPipeline<RGBColor> pipeline(pipelineParams);
+  const ImagePipelineStats stats = pipeline.run(viewsToExport.size(),
+    // read
+    [&](std::size_t i, Image<RGBColor>& image)
+    {
+      const View * view = sfm_data.GetViews().at(viewsToExport[i].first).get();
+      const std::string srcImage = stlplus::create_filespec(sfm_data.s_root_path, view->getImagePath());
+      if(!ReadImage(srcImage.c_str(), &image))
+      {
+        ALICEVISION_LOG_WARNING("Cannot read the image: " << srcImage);
+        return false;
+      }
+      return true;
+    },
+    // undistort & rescale
+    [&](std::size_t i, Image<RGBColor>& image)
+    {
+      const View * view = sfm_data.GetViews().at(viewsToExport[i].first).get();
+      const IntrinsicBase * cam = sfm_data.GetIntrinsics().at(view->getIntrinsicId()).get();
 
-      const IntrinsicBase * cam = iterIntrinsic->second.get();
-      Image<RGBColor> image;
-      ReadImage(srcImage.c_str(), &image);
-      
       // Undistort
       Image<RGBColor> image_ud;
       if (cam->isValid() && cam->have_disto())
       {
         // undistort the image and save it
-        UndistortImage(image, cam, image_ud, BLACK);
+        UndistortImage(image, *undistortionMaps.get(*cam, image.Width(), image.Height()), image_ud, BLACK);
       }
       else
       {
-        image_ud = image;
+        image_ud.swap(image);
       }
       
       // Rescale
       Image<RGBColor> image_ud_scaled;
       if(scale == 1)
       {
-        image_ud_scaled = image_ud;
+        image_ud_scaled.swap(image_ud);
       }
       else if(scale == 2)
       {
@@ -290,29 +332,23 @@ bool prepareDenseScene(
       else
       {
         std::cerr << "Rescale not implemented." << std::endl;
-        image_ud_scaled = image_ud;
+        image_ud_scaled.swap(image_ud);
       }
-      WriteImage(dstColorImage.c_str(), image_ud_scaled);
-    }
-    
-    // Export Seeds
+      image.swap(image_ud_scaled);
+    },
+    // write
+    [&](std::size_t i, const Image<RGBColor>& image)
     {
-      const std::string seedsFilepath = stlplus::create_filespec(
-        stlplus::folder_append_separator(sOutDirectory), baseFilename + "_seeds", "bin");
-      std::ofstream seedsFile(seedsFilepath, std::ios::binary);
-      
-      const int nbSeeds = seedsPerView[contiguousViewIndex].size();
-      seedsFile.write((char*)&nbSeeds, sizeof(int));
-      
-      for(const Seed& seed: seedsPerView[contiguousViewIndex])
-      {
-        seedsFile.write((char*)&seed, sizeof(seed_io_block) + sizeof(unsigned short) + 2 * sizeof(point2d)); //sizeof(Seed));
-      }
-      seedsFile.close();
-    }
-   #pragma omp critical
-    ++my_progress_bar;
-  }
+      const std::string dstColorImage = stlplus::create_filespec(
+        stlplus::folder_append_separator(sOutDirectory), getBaseFilename(viewsToExport[i].second) + "._c", "png");
+      const bool isWritten = WriteImage(dstColorImage.c_str(), image);
+
+      std::lock_guard<std::mutex> lock(progressMutex);
+      ++my_progress_bar;
+      return isWritten;
+    });
+
+  ALICEVISION_LOG_INFO(stats);
 
   // Write the cmpmvs ini file
   std::ostringstream os;
@@ -354,6 +390,8 @@ int main(int argc, char *argv[])
   std::string sfmDataFilename;
   std::string outFolder;
   int scale = 2;
+  ImagePipelineParams pipelineParams;
+  std::size_t maxInFlightMemory = pipelineParams.maxInFlightBytes / (1024 * 1024);
 
   po::options_description allParams("AliceVision prepareDenseScene");
 
@@ -367,7 +405,15 @@ int main(int argc, char *argv[])
   po::options_description optionalParams("Optional parameters");
   optionalParams.add_options()
     ("scale", po::value<int>(&scale)->default_value(scale),
-      "Image downscale factor.");
+      "Image downscale factor.")
+    ("nbDecodeThreads", po::value<std::size_t>(&pipelineParams.nbDecodeThreads)->default_value(pipelineParams.nbDecodeThreads),
+      "Number of threads reading the images.")
+    ("nbTransformThreads", po::value<std::size_t>(&pipelineParams.nbTransformThreads)->default_value(pipelineParams.nbTransformThreads),
+      "Number of threads undistorting and rescaling the images (0: use all the cores).")
+    ("nbEncodeThreads", po::value<std::size_t>(&pipelineParams.nbEncodeThreads)->default_value(pipelineParams.nbEncodeThreads),
+      "Number of threads writing the images.")
+    ("maxInFlightMemory", po::value<std::size_t>(&maxInFlightMemory)->default_value(maxInFlightMemory),
+      "Maximum memory used by the images being processed (in MB).");
 
   po::options_description logParams("Log parameters");
   logParams.add_options()
@@ -404,6 +450,8 @@ int main(int argc, char *argv[])
   // set verbose level
   system::Logger::get()->setLogLevel(verboseLevel);
 
+  pipelineParams.maxInFlightBytes = maxInFlightMemory * 1024 * 1024;
+
   // export
   {
     outFolder = stlplus::folder_to_path(outFolder);
@@ -421,7 +469,7 @@ int main(int argc, char *argv[])
       return EXIT_FAILURE;
     }
 
-    if (!prepareDenseScene(sfm_data, scale, stlplus::filespec_to_path(outFolder, "_tmp_scale" + std::to_string(scale))))
+    if (!prepareDenseScene(sfm_data, scale, stlplus::filespec_to_path(outFolder, "_tmp_scale" + std::to_string(scale)), pipelineParams))
       return EXIT_FAILURE;
   }
 
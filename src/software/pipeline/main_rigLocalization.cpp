@@ -142,6 +142,8 @@ int main(int argc, char** argv)
   std::size_t numResults = 4;
   /// maximum number of matching documents to retain
   std::size_t maxResults = 10;
+  /// Number of database views whose matchers are kept in memory between frames
+  std::size_t matcherCacheSize = 0;
   
   // parameters for cctag localizer
   std::size_t nNearestKeyFrames = 5;
@@ -212,6 +214,9 @@ int main(int argc, char** argv)
           "[voctree] Maximum matching error (in pixels) allowed for image matching with "
           "geometric verification. If set to 0 it lets the ACRansac select "
           "an optimal value.")
+      ("matcherCacheSize", po::value<std::size_t>(&matcherCacheSize)->default_value(matcherCacheSize),
+          "[voctree] Number of database images whose matching structures are kept "
+          "in memory and reused by the following frames (0 = Disable)")
 #if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_CCTAG)
   // parameters for cctag localizer
       ("nNearestKeyFrames", po::value<std::size_t>(&nNearestKeyFrames)->default_value(nNearestKeyFrames),
@@ -308,6 +313,7 @@ int main(int argc, char** argv)
     tmpParam->_maxResults = maxResults;
     tmpParam->_ccTagUseCuda = false;
     tmpParam->_matchingError = matchingErrorMax;
+    tmpParam->_matcherCacheSize = matcherCacheSize;
     
   }
 #if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_CCTAG)
@@ -0,0 +1,167 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/sfm/SfMData.hpp>
+#include <aliceVision/sfm/sfmDataIO.hpp>
+#include <aliceVision/sfm/pipeline/regionsIO.hpp>
+#include <aliceVision/feature/imageDescriberCommon.hpp>
+#include <aliceVision/matchingImageCollection/pairBuilder.hpp>
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/cmdline.hpp>
+
+#include <dependencies/stlplus3/filesystemSimplified/file_system.hpp>
+
+#include <boost/program_options.hpp>
+
+#include <cstdlib>
+#include <numeric>
+
+using namespace aliceVision;
+using namespace aliceVision::sfm;
+namespace po = boost::program_options;
+
+/// Split the image pairs to match in chunks of balanced matching costs.
+/// Each chunk is saved as an image pairs list, to be matched by a separate featureMatching job
+/// (--imagePairsList), and the match folders of the jobs are then merged with mergeMatches.
+int main(int argc, char **argv)
+{
+  // command-line parameters
+
+  std::string verboseLevel = system::EVerboseLevel_enumToString(system::Logger::getDefaultVerboseLevel());
+  std::string sfmDataFilename;
+  std::string featuresFolder;
+  std::string outputFolder;
+
+  // user optional parameters
+
+  std::string describerTypesName = feature::EImageDescriberType_enumToString(feature::EImageDescriberType::SIFT);
+  std::string predefinedPairList;
+  int nbChunks = 4;
+
+  po::options_description allParams(
+    "Split the image pairs to match in chunks of balanced matching costs.\n"
+    "The cost of a pair is estimated from the number of features of its images.\n"
+    "AliceVision featureMatchingChunks");
+
+  po::options_description requiredParams("Required parameters");
+  requiredParams.add_options()
+    ("input,i", po::value<std::string>(&sfmDataFilename)->required(),
+      "SfMData file.")
+    ("featuresFolder,f", po::value<std::string>(&featuresFolder)->required(),
+      "Path to a folder containing the extracted features.")
+    ("output,o", po::value<std::string>(&outputFolder)->required(),
+      "Path to a folder in which the image pairs list of each chunk will be stored.");
+
+  po::options_description optionalParams("Optional parameters");
+  optionalParams.add_options()
+    ("describerTypes,d", po::value<std::string>(&describerTypesName)->default_value(describerTypesName),
+      feature::EImageDescriberType_informations().c_str())
+    ("imagePairsList,l", po::value<std::string>(&predefinedPairList)->default_value(predefinedPairList),
+      "Path to a file which contains the list of image pairs to match (exhaustive pairs if empty).")
+    ("nbChunks,n", po::value<int>(&nbChunks)->default_value(nbChunks),
+      "Number of chunks.");
+
+  po::options_description logParams("Log parameters");
+  logParams.add_options()
+    ("verboseLevel,v", po::value<std::string>(&verboseLevel)->default_value(verboseLevel),
+      "verbosity level (fatal, error, warning, info, debug, trace).");
+
+  allParams.add(requiredParams).add(optionalParams).add(logParams);
+
+  po::variables_map vm;
+  try
+  {
+    po::store(po::parse_command_line(argc, argv, allParams), vm);
+
+    if(vm.count("help") || (argc == 1))
+    {
+      ALICEVISION_COUT(allParams);
+      return EXIT_SUCCESS;
+    }
+    po::notify(vm);
+  }
+  catch(boost::program_options::required_option& e)
+  {
+    ALICEVISION_CERR("ERROR: " << e.what());
+    ALICEVISION_COUT("Usage:\n\n" << allParams);
+    return EXIT_FAILURE;
+  }
+  catch(boost::program_options::error& e)
+  {
+    ALICEVISION_CERR("ERROR: " << e.what());
+    ALICEVISION_COUT("Usage:\n\n" << allParams);
+    return EXIT_FAILURE;
+  }
+
+  ALICEVISION_COUT("Program called with the following parameters:");
+  ALICEVISION_COUT(vm);
+
+  // set verbose level
+  system::Logger::get()->setLogLevel(verboseLevel);
+
+  if(nbChunks < 1)
+  {
+    ALICEVISION_LOG_ERROR("Invalid number of chunks: " << nbChunks);
+    return EXIT_FAILURE;
+  }
+
+  if(!stlplus::folder_exists(outputFolder) && !stlplus::folder_create(outputFolder))
+  {
+    ALICEVISION_LOG_ERROR("Cannot create the output folder: " << outputFolder);
+    return EXIT_FAILURE;
+  }
+
+  SfMData sfmData;
+  if(!Load(sfmData, sfmDataFilename, ESfMData(VIEWS)))
+  {
+    ALICEVISION_LOG_ERROR("The input SfMData file '" << sfmDataFilename << "' cannot be read.");
+    return EXIT_FAILURE;
+  }
+
+  PairSet pairs;
+  if(predefinedPairList.empty())
+  {
+    pairs = exhaustivePairs(sfmData.GetViews());
+  }
+  else if(!loadPairs(predefinedPairList, pairs))
+  {
+    return EXIT_FAILURE;
+  }
+
+  std::set<IndexT> viewIds;
+  for(const Pair& pair : pairs)
+  {
+    viewIds.insert(pair.first);
+    viewIds.insert(pair.second);
+  }
+
+  // only the descriptor file headers are read
+  const std::vector<feature::EImageDescriberType> describerTypes = feature::EImageDescriberType_stringToEnums(describerTypesName);
+  std::map<IndexT, std::size_t> nbFeaturesPerView;
+  if(!loadNbFeaturesPerView(nbFeaturesPerView, sfmData, featuresFolder, describerTypes, viewIds))
+    ALICEVISION_LOG_WARNING("Some feature counts are missing, the cost of their pairs is underestimated.");
+
+  std::vector<std::size_t> chunksCost;
+  const std::vector<PairSet> chunks = splitPairsInChunks(pairs, nbFeaturesPerView, nbChunks, &chunksCost);
+
+  const std::size_t totalCost = std::accumulate(chunksCost.begin(), chunksCost.end(), std::size_t(0));
+  std::size_t chunkIndex = 0;
+  for(std::size_t i = 0; i < chunks.size(); ++i)
+  {
+    // an empty pairs list is an error for featureMatching
+    if(chunks[i].empty())
+      continue;
+
+    const std::string chunkFilename = stlplus::create_filespec(outputFolder, "imagePairs_" + std::to_string(chunkIndex++), "txt");
+    if(!savePairs(chunkFilename, chunks[i]))
+      return EXIT_FAILURE;
+
+    ALICEVISION_LOG_INFO(chunkFilename << ": " << chunks[i].size() << " pairs, "
+                         << (totalCost > 0 ? 100.0 * chunksCost[i] / totalCost : 0.0) << "% of the estimated cost.");
+  }
+
+  ALICEVISION_LOG_INFO(pairs.size() << " image pairs split in " << chunkIndex << " chunks.");
+  return EXIT_SUCCESS;
+}
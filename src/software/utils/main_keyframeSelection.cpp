@@ -37,6 +37,7 @@ int main(int argc, char** argv)
   unsigned int minFrameStep = 12;
   unsigned int maxFrameStep = 36;
   unsigned int maxNbOutFrame = 0;
+  unsigned int nbThreads = 0;
 
   po::options_description allParams("This program is used to extract keyframes from single camera or a camera rig");
 
@@ -74,7 +75,9 @@ int main(int argc, char** argv)
       ("maxFrameStep", po::value<unsigned int>(&maxFrameStep)->default_value(maxFrameStep), 
         "maximum number of frames after which a keyframe can be taken")
       ("maxNbOutFrame", po::value<unsigned int>(&maxNbOutFrame)->default_value(maxNbOutFrame), 
-        "maximum number of output frames (0 = no limit)");
+        "maximum number of output frames (0 = no limit)")
+      ("nbThreads", po::value<unsigned int>(&nbThreads)->default_value(nbThreads),
+        "number of threads analyzing the frames, the frames are decoded ahead (0 = all cores, 1 = serial processing)");
 
   allParams.add(inputParams).add(metadataParams).add(algorithmParams);
 
@@ -152,7 +155,8 @@ int main(int argc, char** argv)
                  << "\tsharp subset : "               << sharpSubset     << std::endl
                  << "\tmin frame step : "             << minFrameStep    << std::endl
                  << "\tmax frame step : "             << maxFrameStep    << std::endl
-                 << "\tmax nb out frame : "           << maxNbOutFrame   << std::endl);
+                 << "\tmax nb out frame : "           << maxNbOutFrame   << std::endl
+                 << "\tnb threads : "                 << nbThreads       << std::endl);
   }
 
   // initialize KeyframeSelector
@@ -190,6 +194,7 @@ int main(int argc, char** argv)
   selector.setMinFrameStep(minFrameStep);
   selector.setMaxFrameStep(maxFrameStep);
   selector.setMaxOutFrame(maxNbOutFrame);
+  selector.setNbThreads(nbThreads);
   
   // process
   selector.process();        
@@ -0,0 +1,122 @@
+// This file is part of the AliceVision project.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/matching/io.hpp>
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/Timer.hpp>
+#include <aliceVision/system/cmdline.hpp>
+
+#include <dependencies/stlplus3/filesystemSimplified/file_system.hpp>
+
+#include <boost/program_options.hpp>
+
+#include <cstdlib>
+
+using namespace aliceVision;
+namespace po = boost::program_options;
+
+/// Merge the match folders of featureMatching jobs run on chunks of the image pairs in a single match file.
+int main(int argc, char **argv)
+{
+  // command-line parameters
+
+  std::string verboseLevel = system::EVerboseLevel_enumToString(system::Logger::getDefaultVerboseLevel());
+  std::vector<std::string> matchesFolders;
+  std::string outputFolder;
+
+  // user optional parameters
+
+  std::string geometricMode = "f";
+  std::string fileExtension = "bin";
+  bool matchFilePerImage = false;
+
+  po::options_description allParams(
+    "Merge the matches of several folders (e.g. the outputs of featureMatching jobs run on chunks of the image pairs).\n"
+    "AliceVision mergeMatches");
+
+  po::options_description requiredParams("Required parameters");
+  requiredParams.add_options()
+    ("input,i", po::value<std::vector<std::string>>(&matchesFolders)->multitoken()->required(),
+      "Path to the folders containing the matches to merge.")
+    ("output,o", po::value<std::string>(&outputFolder)->required(),
+      "Path to a folder in which the merged matches will be stored.");
+
+  po::options_description optionalParams("Optional parameters");
+  optionalParams.add_options()
+    ("geometricModel,g", po::value<std::string>(&geometricMode)->default_value(geometricMode),
+      "Type of the matches to merge: f, e, h or putative.")
+    ("fileExtension", po::value<std::string>(&fileExtension)->default_value(fileExtension),
+      "File extension to store matches (bin or txt).")
+    ("matchFilePerImage", po::value<bool>(&matchFilePerImage)->default_value(matchFilePerImage),
+      "Save matches in a separate file per image.");
+
+  po::options_description logParams("Log parameters");
+  logParams.add_options()
+    ("verboseLevel,v", po::value<std::string>(&verboseLevel)->default_value(verboseLevel),
+      "verbosity level (fatal, error, warning, info, debug, trace).");
+
+  allParams.add(requiredParams).add(optionalParams).add(logParams);
+
+  po::variables_map vm;
+  try
+  {
+    po::store(po::parse_command_line(argc, argv, allParams), vm);
+
+    if(vm.count("help") || (argc == 1))
+    {
+      ALICEVISION_COUT(allParams);
+      return EXIT_SUCCESS;
+    }
+    po::notify(vm);
+  }
+  catch(boost::program_options::required_option& e)
+  {
+    ALICEVISION_CERR("ERROR: " << e.what());
+    ALICEVISION_COUT("Usage:\n\n" << allParams);
+    return EXIT_FAILURE;
+  }
+  catch(boost::program_options::error& e)
+  {
+    ALICEVISION_CERR("ERROR: " << e.what());
+    ALICEVISION_COUT("Usage:\n\n" << allParams);
+    return EXIT_FAILURE;
+  }
+
+  ALICEVISION_COUT("Program called with the following parameters:");
+  ALICEVISION_COUT(vm);
+
+  // set verbose level
+  system::Logger::get()->setLogLevel(verboseLevel);
+
+  if(!stlplus::folder_exists(outputFolder) && !stlplus::folder_create(outputFolder))
+  {
+    ALICEVISION_LOG_ERROR("Cannot create the output folder: " << outputFolder);
+    return EXIT_FAILURE;
+  }
+
+  system::Timer timer;
+
+  matching::PairwiseMatches matches;
+  if(!matching::MergeMatchFolders(matches, matchesFolders, geometricMode))
+  {
+    ALICEVISION_LOG_ERROR("Failed to merge the matches.");
+    return EXIT_FAILURE;
+  }
+
+  std::size_t nbMatches = 0;
+  for(const auto& matchesPerPair : matches)
+    nbMatches += matchesPerPair.second.getNbAllMatches();
+
+  ALICEVISION_LOG_INFO(matchesFolders.size() << " folders merged: " << matches.size() << " image pairs, " << nbMatches << " matches.");
+
+  if(!matching::Save(matches, outputFolder, geometricMode, fileExtension, matchFilePerImage))
+  {
+    ALICEVISION_LOG_ERROR("Failed to save the merged matches in: " << outputFolder);
+    return EXIT_FAILURE;
+  }
+
+  ALICEVISION_LOG_INFO("Task done in (s): " << timer.elapsed());
+  return EXIT_SUCCESS;
+}
@@ -30,6 +30,7 @@ int main( int argc, char **argv )
   std::string outputFolder ;
   int selectionMethod;
   int imgRef;
+  std::size_t imageCacheSize = 1024;
 
   po::options_description allParams("AliceVision sfmColorHarmonize");
 
@@ -51,12 +52,14 @@ int main( int argc, char **argv )
   po::options_description optionalParams("Optional parameters");
   optionalParams.add_options()
     ("describerTypes,d", po::value<std::string>(&describerTypesName)->default_value(describerTypesName),
-      feature::EImageDescriberType_informations().c_str());
+      feature::EImageDescriberType_informations().c_str())
     ("matchesGeometricModel,g", po::value<std::string>(&matchesGeometricModel)->default_value(matchesGeometricModel),
       "Matches geometric Model :\n"
       "- f: fundamental matrix\n"
       "- e: essential matrix\n"
-      "- h: homography matrix");
+      "- h: homography matrix")
+    ("imageCacheSize", po::value<std::size_t>(&imageCacheSize)->default_value(imageCacheSize),
+      "Maximum memory used by the decoded images shared by the image pairs (in MB).");
 
   po::options_description logParams("Log parameters");
   logParams.add_options()
@@ -118,6 +121,7 @@ int main( int argc, char **argv )
     describerTypes,
     selectionMethod,
     imgRef);
+  colorHarmonizeEngine.setImageCacheSize(imageCacheSize * 1024 * 1024);
 
   if (colorHarmonizeEngine.Process() )
   {
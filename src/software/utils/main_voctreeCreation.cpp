@@ -18,6 +18,7 @@
 #include <fstream>
 #include <string>
 #include <chrono>
+#include <random>
 
 static const int DIMENSION = 128;
 
@@ -43,6 +44,8 @@ int main(int argc, char** argv)
   uint32_t restart = 5;
   uint32_t LEVELS = 6;
   bool sanityCheck = true;
+  bool quantizeCenters = false;
+  unsigned int randomSeed = std::mt19937::default_seed;
 
   po::options_description desc("Options:");
   desc.add_options()
@@ -55,7 +58,9 @@ int main(int argc, char** argv)
           (",k", po::value<uint32_t>(&K)->default_value(10), "The branching factor of the tree")
           ("restart,r", po::value<uint32_t>(&restart)->default_value(5), "Number of times that the kmean is launched for each cluster, the best solution is kept")
           (",L", po::value<uint32_t>(&LEVELS)->default_value(6), "Number of levels of the tree")
-          ("sanitycheck,s", po::value<bool>(&sanityCheck)->default_value(sanityCheck), "Perform a sanity check at the end of the creation of the vocabulary tree. The sanity check is a query to the database with the same documents/images useed to train the vocabulary tree");
+          ("randomSeed", po::value<unsigned int>(&randomSeed)->default_value(randomSeed), "Seed of the k-means initialization, the same seed gives the same tree")
+          ("sanitycheck,s", po::value<bool>(&sanityCheck)->default_value(sanityCheck), "Perform a sanity check at the end of the creation of the vocabulary tree. The sanity check is a query to the database with the same documents/images useed to train the vocabulary tree")
+          ("quantizeCenters", po::value<bool>(&quantizeCenters)->default_value(quantizeCenters), "Store the centers of the tree as 8-bit values instead of floats (4 times smaller file, suited to SIFT descriptors). The tree can then be memory-mapped by the localizer");
 
 
   po::variables_map vm;
@@ -99,6 +104,7 @@ int main(int argc, char** argv)
             << "keylist: " << keylist << std::endl
             << "restart: " << restart << std::endl
             << "sanity check: " << sanityCheck << std::endl
+            << "quantize centers: " << quantizeCenters << std::endl
             << "verbosity: " << verbosity << std::endl << std::endl;
   }
 
@@ -123,6 +129,7 @@ int main(int argc, char** argv)
   aliceVision::voctree::TreeBuilder<DescriptorFloat> builder(DescriptorFloat(0));
   builder.setVerbose(verbosity);
   builder.kmeans().setRestarts(restart);
+  builder.setSeed(randomSeed);
   ALICEVISION_COUT("Building a tree of L=" << LEVELS << " levels with a branching factor of k=" << K);
   detect_start = std::chrono::steady_clock::now();
   builder.build(descriptors, K, LEVELS);
@@ -131,7 +138,7 @@ int main(int argc, char** argv)
   ALICEVISION_COUT("Tree created in " << ((float) detect_elapsed.count()) / 1000 << " sec");
   ALICEVISION_COUT(builder.tree().centers().size() << " centers");
   ALICEVISION_COUT("Saving vocabulary tree as " << treeName);
-  builder.tree().save(treeName);
+  builder.tree().save(treeName, quantizeCenters ? aliceVision::voctree::EVocTreeCenterType::UINT8 : aliceVision::voctree::EVocTreeCenterType::FLOAT32);
 
   aliceVision::voctree::SparseHistogramPerImage allSparseHistograms;
   // temporary vector used to save all the visual word for each image before adding them to documents
@@ -187,6 +194,7 @@ int main(int argc, char** argv)
   ALICEVISION_COUT("Computing weights done in " << detect_elapsed.count() << " sec");
   ALICEVISION_COUT("Saving weights as " << weightName);
   db.saveWeights(weightName);
+  db.buildInvertedIndex();
 
 
   if(sanityCheck)
@@ -287,6 +287,7 @@ int main(int argc, char** argv)
     ALICEVISION_COUT("Computing weights...");
     db.computeTfIdfWeights();
   }
+  db.buildInvertedIndex();
 
 
   //************************************************
@@ -7,6 +7,7 @@
 #include "software/utils/sfmHelper/sfmIOHelper.hpp"
 
 #include "aliceVision/image/image.hpp"
+#include "aliceVision/image/ImageCache.hpp"
 //-- Load features per view
 #include <aliceVision/sfm/pipeline/regionsIO.hpp>
 //-- Feature matches
@@ -30,6 +31,8 @@
 #include "aliceVision/colorHarmonization/GainOffsetConstraintBuilder.hpp"
 
 #include "aliceVision/system/Timer.hpp"
+#include "aliceVision/system/Logger.hpp"
+#include <aliceVision/alicevision_omp.hpp>
 
 #include <boost/progress.hpp>
 
@@ -167,15 +170,10 @@ bool ColorHarmonizationEngineGlobal::Process()
   std::map<size_t, size_t> map_cameraIndexTocameraNode; // 0->Ncam correspondance to graph node Id
   std::set<size_t> set_indeximage;
 
-  for (size_t i = 0; i < _pairwiseMatches.size(); ++i)
+  for (const auto& iter : _pairwiseMatches)
   {
-    matching::PairwiseMatches::const_iterator iter = _pairwiseMatches.begin();
-    std::advance(iter, i);
-
-    const size_t I = iter->first.first;
-    const size_t J = iter->first.second;
-    set_indeximage.insert(I);
-    set_indeximage.insert(J);
+    set_indeximage.insert(iter.first.first);
+    set_indeximage.insert(iter.first.second);
   }
 
   for (std::set<size_t>::const_iterator iterSet = set_indeximage.begin();
@@ -198,10 +196,30 @@ bool ColorHarmonizationEngineGlobal::Process()
   map_relativeHistograms[1].resize(_pairwiseMatches.size());
   map_relativeHistograms[2].resize(_pairwiseMatches.size());
 
-  for (size_t i = 0; i < _pairwiseMatches.size(); ++i)
+  if(_selectionMethod != eHistogramHarmonizeFullFrame &&
+     _selectionMethod != eHistogramHarmonizeMatchedPoints &&
+     _selectionMethod != eHistogramHarmonizeVLDSegment)
   {
-    matching::PairwiseMatches::const_iterator iter = _pairwiseMatches.begin();
-    std::advance(iter, i);
+    std::cout << "Selection method unsupported" << std::endl;
+    return false;
+  }
+
+  // The pairs are sorted by their first view: consecutive pairs share an image,
+  // each image is decoded once as long as it stays in the cache.
+  std::vector<matching::PairwiseMatches::const_iterator> pairs;
+  pairs.reserve(_pairwiseMatches.size());
+  for(matching::PairwiseMatches::const_iterator iter = _pairwiseMatches.begin(); iter != _pairwiseMatches.end(); ++iter)
+    pairs.push_back(iter);
+
+  ImageCache<RGBColor> imageCache(_imageCacheSize);
+  boost::progress_display progressBarPairs(pairs.size(), std::cout, "\n- Compute the histograms of the pairs -\n");
+  bool bOk = true;
+
+  // The edges are independent, they are computed in parallel
+  #pragma omp parallel for schedule(dynamic)
+  for (int i = 0; i < pairs.size(); ++i)
+  {
+    matching::PairwiseMatches::const_iterator iter = pairs[i];
 
     const size_t viewI = iter->first.first;
     const size_t viewJ = iter->first.second;
@@ -212,9 +230,17 @@ bool ColorHarmonizationEngineGlobal::Process()
     //-- Edges names:
     std::pair< std::string, std::string > p_imaNames;
     p_imaNames = make_pair( _vec_fileNames[ viewI ], _vec_fileNames[ viewJ ] );
-    std::cout << "Current edge : "
-      << stlplus::filename_part(p_imaNames.first) << "\t"
-      << stlplus::filename_part(p_imaNames.second) << std::endl;
+
+    const ImageCache<RGBColor>::ImagePtr imageI = imageCache.get(p_imaNames.first);
+    const ImageCache<RGBColor>::ImagePtr imageJ = imageCache.get(p_imaNames.second);
+    if(!imageI || !imageJ)
+    {
+      ALICEVISION_LOG_WARNING("Unable to read the images of the edge: "
+        << stlplus::filename_part(p_imaNames.first) << ", " << stlplus::filename_part(p_imaNames.second));
+      #pragma omp critical
+      bOk = false;
+      continue;
+    }
 
     //-- Compute the masks from the data selection:
     Image< unsigned char > maskI ( _vec_imageSize[ viewI ].first, _vec_imageSize[ viewI ].second );
@@ -248,6 +274,11 @@ bool ColorHarmonizationEngineGlobal::Process()
         maskI.fill(0);
         maskJ.fill(0);
 
+        // grey images converted from the cached color images
+        Image< unsigned char > greyI, greyJ;
+        ConvertPixelType(*imageI, &greyI);
+        ConvertPixelType(*imageJ, &greyJ);
+
         for(const auto& matchesIt: matchesPerDesc)
         {
           const feature::EImageDescriberType descType = matchesIt.first;
@@ -257,15 +288,16 @@ bool ColorHarmonizationEngineGlobal::Process()
             p_imaNames.second,
             matches,
             feature::getSIOPointFeatures(_regionsPerView.getRegions(viewI, descType)),
-            feature::getSIOPointFeatures(_regionsPerView.getRegions(viewJ, descType)));
+            feature::getSIOPointFeatures(_regionsPerView.getRegions(viewJ, descType)),
+            &greyI,
+            &greyJ);
 
           dataSelector.computeMask( maskI, maskJ );
         }
       }
       break;
       default:
-        std::cout << "Selection method unsupported" << std::endl;
-        return false;
+      break;
     }
 
     //-- Export the masks
@@ -287,38 +319,29 @@ bool ColorHarmonizationEngineGlobal::Process()
       WriteImage( out_filename_J.c_str(), maskJ );
     }
 
-    //-- Compute the histograms
-    Image< RGBColor > imageI, imageJ;
-    ReadImage( p_imaNames.first.c_str(), &imageI );
-    ReadImage( p_imaNames.second.c_str(), &imageJ );
-
-    Histogram< double > histoI( minvalue, maxvalue, bin);
-    Histogram< double > histoJ( minvalue, maxvalue, bin);
-
-    int channelIndex = 0; // RED channel
-    colorHarmonization::CommonDataByPair::computeHisto( histoI, maskI, channelIndex, imageI );
-    colorHarmonization::CommonDataByPair::computeHisto( histoJ, maskJ, channelIndex, imageJ );
-    relativeColorHistogramEdge & edgeR = map_relativeHistograms[channelIndex][i];
-    edgeR = relativeColorHistogramEdge(map_cameraNodeToCameraIndex[viewI], map_cameraNodeToCameraIndex[viewJ],
-      histoI.GetHist(), histoJ.GetHist());
-
-    histoI = histoJ = Histogram< double >( minvalue, maxvalue, bin);
-    channelIndex = 1; // GREEN channel
-    colorHarmonization::CommonDataByPair::computeHisto( histoI, maskI, channelIndex, imageI );
-    colorHarmonization::CommonDataByPair::computeHisto( histoJ, maskJ, channelIndex, imageJ );
-    relativeColorHistogramEdge & edgeG = map_relativeHistograms[channelIndex][i];
-    edgeG = relativeColorHistogramEdge(map_cameraNodeToCameraIndex[viewI], map_cameraNodeToCameraIndex[viewJ],
-      histoI.GetHist(), histoJ.GetHist());
-
-    histoI = histoJ = Histogram< double >( minvalue, maxvalue, bin);
-    channelIndex = 2; // BLUE channel
-    colorHarmonization::CommonDataByPair::computeHisto( histoI, maskI, channelIndex, imageI );
-    colorHarmonization::CommonDataByPair::computeHisto( histoJ, maskJ, channelIndex, imageJ );
-    relativeColorHistogramEdge & edgeB = map_relativeHistograms[channelIndex][i];
-    edgeB = relativeColorHistogramEdge(map_cameraNodeToCameraIndex[viewI], map_cameraNodeToCameraIndex[viewJ],
-      histoI.GetHist(), histoJ.GetHist());
+    //-- Compute the histograms of the RGB channels
+    const size_t cameraIndexI = map_cameraNodeToCameraIndex.at(viewI);
+    const size_t cameraIndexJ = map_cameraNodeToCameraIndex.at(viewJ);
+    for(int channelIndex = 0; channelIndex < 3; ++channelIndex)
+    {
+      Histogram< double > histoI( minvalue, maxvalue, bin);
+      Histogram< double > histoJ( minvalue, maxvalue, bin);
+      colorHarmonization::CommonDataByPair::computeHisto( histoI, maskI, channelIndex, *imageI );
+      colorHarmonization::CommonDataByPair::computeHisto( histoJ, maskJ, channelIndex, *imageJ );
+      // each edge has its own slot, they can be filled concurrently
+      map_relativeHistograms[channelIndex][i] = relativeColorHistogramEdge(cameraIndexI, cameraIndexJ,
+        histoI.GetHist(), histoJ.GetHist());
+    }
+
+    #pragma omp critical
+    ++progressBarPairs;
   }
 
+  ALICEVISION_LOG_INFO("Histograms computed with " << imageCache.nbLoads() << " image decodings for "
+    << set_indeximage.size() << " images.");
+  if(!bOk)
+    return false;
+
   std::cout << "\n -- \n SOLVE for color consistency with linear programming\n --" << std::endl;
   //-- Solve for the gains and offsets:
   std::vector<size_t> vec_indexToFix;
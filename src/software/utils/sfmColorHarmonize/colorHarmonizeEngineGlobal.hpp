@@ -59,11 +59,15 @@ public:
 
   const std::vector< std::pair< size_t, size_t > > & getImagesSize() const { return _vec_imageSize; }
 
+  /// Set the maximum memory (in bytes) of the decoded images shared by the pairs
+  void setImageCacheSize(std::size_t imageCacheSize) { _imageCacheSize = imageCacheSize; }
+
 private:
 
   EHistogramSelectionMethod _selectionMethod;
   int _imgRef;
   std::string _sMatchesGeometricModel;
+  std::size_t _imageCacheSize = 1024 * 1024 * 1024; // 1GB
 
   // -----
   // Input data